@@ -51,6 +51,7 @@ namespace dmBuffer
         Stream*  m_Streams;
         uint32_t m_Stride;          // The struct size (in bytes)
         uint32_t m_Count;           // The number of "structs" in the buffer (e.g. vertex count)
+        uint32_t m_Capacity;        // The number of "structs" the data segment has room for
         uint16_t m_Version;
         uint16_t m_ContentVersion;  // A running number, which user can use to signal content changes
         uint8_t  m_NumStreams;
@@ -389,6 +390,7 @@ namespace dmBuffer
         // Get buffer from data block start
         Buffer* buffer = (Buffer*)data_block;
         buffer->m_Count = count;
+        buffer->m_Capacity = count;
         buffer->m_NumStreams = streams_decl_count;
         buffer->m_Streams = (Buffer::Stream*)((uintptr_t)data_block + sizeof(Buffer));
         buffer->m_Data = (void*)((uintptr_t)data_block + header_size);
@@ -459,6 +461,40 @@ namespace dmBuffer
         return RESULT_OK;
     }
 
+    Result Resize(HBuffer hbuffer, uint32_t count)
+    {
+        BufferContext* ctx = g_BufferContext;
+        Buffer* buffer = GetBuffer(ctx, hbuffer);
+        if (!buffer) {
+            return RESULT_BUFFER_INVALID;
+        }
+
+        if (count > buffer->m_Capacity)
+        {
+            // Same layout as in Create, the header and the streams are moved along with the data
+            uint32_t header_size = (uint32_t)((uintptr_t)buffer->m_Data - (uintptr_t)buffer);
+            uint32_t buffer_size = header_size + buffer->m_Stride * count + GUARD_SIZE;
+
+            void* data_block = 0x0;
+            dmMemory::Result r = dmMemory::AlignedMalloc((void**)&data_block, ADDR_ALIGNMENT, buffer_size);
+            if (r != dmMemory::RESULT_OK) {
+                return RESULT_ALLOCATION_ERROR;
+            }
+            memcpy(data_block, buffer, header_size + buffer->m_Stride * buffer->m_Count);
+            dmMemory::AlignedFree(buffer);
+
+            buffer = (Buffer*)data_block;
+            buffer->m_Streams = (Buffer::Stream*)((uintptr_t)data_block + sizeof(Buffer));
+            buffer->m_Data = (void*)((uintptr_t)data_block + header_size);
+            buffer->m_Capacity = count;
+            ctx->m_Buffers[hbuffer & 0xffff] = buffer;
+        }
+
+        buffer->m_Count = count;
+        WriteGuard((uint8_t*)buffer->m_Data + (buffer->m_Count * buffer->m_Stride));
+        return RESULT_OK;
+    }
+
     void Destroy(HBuffer hbuffer)
     {
         if (hbuffer) {
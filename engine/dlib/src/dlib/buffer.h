@@ -69,6 +69,19 @@ Result GetStreamName(HBuffer buffer, uint32_t index, dmhash_t* stream_name);
 */
 Result GetStreamOffset(HBuffer buffer, uint32_t index, uint32_t* offset);
 
+/*# set the number of elements in a buffer
+ *
+ * Sets the number of elements in the buffer, keeping the handle and the values of the
+ * elements that are kept. The memory is only reallocated if the buffer grows past the
+ * largest count it has had, so a buffer that is filled again every frame can be reused.
+ * Stream pointers fetched before the call are invalid afterwards.
+ * @name dmBuffer::Resize
+ * @param buffer [type:dmBuffer::HBuffer] The buffer
+ * @param count [type:uint32_t] The new number of elements
+ * @return result [type:dmBuffer::Result] RESULT_OK if the buffer was resized
+*/
+Result Resize(HBuffer buffer, uint32_t count);
+
 
 // FOR UNIT TESTING
 Result CalcStructSize(uint32_t num_streams, const StreamDeclaration* streams, uint32_t* size, uint32_t* offsets);
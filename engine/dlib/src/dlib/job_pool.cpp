@@ -0,0 +1,196 @@
+// Copyright 2020 The Defold Foundation
+// Licensed under the Defold License version 1.0 (the "License"); you may not use
+// this file except in compliance with the License.
+//
+// You may obtain a copy of the License, together with FAQs at
+// https://www.defold.com/license
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include <assert.h>
+
+#include "job_pool.h"
+#include "array.h"
+#include "atomic.h"
+#include "condition_variable.h"
+#include "dstrings.h"
+#include "math.h"
+#include "mutex.h"
+#include "profile.h"
+#include "thread.h"
+
+namespace dmJobPool
+{
+    // Aim for a few batches per thread, so that uneven batches even out
+    const uint32_t BATCHES_PER_THREAD = 4;
+    const uint32_t MAX_THREAD_NAME    = 32;
+
+    struct JobPool
+    {
+        dmArray<dmThread::Thread>               m_Threads;
+        // The thread names must outlive the start of the threads
+        char*                                   m_ThreadNames;
+        // Serializes calls to ParallelFor
+        dmMutex::HMutex                         m_CallMutex;
+        dmMutex::HMutex                         m_Mutex;
+        // Signalled when a new job is started, or when the pool is deleted
+        dmConditionVariable::HConditionVariable m_WorkCondition;
+        // Signalled when the last worker has finished the current job
+        dmConditionVariable::HConditionVariable m_DoneCondition;
+
+        // Current job. Protected by m_Mutex
+        RangeFunction                           m_Function;
+        void*                                   m_Context;
+        uint32_t                                m_Count;
+        uint32_t                                m_BatchSize;
+        uint32_t                                m_Generation;
+        uint32_t                                m_ActiveWorkers;
+        uint32_t                                m_Quit : 1;
+
+        // Start of the next batch to process
+        int32_atomic_t                          m_Next;
+    };
+
+    static void RunBatches(JobPool* pool, RangeFunction function, void* context, uint32_t count, uint32_t batch_size)
+    {
+        while (true)
+        {
+            uint32_t begin = (uint32_t) dmAtomicAdd32(&pool->m_Next, (int32_t) batch_size);
+            if (begin >= count)
+                break;
+            function(context, begin, dmMath::Min(begin + batch_size, count));
+        }
+    }
+
+    static void WorkerThread(void* arg)
+    {
+        JobPool* pool = (JobPool*) arg;
+        uint32_t generation = 0;
+
+        dmMutex::Lock(pool->m_Mutex);
+        while (true)
+        {
+            while (!pool->m_Quit && pool->m_Generation == generation)
+            {
+                dmConditionVariable::Wait(pool->m_WorkCondition, pool->m_Mutex);
+            }
+            if (pool->m_Quit)
+                break;
+
+            generation = pool->m_Generation;
+            RangeFunction function = pool->m_Function;
+            void* context = pool->m_Context;
+            uint32_t count = pool->m_Count;
+            uint32_t batch_size = pool->m_BatchSize;
+            dmMutex::Unlock(pool->m_Mutex);
+
+            RunBatches(pool, function, context, count, batch_size);
+
+            dmMutex::Lock(pool->m_Mutex);
+            if (--pool->m_ActiveWorkers == 0)
+            {
+                dmConditionVariable::Signal(pool->m_DoneCondition);
+            }
+        }
+        dmMutex::Unlock(pool->m_Mutex);
+    }
+
+    HJobPool New(const char* name, uint32_t worker_count)
+    {
+#if defined(__EMSCRIPTEN__)
+        worker_count = 0;
+#endif
+        JobPool* pool = new JobPool;
+        pool->m_CallMutex = dmMutex::New();
+        pool->m_Mutex = dmMutex::New();
+        pool->m_WorkCondition = dmConditionVariable::New();
+        pool->m_DoneCondition = dmConditionVariable::New();
+        pool->m_Function = 0;
+        pool->m_Context = 0;
+        pool->m_Count = 0;
+        pool->m_BatchSize = 0;
+        pool->m_Generation = 0;
+        pool->m_ActiveWorkers = 0;
+        pool->m_Quit = 0;
+        pool->m_Next = 0;
+
+        pool->m_ThreadNames = new char[worker_count * MAX_THREAD_NAME];
+        pool->m_Threads.SetCapacity(worker_count);
+        for (uint32_t i = 0; i < worker_count; ++i)
+        {
+            char* thread_name = &pool->m_ThreadNames[i * MAX_THREAD_NAME];
+            dmSnPrintf(thread_name, MAX_THREAD_NAME, "%s%u", name, i);
+            pool->m_Threads.Push(dmThread::New(WorkerThread, 0x80000, pool, thread_name));
+        }
+        return pool;
+    }
+
+    void Delete(HJobPool pool)
+    {
+        dmMutex::Lock(pool->m_Mutex);
+        pool->m_Quit = 1;
+        dmConditionVariable::Broadcast(pool->m_WorkCondition);
+        dmMutex::Unlock(pool->m_Mutex);
+
+        for (uint32_t i = 0; i < pool->m_Threads.Size(); ++i)
+        {
+            dmThread::Join(pool->m_Threads[i]);
+        }
+
+        dmConditionVariable::Delete(pool->m_DoneCondition);
+        dmConditionVariable::Delete(pool->m_WorkCondition);
+        dmMutex::Delete(pool->m_Mutex);
+        dmMutex::Delete(pool->m_CallMutex);
+        delete [] pool->m_ThreadNames;
+        delete pool;
+    }
+
+    uint32_t GetWorkerCount(HJobPool pool)
+    {
+        return pool->m_Threads.Size();
+    }
+
+    void ParallelFor(HJobPool pool, uint32_t count, uint32_t min_batch_size, RangeFunction function, void* context)
+    {
+        if (count == 0)
+            return;
+
+        uint32_t worker_count = pool ? pool->m_Threads.Size() : 0;
+        min_batch_size = dmMath::Max(min_batch_size, 1U);
+        if (worker_count == 0 || count <= min_batch_size)
+        {
+            function(context, 0, count);
+            return;
+        }
+
+        DM_PROFILE(JobPool, "ParallelFor");
+
+        uint32_t target_batch_count = (worker_count + 1) * BATCHES_PER_THREAD;
+        uint32_t batch_size = dmMath::Max(min_batch_size, (count + target_batch_count - 1) / target_batch_count);
+
+        DM_MUTEX_SCOPED_LOCK(pool->m_CallMutex);
+
+        dmMutex::Lock(pool->m_Mutex);
+        pool->m_Function = function;
+        pool->m_Context = context;
+        pool->m_Count = count;
+        pool->m_BatchSize = batch_size;
+        pool->m_ActiveWorkers = worker_count;
+        dmAtomicStore32(&pool->m_Next, 0);
+        pool->m_Generation++;
+        dmConditionVariable::Broadcast(pool->m_WorkCondition);
+        dmMutex::Unlock(pool->m_Mutex);
+
+        RunBatches(pool, function, context, count, batch_size);
+
+        dmMutex::Lock(pool->m_Mutex);
+        while (pool->m_ActiveWorkers > 0)
+        {
+            dmConditionVariable::Wait(pool->m_DoneCondition, pool->m_Mutex);
+        }
+        dmMutex::Unlock(pool->m_Mutex);
+    }
+}
@@ -0,0 +1,70 @@
+// Copyright 2020 The Defold Foundation
+// Licensed under the Defold License version 1.0 (the "License"); you may not use
+// this file except in compliance with the License.
+//
+// You may obtain a copy of the License, together with FAQs at
+// https://www.defold.com/license
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#ifndef DM_JOB_POOL_H
+#define DM_JOB_POOL_H
+
+#include <stdint.h>
+
+/**
+ * Pool of worker threads for data parallel work
+ */
+namespace dmJobPool
+{
+    typedef struct JobPool* HJobPool;
+
+    /**
+     * Range function. Called with a sub range [begin, end) of the full range
+     * @param context user context
+     * @param begin first index
+     * @param end last index (exclusive)
+     */
+    typedef void (*RangeFunction)(void* context, uint32_t begin, uint32_t end);
+
+    /**
+     * Create a new job pool
+     * @note On platforms without thread support no worker threads are created,
+     * and all work is done on the calling thread
+     * @param name name of the worker threads
+     * @param worker_count number of worker threads. Zero is valid.
+     * @return job pool handle
+     */
+    HJobPool New(const char* name, uint32_t worker_count);
+
+    /**
+     * Delete a job pool. Waits for the worker threads to exit.
+     * @param pool job pool handle
+     */
+    void Delete(HJobPool pool);
+
+    /**
+     * Get the number of worker threads
+     * @param pool job pool handle
+     * @return number of worker threads
+     */
+    uint32_t GetWorkerCount(HJobPool pool);
+
+    /**
+     * Split the range [0, count) into batches and run them on the worker threads and the calling thread.
+     * Returns when the whole range has been processed. If the pool is 0x0, or the range
+     * fits in a single batch, the function is called directly on the calling thread.
+     * @note The function must not call ParallelFor on the same pool
+     * @param pool job pool handle. May be 0x0
+     * @param count size of the range
+     * @param min_batch_size minimum number of elements per batch
+     * @param function range function
+     * @param context user context passed to the function
+     */
+    void ParallelFor(HJobPool pool, uint32_t count, uint32_t min_batch_size, RangeFunction function, void* context);
+}
+
+#endif // DM_JOB_POOL_H
@@ -23,30 +23,57 @@
 #include <dlib/mutex.h>
 #include <dlib/static_assert.h>
 #include <dlib/spinlock.h>
+#include <dlib/thread.h>
 
 namespace dmMessage
 {
     // Alignment of allocations
     const uint32_t DM_MESSAGE_ALIGNMENT = 16U;
+    // Room for the largest message and its MessageHeader
+    const uint32_t DM_MESSAGE_PAGE_MEMORY_SIZE = DM_MESSAGE_PAGE_SIZE + DM_MESSAGE_ALIGNMENT;
+
+    struct MemoryAllocator;
 
     struct MemoryPage
     {
-        uint8_t     m_Memory[DM_MESSAGE_PAGE_SIZE];
-        uint32_t    m_Current;
-        MemoryPage* m_NextPage;
+        uint8_t             m_Memory[DM_MESSAGE_PAGE_MEMORY_SIZE];
+        MemoryAllocator*    m_Allocator;
+        // Link in the free lists of the allocator
+        MemoryPage*         m_NextPage;
+        // Link in the list of all pages of the allocator
+        MemoryPage*         m_NextAllocated;
+        // Number of messages in the page that are not yet dispatched, plus one while it is the current page of the allocator
+        int32_atomic_t      m_RefCount;
+        uint32_t            m_Current;
+    };
+
+    // Stored in front of each message, in DM_MESSAGE_ALIGNMENT bytes
+    struct MessageHeader
+    {
+        MemoryPage* m_Page;
     };
 
+    // Each posting thread has its own allocator, see GetAllocator.
+    // Only the owning thread allocates from it, so no lock is taken. Pages are handed back by the dispatching threads through m_ReturnedPages.
     struct MemoryAllocator
     {
         MemoryAllocator()
         {
             m_CurrentPage = 0;
             m_FreePages = 0;
-            m_FullPages = 0;
-        }
-        MemoryPage* m_CurrentPage;
-        MemoryPage* m_FreePages;
-        MemoryPage* m_FullPages;
+            m_ReturnedPages = 0;
+            m_Pages = 0;
+            m_Next = 0;
+        }
+        MemoryPage*         m_CurrentPage;
+        // Only used by the owning thread
+        MemoryPage*         m_FreePages;
+        // Pushed by any thread without locking, and taken as a whole by the owning thread
+        MemoryPage* volatile m_ReturnedPages;
+        // All pages of the allocator, so that they are deleted with the context
+        MemoryPage*         m_Pages;
+        // Next allocator of the context
+        MemoryAllocator*    m_Next;
     };
 
     struct GlobalInit
@@ -54,17 +81,36 @@ namespace dmMessage
         GlobalInit() {
             // Make sure the struct sizes are in sync! Think of potential save files!
             DM_STATIC_ASSERT(sizeof(dmMessage::URL) == 32, Invalid_Struct_Size);
+            DM_STATIC_ASSERT(sizeof(MessageHeader) <= DM_MESSAGE_ALIGNMENT, Invalid_Struct_Size);
         }
 
     } g_MessageInit;
 
+    // Called by any thread when the last message in the page is released
+    static void ReturnPage(MemoryAllocator* allocator, MemoryPage* page)
+    {
+        MemoryPage* head;
+        do
+        {
+            head = allocator->m_ReturnedPages;
+            page->m_NextPage = head;
+        } while (dmAtomicCompareStorePtr((void* volatile*) &allocator->m_ReturnedPages, page, head) != head);
+    }
+
+    // Called by the owning thread
     static void AllocateNewPage(MemoryAllocator* allocator)
     {
-        if (allocator->m_CurrentPage)
+        MemoryPage* page = allocator->m_CurrentPage;
+        if (page && dmAtomicDecrement32(&page->m_RefCount) == 1)
         {
-            // Link current page to full pages
-            allocator->m_CurrentPage->m_NextPage = allocator->m_FullPages;
-            allocator->m_FullPages = allocator->m_CurrentPage;
+            // All messages in the page are already dispatched
+            page->m_NextPage = allocator->m_FreePages;
+            allocator->m_FreePages = page;
+        }
+
+        if (allocator->m_FreePages == 0)
+        {
+            allocator->m_FreePages = (MemoryPage*) dmAtomicStorePtr((void* volatile*) &allocator->m_ReturnedPages, 0);
         }
 
         MemoryPage* new_page = 0;
@@ -79,43 +125,88 @@ namespace dmMessage
         {
             // Allocate new page
             new_page = new MemoryPage;
+            new_page->m_Allocator = allocator;
+            new_page->m_NextAllocated = allocator->m_Pages;
+            allocator->m_Pages = new_page;
         }
 
         new_page->m_Current = 0;
         new_page->m_NextPage = 0;
+        new_page->m_RefCount = 1;
 
         allocator->m_CurrentPage = new_page;
     }
 
+    // Called by the owning thread
     static void* AllocateMessage(MemoryAllocator* allocator, uint32_t size)
     {
         // At least ALIGNMENT bytes alignment of size in order to ensure that the next allocation is aligned
-        size += DM_MESSAGE_ALIGNMENT-1;
+        size += DM_MESSAGE_ALIGNMENT + DM_MESSAGE_ALIGNMENT-1;
         size &= ~(DM_MESSAGE_ALIGNMENT-1);
-        assert(size <= DM_MESSAGE_PAGE_SIZE);
+        assert(size <= DM_MESSAGE_PAGE_MEMORY_SIZE);
 
-        if (allocator->m_CurrentPage == 0 || (DM_MESSAGE_PAGE_SIZE-allocator->m_CurrentPage->m_Current) < size)
+        if (allocator->m_CurrentPage == 0 || (DM_MESSAGE_PAGE_MEMORY_SIZE-allocator->m_CurrentPage->m_Current) < size)
         {
             // No current page or allocation didn't fit.
             AllocateNewPage(allocator);
         }
 
         MemoryPage* page = allocator->m_CurrentPage;
-        void* ret = (void*) ((uintptr_t) &page->m_Memory[0] + page->m_Current);
+        uint8_t* ret = &page->m_Memory[page->m_Current];
         page->m_Current += size;
-        return ret;
+        dmAtomicIncrement32(&page->m_RefCount);
+
+        ((MessageHeader*) ret)->m_Page = page;
+        return ret + DM_MESSAGE_ALIGNMENT;
+    }
+
+    // Releases count messages that were allocated from the page
+    static void ReleasePage(MemoryPage* page, uint32_t count)
+    {
+        if (dmAtomicSub32(&page->m_RefCount, (int32_t) count) == (int32_t) count)
+        {
+            ReturnPage(page->m_Allocator, page);
+        }
+    }
+
+    // Releases the memory of a list of messages
+    static void ReleaseMessages(Message* message)
+    {
+        // Consecutive messages are usually from the same page
+        MemoryPage* page = 0;
+        uint32_t count = 0;
+        while (message)
+        {
+            MemoryPage* message_page = ((MessageHeader*) ((uintptr_t) message - DM_MESSAGE_ALIGNMENT))->m_Page;
+            if (message_page != page)
+            {
+                if (page)
+                {
+                    ReleasePage(page, count);
+                }
+                page = message_page;
+                count = 0;
+            }
+            ++count;
+            message = message->m_Next;
+        }
+        if (page)
+        {
+            ReleasePage(page, count);
+        }
     }
 
     struct MessageSocket
     {
-        uint32_t        m_RefCount; // Is protected by "g_MessageContext->m_Spinlock"
+        int32_atomic_t  m_RefCount; // Is incremented under "g_MessageContext->m_Spinlock"
         dmhash_t        m_NameHash;
-        Message*        m_Header;
-        Message*        m_Tail;
+        // The posted messages, the most recently posted first. Pushed by any thread without locking, and taken as a whole by the dispatch
+        Message* volatile m_Head;
         const char*     m_Name;
+        // Only used by DispatchBlocking, to wait for messages
         dmMutex::HMutex m_Mutex;
         dmConditionVariable::HConditionVariable m_Condition;
-        MemoryAllocator m_Allocator;
+        int32_atomic_t  m_Waiting;
     };
 
     const uint32_t MAX_SOCKETS = 256;
@@ -124,6 +215,10 @@ namespace dmMessage
     {
         dmHashTable64<MessageSocket> m_Sockets;
         dmSpinlock::lock_t m_Spinlock;
+        // All allocators, one for each thread that has posted. Added to under m_Spinlock
+        MemoryAllocator* m_Allocators;
+        // The allocator of the thread
+        dmThread::TlsKey m_AllocatorKey;
     };
 
     MessageContext* g_MessageContext = 0;
@@ -133,9 +228,63 @@ namespace dmMessage
         MessageContext* ctx = new MessageContext;
         ctx->m_Sockets.SetCapacity(max_sockets, max_sockets);
         dmSpinlock::Init(&ctx->m_Spinlock);
+        ctx->m_Allocators = 0;
+        ctx->m_AllocatorKey = dmThread::AllocTls();
         return ctx;
     }
 
+    static void Destroy(MessageContext* ctx)
+    {
+        // Every page is deleted, including the pages holding messages of sockets that are not deleted
+        MemoryAllocator* allocator = ctx->m_Allocators;
+        while (allocator)
+        {
+            MemoryPage* page = allocator->m_Pages;
+            while (page)
+            {
+                MemoryPage* next = page->m_NextAllocated;
+                delete page;
+                page = next;
+            }
+            MemoryAllocator* next = allocator->m_Next;
+            delete allocator;
+            allocator = next;
+        }
+        dmThread::FreeTls(ctx->m_AllocatorKey);
+        delete ctx;
+    }
+
+    static MemoryAllocator* GetAllocator()
+    {
+        MessageContext* ctx = g_MessageContext;
+        MemoryAllocator* allocator = (MemoryAllocator*) dmThread::GetTlsValue(ctx->m_AllocatorKey);
+        if (allocator == 0)
+        {
+            // First post from this thread
+            allocator = new MemoryAllocator;
+            dmThread::SetTlsValue(ctx->m_AllocatorKey, allocator);
+            DM_SPINLOCK_SCOPED_LOCK(ctx->m_Spinlock);
+            allocator->m_Next = ctx->m_Allocators;
+            ctx->m_Allocators = allocator;
+        }
+        return allocator;
+    }
+
+    // Takes all posted messages of the socket, in the order they were posted
+    static Message* TakeMessages(MessageSocket* s)
+    {
+        Message* message = (Message*) dmAtomicStorePtr((void* volatile*) &s->m_Head, 0);
+        Message* first = 0;
+        while (message)
+        {
+            Message* next = message->m_Next;
+            message->m_Next = first;
+            first = message;
+            message = next;
+        }
+        return first;
+    }
+
     // Until the Create/Destroy functions are exposed:
     // The context is created on demand, and we also need to destroy it automatically
     struct ContextDestroyer
@@ -144,7 +293,7 @@ namespace dmMessage
         {
             if (g_MessageContext)
             {
-                delete g_MessageContext;
+                Destroy(g_MessageContext);
                 g_MessageContext = 0;
             }
         }
@@ -178,12 +327,12 @@ namespace dmMessage
 
         MessageSocket s;
         s.m_RefCount = 1;
-        s.m_Header = 0;
-        s.m_Tail = 0;
+        s.m_Head = 0;
         s.m_NameHash = name_hash;
         s.m_Name = strdup(name);
         s.m_Mutex = dmMutex::New();
         s.m_Condition = dmConditionVariable::New();
+        s.m_Waiting = 0;
 
         g_MessageContext->m_Sockets.Put(name_hash, s);
         *socket = name_hash;
@@ -193,7 +342,8 @@ namespace dmMessage
 
     static void DisposeSocket(MessageSocket* s)
     {
-        Message *message_object = s->m_Header;
+        Message* first = TakeMessages(s);
+        Message *message_object = first;
         while (message_object)
         {
             if (message_object->m_DestroyCallback)
@@ -202,28 +352,10 @@ namespace dmMessage
             }
             message_object = message_object->m_Next;
         }
+        ReleaseMessages(first);
 
         free((void*) s->m_Name);
 
-        MemoryPage* p = s->m_Allocator.m_FreePages;
-        while (p)
-        {
-            MemoryPage* next = p->m_NextPage;
-            delete p;
-            p = next;
-        }
-        p = s->m_Allocator.m_FullPages;
-        while (p)
-        {
-            MemoryPage* next = p->m_NextPage;
-            delete p;
-            p = next;
-        }
-        if (s->m_Allocator.m_CurrentPage)
-        {
-            delete s->m_Allocator.m_CurrentPage;
-        }
-
         dmConditionVariable::Delete(s->m_Condition);
 
         dmMutex::Delete(s->m_Mutex);
@@ -233,16 +365,10 @@ namespace dmMessage
 
     static void ReleaseSocket(MessageSocket* s)
     {
+        if (dmAtomicDecrement32(&s->m_RefCount) == 1)
         {
-            DM_SPINLOCK_SCOPED_LOCK(g_MessageContext->m_Spinlock);
-            --s->m_RefCount;
-
-            if (s->m_RefCount > 0)
-            {
-                return;
-            }
+            DisposeSocket(s);
         }
-        DisposeSocket(s);
     }
 
     static MessageSocket* AcquireSocket(HSocket socket)
@@ -258,7 +384,7 @@ namespace dmMessage
 
         assert(s->m_RefCount >= 1);
 
-        ++s->m_RefCount;
+        dmAtomicIncrement32(&s->m_RefCount);
 
         return s;
     }
@@ -275,15 +401,9 @@ namespace dmMessage
             }
 
             g_MessageContext->m_Sockets.Erase(s->m_NameHash);
-            --s->m_RefCount;
-
-            if(s->m_RefCount > 0)
-            {
-                // Defer deletion
-                return RESULT_OK;
-            }
         }
-        DisposeSocket(s);
+        // Deletion is deferred if the socket is in use
+        ReleaseSocket(s);
         return RESULT_OK;
     }
 
@@ -343,11 +463,7 @@ namespace dmMessage
         MessageSocket* s = AcquireSocket(socket);
         if (s != 0)
         {
-            bool has_messages;
-            {
-                DM_MUTEX_SCOPED_LOCK(s->m_Mutex);
-                has_messages = s->m_Header != 0;
-            }
+            bool has_messages = s->m_Head != 0;
             ReleaseSocket(s);
             return has_messages;
         }
@@ -411,11 +527,8 @@ namespace dmMessage
             return RESULT_SOCKET_NOT_FOUND;
         }
 
-        dmMutex::Lock(s->m_Mutex);
-
-        MemoryAllocator* allocator = &s->m_Allocator;
         uint32_t data_size = sizeof(Message) + message_data_size;
-        Message *new_message = (Message *) AllocateMessage(allocator, data_size);
+        Message *new_message = (Message *) AllocateMessage(GetAllocator(), data_size);
         if (sender != 0x0)
         {
             new_message->m_Sender = *sender;
@@ -430,28 +543,22 @@ namespace dmMessage
         new_message->m_UserData2 = user_data2;
         new_message->m_Descriptor = descriptor;
         new_message->m_DataSize = message_data_size;
-        new_message->m_Next = 0;
         new_message->m_DestroyCallback = destroy_callback;
         memcpy(&new_message->m_Data[0], message_data, message_data_size);
 
-        bool is_first_message = !s->m_Header;
-
-        if (!s->m_Header)
-        {
-            s->m_Header = new_message;
-            s->m_Tail = new_message;
-        }
-        else
+        Message* head;
+        do
         {
-            s->m_Tail->m_Next = new_message;
-            s->m_Tail = new_message;
-        }
+            head = s->m_Head;
+            new_message->m_Next = head;
+        } while (dmAtomicCompareStorePtr((void* volatile*) &s->m_Head, new_message, head) != head);
 
-        if (is_first_message)
+        // The socket mutex is only taken if a thread is blocked in DispatchBlocking, see WaitForMessages
+        if (s->m_Waiting)
         {
+            DM_MUTEX_SCOPED_LOCK(s->m_Mutex);
             dmConditionVariable::Signal(s->m_Condition);
         }
-        dmMutex::Unlock(s->m_Mutex);
 
         ReleaseSocket(s);
 
@@ -497,6 +604,18 @@ namespace dmMessage
         return profiler_string;
     }
 
+    static void WaitForMessages(MessageSocket* s)
+    {
+        DM_MUTEX_SCOPED_LOCK(s->m_Mutex);
+        // Announce the wait before checking for messages, so that a Post either sees it or is seen here
+        dmAtomicIncrement32(&s->m_Waiting);
+        if (!s->m_Head)
+        {
+            dmConditionVariable::Wait(s->m_Condition, s->m_Mutex);
+        }
+        dmAtomicDecrement32(&s->m_Waiting);
+    }
+
     uint32_t InternalDispatch(HSocket socket, DispatchCallback dispatch_callback, void* user_ptr, bool blocking)
     {
         MessageSocket* s = AcquireSocket(socket);
@@ -505,19 +624,17 @@ namespace dmMessage
             return 0;
         }
 
-        dmMutex::Lock(s->m_Mutex);
-
-        MemoryAllocator* allocator = &s->m_Allocator;
+        if (!s->m_Head && blocking)
+        {
+            WaitForMessages(s);
+        }
 
-        if (!s->m_Header)
+        // Messages posted from here on are dispatched by the next call
+        Message* first = TakeMessages(s);
+        if (!first)
         {
-            if (blocking) {
-                dmConditionVariable::Wait(s->m_Condition, s->m_Mutex);
-            } else {
-                dmMutex::Unlock(s->m_Mutex);
-                ReleaseSocket(s);
-                return 0;
-            }
+            ReleaseSocket(s);
+            return 0;
         }
 
         uint32_t profiler_hash = 0;
@@ -526,16 +643,7 @@ namespace dmMessage
 
         uint32_t dispatch_count = 0;
 
-        Message *message_object = s->m_Header;
-        s->m_Header = 0;
-        s->m_Tail = 0;
-
-        // Unlink full pages
-        MemoryPage* full_pages = allocator->m_FullPages;
-        allocator->m_FullPages = 0;
-
-        dmMutex::Unlock(s->m_Mutex);
-
+        Message *message_object = first;
         while (message_object)
         {
             dispatch_callback(message_object, user_ptr);
@@ -546,17 +654,7 @@ namespace dmMessage
             dispatch_count++;
         }
 
-        // Reclaim all full pages active when dispatch started
-        dmMutex::Lock(s->m_Mutex);
-        MemoryPage* p = full_pages;
-        while (p)
-        {
-            MemoryPage* next = p->m_NextPage;
-            p->m_NextPage = allocator->m_FreePages;
-            allocator->m_FreePages = p;
-            p = next;
-        }
-        dmMutex::Unlock(s->m_Mutex);
+        ReleaseMessages(first);
 
         ReleaseSocket(s);
 
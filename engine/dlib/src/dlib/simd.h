@@ -0,0 +1,117 @@
+// Copyright 2020 The Defold Foundation
+// Licensed under the Defold License version 1.0 (the "License"); you may not use
+// this file except in compliance with the License.
+//
+// You may obtain a copy of the License, together with FAQs at
+// https://www.defold.com/license
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#ifndef DM_SIMD_H
+#define DM_SIMD_H
+
+#include <stdint.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #include <emmintrin.h>
+    #define DM_SIMD_SSE
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+    #include <arm_neon.h>
+    #define DM_SIMD_NEON
+#endif
+
+/**
+ * Four wide float vectors, using SSE2 or NEON where available and plain floats otherwise.
+ * Loads and stores are unaligned. Check for DM_SIMD_SSE or DM_SIMD_NEON to only take a vectorized
+ * path when it's backed by hardware.
+ */
+namespace dmSimd
+{
+#if defined(DM_SIMD_SSE)
+    typedef __m128 Float4;
+
+    static inline Float4 Load4(const float* p)              { return _mm_loadu_ps(p); }
+    static inline void Store4(float* p, Float4 v)           { _mm_storeu_ps(p, v); }
+    static inline Float4 Splat4(float f)                    { return _mm_set1_ps(f); }
+    static inline Float4 Add4(Float4 a, Float4 b)           { return _mm_add_ps(a, b); }
+    static inline Float4 Sub4(Float4 a, Float4 b)           { return _mm_sub_ps(a, b); }
+    static inline Float4 Mul4(Float4 a, Float4 b)           { return _mm_mul_ps(a, b); }
+    static inline Float4 Min4(Float4 a, Float4 b)           { return _mm_min_ps(a, b); }
+    static inline Float4 Max4(Float4 a, Float4 b)           { return _mm_max_ps(a, b); }
+    // a0 b0 a1 b1
+    static inline Float4 ZipLo4(Float4 a, Float4 b)         { return _mm_unpacklo_ps(a, b); }
+    // a2 b2 a3 b3
+    static inline Float4 ZipHi4(Float4 a, Float4 b)         { return _mm_unpackhi_ps(a, b); }
+
+    // Stores x, y and z, leaving p[3] untouched
+    static inline void Store3(float* p, Float4 v)
+    {
+        _mm_storel_pi((__m64*) p, v);
+        _mm_store_ss(p + 2, _mm_movehl_ps(v, v));
+    }
+
+    // Truncates towards zero, like a cast, and saturates
+    static inline void StoreInt16x8(int16_t* p, Float4 a, Float4 b)
+    {
+        _mm_storeu_si128((__m128i*) p, _mm_packs_epi32(_mm_cvttps_epi32(a), _mm_cvttps_epi32(b)));
+    }
+#elif defined(DM_SIMD_NEON)
+    typedef float32x4_t Float4;
+
+    static inline Float4 Load4(const float* p)              { return vld1q_f32(p); }
+    static inline void Store4(float* p, Float4 v)           { vst1q_f32(p, v); }
+    static inline Float4 Splat4(float f)                    { return vdupq_n_f32(f); }
+    static inline Float4 Add4(Float4 a, Float4 b)           { return vaddq_f32(a, b); }
+    static inline Float4 Sub4(Float4 a, Float4 b)           { return vsubq_f32(a, b); }
+    static inline Float4 Mul4(Float4 a, Float4 b)           { return vmulq_f32(a, b); }
+    static inline Float4 Min4(Float4 a, Float4 b)           { return vminq_f32(a, b); }
+    static inline Float4 Max4(Float4 a, Float4 b)           { return vmaxq_f32(a, b); }
+    static inline Float4 ZipLo4(Float4 a, Float4 b)         { return vzipq_f32(a, b).val[0]; }
+    static inline Float4 ZipHi4(Float4 a, Float4 b)         { return vzipq_f32(a, b).val[1]; }
+
+    static inline void Store3(float* p, Float4 v)
+    {
+        vst1_f32(p, vget_low_f32(v));
+        vst1q_lane_f32(p + 2, v, 2);
+    }
+
+    static inline void StoreInt16x8(int16_t* p, Float4 a, Float4 b)
+    {
+        vst1q_s16(p, vcombine_s16(vqmovn_s32(vcvtq_s32_f32(a)), vqmovn_s32(vcvtq_s32_f32(b))));
+    }
+#else
+    struct Float4 { float x, y, z, w; };
+
+    static inline Float4 Load4(const float* p)              { Float4 r = { p[0], p[1], p[2], p[3] }; return r; }
+    static inline void Store4(float* p, Float4 v)           { p[0] = v.x; p[1] = v.y; p[2] = v.z; p[3] = v.w; }
+    static inline Float4 Splat4(float f)                    { Float4 r = { f, f, f, f }; return r; }
+    static inline Float4 Add4(Float4 a, Float4 b)           { Float4 r = { a.x + b.x, a.y + b.y, a.z + b.z, a.w + b.w }; return r; }
+    static inline Float4 Sub4(Float4 a, Float4 b)           { Float4 r = { a.x - b.x, a.y - b.y, a.z - b.z, a.w - b.w }; return r; }
+    static inline Float4 Mul4(Float4 a, Float4 b)           { Float4 r = { a.x * b.x, a.y * b.y, a.z * b.z, a.w * b.w }; return r; }
+    static inline float Min1(float a, float b)              { return a < b ? a : b; }
+    static inline float Max1(float a, float b)              { return a > b ? a : b; }
+    static inline Float4 Min4(Float4 a, Float4 b)           { Float4 r = { Min1(a.x, b.x), Min1(a.y, b.y), Min1(a.z, b.z), Min1(a.w, b.w) }; return r; }
+    static inline Float4 Max4(Float4 a, Float4 b)           { Float4 r = { Max1(a.x, b.x), Max1(a.y, b.y), Max1(a.z, b.z), Max1(a.w, b.w) }; return r; }
+    static inline Float4 ZipLo4(Float4 a, Float4 b)         { Float4 r = { a.x, b.x, a.y, b.y }; return r; }
+    static inline Float4 ZipHi4(Float4 a, Float4 b)         { Float4 r = { a.z, b.z, a.w, b.w }; return r; }
+    static inline void Store3(float* p, Float4 v)           { p[0] = v.x; p[1] = v.y; p[2] = v.z; }
+
+    static inline int16_t ToInt16(float f)                  { return (int16_t) (f < -32768.0f ? -32768.0f : (f > 32767.0f ? 32767.0f : f)); }
+    static inline void StoreInt16x8(int16_t* p, Float4 a, Float4 b)
+    {
+        p[0] = ToInt16(a.x); p[1] = ToInt16(a.y); p[2] = ToInt16(a.z); p[3] = ToInt16(a.w);
+        p[4] = ToInt16(b.x); p[5] = ToInt16(b.y); p[6] = ToInt16(b.z); p[7] = ToInt16(b.w);
+    }
+#endif
+
+    static inline Float4 Set4(float a, float b, float c, float d)
+    {
+        const float v[4] = { a, b, c, d };
+        return Load4(v);
+    }
+}
+
+#endif // DM_SIMD_H
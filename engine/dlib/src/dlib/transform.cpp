@@ -0,0 +1,129 @@
+// Copyright 2020 The Defold Foundation
+// Licensed under the Defold License version 1.0 (the "License"); you may not use
+// this file except in compliance with the License.
+//
+// You may obtain a copy of the License, together with FAQs at
+// https://www.defold.com/license
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include "transform.h"
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+    #include <xmmintrin.h>
+    #define DM_TRANSFORM_SSE
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+    #include <arm_neon.h>
+    #define DM_TRANSFORM_NEON
+#endif
+
+namespace dmTransform
+{
+#if defined(DM_TRANSFORM_SSE) || defined(DM_TRANSFORM_NEON)
+
+#if defined(DM_TRANSFORM_SSE)
+    typedef __m128 Float4;
+
+    static inline Float4 Load4(const float* p)              { return _mm_loadu_ps(p); }
+    static inline void Store4(float* p, Float4 v)           { _mm_storeu_ps(p, v); }
+    static inline Float4 Splat4(float f)                    { return _mm_set1_ps(f); }
+    static inline Float4 Add4(Float4 a, Float4 b)           { return _mm_add_ps(a, b); }
+    static inline Float4 Sub4(Float4 a, Float4 b)           { return _mm_sub_ps(a, b); }
+    static inline Float4 Mul4(Float4 a, Float4 b)           { return _mm_mul_ps(a, b); }
+
+    static inline void Transpose4(Float4& a, Float4& b, Float4& c, Float4& d)
+    {
+        _MM_TRANSPOSE4_PS(a, b, c, d);
+    }
+#else
+    typedef float32x4_t Float4;
+
+    static inline Float4 Load4(const float* p)              { return vld1q_f32(p); }
+    static inline void Store4(float* p, Float4 v)           { vst1q_f32(p, v); }
+    static inline Float4 Splat4(float f)                    { return vdupq_n_f32(f); }
+    static inline Float4 Add4(Float4 a, Float4 b)           { return vaddq_f32(a, b); }
+    static inline Float4 Sub4(Float4 a, Float4 b)           { return vsubq_f32(a, b); }
+    static inline Float4 Mul4(Float4 a, Float4 b)           { return vmulq_f32(a, b); }
+
+    static inline void Transpose4(Float4& a, Float4& b, Float4& c, Float4& d)
+    {
+        float32x4x2_t ab = vtrnq_f32(a, b);
+        float32x4x2_t cd = vtrnq_f32(c, d);
+        a = vcombine_f32(vget_low_f32(ab.val[0]), vget_low_f32(cd.val[0]));
+        b = vcombine_f32(vget_low_f32(ab.val[1]), vget_low_f32(cd.val[1]));
+        c = vcombine_f32(vget_high_f32(ab.val[0]), vget_high_f32(cd.val[0]));
+        d = vcombine_f32(vget_high_f32(ab.val[1]), vget_high_f32(cd.val[1]));
+    }
+#endif
+
+    // Converts four transforms at a time.
+    // The rotations and scales are transposed so that each register holds one component of all four transforms,
+    // and the columns are transposed back when stored. Follows the operation order of Matrix4(Quat, Vector3)
+    // and appendScale() to give the same result as ToMatrix4(const Transform&)
+    static void ToMatrix4x4(const Transform* t, Matrix4* out)
+    {
+        // The Quat is four floats, and the Vector3 is padded to four floats
+        Float4 qx = Load4(t[0].GetRotationPtr());
+        Float4 qy = Load4(t[1].GetRotationPtr());
+        Float4 qz = Load4(t[2].GetRotationPtr());
+        Float4 qw = Load4(t[3].GetRotationPtr());
+        Transpose4(qx, qy, qz, qw);
+
+        Float4 sx = Load4(t[0].GetScalePtr());
+        Float4 sy = Load4(t[1].GetScalePtr());
+        Float4 sz = Load4(t[2].GetScalePtr());
+        Float4 sw = Load4(t[3].GetScalePtr());
+        Transpose4(sx, sy, sz, sw);
+
+        Float4 one = Splat4(1.0f);
+        Float4 qx2 = Add4(qx, qx);
+        Float4 qy2 = Add4(qy, qy);
+        Float4 qz2 = Add4(qz, qz);
+        Float4 qxqx2 = Mul4(qx, qx2);
+        Float4 qxqy2 = Mul4(qx, qy2);
+        Float4 qxqz2 = Mul4(qx, qz2);
+        Float4 qxqw2 = Mul4(qw, qx2);
+        Float4 qyqy2 = Mul4(qy, qy2);
+        Float4 qyqz2 = Mul4(qy, qz2);
+        Float4 qyqw2 = Mul4(qw, qy2);
+        Float4 qzqz2 = Mul4(qz, qz2);
+        Float4 qzqw2 = Mul4(qw, qz2);
+
+        Float4 zero = Splat4(0.0f);
+        Float4 c0[4] = { Mul4(Sub4(Sub4(one, qyqy2), qzqz2), sx), Mul4(Add4(qxqy2, qzqw2), sx), Mul4(Sub4(qxqz2, qyqw2), sx), zero };
+        Float4 c1[4] = { Mul4(Sub4(qxqy2, qzqw2), sy), Mul4(Sub4(Sub4(one, qxqx2), qzqz2), sy), Mul4(Add4(qyqz2, qxqw2), sy), zero };
+        Float4 c2[4] = { Mul4(Add4(qxqz2, qyqw2), sz), Mul4(Sub4(qyqz2, qxqw2), sz), Mul4(Sub4(Sub4(one, qxqx2), qyqy2), sz), zero };
+        Transpose4(c0[0], c0[1], c0[2], c0[3]);
+        Transpose4(c1[0], c1[1], c1[2], c1[3]);
+        Transpose4(c2[0], c2[1], c2[2], c2[3]);
+
+        for (uint32_t i = 0; i < 4; ++i)
+        {
+            // The Matrix4 is four columns of four floats
+            float* m = (float*) &out[i];
+            Store4(m + 0, c0[i]);
+            Store4(m + 4, c1[i]);
+            Store4(m + 8, c2[i]);
+            out[i].setCol3(Vector4(t[i].GetTranslation(), 1.0f));
+        }
+    }
+#endif
+
+    void ToMatrix4(const Transform* transforms, Matrix4* out_matrices, uint32_t count)
+    {
+        uint32_t i = 0;
+#if defined(DM_TRANSFORM_SSE) || defined(DM_TRANSFORM_NEON)
+        for (; i + 4 <= count; i += 4)
+        {
+            ToMatrix4x4(&transforms[i], &out_matrices[i]);
+        }
+#endif
+        for (; i < count; ++i)
+        {
+            out_matrices[i] = ToMatrix4(transforms[i]);
+        }
+    }
+}
@@ -14,6 +14,7 @@
 #define DM_TRANSFORM_H
 
 #include <assert.h>
+#include <stdint.h>
 #include <dmsdk/dlib/transform.h>
 #include <dmsdk/vectormath/cpp/vectormath_aos.h>
 
@@ -179,6 +180,16 @@ namespace dmTransform
         res = appendScale(res, Vector3(t.GetScale()));
         return res;
     }
+
+    /**
+     * Convert an array of transforms into 4-dim matrices.
+     * Gives the same result as calling ToMatrix4 for each transform, but
+     * converts four transforms at a time when SIMD instructions are available.
+     * @param transforms Transforms to convert
+     * @param out_matrices Resulting matrices. Must hold count matrices
+     * @param count Number of transforms
+     */
+    void ToMatrix4(const Transform* transforms, Matrix4* out_matrices, uint32_t count);
 }
 
 #endif // DM_TRANSFORM_H
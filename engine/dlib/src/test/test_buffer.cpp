@@ -341,6 +341,53 @@ TEST_F(GetDataTest, ValidGetData)
 }
 
 
+TEST_F(GetDataTest, Resize)
+{
+    uint16_t* ptr = 0x0;
+    CLEAR_OUT_VARS();
+    ASSERT_EQ(dmBuffer::RESULT_OK, dmBuffer::GetStream(buffer, dmHashString64("texcoord"), &out_stream, &out_count, &out_components, &out_stride));
+    ptr = (uint16_t*)out_stream;
+    for (uint32_t i = 0; i < out_count; ++i, ptr += out_stride)
+    {
+        ptr[0] = (uint16_t)i;
+        ptr[1] = (uint16_t)(i + 100);
+    }
+
+    // Shrinking keeps the memory
+    ASSERT_EQ(dmBuffer::RESULT_OK, dmBuffer::Resize(buffer, 2));
+    ASSERT_EQ(dmBuffer::RESULT_OK, dmBuffer::ValidateBuffer(buffer));
+    CLEAR_OUT_VARS();
+    ASSERT_EQ(dmBuffer::RESULT_OK, dmBuffer::GetStream(buffer, dmHashString64("texcoord"), &out_stream, &out_count, &out_components, &out_stride));
+    ASSERT_EQ(2, out_count);
+    void* first_stream = out_stream;
+
+    // Growing within the largest count so far keeps the memory
+    ASSERT_EQ(dmBuffer::RESULT_OK, dmBuffer::Resize(buffer, 4));
+    ASSERT_EQ(dmBuffer::RESULT_OK, dmBuffer::ValidateBuffer(buffer));
+    CLEAR_OUT_VARS();
+    ASSERT_EQ(dmBuffer::RESULT_OK, dmBuffer::GetStream(buffer, dmHashString64("texcoord"), &out_stream, &out_count, &out_components, &out_stride));
+    ASSERT_EQ(4, out_count);
+    ASSERT_EQ(first_stream, out_stream);
+
+    // Growing past it moves the values to the new memory, with the same handle
+    ASSERT_EQ(dmBuffer::RESULT_OK, dmBuffer::Resize(buffer, 1000));
+    ASSERT_EQ(dmBuffer::RESULT_OK, dmBuffer::ValidateBuffer(buffer));
+    CLEAR_OUT_VARS();
+    ASSERT_EQ(dmBuffer::RESULT_OK, dmBuffer::GetStream(buffer, dmHashString64("texcoord"), &out_stream, &out_count, &out_components, &out_stride));
+    ASSERT_EQ(1000, out_count);
+    ASSERT_EQ(2, out_components);
+    ASSERT_EQ(stride/sizeof(uint16_t), out_stride);
+    // The values of the elements that were never removed
+    ptr = (uint16_t*)out_stream;
+    for (uint32_t i = 0; i < 2; ++i, ptr += out_stride)
+    {
+        ASSERT_EQ(i, (uint32_t)ptr[0]);
+        ASSERT_EQ(i + 100, (uint32_t)ptr[1]);
+    }
+
+    ASSERT_EQ(dmBuffer::RESULT_BUFFER_INVALID, dmBuffer::Resize(0x0, 4));
+}
+
 TEST_F(GetDataTest, ValidGetBytes)
 {
     // Get texcoord stream
@@ -0,0 +1,146 @@
+// Copyright 2020 The Defold Foundation
+// Licensed under the Defold License version 1.0 (the "License"); you may not use
+// this file except in compliance with the License.
+//
+// You may obtain a copy of the License, together with FAQs at
+// https://www.defold.com/license
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include <stdint.h>
+#include <string.h>
+#define JC_TEST_IMPLEMENTATION
+#include <jc_test/jc_test.h>
+#include "../dlib/array.h"
+#include "../dlib/atomic.h"
+#include "../dlib/job_pool.h"
+
+struct RangeContext
+{
+    dmArray<uint32_t> m_Visits;
+    int32_atomic_t    m_Calls;
+    uint32_t          m_MinBatchSize;
+    uint32_t          m_Count;
+    bool              m_SmallBatch;
+};
+
+static void VisitRange(void* _context, uint32_t begin, uint32_t end)
+{
+    RangeContext* context = (RangeContext*) _context;
+    dmAtomicIncrement32(&context->m_Calls);
+    // Only the last batch may be smaller than the minimum batch size
+    if (end - begin < context->m_MinBatchSize && end != context->m_Count)
+        context->m_SmallBatch = true;
+    for (uint32_t i = begin; i < end; ++i)
+    {
+        context->m_Visits[i]++;
+    }
+}
+
+static void RunParallelFor(dmJobPool::HJobPool pool, RangeContext* context, uint32_t count, uint32_t min_batch_size)
+{
+    context->m_Visits.SetCapacity(count);
+    context->m_Visits.SetSize(count);
+    if (count > 0)
+        memset(context->m_Visits.Begin(), 0, count * sizeof(uint32_t));
+    context->m_Calls = 0;
+    context->m_MinBatchSize = min_batch_size;
+    context->m_Count = count;
+    context->m_SmallBatch = false;
+    dmJobPool::ParallelFor(pool, count, min_batch_size, VisitRange, context);
+}
+
+static void AssertVisitedOnce(RangeContext* context)
+{
+    for (uint32_t i = 0; i < context->m_Visits.Size(); ++i)
+    {
+        ASSERT_EQ(1U, context->m_Visits[i]);
+    }
+    ASSERT_FALSE(context->m_SmallBatch);
+}
+
+TEST(dmJobPool, NoPool)
+{
+    RangeContext context;
+    RunParallelFor(0, &context, 1000, 10);
+    AssertVisitedOnce(&context);
+    ASSERT_EQ(1, context.m_Calls);
+}
+
+TEST(dmJobPool, NoWorkers)
+{
+    dmJobPool::HJobPool pool = dmJobPool::New("test", 0);
+    ASSERT_EQ(0U, dmJobPool::GetWorkerCount(pool));
+
+    RangeContext context;
+    RunParallelFor(pool, &context, 1000, 10);
+    AssertVisitedOnce(&context);
+    ASSERT_EQ(1, context.m_Calls);
+
+    dmJobPool::Delete(pool);
+}
+
+TEST(dmJobPool, Empty)
+{
+    dmJobPool::HJobPool pool = dmJobPool::New("test", 3);
+
+    RangeContext context;
+    RunParallelFor(pool, &context, 0, 10);
+    ASSERT_EQ(0, context.m_Calls);
+
+    dmJobPool::Delete(pool);
+}
+
+TEST(dmJobPool, SingleBatch)
+{
+    dmJobPool::HJobPool pool = dmJobPool::New("test", 3);
+
+    RangeContext context;
+    RunParallelFor(pool, &context, 64, 64);
+    AssertVisitedOnce(&context);
+    ASSERT_EQ(1, context.m_Calls);
+
+    dmJobPool::Delete(pool);
+}
+
+TEST(dmJobPool, ParallelFor)
+{
+    dmJobPool::HJobPool pool = dmJobPool::New("test", 3);
+
+    const uint32_t counts[] = {2, 17, 100, 1000, 12345, 100000};
+    const uint32_t batch_sizes[] = {1, 7, 64, 1000};
+    RangeContext context;
+    for (uint32_t c = 0; c < sizeof(counts) / sizeof(counts[0]); ++c)
+    {
+        for (uint32_t b = 0; b < sizeof(batch_sizes) / sizeof(batch_sizes[0]); ++b)
+        {
+            RunParallelFor(pool, &context, counts[c], batch_sizes[b]);
+            AssertVisitedOnce(&context);
+        }
+    }
+
+    dmJobPool::Delete(pool);
+}
+
+TEST(dmJobPool, Repeated)
+{
+    dmJobPool::HJobPool pool = dmJobPool::New("test", 4);
+
+    RangeContext context;
+    for (uint32_t i = 0; i < 1000; ++i)
+    {
+        RunParallelFor(pool, &context, 256, 1);
+        AssertVisitedOnce(&context);
+    }
+
+    dmJobPool::Delete(pool);
+}
+
+int main(int argc, char **argv)
+{
+    jc_test_init(&argc, argv);
+    return jc_test_run_all();
+}
@@ -0,0 +1,112 @@
+// Copyright 2020 The Defold Foundation
+// Licensed under the Defold License version 1.0 (the "License"); you may not use
+// this file except in compliance with the License.
+//
+// You may obtain a copy of the License, together with FAQs at
+// https://www.defold.com/license
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+#define JC_TEST_IMPLEMENTATION
+#include <jc_test/jc_test.h>
+#include "../../src/dlib/hash.h"
+#include "../../src/dlib/message.h"
+#include "../../src/dlib/thread.h"
+#include "../../src/dlib/time.h"
+
+const dmhash_t m_HashMessage1 = 0x35d47694;
+
+struct CustomMessageData1
+{
+    uint32_t m_MyValue;
+};
+
+void HandleMessage(dmMessage::Message *message_object, void *user_ptr)
+{
+    switch(message_object->m_Id)
+    {
+        case m_HashMessage1:
+            break;
+
+        default:
+            assert(false);
+            break;
+    }
+}
+
+struct BenchPostContext
+{
+    dmMessage::URL* m_Receiver;
+    uint32_t        m_Count;
+};
+
+void BenchPostThread(void* arg)
+{
+    BenchPostContext* context = (BenchPostContext*) arg;
+    CustomMessageData1 message_data1;
+    message_data1.m_MyValue = 0;
+    for (uint32_t i = 0; i < context->m_Count; ++i)
+    {
+        dmMessage::Post(0x0, context->m_Receiver, m_HashMessage1, 0, 0x0, &message_data1, sizeof(CustomMessageData1), 0);
+    }
+}
+
+// Posts from a number of threads while the main thread dispatches
+static void BenchPostThreads(uint32_t thread_count)
+{
+    const uint32_t post_count = 1024 * 64;
+    const uint32_t max_thread_count = 8;
+    ASSERT_LE(thread_count, max_thread_count);
+
+    dmMessage::URL receiver;
+    dmMessage::ResetURL(&receiver);
+    ASSERT_EQ(dmMessage::RESULT_OK, dmMessage::NewSocket("my_socket", &receiver.m_Socket));
+
+    BenchPostContext context;
+    context.m_Receiver = &receiver;
+    context.m_Count = post_count;
+
+    dmThread::Thread threads[max_thread_count];
+    uint64_t start = dmTime::GetTime();
+    for (uint32_t i = 0; i < thread_count; ++i)
+    {
+        threads[i] = dmThread::New(&BenchPostThread, 0xf0000, (void*) &context, "post");
+    }
+
+    uint32_t count = 0;
+    while (count < post_count * thread_count)
+    {
+        count += dmMessage::Dispatch(receiver.m_Socket, HandleMessage, 0);
+    }
+    uint64_t end = dmTime::GetTime();
+
+    for (uint32_t i = 0; i < thread_count; ++i)
+    {
+        dmThread::Join(threads[i]);
+    }
+    ASSERT_EQ(post_count * thread_count, count);
+
+    uint64_t elapsed = end - start;
+    printf("Bench %u thread(s): %f ms (%f posts/s)\n", thread_count, elapsed / 1000.0f, count * 1000000.0 / (elapsed ? elapsed : 1));
+
+    ASSERT_EQ(0u, dmMessage::Dispatch(receiver.m_Socket, HandleMessage, 0));
+    ASSERT_EQ(dmMessage::RESULT_OK, dmMessage::DeleteSocket(receiver.m_Socket));
+}
+
+TEST(dmMessage, BenchThreads)
+{
+    BenchPostThreads(1);
+    BenchPostThreads(4);
+}
+
+int main(int argc, char **argv)
+{
+    jc_test_init(&argc, argv);
+    return jc_test_run_all();
+}
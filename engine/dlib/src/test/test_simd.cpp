@@ -0,0 +1,74 @@
+// Copyright 2020 The Defold Foundation
+// Licensed under the Defold License version 1.0 (the "License"); you may not use
+// this file except in compliance with the License.
+//
+// You may obtain a copy of the License, together with FAQs at
+// https://www.defold.com/license
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include <stdint.h>
+#include <stdio.h>
+#define JC_TEST_IMPLEMENTATION
+#include <jc_test/jc_test.h>
+#include "../dlib/simd.h"
+
+using namespace dmSimd;
+
+TEST(dmSimd, Arithmetic)
+{
+    float r[4];
+    Store4(r, Mul4(Add4(Set4(1.0f, 2.0f, 3.0f, 4.0f), Splat4(1.0f)), Sub4(Splat4(3.0f), Splat4(1.0f))));
+    ASSERT_EQ(4.0f, r[0]);
+    ASSERT_EQ(6.0f, r[1]);
+    ASSERT_EQ(8.0f, r[2]);
+    ASSERT_EQ(10.0f, r[3]);
+
+    Store4(r, Max4(Min4(Set4(-1.0f, 0.5f, 2.0f, 1.0f), Splat4(1.0f)), Splat4(0.0f)));
+    ASSERT_EQ(0.0f, r[0]);
+    ASSERT_EQ(0.5f, r[1]);
+    ASSERT_EQ(1.0f, r[2]);
+    ASSERT_EQ(1.0f, r[3]);
+}
+
+TEST(dmSimd, Zip)
+{
+    Float4 a = Set4(1.0f, 2.0f, 3.0f, 4.0f);
+    Float4 b = Set4(5.0f, 6.0f, 7.0f, 8.0f);
+    float r[8];
+    Store4(r, ZipLo4(a, b));
+    Store4(r + 4, ZipHi4(a, b));
+    const float expected[] = { 1.0f, 5.0f, 2.0f, 6.0f, 3.0f, 7.0f, 4.0f, 8.0f };
+    for (uint32_t i = 0; i < 8; ++i)
+        ASSERT_EQ(expected[i], r[i]);
+}
+
+// Store3 must not touch the float after the three it stores
+TEST(dmSimd, Store3)
+{
+    float r[4] = { 0.0f, 0.0f, 0.0f, 9.0f };
+    Store3(r, Set4(1.0f, 2.0f, 3.0f, 4.0f));
+    ASSERT_EQ(1.0f, r[0]);
+    ASSERT_EQ(2.0f, r[1]);
+    ASSERT_EQ(3.0f, r[2]);
+    ASSERT_EQ(9.0f, r[3]);
+}
+
+// Truncates towards zero and saturates, like the sound mixer expects
+TEST(dmSimd, StoreInt16x8)
+{
+    int16_t r[8];
+    StoreInt16x8(r, Set4(1.7f, -1.7f, 40000.0f, -40000.0f), Set4(0.0f, 32767.0f, -32768.0f, 100.5f));
+    const int16_t expected[] = { 1, -1, 32767, -32768, 0, 32767, -32768, 100 };
+    for (uint32_t i = 0; i < 8; ++i)
+        ASSERT_EQ(expected[i], r[i]);
+}
+
+int main(int argc, char **argv)
+{
+    jc_test_init(&argc, argv);
+    return jc_test_run_all();
+}
@@ -172,6 +172,41 @@ TEST(dmTransform, Conversion)
     }
 }
 
+TEST(dmTransform, ConversionBatch)
+{
+    // Not a multiple of four, to test the remainder
+    const int count = 4*4*4 + 3;
+    Vector3 vecs[4] = {
+        Vector3(-1, -2, -3),
+        Vector3(5, 0.3f, 3),
+        Vector3(0.09f, -3, 1),
+        Vector3(1, 2, 0.5f)
+    };
+
+    Transform transforms[count];
+    for (int n = 0; n < count; ++n)
+    {
+        int i = n % 4;
+        int j = (n / 4) % 4;
+        int k = (n / 16) % 4;
+        Vector3 axis = vecs[j] * (1.0f / length(vecs[j]));
+        Vector3 scale(dmMath::Abs(vecs[k].getX()), dmMath::Abs(vecs[k].getY()), dmMath::Abs(vecs[k].getZ()));
+        transforms[n] = Transform(vecs[i], normalize(Quat(axis, 1.0f)), scale);
+    }
+
+    Matrix4 matrices[count];
+    ToMatrix4(transforms, matrices, count);
+
+    for (int n = 0; n < count; ++n)
+    {
+        Matrix4 expected = ToMatrix4(transforms[n]);
+        for (int c = 0; c < 4; ++c)
+        {
+            ASSERT_V4_NEAR(expected.getCol(c), matrices[n].getCol(c));
+        }
+    }
+}
+
 TEST(dmTransform, Inverse)
 {
     TransformS1 is1;
@@ -197,6 +197,7 @@ namespace dmEngine
     Engine::Engine(dmEngineService::HEngineService engine_service)
     : m_Config(0)
     , m_Alive(true)
+    , m_JobPool(0)
     , m_MainCollection(0)
     , m_LastReloadMTime(0)
     , m_MouseSensitivity(1.0f)
@@ -230,8 +231,11 @@ namespace dmEngine
         m_ResourceTypeContexts.SetCapacity(31, 64);
 
         m_PhysicsContext.m_Context3D = 0x0;
+        m_PhysicsContext.m_JobPool = 0x0;
         m_PhysicsContext.m_Debug = false;
         m_PhysicsContext.m_3D = false;
+        m_PhysicsContext.m_ParallelStep = false;
+        m_PhysicsContext.m_SteppingWorlds = false;
         m_GuiContext.m_GuiContext = 0x0;
         m_GuiContext.m_RenderContext = 0x0;
         m_SpriteContext.m_RenderContext = 0x0;
@@ -282,6 +286,9 @@ namespace dmEngine
 
         dmGameObject::DeleteRegister(engine->m_Register);
 
+        if (engine->m_JobPool)
+            dmJobPool::Delete(engine->m_JobPool);
+
         UnloadBootstrapContent(engine);
 
         dmSound::Finalize();
@@ -794,6 +801,9 @@ namespace dmEngine
         const uint32_t max_resources = dmConfigFile::GetInt(engine->m_Config, dmResource::MAX_RESOURCES_KEY, 1024);
         dmResource::NewFactoryParams params;
         params.m_MaxResources = max_resources;
+        params.m_LoaderThreadCount = (uint32_t) dmMath::Max(1, dmConfigFile::GetInt(engine->m_Config, "resource.loader_threads", 2));
+        params.m_MaxPreloaderRequests = (uint32_t) dmMath::Max(1, dmConfigFile::GetInt(engine->m_Config, "resource.preloader_max_requests", 8192));
+        params.m_MaxPreloaderPaths = (uint32_t) dmMath::Max(2, dmConfigFile::GetInt(engine->m_Config, "resource.preloader_max_paths", 16384));
         params.m_Flags = 0;
 
         dmResourceArchive::ClearArchiveLoaders(); // in case we've rebooted
@@ -889,6 +899,10 @@ namespace dmEngine
             return false;
         }
         dmGameObject::SetInputStackDefaultCapacity(engine->m_Register, dmConfigFile::GetInt(engine->m_Config, dmGameObject::COLLECTION_MAX_INPUT_STACK_ENTRIES_KEY, dmGameObject::DEFAULT_MAX_INPUT_STACK_CAPACITY));
+        dmGameObject::SetSpatialIndexCellSize(engine->m_Register, dmConfigFile::GetFloat(engine->m_Config, dmGameObject::COLLECTION_SPATIAL_INDEX_CELL_SIZE_KEY, 0.0f));
+
+        engine->m_JobPool = dmJobPool::New("worker", (uint32_t) dmMath::Max(0, dmConfigFile::GetInt(engine->m_Config, "engine.worker_threads", 3)));
+        dmGameObject::SetJobPool(engine->m_Register, engine->m_JobPool);
 
         dmRender::RenderContextParams render_params;
         render_params.m_MaxRenderTypes = 16;
@@ -908,6 +922,7 @@ namespace dmEngine
 
         engine->m_ParticleFXContext.m_Factory = engine->m_Factory;
         engine->m_ParticleFXContext.m_RenderContext = engine->m_RenderContext;
+        engine->m_ParticleFXContext.m_JobPool = engine->m_JobPool;
         engine->m_ParticleFXContext.m_MaxParticleFXCount = dmConfigFile::GetInt(engine->m_Config, dmParticle::MAX_INSTANCE_COUNT_KEY, 64);
         engine->m_ParticleFXContext.m_MaxParticleCount = dmConfigFile::GetInt(engine->m_Config, dmParticle::MAX_PARTICLE_COUNT_KEY, 1024);
         engine->m_ParticleFXContext.m_Debug = false;
@@ -997,6 +1012,8 @@ namespace dmEngine
         engine->m_PhysicsContext.m_MaxContactPointCount = dmConfigFile::GetInt(engine->m_Config, dmGameSystem::PHYSICS_MAX_CONTACTS_KEY, 128);
         // TODO: Should move inside the ifdef release? Is this usable without the debug callbacks?
         engine->m_PhysicsContext.m_Debug = (bool) dmConfigFile::GetInt(engine->m_Config, "physics.debug", 0);
+        engine->m_PhysicsContext.m_ParallelStep = (bool) dmConfigFile::GetInt(engine->m_Config, "physics.parallel_step", 0);
+        engine->m_PhysicsContext.m_JobPool = engine->m_JobPool;
 
 #if !defined(DM_RELEASE)
         dmPhysics::DebugCallbacks debug_callbacks;
@@ -1014,8 +1031,10 @@ namespace dmEngine
 #endif
 
         engine->m_SpriteContext.m_RenderContext = engine->m_RenderContext;
+        engine->m_SpriteContext.m_JobPool = engine->m_JobPool;
         engine->m_SpriteContext.m_MaxSpriteCount = dmConfigFile::GetInt(engine->m_Config, "sprite.max_count", 128);
         engine->m_SpriteContext.m_Subpixels = dmConfigFile::GetInt(engine->m_Config, "sprite.subpixels", 1);
+        engine->m_SpriteContext.m_Instancing = dmConfigFile::GetInt(engine->m_Config, "sprite.instancing", 0);
 
         engine->m_ModelContext.m_RenderContext = engine->m_RenderContext;
         engine->m_ModelContext.m_Factory = engine->m_Factory;
@@ -1518,6 +1537,8 @@ bail:
                     dmGameObject::UpdateContext update_context;
                     update_context.m_DT = dt;
                     dmGameObject::Update(engine->m_MainCollection, &update_context);
+                    // Steps the physics worlds of all collections, when "physics.parallel_step" is set
+                    dmGameSystem::StepPhysicsWorlds(&engine->m_PhysicsContext);
 
                     // Don't render while iconified
                     if (!dmGraphics::GetWindowState(engine->m_GraphicsContext, dmGraphics::WINDOW_STATE_ICONIFIED))
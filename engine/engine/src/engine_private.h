@@ -17,6 +17,7 @@
 
 #include <dlib/configfile.h>
 #include <dlib/hashtable.h>
+#include <dlib/job_pool.h>
 #include <dlib/message.h>
 
 #include <resource/resource.h>
@@ -115,6 +116,7 @@ namespace dmEngine
         bool                                        m_Alive;
 
         dmGameObject::HRegister                     m_Register;
+        dmJobPool::HJobPool                         m_JobPool;
         dmGameObject::HCollection                   m_MainCollection;
         dmArray<dmGameObject::InputAction>          m_InputBuffer;
         dmHashTable64<void*>                        m_ResourceTypeContexts;
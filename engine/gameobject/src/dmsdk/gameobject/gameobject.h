@@ -603,6 +603,32 @@ namespace dmGameObject
      */
     dmTransform::Transform GetWorldTransform(HInstance instance);
 
+    /*# find instances within a box
+     * Find the instances of a collection whose world positions are inside an axis aligned box.
+     * The positions are those of the last transform update.
+     * The instances are appended to the array, which grows as needed.
+     * @name QueryAABB
+     * @param collection [type:dmGameObject::HCollection] Collection
+     * @param min [type:dmVMath::Point3] Minimum corner of the box
+     * @param max [type:dmVMath::Point3] Maximum corner of the box
+     * @param instances [type:dmArray<dmGameObject::HInstance>&] Array to append the instances to
+     * @return result [type:dmGameObject::Result] RESULT_OK, or RESULT_INVALID_OPERATION if the collection has no spatial index
+     */
+    Result QueryAABB(HCollection collection, const dmVMath::Point3& min, const dmVMath::Point3& max, dmArray<HInstance>& instances);
+
+    /*# find instances within a sphere
+     * Find the instances of a collection whose world positions are within a distance from a point.
+     * The positions are those of the last transform update.
+     * The instances are appended to the array, which grows as needed.
+     * @name QueryRadius
+     * @param collection [type:dmGameObject::HCollection] Collection
+     * @param center [type:dmVMath::Point3] Center of the sphere
+     * @param radius [type:float] Radius of the sphere
+     * @param instances [type:dmArray<dmGameObject::HInstance>&] Array to append the instances to
+     * @return result [type:dmGameObject::Result] RESULT_OK, or RESULT_INVALID_OPERATION if the collection has no spatial index
+     */
+    Result QueryRadius(HCollection collection, const dmVMath::Point3& center, float radius, dmArray<HInstance>& instances);
+
     /*#
      * Set whether the instance should be flagged as a bone.
      * Instances flagged as bones can have their transforms updated in a batch through SetBoneTransforms.
@@ -19,6 +19,7 @@
 #include <script/script.h>
 
 #include "component.h"
+#include "gameobject_private.h"
 #include "gameobject_script.h"
 #include "gameobject_props_lua.h"
 
@@ -305,6 +306,9 @@ namespace dmGameObject
                 if (anim.m_Value != 0x0)
                 {
                     *anim.m_Value = v;
+                    // Properties of the instance itself are transform properties
+                    if (anim.m_ComponentId == 0)
+                        SetTransformDirty(anim.m_Instance->m_Collection, anim.m_Instance);
                 }
                 else
                 {
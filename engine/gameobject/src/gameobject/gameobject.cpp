@@ -37,6 +37,7 @@ namespace dmGameObject
 {
     const char* COLLECTION_MAX_INSTANCES_KEY = "collection.max_instances";
     const char* COLLECTION_MAX_INPUT_STACK_ENTRIES_KEY = "collection.max_input_stack_entries";
+    const char* COLLECTION_SPATIAL_INDEX_CELL_SIZE_KEY = "collection.spatial_index_cell_size";
     const dmhash_t UNNAMED_IDENTIFIER = dmHashBuffer64("__unnamed__", strlen("__unnamed__"));
     const char* ID_SEPARATOR = "/";
     const uint32_t MAX_DISPATCH_ITERATION_COUNT = 10;
@@ -156,6 +157,8 @@ namespace dmGameObject
         m_ComponentTypeCount = 0;
         m_DefaultCollectionCapacity = DEFAULT_MAX_COLLECTION_CAPACITY;
         m_DefaultInputStackCapacity = DEFAULT_MAX_INPUT_STACK_CAPACITY;
+        m_JobPool = 0;
+        m_SpatialIndexCellSize = 0.0f;
         m_Mutex = dmMutex::New();
     }
 
@@ -187,8 +190,10 @@ namespace dmGameObject
         m_Instances.SetCapacity(max_instances);
         m_Instances.SetSize(max_instances);
         m_InstanceIndices.SetCapacity(max_instances);
-        m_WorldTransforms.SetCapacity(max_instances);
-        m_WorldTransforms.SetSize(max_instances);
+        m_DirtyTransformFlags.SetCapacity(max_instances);
+        m_DirtyTransformFlags.SetSize(max_instances);
+        m_DirtyTransformIndices.SetCapacity(max_instances);
+        m_DirtyTransformLevelIndices.SetCapacity(max_instances);
         m_IDToInstance.SetCapacity(dmMath::Max(1U, max_instances/3), max_instances);
         m_InputFocusStack.SetCapacity(max_input_stack_entries);
         m_NameHash = 0;
@@ -204,6 +209,7 @@ namespace dmGameObject
         m_ToBeDeleted = 0;
         m_ScaleAlongZ = 0;
         m_DirtyTransforms = 1;
+        m_UseSpatialIndex = 0;
         m_Initialized = 0;
 
         m_InstancesToDeleteHead = INVALID_INSTANCE_INDEX;
@@ -213,7 +219,7 @@ namespace dmGameObject
         m_InstancesToAddTail = INVALID_INSTANCE_INDEX;
 
         memset(&m_Instances[0], 0, sizeof(Instance*) * max_instances);
-        memset(&m_WorldTransforms[0], 0xcc, sizeof(dmTransform::Transform) * max_instances);
+        memset(&m_DirtyTransformFlags[0], 0, sizeof(uint8_t) * max_instances);
         memset(&m_LevelIndices[0], 0, sizeof(m_LevelIndices));
         memset(&m_ComponentInstanceCount[0], 0, sizeof(uint32_t) * MAX_COMPONENT_TYPES);
     }
@@ -239,6 +245,18 @@ namespace dmGameObject
         regist->m_DefaultInputStackCapacity = capacity;
     }
 
+    void SetJobPool(HRegister regist, dmJobPool::HJobPool job_pool)
+    {
+        assert(regist != 0x0);
+        regist->m_JobPool = job_pool;
+    }
+
+    void SetSpatialIndexCellSize(HRegister regist, float cell_size)
+    {
+        assert(regist != 0x0);
+        regist->m_SpatialIndexCellSize = dmMath::Max(0.0f, cell_size);
+    }
+
     static uint32_t GetInputStackDefaultCapacity(HRegister regist)
     {
         assert(regist != 0x0);
@@ -264,6 +282,12 @@ namespace dmGameObject
         Collection* collection = new Collection(0, 0, max_instances, GetInputStackDefaultCapacity(regist));
         collection->m_Mutex = dmMutex::New();
 
+        if (regist->m_SpatialIndexCellSize > 0.0f)
+        {
+            SpatialIndexInit(&collection->m_SpatialIndex, max_instances, regist->m_SpatialIndexCellSize);
+            collection->m_UseSpatialIndex = 1;
+        }
+
         for (uint32_t i = 0; i < regist->m_ComponentTypeCount; ++i)
         {
             if (regist->m_ComponentTypes[i].m_NewWorldFunction)
@@ -538,10 +562,22 @@ namespace dmGameObject
     }
 
 
+    // Points the level transforms of the children to the current level index of the instance
+    static void UpdateChildrenParentLevelIndex(Collection* collection, HInstance instance)
+    {
+        uint32_t index = instance->m_FirstChildIndex;
+        while (index != INVALID_INSTANCE_INDEX)
+        {
+            Instance* child = collection->m_Instances[index];
+            collection->m_LevelTransforms[child->m_Depth].m_ParentLevelIndices[child->m_LevelIndex] = instance->m_LevelIndex;
+            index = child->m_SiblingIndex;
+        }
+    }
+
     static void EraseSwapLevelIndex(Collection* collection, HInstance instance)
     {
         /*
-         * Remove instance from m_LevelIndices using an erase-swap operation
+         * Remove instance from m_LevelIndices, and its transforms from m_LevelTransforms, using an erase-swap operation
          */
 
         dmArray<uint16_t>& level = collection->m_LevelIndices[instance->m_Depth];
@@ -550,9 +586,19 @@ namespace dmGameObject
 
         uint16_t level_index = instance->m_LevelIndex;
         uint16_t swap_in_index = level.EraseSwap(level_index);
+        LevelTransforms& transforms = collection->m_LevelTransforms[instance->m_Depth];
+        transforms.m_Positions.EraseSwap(level_index);
+        transforms.m_Rotations.EraseSwap(level_index);
+        transforms.m_Scales.EraseSwap(level_index);
+        transforms.m_WorldTransforms.EraseSwap(level_index);
+        transforms.m_ParentLevelIndices.EraseSwap(level_index);
         HInstance swap_in_instance = collection->m_Instances[swap_in_index];
         assert(swap_in_instance->m_Index == swap_in_index);
         swap_in_instance->m_LevelIndex = level_index;
+        if (swap_in_instance != instance)
+        {
+            UpdateChildrenParentLevelIndex(collection, swap_in_instance);
+        }
     }
 
     /*
@@ -561,28 +607,59 @@ namespace dmGameObject
      * ** 10 elements as min
      * ** Up to max_instances as max
      */
-    static void ExpandLevel(dmArray<uint16_t>& level, uint32_t max_instances)
+    static void ExpandLevel(dmArray<uint16_t>& level, LevelTransforms& transforms, uint32_t max_instances)
     {
         const uint32_t min_offset = 10;
         const uint32_t max_offset = max_instances - level.Capacity();
         int32_t offset = dmMath::Min(max_offset, dmMath::Max(min_offset, level.Size() / 2));
         level.OffsetCapacity(offset);
+        transforms.m_Positions.SetCapacity(level.Capacity());
+        transforms.m_Rotations.SetCapacity(level.Capacity());
+        transforms.m_Scales.SetCapacity(level.Capacity());
+        transforms.m_WorldTransforms.SetCapacity(level.Capacity());
+        transforms.m_ParentLevelIndices.SetCapacity(level.Capacity());
     }
 
-    static void InsertInstanceInLevelIndex(Collection* collection, HInstance instance)
+    static void InsertInstanceInLevelIndex(Collection* collection, HInstance instance, const dmTransform::Transform& local, const Matrix4& world)
     {
         /*
-         * Insert instance in m_LevelIndices at level set in instance->m_Depth
+         * Insert instance in m_LevelIndices, and its transforms in m_LevelTransforms, at level set in instance->m_Depth
          */
         dmArray<uint16_t>& level = collection->m_LevelIndices[instance->m_Depth];
+        LevelTransforms& transforms = collection->m_LevelTransforms[instance->m_Depth];
         if (level.Full())
-            ExpandLevel(level, collection->m_MaxInstances);
+            ExpandLevel(level, transforms, collection->m_MaxInstances);
         assert(!level.Full());
 
         uint16_t level_index = (uint16_t)level.Size();
         level.SetSize(level_index + 1);
         level[level_index] = instance->m_Index;
         instance->m_LevelIndex = level_index;
+
+        uint16_t parent_level_index = INVALID_INSTANCE_INDEX;
+        if (instance->m_Parent != INVALID_INSTANCE_INDEX)
+        {
+            parent_level_index = collection->m_Instances[instance->m_Parent]->m_LevelIndex;
+        }
+        transforms.m_Positions.Push(local.GetTranslation());
+        transforms.m_Rotations.Push(local.GetRotation());
+        transforms.m_Scales.Push(local.GetScale());
+        transforms.m_WorldTransforms.Push(world);
+        transforms.m_ParentLevelIndices.Push(parent_level_index);
+        UpdateChildrenParentLevelIndex(collection, instance);
+
+        // New, or moved in the hierarchy
+        SetTransformDirty(collection, instance);
+    }
+
+    // Moves the instance, and its transforms, to another level
+    static void MoveLevel(Collection* collection, HInstance instance, uint32_t depth)
+    {
+        dmTransform::Transform local = GetLocalTransform(instance);
+        Matrix4 world = GetWorldTransformRef(instance);
+        EraseSwapLevelIndex(collection, instance);
+        instance->m_Depth = depth;
+        InsertInstanceInLevelIndex(collection, instance, local, world);
     }
 
     static HInstance AllocInstance(Prototype* proto, const char* prototype_name) {
@@ -634,7 +711,7 @@ namespace dmGameObject
         assert(collection->m_Instances[instance_index] == 0);
         collection->m_Instances[instance_index] = instance;
 
-        InsertInstanceInLevelIndex(collection, instance);
+        InsertInstanceInLevelIndex(collection, instance, dmTransform::Transform(Vector3(0.0f, 0.0f, 0.0f), Quat::identity(), Vector3(1.0f, 1.0f, 1.0f)), Matrix4::identity());
 
         return instance;
     }
@@ -657,6 +734,8 @@ namespace dmGameObject
         uint16_t instance_index = instance->m_Index;
         operator delete ((void*)instance);
         collection->m_Instances[instance_index] = 0x0;
+        if (collection->m_UseSpatialIndex)
+            SpatialIndexRemove(&collection->m_SpatialIndex, instance_index);
         collection->m_InstanceIndices.Push(instance_index);
         assert(collection->m_IDToInstance.Size() <= collection->m_InstanceIndices.Size());
     }
@@ -1035,7 +1114,7 @@ namespace dmGameObject
         SetPosition(instance, position);
         SetRotation(instance, rotation);
         SetScale(instance, scale);
-        collection->m_WorldTransforms[instance->m_Index] = dmTransform::ToMatrix4(instance->m_Transform);
+        GetWorldTransformRef(instance) = dmTransform::ToMatrix4(GetLocalTransform(instance));
 
         dmHashInit64(&instance->m_CollectionPathHashState, true);
         dmHashUpdateBuffer64(&instance->m_CollectionPathHashState, ID_SEPARATOR, strlen(ID_SEPARATOR));
@@ -1122,7 +1201,7 @@ namespace dmGameObject
             if (scale.getX() == 0 && scale.getY() == 0 && scale.getZ() == 0)
                     scale = Vector3(instance_desc.m_Scale, instance_desc.m_Scale, instance_desc.m_Scale);
 
-            instance->m_Transform = dmTransform::Transform(Vector3(instance_desc.m_Position), instance_desc.m_Rotation, scale);
+            SetLocalTransform(instance, dmTransform::Transform(Vector3(instance_desc.m_Position), instance_desc.m_Rotation, scale));
             dmHashClone64(&instance->m_CollectionPathHashState, &prefixHashState, true);
 
             const char* path_end = strrchr(instance_desc.m_Id, *ID_SEPARATOR);
@@ -1202,11 +1281,11 @@ namespace dmGameObject
             {
                 if (!GetParent(new_instances[i]))
                 {
-                    new_instances[i]->m_Transform = dmTransform::Mul(transform, new_instances[i]->m_Transform);
+                    SetLocalTransform(new_instances[i], dmTransform::Mul(transform, GetLocalTransform(new_instances[i])));
                 }
 
                 // world transforms need to be up to date in time for the script init calls
-                collection->m_WorldTransforms[new_instances[i]->m_Index] = dmTransform::ToMatrix4(new_instances[i]->m_Transform);
+                GetWorldTransformRef(new_instances[i]) = dmTransform::ToMatrix4(GetLocalTransform(new_instances[i]));
             }
         }
 
@@ -1449,9 +1528,7 @@ namespace dmGameObject
          */
 
         assert(instance->m_Depth > 0);
-        EraseSwapLevelIndex(collection, instance);
-        instance->m_Depth--;
-        InsertInstanceInLevelIndex(collection, instance);
+        MoveLevel(collection, instance, instance->m_Depth - 1);
     }
 
     static void MoveAllUp(Collection* collection, Instance* instance)
@@ -1481,9 +1558,7 @@ namespace dmGameObject
          */
 
         assert(instance->m_Depth < MAX_HIERARCHICAL_DEPTH - 1);
-        EraseSwapLevelIndex(collection, instance);
-        instance->m_Depth++;
-        InsertInstanceInLevelIndex(collection, instance);
+        MoveLevel(collection, instance, instance->m_Depth + 1);
     }
 
     static void MoveAllDown(Collection* collection, Instance* instance)
@@ -1556,21 +1631,21 @@ namespace dmGameObject
             assert(collection->m_Instances[instance->m_Index] == instance);
 
             // Update world transforms since some components might need them in their init-callback
-            Matrix4* trans = &collection->m_WorldTransforms[instance->m_Index];
+            Matrix4* trans = &GetWorldTransformRef(instance);
             if (instance->m_Parent == INVALID_INSTANCE_INDEX)
             {
-                *trans = dmTransform::ToMatrix4(instance->m_Transform);
+                *trans = dmTransform::ToMatrix4(GetLocalTransform(instance));
             }
             else
             {
-                const Matrix4* parent_trans = &collection->m_WorldTransforms[instance->m_Parent];
+                const Matrix4* parent_trans = &GetWorldTransformRef(collection->m_Instances[instance->m_Parent]);
                 if (instance->m_ScaleAlongZ)
                 {
-                    *trans = (*parent_trans) * dmTransform::ToMatrix4(instance->m_Transform);
+                    *trans = (*parent_trans) * dmTransform::ToMatrix4(GetLocalTransform(instance));
                 }
                 else
                 {
-                    *trans = dmTransform::MulNoScaleZ(*parent_trans, dmTransform::ToMatrix4(instance->m_Transform));
+                    *trans = dmTransform::MulNoScaleZ(*parent_trans, dmTransform::ToMatrix4(GetLocalTransform(instance)));
                 }
             }
             return InitComponents(collection, instance);
@@ -1838,6 +1913,8 @@ namespace dmGameObject
             dmResource::Release(factory, prototype);
         collection->m_InstanceIndices.Push(instance->m_Index);
         collection->m_Instances[instance->m_Index] = 0;
+        if (collection->m_UseSpatialIndex)
+            SpatialIndexRemove(&collection->m_SpatialIndex, instance->m_Index);
 
         // Erase from input stack
         bool found_instance = false;
@@ -1983,10 +2060,11 @@ namespace dmGameObject
             HInstance instance = collection->m_Instances[current_index];
             if (instance->m_Bone)
             {
-                instance->m_Transform = transforms[count++];
+                SetLocalTransform(instance, transforms[count++]);
                 if (component_transform && count == 1) {
-                    instance->m_Transform = dmTransform::Mul(*component_transform, instance->m_Transform);
+                    SetLocalTransform(instance, dmTransform::Mul(*component_transform, GetLocalTransform(instance)));
                 }
+                SetTransformDirty(collection, instance);
                 if (count < transform_count)
                 {
                     count += DoSetBoneTransforms(hcollection, 0x0, instance->m_FirstChildIndex, &transforms[count], transform_count - count);
@@ -2118,41 +2196,52 @@ namespace dmGameObject
 
                 if (parent)
                 {
-                    parent_t = collection->m_WorldTransforms[parent->m_Index];
+                    parent_t = GetWorldTransformRef(parent);
                 }
 
-                if (sp->m_KeepWorldTransform == 0)
-                {
-                    Matrix4& world = collection->m_WorldTransforms[instance->m_Index];
-                    if (instance->m_ScaleAlongZ)
-                    {
-                        world = parent_t * dmTransform::ToMatrix4(instance->m_Transform);
-                    }
-                    else
-                    {
-                        world = dmTransform::MulNoScaleZ(parent_t, dmTransform::ToMatrix4(instance->m_Transform));
-                    }
-                }
-                else
+                // The local transform that keeps the world transform is calculated before the hierarchy changes,
+                // but only applied if the parent could be set
+                dmTransform::Transform keep_world_local;
+                if (sp->m_KeepWorldTransform)
                 {
                     if (instance->m_ScaleAlongZ)
                     {
-                        instance->m_Transform = dmTransform::ToTransform(inverse(parent_t) * collection->m_WorldTransforms[instance->m_Index]);
+                        keep_world_local = dmTransform::ToTransform(inverse(parent_t) * GetWorldTransformRef(instance));
                     }
                     else
                     {
-                        Matrix4 tmp = dmTransform::MulNoScaleZ(inverse(parent_t), collection->m_WorldTransforms[instance->m_Index]);
-                        instance->m_Transform = dmTransform::ToTransform(tmp);
+                        Matrix4 tmp = dmTransform::MulNoScaleZ(inverse(parent_t), GetWorldTransformRef(instance));
+                        keep_world_local = dmTransform::ToTransform(tmp);
                     }
                 }
 
                 dmGameObject::Result result = dmGameObject::SetParent(instance, parent);
 
                 if (result != dmGameObject::RESULT_OK)
+                {
                     dmLogWarning("Error when setting parent of '%s' to '%s', error: %i.",
                                  dmHashReverseSafe64(instance->m_Identifier),
                                  dmHashReverseSafe64(sp->m_ParentId),
                                  result);
+                    return;
+                }
+
+                if (sp->m_KeepWorldTransform == 0)
+                {
+                    Matrix4& world = GetWorldTransformRef(instance);
+                    if (instance->m_ScaleAlongZ)
+                    {
+                        world = parent_t * dmTransform::ToMatrix4(GetLocalTransform(instance));
+                    }
+                    else
+                    {
+                        world = dmTransform::MulNoScaleZ(parent_t, dmTransform::ToMatrix4(GetLocalTransform(instance)));
+                    }
+                }
+                else
+                {
+                    SetLocalTransform(instance, keep_world_local);
+                }
                 return;
             }
         }
@@ -2312,66 +2401,178 @@ namespace dmGameObject
         }
     }
 
+    // Levels smaller than this are updated on the calling thread
+    static const uint32_t TRANSFORM_JOB_MIN_BATCH_SIZE = 256;
+    // Number of transforms converted to matrices at a time
+    static const uint32_t TRANSFORM_BATCH_SIZE = 64;
+
+    struct UpdateTransformsContext
+    {
+        LevelTransforms*        m_Level;
+        // World transforms of the previous level, where the parents are
+        const Matrix4*          m_ParentWorldTransforms;
+        // Level indices of the instances to update, or 0x0 to update the whole level
+        const uint16_t*         m_LevelIndices;
+        bool                    m_ScaleAlongZ;
+    };
+
+    // Updates the world transforms of a range of the instances in a level.
+    // The instances within a level are independent, and their parents are in the previous level.
+    // When the whole level is updated, the transforms are streamed linearly from the level arrays
+    static void UpdateLevelTransforms(void* _context, uint32_t begin, uint32_t end)
+    {
+        UpdateTransformsContext* context = (UpdateTransformsContext*) _context;
+        LevelTransforms* level = context->m_Level;
+        const uint16_t* level_indices = context->m_LevelIndices;
+        const Vector3* positions = level->m_Positions.Begin();
+        const Quat* rotations = level->m_Rotations.Begin();
+        const Vector3* scales = level->m_Scales.Begin();
+        const uint16_t* parent_indices = level->m_ParentLevelIndices.Begin();
+        Matrix4* world_transforms = level->m_WorldTransforms.Begin();
+        const Matrix4* parent_world_transforms = context->m_ParentWorldTransforms;
+        bool scale_along_z = context->m_ScaleAlongZ;
+
+        dmTransform::Transform transforms[TRANSFORM_BATCH_SIZE];
+        Matrix4 own[TRANSFORM_BATCH_SIZE];
+        for (uint32_t batch_begin = begin; batch_begin < end; batch_begin += TRANSFORM_BATCH_SIZE)
+        {
+            uint32_t count = dmMath::Min(end - batch_begin, TRANSFORM_BATCH_SIZE);
+            if (level_indices)
+            {
+                for (uint32_t i = 0; i < count; ++i)
+                {
+                    uint16_t index = level_indices[batch_begin + i];
+                    transforms[i] = dmTransform::Transform(positions[index], rotations[index], scales[index]);
+                }
+            }
+            else
+            {
+                for (uint32_t i = 0; i < count; ++i)
+                {
+                    uint32_t index = batch_begin + i;
+                    transforms[i] = dmTransform::Transform(positions[index], rotations[index], scales[index]);
+                }
+            }
+
+            dmTransform::ToMatrix4(transforms, own, count);
+
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                uint32_t index = level_indices ? level_indices[batch_begin + i] : batch_begin + i;
+                uint16_t parent_index = parent_indices[index];
+                if (parent_index == INVALID_INSTANCE_INDEX)
+                    world_transforms[index] = own[i];
+                else if (scale_along_z)
+                    world_transforms[index] = parent_world_transforms[parent_index] * own[i];
+                else
+                    world_transforms[index] = dmTransform::MulNoScaleZ(parent_world_transforms[parent_index], own[i]);
+            }
+        }
+    }
+
+    void SetTransformDirty(Collection* collection, Instance* instance)
+    {
+        uint16_t index = instance->m_Index;
+        // The descendants of a dirty instance are already dirty
+        if (collection->m_DirtyTransformFlags[index])
+            return;
+        collection->m_DirtyTransformFlags[index] = 1;
+        collection->m_DirtyTransformIndices.Push(index);
+        collection->m_DirtyTransforms = 1;
+
+        uint16_t child_index = instance->m_FirstChildIndex;
+        while (child_index != INVALID_INSTANCE_INDEX)
+        {
+            Instance* child = collection->m_Instances[child_index];
+            SetTransformDirty(collection, child);
+            child_index = child->m_SiblingIndex;
+        }
+    }
+
     void UpdateTransforms(Collection* collection)
     {
         DM_PROFILE(GameObject, "UpdateTransforms");
 
-        // Calculate world transforms
-        // First root-level instances
-        dmArray<uint16_t>& root_level = collection->m_LevelIndices[0];
-        uint32_t root_count = root_level.Size();
-        for (uint32_t i = 0; i < root_count; ++i)
+        // Only the dirty instances are updated. Since the descendants of a dirty instance are dirty too,
+        // the parent of an updated instance is either updated in a previous level, or already up to date
+        dmArray<uint16_t>& dirty_indices = collection->m_DirtyTransformIndices;
+        uint32_t dirty_count = dirty_indices.Size();
+        DM_COUNTER("DirtyTransforms", dirty_count);
+        if (dirty_count == 0)
         {
-            uint16_t index = root_level[i];
-            Instance* instance = collection->m_Instances[index];
-            CheckEuler(instance);
-            collection->m_WorldTransforms[index] = dmTransform::ToMatrix4(instance->m_Transform);
-            uint16_t parent_index = instance->m_Parent;
-            assert(parent_index == INVALID_INSTANCE_INDEX);
+            collection->m_DirtyTransforms = false;
+            return;
         }
 
-
-        if (collection->m_ScaleAlongZ) {
-            for (uint32_t level_i = 1; level_i < MAX_HIERARCHICAL_DEPTH; ++level_i)
+        // Order the level indices of the dirty instances by level. Indices of deleted instances are skipped
+        uint32_t level_end[MAX_HIERARCHICAL_DEPTH];
+        memset(level_end, 0, sizeof(level_end));
+        for (uint32_t i = 0; i < dirty_count; ++i)
+        {
+            Instance* instance = collection->m_Instances[dirty_indices[i]];
+            if (instance)
+                level_end[instance->m_Depth]++;
+        }
+        uint32_t offset = 0;
+        for (uint32_t level_i = 0; level_i < MAX_HIERARCHICAL_DEPTH; ++level_i)
+        {
+            uint32_t count = level_end[level_i];
+            level_end[level_i] = offset;
+            offset += count;
+        }
+        dmArray<uint16_t>& level_indices = collection->m_DirtyTransformLevelIndices;
+        level_indices.SetSize(offset);
+        for (uint32_t i = 0; i < dirty_count; ++i)
+        {
+            Instance* instance = collection->m_Instances[dirty_indices[i]];
+            if (instance)
             {
-                dmArray<uint16_t>& level = collection->m_LevelIndices[level_i];
-                uint32_t instance_count = level.Size();
-                for (uint32_t i = 0; i < instance_count; ++i)
-                {
-                    uint16_t index = level[i];
-                    Instance* instance = collection->m_Instances[index];
-                    CheckEuler(instance);
-                    Matrix4* trans = &collection->m_WorldTransforms[index];
-
-                    uint16_t parent_index = instance->m_Parent;
-                    assert(parent_index != INVALID_INSTANCE_INDEX);
-
-                    Matrix4* parent_trans = &collection->m_WorldTransforms[parent_index];
-                    Matrix4 own = dmTransform::ToMatrix4(instance->m_Transform);
-                    *trans = *parent_trans * own;
-                }
+                // May update the rotation
+                CheckEuler(instance);
+                level_indices[level_end[instance->m_Depth]++] = instance->m_LevelIndex;
             }
-        } else {
-            for (uint32_t level_i = 1; level_i < MAX_HIERARCHICAL_DEPTH; ++level_i)
-            {
-                dmArray<uint16_t>& level = collection->m_LevelIndices[level_i];
-                uint32_t instance_count = level.Size();
-                for (uint32_t i = 0; i < instance_count; ++i)
-                {
-                    uint16_t index = level[i];
-                    Instance* instance = collection->m_Instances[index];
-                    CheckEuler(instance);
-                    Matrix4* trans = &collection->m_WorldTransforms[index];
+        }
 
-                    uint16_t parent_index = instance->m_Parent;
-                    assert(parent_index != INVALID_INSTANCE_INDEX);
+        // Calculate world transforms, one level at a time, starting with the root-level instances.
+        // Large levels are split across the job pool
+        dmJobPool::HJobPool job_pool = collection->m_Register->m_JobPool;
+        UpdateTransformsContext context;
+        context.m_ScaleAlongZ = collection->m_ScaleAlongZ != 0;
+        uint32_t level_begin = 0;
+        for (uint32_t level_i = 0; level_i < MAX_HIERARCHICAL_DEPTH && level_begin < offset; ++level_i)
+        {
+            uint32_t count = level_end[level_i] - level_begin;
+            if (count > 0)
+            {
+                LevelTransforms* level = &collection->m_LevelTransforms[level_i];
+                context.m_Level = level;
+                context.m_ParentWorldTransforms = level_i > 0 ? collection->m_LevelTransforms[level_i - 1].m_WorldTransforms.Begin() : 0x0;
+                // Every instance in the level is dirty, e.g. when the root-nodes are moving
+                bool whole_level = count == level->m_WorldTransforms.Size();
+                context.m_LevelIndices = whole_level ? 0x0 : level_indices.Begin() + level_begin;
+                dmJobPool::ParallelFor(job_pool, count, TRANSFORM_JOB_MIN_BATCH_SIZE, UpdateLevelTransforms, &context);
 
-                    Matrix4* parent_trans = &collection->m_WorldTransforms[parent_index];
-                    Matrix4 own = dmTransform::ToMatrix4(instance->m_Transform);
-                    *trans = dmTransform::MulNoScaleZ(*parent_trans, own);
+                // Only the moved instances need to be updated in the index
+                if (collection->m_UseSpatialIndex)
+                {
+                    DM_PROFILE(GameObject, "UpdateSpatialIndex");
+                    const uint16_t* instance_indices = collection->m_LevelIndices[level_i].Begin();
+                    const Matrix4* world_transforms = level->m_WorldTransforms.Begin();
+                    for (uint32_t i = 0; i < count; ++i)
+                    {
+                        uint16_t index = whole_level ? i : level_indices[level_begin + i];
+                        SpatialIndexUpdate(&collection->m_SpatialIndex, instance_indices[index], Point3(world_transforms[index].getCol3().getXYZ()));
+                    }
                 }
             }
+            level_begin = level_end[level_i];
+        }
+
+        for (uint32_t i = 0; i < dirty_count; ++i)
+        {
+            collection->m_DirtyTransformFlags[dirty_indices[i]] = 0;
         }
+        dirty_indices.SetSize(0);
 
         collection->m_DirtyTransforms = false;
     }
@@ -2381,6 +2582,68 @@ namespace dmGameObject
         UpdateTransforms(hcollection->m_Collection);
     }
 
+    struct SpatialQueryContext
+    {
+        Collection*         m_Collection;
+        dmArray<HInstance>* m_Instances;
+        Point3              m_Center;
+        float               m_RadiusSq;
+    };
+
+    static void AppendInstance(SpatialQueryContext* context, uint16_t instance_index)
+    {
+        dmArray<HInstance>& instances = *context->m_Instances;
+        if (instances.Full())
+        {
+            instances.OffsetCapacity(dmMath::Max(16U, instances.Capacity()));
+        }
+        instances.Push(context->m_Collection->m_Instances[instance_index]);
+    }
+
+    static void QueryAABBCallback(void* _context, uint16_t instance_index, const Point3& position)
+    {
+        (void)position;
+        AppendInstance((SpatialQueryContext*) _context, instance_index);
+    }
+
+    static void QueryRadiusCallback(void* _context, uint16_t instance_index, const Point3& position)
+    {
+        SpatialQueryContext* context = (SpatialQueryContext*) _context;
+        if (distSqr(position, context->m_Center) <= context->m_RadiusSq)
+        {
+            AppendInstance(context, instance_index);
+        }
+    }
+
+    Result QueryAABB(HCollection hcollection, const Point3& min, const Point3& max, dmArray<HInstance>& instances)
+    {
+        Collection* collection = hcollection->m_Collection;
+        if (!collection->m_UseSpatialIndex)
+            return RESULT_INVALID_OPERATION;
+
+        SpatialQueryContext context;
+        context.m_Collection = collection;
+        context.m_Instances = &instances;
+        SpatialIndexQuery(&collection->m_SpatialIndex, min, max, QueryAABBCallback, &context);
+        return RESULT_OK;
+    }
+
+    Result QueryRadius(HCollection hcollection, const Point3& center, float radius, dmArray<HInstance>& instances)
+    {
+        Collection* collection = hcollection->m_Collection;
+        if (!collection->m_UseSpatialIndex)
+            return RESULT_INVALID_OPERATION;
+
+        SpatialQueryContext context;
+        context.m_Collection = collection;
+        context.m_Instances = &instances;
+        context.m_Center = center;
+        context.m_RadiusSq = radius * radius;
+        Vector3 extents(radius, radius, radius);
+        SpatialIndexQuery(&collection->m_SpatialIndex, center - extents, center + extents, QueryRadiusCallback, &context);
+        return RESULT_OK;
+    }
+
     static bool Update(Collection* collection, const UpdateContext* update_context)
     {
         DM_PROFILE(GameObject, "Update");
@@ -2769,53 +3032,57 @@ namespace dmGameObject
 
     void SetPosition(HInstance instance, Point3 position)
     {
-        instance->m_Transform.SetTranslation(Vector3(position));
+        GetLevelTransforms(instance).m_Positions[instance->m_LevelIndex] = Vector3(position);
+        SetTransformDirty(instance->m_Collection, instance);
     }
 
     Point3 GetPosition(HInstance instance)
     {
-        return Point3(instance->m_Transform.GetTranslation());
+        return Point3(GetLevelTransforms(instance).m_Positions[instance->m_LevelIndex]);
     }
 
     void SetRotation(HInstance instance, Quat rotation)
     {
-        instance->m_Transform.SetRotation(rotation);
+        GetLevelTransforms(instance).m_Rotations[instance->m_LevelIndex] = rotation;
+        SetTransformDirty(instance->m_Collection, instance);
     }
 
     Quat GetRotation(HInstance instance)
     {
-        return instance->m_Transform.GetRotation();
+        return GetLevelTransforms(instance).m_Rotations[instance->m_LevelIndex];
     }
 
     void SetScale(HInstance instance, float scale)
     {
-        instance->m_Transform.SetUniformScale(scale);
+        GetLevelTransforms(instance).m_Scales[instance->m_LevelIndex] = Vector3(scale);
+        SetTransformDirty(instance->m_Collection, instance);
     }
 
     void SetScale(HInstance instance, Vector3 scale)
     {
-        instance->m_Transform.SetScale(scale);
+        GetLevelTransforms(instance).m_Scales[instance->m_LevelIndex] = scale;
+        SetTransformDirty(instance->m_Collection, instance);
     }
 
     float GetUniformScale(HInstance instance)
     {
-        return instance->m_Transform.GetUniformScale();
+        return minElem(GetLevelTransforms(instance).m_Scales[instance->m_LevelIndex]);
     }
 
     Vector3 GetScale(HInstance instance)
     {
-        return instance->m_Transform.GetScale();
+        return GetLevelTransforms(instance).m_Scales[instance->m_LevelIndex];
     }
 
     Point3 GetWorldPosition(HInstance instance)
     {
-        Vector4 translation = instance->m_Collection->m_WorldTransforms[instance->m_Index].getCol(3);
+        Vector4 translation = GetWorldTransformRef(instance).getCol(3);
         return Point3(translation.getX(), translation.getY(), translation.getZ());
     }
 
     Quat GetWorldRotation(HInstance instance)
     {
-        Matrix4 world_transform = instance->m_Collection->m_WorldTransforms[instance->m_Index];
+        Matrix4 world_transform = GetWorldTransformRef(instance);
         dmTransform::ResetScale(&world_transform);
         return Quat(world_transform.getUpper3x3());
     }
@@ -2828,7 +3095,7 @@ namespace dmGameObject
 
     Vector3 GetWorldScale(HInstance instance)
     {
-        return dmTransform::ExtractScale(instance->m_Collection->m_WorldTransforms[instance->m_Index]);
+        return dmTransform::ExtractScale(GetWorldTransformRef(instance));
     }
 
     /*
@@ -2837,13 +3104,13 @@ namespace dmGameObject
     */
     dmTransform::Transform GetWorldTransform(HInstance instance)
     {
-        Matrix4 mtx = instance->m_Collection->m_WorldTransforms[instance->m_Index];
+        Matrix4 mtx = GetWorldTransformRef(instance);
         return dmTransform::ToTransform(mtx);
     }
 
     const Matrix4 & GetWorldMatrix(HInstance instance)
     {
-        return instance->m_Collection->m_WorldTransforms[instance->m_Index];
+        return GetWorldTransformRef(instance);
     }
 
     Result SetParent(HInstance child, HInstance parent)
@@ -2887,6 +3154,8 @@ namespace dmGameObject
             Unlink(collection, child);
         }
 
+        dmTransform::Transform local = GetLocalTransform(child);
+        Matrix4 world = GetWorldTransformRef(child);
         EraseSwapLevelIndex(collection, child);
 
         // Add child to parent
@@ -2917,7 +3186,7 @@ namespace dmGameObject
             child->m_Parent = INVALID_INSTANCE_INDEX;
             child->m_Depth = 0;
         }
-        InsertInstanceInLevelIndex(collection, child);
+        InsertInstanceInLevelIndex(collection, child, local, world);
 
         int32_t n_steps =  (int32_t) original_child_depth - (int32_t) child->m_Depth;
         if (n_steps < 0)
@@ -2986,7 +3255,7 @@ namespace dmGameObject
 
     static void UpdateRotationToEuler(HInstance instance)
     {
-        Quat q = instance->m_Transform.GetRotation();
+        Quat q = GetRotation(instance);
         instance->m_EulerRotation = dmVMath::QuatToEuler(q.getX(), q.getY(), q.getZ(), q.getW());
         instance->m_PrevEulerRotation = instance->m_EulerRotation;
     }
@@ -2994,7 +3263,7 @@ namespace dmGameObject
     static void UpdateEulerToRotation(HInstance instance)
     {
         instance->m_PrevEulerRotation = instance->m_EulerRotation;
-        instance->m_Transform.SetRotation(dmVMath::EulerToQuat(instance->m_EulerRotation));
+        GetLevelTransforms(instance).m_Rotations[instance->m_LevelIndex] = dmVMath::EulerToQuat(instance->m_EulerRotation);
     }
 
     PropertyResult GetProperty(HInstance instance, dmhash_t component_id, dmhash_t property_id, PropertyDesc& out_value)
@@ -3003,96 +3272,72 @@ namespace dmGameObject
             return PROPERTY_RESULT_INVALID_INSTANCE;
         if (component_id == 0)
         {
+            // The transforms are stored per level and move when the hierarchy changes, so only the euler rotation
+            // is exposed through m_ValuePtr. Animations of the other properties are applied through SetProperty
             out_value.m_ValuePtr = 0x0;
 
             // Scale used to be a uniform scalar, but is now a non-uniform 3-component scale
             if (property_id == PROP_SCALE)
             {
-                float* scale = instance->m_Transform.GetScalePtr();
-                out_value.m_ValuePtr = scale;
                 out_value.m_ElementIds[0] = PROP_SCALE_X;
                 out_value.m_ElementIds[1] = PROP_SCALE_Y;
                 out_value.m_ElementIds[2] = PROP_SCALE_Z;
-                out_value.m_Variant = PropertyVar(instance->m_Transform.GetScale());
+                out_value.m_Variant = PropertyVar(GetScale(instance));
             }
             else if (property_id == PROP_SCALE_X)
             {
-                float* scale = instance->m_Transform.GetScalePtr();
-                out_value.m_ValuePtr = scale;
-                out_value.m_Variant = PropertyVar(*out_value.m_ValuePtr);
+                out_value.m_Variant = PropertyVar(GetLocalScalePtr(instance)[0]);
             }
             else if (property_id == PROP_SCALE_Y)
             {
-                float* scale = instance->m_Transform.GetScalePtr();
-                out_value.m_ValuePtr = scale + 1;
-                out_value.m_Variant = PropertyVar(*out_value.m_ValuePtr);
+                out_value.m_Variant = PropertyVar(GetLocalScalePtr(instance)[1]);
             }
             else if (property_id == PROP_SCALE_Z)
             {
-                float* scale = instance->m_Transform.GetScalePtr();
-                out_value.m_ValuePtr = scale + 2;
-                out_value.m_Variant = PropertyVar(*out_value.m_ValuePtr);
+                out_value.m_Variant = PropertyVar(GetLocalScalePtr(instance)[2]);
             }
             else if (property_id == PROP_POSITION)
             {
-                float* position = instance->m_Transform.GetPositionPtr();
-                out_value.m_ValuePtr = position;
                 out_value.m_ElementIds[0] = PROP_POSITION_X;
                 out_value.m_ElementIds[1] = PROP_POSITION_Y;
                 out_value.m_ElementIds[2] = PROP_POSITION_Z;
-                out_value.m_Variant = PropertyVar(instance->m_Transform.GetTranslation());
+                out_value.m_Variant = PropertyVar(Vector3(GetPosition(instance)));
             }
             else if (property_id == PROP_POSITION_X)
             {
-                float* position = instance->m_Transform.GetPositionPtr();
-                out_value.m_ValuePtr = position;
-                out_value.m_Variant = PropertyVar(*out_value.m_ValuePtr);
+                out_value.m_Variant = PropertyVar(GetLocalPositionPtr(instance)[0]);
             }
             else if (property_id == PROP_POSITION_Y)
             {
-                float* position = instance->m_Transform.GetPositionPtr();
-                out_value.m_ValuePtr = position + 1;
-                out_value.m_Variant = PropertyVar(*out_value.m_ValuePtr);
+                out_value.m_Variant = PropertyVar(GetLocalPositionPtr(instance)[1]);
             }
             else if (property_id == PROP_POSITION_Z)
             {
-                float* position = instance->m_Transform.GetPositionPtr();
-                out_value.m_ValuePtr = position + 2;
-                out_value.m_Variant = PropertyVar(*out_value.m_ValuePtr);
+                out_value.m_Variant = PropertyVar(GetLocalPositionPtr(instance)[2]);
             }
             else if (property_id == PROP_ROTATION)
             {
-                float* rotation = instance->m_Transform.GetRotationPtr();
-                out_value.m_ValuePtr = rotation;
                 out_value.m_ElementIds[0] = PROP_ROTATION_X;
                 out_value.m_ElementIds[1] = PROP_ROTATION_Y;
                 out_value.m_ElementIds[2] = PROP_ROTATION_Z;
                 out_value.m_ElementIds[3] = PROP_ROTATION_W;
-                out_value.m_Variant = PropertyVar(instance->m_Transform.GetRotation());
+                out_value.m_Variant = PropertyVar(GetRotation(instance));
             }
             else if (property_id == PROP_ROTATION_X)
             {
-                float* rotation = instance->m_Transform.GetRotationPtr();
-                out_value.m_ValuePtr = rotation;
-                out_value.m_Variant = PropertyVar(*out_value.m_ValuePtr);
+                out_value.m_Variant = PropertyVar(GetLocalRotationPtr(instance)[0]);
             }
             else if (property_id == PROP_ROTATION_Y)
             {
-                float* rotation = instance->m_Transform.GetRotationPtr();
-                out_value.m_ValuePtr = rotation + 1;
-                out_value.m_Variant = PropertyVar(*out_value.m_ValuePtr);
+                out_value.m_Variant = PropertyVar(GetLocalRotationPtr(instance)[1]);
             }
             else if (property_id == PROP_ROTATION_Z)
             {
-                float* rotation = instance->m_Transform.GetRotationPtr();
-                out_value.m_ValuePtr = rotation + 2;
-                out_value.m_Variant = PropertyVar(*out_value.m_ValuePtr);
+                out_value.m_Variant = PropertyVar(GetLocalRotationPtr(instance)[2]);
             }
             else if (property_id == PROP_ROTATION_W)
             {
-                float* rotation = instance->m_Transform.GetRotationPtr();
-                out_value.m_ValuePtr = rotation + 3;
-                out_value.m_Variant = PropertyVar(*out_value.m_ValuePtr);
+                out_value.m_Variant = PropertyVar(GetLocalRotationPtr(instance)[3]);
             }
             else if (property_id == PROP_EULER)
             {
@@ -3121,14 +3366,11 @@ namespace dmGameObject
                 out_value.m_ValuePtr = ((float*)&instance->m_EulerRotation) + 2;
                 out_value.m_Variant = PropertyVar(*out_value.m_ValuePtr);
             }
-            if (out_value.m_ValuePtr != 0x0)
-            {
-                return PROPERTY_RESULT_OK;
-            }
             else
             {
                 return PROPERTY_RESULT_NOT_FOUND;
             }
+            return PROPERTY_RESULT_OK;
         }
         else
         {
@@ -3183,9 +3425,10 @@ namespace dmGameObject
             return PROPERTY_RESULT_INVALID_INSTANCE;
         if (component_id == 0)
         {
-            float* position = instance->m_Transform.GetPositionPtr();
-            float* rotation = instance->m_Transform.GetRotationPtr();
-            float* scale = instance->m_Transform.GetScalePtr();
+            SetTransformDirty(instance->m_Collection, instance);
+            float* position = GetLocalPositionPtr(instance);
+            float* rotation = GetLocalRotationPtr(instance);
+            float* scale = GetLocalScalePtr(instance);
             if (property_id == PROP_POSITION)
             {
                 if (value.m_Type != PROPERTY_TYPE_VECTOR3)
@@ -3398,7 +3641,6 @@ namespace dmGameObject
         new_instance->m_FirstChildIndex = instance->m_FirstChildIndex;
         new_instance->m_SiblingIndex = instance->m_SiblingIndex;
         // transform-related
-        new_instance->m_Transform = instance->m_Transform;
         new_instance->m_EulerRotation = instance->m_EulerRotation;
         new_instance->m_PrevEulerRotation = instance->m_PrevEulerRotation;
         new_instance->m_ScaleAlongZ = instance->m_ScaleAlongZ;
@@ -19,6 +19,7 @@
 
 #include <dlib/easing.h>
 #include <dlib/hashtable.h>
+#include <dlib/job_pool.h>
 #include <dlib/message.h>
 #include <dlib/transform.h>
 
@@ -44,6 +45,9 @@ namespace dmGameObject
     /// Config key to use for tweaking the maximum capacity of the input stack
     extern const char* COLLECTION_MAX_INPUT_STACK_ENTRIES_KEY;
 
+    /// Config key to use for the cell size of the spatial index of collections
+    extern const char* COLLECTION_SPATIAL_INDEX_CELL_SIZE_KEY;
+
     extern const dmhash_t UNNAMED_IDENTIFIER;
 
 
@@ -88,6 +92,22 @@ namespace dmGameObject
      */
     void SetInputStackDefaultCapacity(HRegister regist, uint32_t capacity);
 
+    /**
+     * Set the job pool used to update the transforms of large collections in parallel.
+     * The pool must outlive the register, or be reset to 0x0 before it is deleted.
+     * @param regist Register
+     * @param job_pool Job pool, or 0x0 to update all transforms on the calling thread
+     */
+    void SetJobPool(HRegister regist, dmJobPool::HJobPool job_pool);
+
+    /**
+     * Set the cell size of the spatial index of new collections in this register. This does not affect existing collections.
+     * The index keeps track of the world positions of the instances, see QueryAABB and QueryRadius.
+     * @param regist Register
+     * @param cell_size Cell size in world units, or 0 to disable the spatial index (default)
+     */
+    void SetSpatialIndexCellSize(HRegister regist, float cell_size);
+
     /**
      * Creates a new gameobject collection
      * @param name Collection name, which must be unique and follow the same naming as for sockets
@@ -242,6 +262,13 @@ namespace dmGameObject
      */
     bool Update(HCollection collection, const UpdateContext* update_context);
 
+    /**
+     * Updates the world transforms of the instances of the collection whose transforms have changed.
+     * Only needed when transforms are changed outside of the update of the collection, since Update does this.
+     * @param collection Game object collection
+     */
+    void UpdateTransforms(HCollection collection);
+
     /**
      * Render all components in all game objects.
      * @param collection Collection to be rendered
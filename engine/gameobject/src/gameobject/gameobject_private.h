@@ -22,6 +22,7 @@
 
 #include "gameobject.h"
 #include "gameobject_props.h"
+#include "gameobject_spatial.h"
 #include "component.h"
 
 extern "C"
@@ -92,7 +93,6 @@ namespace dmGameObject
         Instance(Prototype* prototype)
         {
             m_Collection = 0;
-            m_Transform.SetIdentity();
             m_EulerRotation = Vector3(0.0f, 0.0f, 0.0f);
             m_PrevEulerRotation = Vector3(0.0f, 0.0f, 0.0f);
             m_Prototype = prototype;
@@ -119,8 +119,6 @@ namespace dmGameObject
         {
         }
 
-        dmTransform::Transform m_Transform;
-
         // Shadowed rotation expressed in euler coordinates
         Vector3 m_EulerRotation;
         // Previous euler rotation, used to detect if the euler rotation has changed and should overwrite the real rotation (needed by animation)
@@ -200,6 +198,10 @@ namespace dmGameObject
         // Default capacity of collections
         uint32_t                    m_DefaultCollectionCapacity;
         uint32_t                    m_DefaultInputStackCapacity;
+        // Optional pool used by UpdateTransforms
+        dmJobPool::HJobPool         m_JobPool;
+        // Cell size of the spatial index of new collections, 0 if disabled
+        float                       m_SpatialIndexCellSize;
 
         Register();
         ~Register();
@@ -209,6 +211,20 @@ namespace dmGameObject
     // depth is interpreted as up to <depth> levels of child nodes including root-nodes
     // Must be greater than zero
     const uint32_t MAX_HIERARCHICAL_DEPTH = 128;
+
+    // Transforms of the instances in one level of the scene-graph, as a structure of arrays.
+    // The arrays are parallel to the level in Collection::m_LevelIndices and indexed by Instance::m_LevelIndex,
+    // so the transforms move along with the instances when the level is erase-swapped
+    struct LevelTransforms
+    {
+        dmArray<Vector3>         m_Positions;
+        dmArray<Quat>            m_Rotations;
+        dmArray<Vector3>         m_Scales;
+        dmArray<Matrix4>         m_WorldTransforms;
+        // Level index of the parent in the previous level, or INVALID_INSTANCE_INDEX for root-nodes
+        dmArray<uint16_t>        m_ParentLevelIndices;
+    };
+
     struct Collection
     {
         Collection(dmResource::HFactory factory, HRegister regist, uint32_t max_instances, uint32_t max_input_stack_entries);
@@ -248,8 +264,19 @@ namespace dmGameObject
         // Level 1 contains level 1 indices in [0..m_LevelIndices[1].Size()-1]
         dmArray<uint16_t>        m_LevelIndices[MAX_HIERARCHICAL_DEPTH];
 
-        // Array of world transforms. Calculated using m_LevelIndices above
-        dmArray<Matrix4>         m_WorldTransforms;
+        // Local and world transforms of the instances, one structure of arrays per level,
+        // parallel to m_LevelIndices above. See LevelTransforms
+        LevelTransforms          m_LevelTransforms[MAX_HIERARCHICAL_DEPTH];
+
+        // Instances whose world transforms are out of date, see SetTransformDirty()
+        // Flag per instance index, and the indices of the flagged instances
+        dmArray<uint8_t>         m_DirtyTransformFlags;
+        dmArray<uint16_t>        m_DirtyTransformIndices;
+        // Scratch buffer used by UpdateTransforms to order the level indices of the dirty instances by level
+        dmArray<uint16_t>        m_DirtyTransformLevelIndices;
+
+        // World positions of the instances, updated with the world transforms. Only used if m_UseSpatialIndex is set
+        SpatialIndex             m_SpatialIndex;
 
         // Identifier to Instance mapping
         dmHashTable64<Instance*> m_IDToInstance;
@@ -288,7 +315,9 @@ namespace dmGameObject
         uint32_t                 m_ToBeDeleted : 1;
         // If the game object dynamically created in this collection should have the Z component of the position affected by scale
         uint32_t                 m_ScaleAlongZ : 1;
+        // Set if any instance has an out of date world transform
         uint32_t                 m_DirtyTransforms : 1;
+        uint32_t                 m_UseSpatialIndex : 1;
         uint32_t                 m_Initialized : 1;
     };
 
@@ -297,6 +326,49 @@ namespace dmGameObject
         Collection* m_Collection;
     };
 
+    inline LevelTransforms& GetLevelTransforms(HInstance instance)
+    {
+        return instance->m_Collection->m_LevelTransforms[instance->m_Depth];
+    }
+
+    inline dmTransform::Transform GetLocalTransform(HInstance instance)
+    {
+        LevelTransforms& level = GetLevelTransforms(instance);
+        uint16_t index = instance->m_LevelIndex;
+        return dmTransform::Transform(level.m_Positions[index], level.m_Rotations[index], level.m_Scales[index]);
+    }
+
+    inline void SetLocalTransform(HInstance instance, const dmTransform::Transform& transform)
+    {
+        LevelTransforms& level = GetLevelTransforms(instance);
+        uint16_t index = instance->m_LevelIndex;
+        level.m_Positions[index] = transform.GetTranslation();
+        level.m_Rotations[index] = transform.GetRotation();
+        level.m_Scales[index] = transform.GetScale();
+    }
+
+    inline Matrix4& GetWorldTransformRef(HInstance instance)
+    {
+        return GetLevelTransforms(instance).m_WorldTransforms[instance->m_LevelIndex];
+    }
+
+    // Pointers to the local transform components.
+    // They are only valid until the instance, or another instance in the same level, is moved in the hierarchy or deleted
+    inline float* GetLocalPositionPtr(HInstance instance)
+    {
+        return (float*) &GetLevelTransforms(instance).m_Positions[instance->m_LevelIndex];
+    }
+
+    inline float* GetLocalRotationPtr(HInstance instance)
+    {
+        return (float*) &GetLevelTransforms(instance).m_Rotations[instance->m_LevelIndex];
+    }
+
+    inline float* GetLocalScalePtr(HInstance instance)
+    {
+        return (float*) &GetLevelTransforms(instance).m_Scales[instance->m_LevelIndex];
+    }
+
     ComponentType* FindComponentType(Register* regist, uint32_t resource_type, uint32_t* index);
 
     // Used by res_collection.cpp
@@ -309,6 +381,10 @@ namespace dmGameObject
     bool CreateComponents(Collection* collection, HInstance instance);
     void Delete(Collection* collection, HInstance instance, bool recursive);
     void UpdateTransforms(Collection* collection);
+
+    // Marks the world transform of an instance, and those of its descendants, as out of date.
+    // Must be called whenever the local transform or parent of an instance changes
+    void SetTransformDirty(Collection* collection, Instance* instance);
     void DeleteCollection(Collection* collection);
     bool IsCollectionInitialized(Collection* collection);
     Result AttachCollection(Collection* collection, const char* name, dmResource::HFactory factory, HRegister regist, HCollection hcollection);
@@ -1778,6 +1778,132 @@ namespace dmGameObject
         return result;
     }
 
+    struct SpatialQueryLuaContext
+    {
+        lua_State*  m_L;
+        Collection* m_Collection;
+        Point3      m_Center;
+        float       m_RadiusSq;
+        uint32_t    m_Count;
+    };
+
+    static void PushQueryResult(SpatialQueryLuaContext* context, uint16_t instance_index)
+    {
+        lua_State* L = context->m_L;
+        dmScript::PushHash(L, context->m_Collection->m_Instances[instance_index]->m_Identifier);
+        lua_rawseti(L, -2, ++context->m_Count);
+    }
+
+    static void QueryAABBLuaCallback(void* _context, uint16_t instance_index, const Point3& position)
+    {
+        (void)position;
+        PushQueryResult((SpatialQueryLuaContext*) _context, instance_index);
+    }
+
+    static void QueryRadiusLuaCallback(void* _context, uint16_t instance_index, const Point3& position)
+    {
+        SpatialQueryLuaContext* context = (SpatialQueryLuaContext*) _context;
+        if (distSqr(position, context->m_Center) <= context->m_RadiusSq)
+        {
+            PushQueryResult(context, instance_index);
+        }
+    }
+
+    static Collection* CheckSpatialIndex(lua_State* L, const char* function_name)
+    {
+        ScriptInstance* i = ScriptInstance_Check(L);
+        Collection* collection = i->m_Instance->m_Collection;
+        if (!collection->m_UseSpatialIndex)
+        {
+            luaL_error(L, "%s requires the spatial index, see the project setting collection.spatial_index_cell_size", function_name);
+        }
+        return collection;
+    }
+
+    /*# finds the game objects within a box
+     * Finds the game object instances in the collection of the calling script whose
+     * world positions are inside an axis aligned box.
+     * The positions are those calculated at the end of the previous frame, see [ref:go.get_world_position].
+     *
+     * [icon:attention] Requires the project setting `collection.spatial_index_cell_size` to be set.
+     *
+     * @name go.query_aabb
+     * @param min [type:vector3] minimum corner of the box
+     * @param max [type:vector3] maximum corner of the box
+     * @return ids [type:table] the ids of the instances, in no particular order
+     * @examples
+     *
+     * Find the game objects within 100 units of the origin along the x and y axes:
+     *
+     * ```lua
+     * local ids = go.query_aabb(vmath.vector3(-100, -100, -1), vmath.vector3(100, 100, 1))
+     * for _, id in ipairs(ids) do
+     *     print(id)
+     * end
+     * ```
+     */
+    int Script_QueryAABB(lua_State* L)
+    {
+        int top = lua_gettop(L);
+        (void)top;
+
+        Collection* collection = CheckSpatialIndex(L, "go.query_aabb");
+        Vectormath::Aos::Vector3* min = dmScript::CheckVector3(L, 1);
+        Vectormath::Aos::Vector3* max = dmScript::CheckVector3(L, 2);
+
+        SpatialQueryLuaContext context;
+        context.m_L = L;
+        context.m_Collection = collection;
+        context.m_Count = 0;
+        lua_newtable(L);
+        SpatialIndexQuery(&collection->m_SpatialIndex, Point3(*min), Point3(*max), QueryAABBLuaCallback, &context);
+
+        assert(top + 1 == lua_gettop(L));
+        return 1;
+    }
+
+    /*# finds the game objects within a distance
+     * Finds the game object instances in the collection of the calling script whose
+     * world positions are within a distance from a position.
+     * The positions are those calculated at the end of the previous frame, see [ref:go.get_world_position].
+     *
+     * [icon:attention] Requires the project setting `collection.spatial_index_cell_size` to be set.
+     *
+     * @name go.query_radius
+     * @param position [type:vector3] center of the sphere
+     * @param radius [type:number] radius of the sphere
+     * @return ids [type:table] the ids of the instances, in no particular order
+     * @examples
+     *
+     * Find the game objects close to the game object of the calling script, including itself:
+     *
+     * ```lua
+     * local ids = go.query_radius(go.get_world_position(), 50)
+     * ```
+     */
+    int Script_QueryRadius(lua_State* L)
+    {
+        int top = lua_gettop(L);
+        (void)top;
+
+        Collection* collection = CheckSpatialIndex(L, "go.query_radius");
+        Point3 center(*dmScript::CheckVector3(L, 1));
+        float radius = (float) luaL_checknumber(L, 2);
+
+        SpatialQueryLuaContext context;
+        context.m_L = L;
+        context.m_Collection = collection;
+        context.m_Center = center;
+        context.m_RadiusSq = radius * radius;
+        context.m_Count = 0;
+        lua_newtable(L);
+        Vectormath::Aos::Vector3 extents(radius, radius, radius);
+        SpatialIndexQuery(&collection->m_SpatialIndex, center - extents, center + extents, QueryRadiusLuaCallback, &context);
+
+        assert(top + 1 == lua_gettop(L));
+        return 1;
+    }
+
     /* OMITTED FROM API DOCS!
      * constructs a ray in world space from a position in screen space
      *
@@ -1907,6 +2033,8 @@ namespace dmGameObject
         {"cancel_animations",       Script_CancelAnimations},
         {"delete",                  Script_Delete},
         {"delete_all",              Script_DeleteAll},
+        {"query_aabb",              Script_QueryAABB},
+        {"query_radius",            Script_QueryRadius},
         {"screen_ray",              Script_ScreenRay},
         {"property",                Script_Property},
         {0, 0}
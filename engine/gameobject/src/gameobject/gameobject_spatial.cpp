@@ -0,0 +1,213 @@
+// Copyright 2020 The Defold Foundation
+// Licensed under the Defold License version 1.0 (the "License"); you may not use
+// this file except in compliance with the License.
+//
+// You may obtain a copy of the License, together with FAQs at
+// https://www.defold.com/license
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include "gameobject_spatial.h"
+
+#include <assert.h>
+#include <math.h>
+#include <string.h>
+#include <dlib/math.h>
+
+namespace dmGameObject
+{
+    using namespace Vectormath::Aos;
+
+    static const uint16_t INVALID_LINK = 0xffff;
+    // Marks an instance that is not in the index
+    static const uint64_t INVALID_CELL_KEY = 0xffffffffffffffffULL;
+
+    // Cell coordinates are clamped to 21 bits per axis, so the key fits in 64 bits.
+    // Positions outside of the range end up in the border cells, which is still correct since all queries test the positions
+    static const int32_t CELL_COORD_BITS = 21;
+    static const int32_t CELL_COORD_MAX = (1 << (CELL_COORD_BITS - 1)) - 1;
+    static const int32_t CELL_COORD_MIN = -CELL_COORD_MAX;
+
+    static inline int32_t GetCellCoord(const SpatialIndex* index, float v)
+    {
+        float c = floorf(v * index->m_InvCellSize);
+        // Also maps NaN to the min cell
+        if (!(c >= (float)CELL_COORD_MIN))
+            return CELL_COORD_MIN;
+        if (c > (float)CELL_COORD_MAX)
+            return CELL_COORD_MAX;
+        return (int32_t)c;
+    }
+
+    static inline uint64_t GetCellKey(int32_t x, int32_t y, int32_t z)
+    {
+        const uint64_t mask = (1ULL << CELL_COORD_BITS) - 1;
+        return (((uint64_t)(x - CELL_COORD_MIN) & mask) << (2 * CELL_COORD_BITS)) |
+               (((uint64_t)(y - CELL_COORD_MIN) & mask) << CELL_COORD_BITS) |
+               ((uint64_t)(z - CELL_COORD_MIN) & mask);
+    }
+
+    static inline uint64_t GetCellKey(const SpatialIndex* index, const Point3& position)
+    {
+        return GetCellKey(GetCellCoord(index, position.getX()), GetCellCoord(index, position.getY()), GetCellCoord(index, position.getZ()));
+    }
+
+    void SpatialIndexInit(SpatialIndex* index, uint32_t max_instances, float cell_size)
+    {
+        assert(cell_size > 0.0f);
+        index->m_CellSize = cell_size;
+        index->m_InvCellSize = 1.0f / cell_size;
+        // There are never more occupied cells than instances
+        index->m_Cells.SetCapacity(dmMath::Max(1U, max_instances / 3), dmMath::Max(1U, max_instances));
+        index->m_Positions.SetCapacity(max_instances);
+        index->m_Positions.SetSize(max_instances);
+        index->m_CellKeys.SetCapacity(max_instances);
+        index->m_CellKeys.SetSize(max_instances);
+        index->m_Next.SetCapacity(max_instances);
+        index->m_Next.SetSize(max_instances);
+        index->m_Prev.SetCapacity(max_instances);
+        index->m_Prev.SetSize(max_instances);
+        memset(index->m_CellKeys.Begin(), 0xff, sizeof(uint64_t) * max_instances);
+    }
+
+    static void Unlink(SpatialIndex* index, uint16_t instance_index)
+    {
+        uint64_t key = index->m_CellKeys[instance_index];
+        uint16_t prev = index->m_Prev[instance_index];
+        uint16_t next = index->m_Next[instance_index];
+        if (prev != INVALID_LINK)
+        {
+            index->m_Next[prev] = next;
+        }
+        else if (next != INVALID_LINK)
+        {
+            *index->m_Cells.Get(key) = next;
+        }
+        else
+        {
+            index->m_Cells.Erase(key);
+        }
+        if (next != INVALID_LINK)
+        {
+            index->m_Prev[next] = prev;
+        }
+        index->m_CellKeys[instance_index] = INVALID_CELL_KEY;
+    }
+
+    void SpatialIndexUpdate(SpatialIndex* index, uint16_t instance_index, const Point3& position)
+    {
+        index->m_Positions[instance_index] = position;
+
+        uint64_t key = GetCellKey(index, position);
+        uint64_t old_key = index->m_CellKeys[instance_index];
+        if (key == old_key)
+            return;
+        if (old_key != INVALID_CELL_KEY)
+        {
+            Unlink(index, instance_index);
+        }
+
+        // Insert first in the cell
+        uint16_t* head = index->m_Cells.Get(key);
+        uint16_t next = head ? *head : INVALID_LINK;
+        index->m_Next[instance_index] = next;
+        index->m_Prev[instance_index] = INVALID_LINK;
+        if (next != INVALID_LINK)
+        {
+            index->m_Prev[next] = instance_index;
+            *head = instance_index;
+        }
+        else
+        {
+            assert(!index->m_Cells.Full());
+            index->m_Cells.Put(key, instance_index);
+        }
+        index->m_CellKeys[instance_index] = key;
+    }
+
+    void SpatialIndexRemove(SpatialIndex* index, uint16_t instance_index)
+    {
+        if (index->m_CellKeys[instance_index] != INVALID_CELL_KEY)
+        {
+            Unlink(index, instance_index);
+        }
+    }
+
+    struct QueryContext
+    {
+        SpatialIndex*           m_Index;
+        Point3                  m_Min;
+        Point3                  m_Max;
+        SpatialIndexCallback    m_Callback;
+        void*                   m_Context;
+    };
+
+    static void QueryCell(QueryContext* context, uint16_t first)
+    {
+        SpatialIndex* index = context->m_Index;
+        const Point3& min = context->m_Min;
+        const Point3& max = context->m_Max;
+        // The callback must not modify the index
+        for (uint16_t i = first; i != INVALID_LINK; i = index->m_Next[i])
+        {
+            const Point3& p = index->m_Positions[i];
+            if (p.getX() >= min.getX() && p.getX() <= max.getX() &&
+                p.getY() >= min.getY() && p.getY() <= max.getY() &&
+                p.getZ() >= min.getZ() && p.getZ() <= max.getZ())
+            {
+                context->m_Callback(context->m_Context, i, p);
+            }
+        }
+    }
+
+    static void QueryCellCallback(QueryContext* context, const uint64_t* key, uint16_t* first)
+    {
+        (void)key;
+        QueryCell(context, *first);
+    }
+
+    void SpatialIndexQuery(SpatialIndex* index, const Point3& min, const Point3& max, SpatialIndexCallback callback, void* context)
+    {
+        QueryContext query;
+        query.m_Index = index;
+        query.m_Min = min;
+        query.m_Max = max;
+        query.m_Callback = callback;
+        query.m_Context = context;
+
+        int32_t x0 = GetCellCoord(index, min.getX());
+        int32_t y0 = GetCellCoord(index, min.getY());
+        int32_t z0 = GetCellCoord(index, min.getZ());
+        int32_t x1 = GetCellCoord(index, max.getX());
+        int32_t y1 = GetCellCoord(index, max.getY());
+        int32_t z1 = GetCellCoord(index, max.getZ());
+        if (x1 < x0 || y1 < y0 || z1 < z0)
+            return;
+
+        // Visit the occupied cells instead, if there are fewer of them than cells in the box
+        uint64_t cell_count = (uint64_t)(x1 - x0 + 1) * (uint64_t)(y1 - y0 + 1) * (uint64_t)(z1 - z0 + 1);
+        if (cell_count > index->m_Cells.Size())
+        {
+            index->m_Cells.Iterate(QueryCellCallback, &query);
+            return;
+        }
+
+        for (int32_t z = z0; z <= z1; ++z)
+        {
+            for (int32_t y = y0; y <= y1; ++y)
+            {
+                for (int32_t x = x0; x <= x1; ++x)
+                {
+                    uint16_t* first = index->m_Cells.Get(GetCellKey(x, y, z));
+                    if (first)
+                    {
+                        QueryCell(&query, *first);
+                    }
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,52 @@
+// Copyright 2020 The Defold Foundation
+// Licensed under the Defold License version 1.0 (the "License"); you may not use
+// this file except in compliance with the License.
+//
+// You may obtain a copy of the License, together with FAQs at
+// https://www.defold.com/license
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#ifndef GAMEOBJECT_SPATIAL_H
+#define GAMEOBJECT_SPATIAL_H
+
+#include <stdint.h>
+#include <dlib/array.h>
+#include <dlib/hashtable.h>
+#include <dmsdk/vectormath/cpp/vectormath_aos.h>
+
+namespace dmGameObject
+{
+    /*
+     * Uniform grid of the world positions of the instances of a collection.
+     * Each instance is in exactly one cell, and the instances of a cell form a linked list.
+     * Only the occupied cells are stored.
+     */
+    struct SpatialIndex
+    {
+        float                           m_CellSize;
+        float                           m_InvCellSize;
+        // Cell key to the index of the first instance in the cell
+        dmHashTable64<uint16_t>         m_Cells;
+        // Per instance index
+        dmArray<Vectormath::Aos::Point3> m_Positions;
+        dmArray<uint64_t>               m_CellKeys;
+        dmArray<uint16_t>               m_Next;
+        dmArray<uint16_t>               m_Prev;
+    };
+
+    typedef void (*SpatialIndexCallback)(void* context, uint16_t instance_index, const Vectormath::Aos::Point3& position);
+
+    void SpatialIndexInit(SpatialIndex* index, uint32_t max_instances, float cell_size);
+    // Inserts the instance, or moves it if it is already in the index
+    void SpatialIndexUpdate(SpatialIndex* index, uint16_t instance_index, const Vectormath::Aos::Point3& position);
+    // Does nothing if the instance is not in the index
+    void SpatialIndexRemove(SpatialIndex* index, uint16_t instance_index);
+    // Calls the callback for each instance whose position is inside the box (inclusive)
+    void SpatialIndexQuery(SpatialIndex* index, const Vectormath::Aos::Point3& min, const Vectormath::Aos::Point3& max, SpatialIndexCallback callback, void* context);
+}
+
+#endif // GAMEOBJECT_SPATIAL_H
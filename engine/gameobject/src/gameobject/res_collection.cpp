@@ -74,7 +74,7 @@ namespace dmGameObject
                     scale = Vector3(instance_desc.m_Scale, instance_desc.m_Scale, instance_desc.m_Scale);
                 }
 
-                instance->m_Transform = dmTransform::Transform(Vector3(instance_desc.m_Position), instance_desc.m_Rotation, scale);
+                SetLocalTransform(instance, dmTransform::Transform(Vector3(instance_desc.m_Position), instance_desc.m_Rotation, scale));
 
                 dmHashInit64(&instance->m_CollectionPathHashState, true);
                 const char* path_end = strrchr(instance_desc.m_Id, *ID_SEPARATOR);
@@ -242,7 +242,13 @@ bail:
     {
         size_t size = sizeof(Collection) + sizeof(CollectionHandle);
         size += collection->m_InstanceIndices.Capacity()*sizeof(uint16_t);
-        size += collection->m_WorldTransforms.Capacity()*sizeof(Matrix4);
+        for (uint32_t i = 0; i < MAX_HIERARCHICAL_DEPTH; ++i)
+        {
+            size += collection->m_LevelIndices[i].Capacity()*(sizeof(uint16_t) + sizeof(Vector3) + sizeof(Quat) + sizeof(Vector3) + sizeof(Matrix4) + sizeof(uint16_t));
+        }
+        size += collection->m_DirtyTransformFlags.Capacity()*sizeof(uint8_t);
+        size += collection->m_DirtyTransformIndices.Capacity()*sizeof(uint16_t);
+        size += collection->m_DirtyTransformLevelIndices.Capacity()*sizeof(uint16_t);
         size += collection->m_IDToInstance.Capacity()*(sizeof(Instance*)+sizeof(dmhash_t));
         size += collection->m_InputFocusStack.Capacity()*sizeof(Instance*);
         size += collection->m_Instances.Capacity()*sizeof(Instance*);
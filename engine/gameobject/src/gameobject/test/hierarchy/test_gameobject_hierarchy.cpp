@@ -642,6 +642,173 @@ TEST_F(HierarchyTest, TestHierarchyNonUniformScale)
     dmGameObject::Delete(m_Collection, parent, false);
 }
 
+// Levels large enough to be split across the job pool must give the same result as the serial update
+TEST_F(HierarchyTest, TestHierarchyJobPool)
+{
+    const uint32_t root_count = 200;
+    const uint32_t instance_count = root_count * 5;
+    dmGameObject::HInstance instances[instance_count];
+    for (uint32_t i = 0; i < instance_count; ++i)
+    {
+        instances[i] = dmGameObject::New(m_Collection, "/go.goc");
+        ASSERT_NE((void*) 0, instances[i]);
+        float f = (float) i;
+        dmGameObject::SetPosition(instances[i], Point3(f, f * 0.5f, 1.0f));
+        dmGameObject::SetRotation(instances[i], Quat::rotationZ(f * 0.01f));
+        dmGameObject::SetScale(instances[i], Vector3(1.0f + (i % 3), 1.0f + (i % 5), 1.0f + (i % 7)));
+    }
+    // Two children per root, and one child per child
+    for (uint32_t i = root_count; i < instance_count; ++i)
+    {
+        uint32_t parent = i < root_count * 3 ? (i - root_count) / 2 : i - root_count * 2;
+        ASSERT_EQ(dmGameObject::RESULT_OK, dmGameObject::SetParent(instances[i], instances[parent]));
+    }
+
+    dmGameObject::Collection* collection = m_Collection->m_Collection;
+    dmGameObject::UpdateTransforms(collection);
+    Matrix4* expected = new Matrix4[instance_count];
+    for (uint32_t i = 0; i < instance_count; ++i)
+    {
+        expected[i] = dmGameObject::GetWorldMatrix(instances[i]);
+    }
+
+    dmJobPool::HJobPool job_pool = dmJobPool::New("transforms", 3);
+    dmGameObject::SetJobPool(m_Register, job_pool);
+
+    // Make sure the matrices are recomputed
+    for (uint32_t i = 0; i < instance_count; ++i)
+    {
+        dmGameObject::GetWorldTransformRef(instances[i]) = Matrix4::identity();
+    }
+    for (uint32_t i = 0; i < root_count; ++i)
+    {
+        dmGameObject::SetTransformDirty(collection, instances[i]);
+    }
+    ASSERT_EQ(instance_count, collection->m_DirtyTransformIndices.Size());
+    dmGameObject::UpdateTransforms(collection);
+
+    for (uint32_t i = 0; i < instance_count; ++i)
+    {
+        const Matrix4& world = dmGameObject::GetWorldMatrix(instances[i]);
+        for (uint32_t c = 0; c < 4; ++c)
+        {
+            ASSERT_NEAR(0.0f, length(world.getCol(c) - expected[i].getCol(c)), 0.001f);
+        }
+    }
+
+    dmGameObject::SetJobPool(m_Register, 0);
+    dmJobPool::Delete(job_pool);
+    delete [] expected;
+
+    for (uint32_t i = 0; i < instance_count; ++i)
+    {
+        dmGameObject::Delete(m_Collection, instances[i], false);
+    }
+}
+
+// The transforms are stored per level, and move along with the instances in the hierarchy
+TEST_F(HierarchyTest, TestLevelTransformStorage)
+{
+    dmGameObject::HInstance other = dmGameObject::New(m_Collection, "/go.goc");
+    dmGameObject::HInstance child = dmGameObject::New(m_Collection, "/go.goc");
+    dmGameObject::HInstance parent = dmGameObject::New(m_Collection, "/go.goc");
+    dmGameObject::Collection* collection = m_Collection->m_Collection;
+
+    // New instances have the identity transform
+    dmGameObject::LevelTransforms& root_level = collection->m_LevelTransforms[0];
+    ASSERT_EQ(3U, root_level.m_Positions.Size());
+    ASSERT_NEAR(0.0f, length(root_level.m_Positions[child->m_LevelIndex]), EPSILON);
+    ASSERT_NEAR(0.0f, length(Vector4(root_level.m_Rotations[child->m_LevelIndex]) - Vector4(Quat::identity())), EPSILON);
+    ASSERT_NEAR(0.0f, length(root_level.m_Scales[child->m_LevelIndex] - Vector3(1.0f, 1.0f, 1.0f)), EPSILON);
+
+    dmGameObject::SetPosition(parent, Point3(10.0f, 0.0f, 0.0f));
+    dmGameObject::SetPosition(child, Point3(1.0f, 2.0f, 3.0f));
+    dmGameObject::SetScale(child, Vector3(4.0f, 5.0f, 6.0f));
+    dmGameObject::SetPosition(other, Point3(7.0f, 8.0f, 9.0f));
+    ASSERT_NEAR(2.0f, root_level.m_Positions[child->m_LevelIndex].getY(), EPSILON);
+    ASSERT_NEAR(5.0f, root_level.m_Scales[child->m_LevelIndex].getY(), EPSILON);
+
+    // The child keeps its local transform when moved to the next level, and the parent swapped into its slot keeps its own
+    ASSERT_EQ(dmGameObject::RESULT_OK, dmGameObject::SetParent(child, parent));
+    ASSERT_EQ(2U, root_level.m_Positions.Size());
+    dmGameObject::LevelTransforms& child_level = collection->m_LevelTransforms[1];
+    ASSERT_EQ(1U, child_level.m_Positions.Size());
+    ASSERT_EQ(parent->m_LevelIndex, child_level.m_ParentLevelIndices[child->m_LevelIndex]);
+    ASSERT_NEAR(2.0f, dmGameObject::GetPosition(child).getY(), EPSILON);
+    ASSERT_NEAR(5.0f, dmGameObject::GetScale(child).getY(), EPSILON);
+    ASSERT_NEAR(10.0f, dmGameObject::GetPosition(parent).getX(), EPSILON);
+    ASSERT_NEAR(8.0f, dmGameObject::GetPosition(other).getY(), EPSILON);
+
+    // Deleting the first root instance swaps the parent into a new slot
+    dmGameObject::Delete(m_Collection, other, false);
+    dmGameObject::PostUpdate(m_Collection);
+    ASSERT_EQ(parent->m_LevelIndex, child_level.m_ParentLevelIndices[child->m_LevelIndex]);
+    dmGameObject::UpdateTransforms(collection);
+    ASSERT_NEAR(11.0f, dmGameObject::GetWorldPosition(child).getX(), EPSILON);
+
+    // Transform properties are not exposed through pointers, since the storage moves
+    dmGameObject::PropertyDesc desc;
+    ASSERT_EQ(dmGameObject::PROPERTY_RESULT_OK, dmGameObject::GetProperty(child, 0, dmHashString64("position.z"), desc));
+    ASSERT_EQ((float*) 0x0, desc.m_ValuePtr);
+    ASSERT_NEAR(3.0f, desc.m_Variant.m_Number, EPSILON);
+
+    dmGameObject::Delete(m_Collection, child, false);
+    dmGameObject::Delete(m_Collection, parent, false);
+}
+
+// Only moved instances and their descendants should be updated
+TEST_F(HierarchyTest, TestHierarchyDirtyTransforms)
+{
+    dmGameObject::HInstance parent = dmGameObject::New(m_Collection, "/go.goc");
+    dmGameObject::HInstance child = dmGameObject::New(m_Collection, "/go.goc");
+    dmGameObject::HInstance child_child = dmGameObject::New(m_Collection, "/go.goc");
+    dmGameObject::HInstance other = dmGameObject::New(m_Collection, "/go.goc");
+    dmGameObject::SetParent(child, parent);
+    dmGameObject::SetParent(child_child, child);
+    dmGameObject::SetPosition(other, Point3(1.0f, 0.0f, 0.0f));
+
+    dmGameObject::Collection* collection = m_Collection->m_Collection;
+    ASSERT_EQ(4U, collection->m_DirtyTransformIndices.Size());
+    ASSERT_TRUE(dmGameObject::Update(m_Collection, &m_UpdateContext));
+    ASSERT_EQ(0U, collection->m_DirtyTransformIndices.Size());
+    ASSERT_EQ(0, collection->m_DirtyTransformFlags[child->m_Index]);
+    ASSERT_NEAR(1.0f, dmGameObject::GetWorldPosition(other).getX(), EPSILON);
+
+    // A moved child dirties its own children, but not its parent
+    dmGameObject::SetPosition(child, Point3(2.0f, 0.0f, 0.0f));
+    ASSERT_EQ(2U, collection->m_DirtyTransformIndices.Size());
+    ASSERT_EQ(0, collection->m_DirtyTransformFlags[parent->m_Index]);
+    ASSERT_EQ(1, collection->m_DirtyTransformFlags[child->m_Index]);
+    ASSERT_EQ(1, collection->m_DirtyTransformFlags[child_child->m_Index]);
+    ASSERT_EQ(0, collection->m_DirtyTransformFlags[other->m_Index]);
+
+    // Setting it again does not add any more instances
+    dmGameObject::SetRotation(child, Quat::identity());
+    ASSERT_EQ(2U, collection->m_DirtyTransformIndices.Size());
+
+    dmGameObject::UpdateTransforms(collection);
+    ASSERT_EQ(0U, collection->m_DirtyTransformIndices.Size());
+    ASSERT_NEAR(2.0f, dmGameObject::GetWorldPosition(child_child).getX(), EPSILON);
+    ASSERT_NEAR(1.0f, dmGameObject::GetWorldPosition(other).getX(), EPSILON);
+
+    // Transform properties dirty the instance
+    ASSERT_EQ(dmGameObject::PROPERTY_RESULT_OK, dmGameObject::SetProperty(parent, 0, dmHashString64("position.x"), dmGameObject::PropertyVar(3.0f)));
+    ASSERT_EQ(3U, collection->m_DirtyTransformIndices.Size());
+    dmGameObject::UpdateTransforms(collection);
+    ASSERT_NEAR(5.0f, dmGameObject::GetWorldPosition(child_child).getX(), EPSILON);
+
+    // Deleted instances are skipped
+    dmGameObject::SetPosition(other, Point3(0.0f, 0.0f, 0.0f));
+    dmGameObject::Delete(m_Collection, other, false);
+    dmGameObject::PostUpdate(m_Collection);
+    dmGameObject::UpdateTransforms(collection);
+    ASSERT_EQ(0U, collection->m_DirtyTransformIndices.Size());
+
+    dmGameObject::Delete(m_Collection, child_child, false);
+    dmGameObject::Delete(m_Collection, child, false);
+    dmGameObject::Delete(m_Collection, parent, false);
+}
+
 TEST_F(HierarchyTest, TestHierarchyInheritScale)
 {
     dmGameObject::HInstance parent = dmGameObject::New(m_Collection, "/go.goc");
@@ -885,6 +1052,59 @@ TEST_F(HierarchyTest, TestHierarchyFromScript)
     dmGameObject::Delete(m_Collection, child, false);
 }
 
+static void PostSetParent(dmGameObject::HInstance child, dmGameObject::HInstance parent, bool keep_world_transform)
+{
+    dmGameObjectDDF::SetParent ddf;
+    ddf.m_ParentId = dmGameObject::GetIdentifier(parent);
+    ddf.m_KeepWorldTransform = keep_world_transform;
+
+    dmMessage::URL receiver;
+    receiver.m_Socket = dmGameObject::GetMessageSocket(child->m_Collection->m_HCollection);
+    receiver.m_Path = dmGameObject::GetIdentifier(child);
+    receiver.m_Fragment = 0;
+    ASSERT_EQ(dmMessage::RESULT_OK, dmMessage::Post(0x0, &receiver, dmGameObjectDDF::SetParent::m_DDFDescriptor->m_NameHash,
+        (uintptr_t) child, (uintptr_t) dmGameObjectDDF::SetParent::m_DDFDescriptor, &ddf, sizeof(ddf), 0));
+}
+
+// A set_parent that fails must leave the transforms of the instance as they were
+TEST_F(HierarchyTest, TestSetParentMessageFailure)
+{
+    dmGameObject::HInstance parent = dmGameObject::New(m_Collection, "/go.goc");
+    dmGameObject::HInstance child  = dmGameObject::New(m_Collection, "/go.goc");
+    ASSERT_EQ(dmGameObject::RESULT_OK, dmGameObject::SetIdentifier(m_Collection, parent, "parent"));
+    ASSERT_EQ(dmGameObject::RESULT_OK, dmGameObject::SetIdentifier(m_Collection, child, "child"));
+
+    dmGameObject::SetPosition(parent, Point3(1.0f, 2.0f, 3.0f));
+    dmGameObject::SetPosition(child, Point3(10.0f, 0.0f, 0.0f));
+    ASSERT_EQ(dmGameObject::RESULT_OK, dmGameObject::SetParent(child, parent));
+    ASSERT_TRUE(dmGameObject::Update(m_Collection, &m_UpdateContext));
+    ASSERT_NEAR(11.0f, dmGameObject::GetWorldPosition(child).getX(), EPSILON);
+
+    // The parent can't be a child of its own child
+    for (uint32_t keep_world_transform = 0; keep_world_transform < 2; ++keep_world_transform)
+    {
+        PostSetParent(parent, child, keep_world_transform != 0);
+        ASSERT_TRUE(dmGameObject::Update(m_Collection, &m_UpdateContext));
+
+        ASSERT_EQ((void*)0, dmGameObject::GetParent(parent));
+        ASSERT_EQ(parent, dmGameObject::GetParent(child));
+
+        Point3 position = dmGameObject::GetPosition(parent);
+        ASSERT_NEAR(1.0f, position.getX(), EPSILON);
+        ASSERT_NEAR(2.0f, position.getY(), EPSILON);
+        ASSERT_NEAR(3.0f, position.getZ(), EPSILON);
+
+        Point3 world_position = dmGameObject::GetWorldPosition(parent);
+        ASSERT_NEAR(1.0f, world_position.getX(), EPSILON);
+        ASSERT_NEAR(2.0f, world_position.getY(), EPSILON);
+        ASSERT_NEAR(3.0f, world_position.getZ(), EPSILON);
+        ASSERT_NEAR(11.0f, dmGameObject::GetWorldPosition(child).getX(), EPSILON);
+    }
+
+    dmGameObject::Delete(m_Collection, parent, false);
+    dmGameObject::Delete(m_Collection, child, false);
+}
+
 TEST_F(HierarchyTest, TestEmptyInstance)
 {
     dmGameObject::HInstance go = dmGameObject::New(m_Collection, 0x0);
@@ -1051,6 +1271,72 @@ TEST_F(HierarchyTest, TestIterateHierarchy)
 
 }
 
+static bool ContainsInstance(const dmArray<dmGameObject::HInstance>& instances, dmGameObject::HInstance instance)
+{
+    for (uint32_t i = 0; i < instances.Size(); ++i)
+    {
+        if (instances[i] == instance)
+            return true;
+    }
+    return false;
+}
+
+TEST_F(HierarchyTest, TestSpatialIndex)
+{
+    dmArray<dmGameObject::HInstance> instances;
+    ASSERT_EQ(dmGameObject::RESULT_INVALID_OPERATION, dmGameObject::QueryAABB(m_Collection, Point3(-1, -1, -1), Point3(1, 1, 1), instances));
+
+    dmGameObject::SetSpatialIndexCellSize(m_Register, 10.0f);
+    dmGameObject::HCollection collection = dmGameObject::NewCollection("spatial", m_Factory, m_Register, 1024);
+
+    dmGameObject::HInstance parent = dmGameObject::New(collection, "/go.goc");
+    dmGameObject::HInstance child = dmGameObject::New(collection, "/go.goc");
+    dmGameObject::HInstance other = dmGameObject::New(collection, "/go.goc");
+    dmGameObject::SetPosition(parent, Point3(5, 5, 0));
+    dmGameObject::SetPosition(child, Point3(20, 0, 0));
+    dmGameObject::SetParent(child, parent);
+    dmGameObject::SetPosition(other, Point3(-100, 42, 0));
+
+    ASSERT_TRUE(dmGameObject::Update(collection, &m_UpdateContext));
+
+    // The child is at (25, 5, 0) in world space
+    ASSERT_EQ(dmGameObject::RESULT_OK, dmGameObject::QueryAABB(collection, Point3(0, 0, -1), Point3(30, 10, 1), instances));
+    ASSERT_EQ(2U, instances.Size());
+    ASSERT_TRUE(ContainsInstance(instances, parent));
+    ASSERT_TRUE(ContainsInstance(instances, child));
+
+    instances.SetSize(0);
+    ASSERT_EQ(dmGameObject::RESULT_OK, dmGameObject::QueryRadius(collection, Point3(-100, 40, 0), 2.5f, instances));
+    ASSERT_EQ(1U, instances.Size());
+    ASSERT_EQ(other, instances[0]);
+
+    // Moving the parent moves the child in the index
+    dmGameObject::SetPosition(parent, Point3(-95, 35, 0));
+    ASSERT_TRUE(dmGameObject::Update(collection, &m_UpdateContext));
+
+    instances.SetSize(0);
+    ASSERT_EQ(dmGameObject::RESULT_OK, dmGameObject::QueryAABB(collection, Point3(0, 0, -1), Point3(30, 10, 1), instances));
+    ASSERT_EQ(0U, instances.Size());
+
+    instances.SetSize(0);
+    ASSERT_EQ(dmGameObject::RESULT_OK, dmGameObject::QueryRadius(collection, Point3(-100, 40, 0), 10.0f, instances));
+    ASSERT_EQ(2U, instances.Size());
+    ASSERT_TRUE(ContainsInstance(instances, parent));
+    ASSERT_TRUE(ContainsInstance(instances, other));
+
+    // Deleted instances are removed from the index
+    dmGameObject::Delete(collection, other, false);
+    ASSERT_TRUE(dmGameObject::PostUpdate(collection));
+
+    instances.SetSize(0);
+    ASSERT_EQ(dmGameObject::RESULT_OK, dmGameObject::QueryRadius(collection, Point3(-100, 40, 0), 10.0f, instances));
+    ASSERT_EQ(1U, instances.Size());
+    ASSERT_EQ(parent, instances[0]);
+
+    dmGameObject::DeleteCollection(collection);
+    dmGameObject::SetSpatialIndexCellSize(m_Register, 0.0f);
+}
+
 #undef EPSILON
 
 int main(int argc, char **argv)
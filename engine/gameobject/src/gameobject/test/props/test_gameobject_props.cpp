@@ -317,7 +317,7 @@ static dmhash_t hash(const char* s)
         dmGameObject::PropertyDesc desc;\
         ASSERT_EQ(dmGameObject::PROPERTY_RESULT_OK, dmGameObject::GetProperty(go, 0, hash(prop), desc));\
         ASSERT_EQ(dmGameObject::PROPERTY_TYPE_NUMBER, desc.m_Variant.m_Type);\
-        ASSERT_NEAR(v0, *desc.m_ValuePtr, epsilon);\
+        ASSERT_NEAR(v0, desc.m_Variant.m_Number, epsilon);\
     }\
 
 #define ASSERT_SET_PROP_V1(go, prop, v0, epsilon)\
@@ -326,7 +326,7 @@ static dmhash_t hash(const char* s)
         dmGameObject::SetProperty(go, 0, hash(prop), var);\
         dmGameObject::PropertyDesc desc;\
         ASSERT_EQ(dmGameObject::PROPERTY_RESULT_OK, dmGameObject::GetProperty(go, 0, hash(prop), desc));\
-        ASSERT_NEAR(v0, *desc.m_ValuePtr, epsilon);\
+        ASSERT_NEAR(v0, desc.m_Variant.m_Number, epsilon);\
     }\
 
 #define ASSERT_GET_PROP_V3(go, prop, v, epsilon)\
@@ -337,22 +337,22 @@ static dmhash_t hash(const char* s)
         ASSERT_EQ(hash(prop ".x"), desc.m_ElementIds[0]);\
         ASSERT_EQ(hash(prop ".y"), desc.m_ElementIds[1]);\
         ASSERT_EQ(hash(prop ".z"), desc.m_ElementIds[2]);\
-        ASSERT_NEAR(v.getX(), desc.m_ValuePtr[0], epsilon);\
-        ASSERT_NEAR(v.getY(), desc.m_ValuePtr[1], epsilon);\
-        ASSERT_NEAR(v.getZ(), desc.m_ValuePtr[2], epsilon);\
+        ASSERT_NEAR(v.getX(), desc.m_Variant.m_V4[0], epsilon);\
+        ASSERT_NEAR(v.getY(), desc.m_Variant.m_V4[1], epsilon);\
+        ASSERT_NEAR(v.getZ(), desc.m_Variant.m_V4[2], epsilon);\
         ASSERT_EQ(dmGameObject::PROPERTY_RESULT_OK, dmGameObject::GetProperty(go, 0, hash(prop), desc));\
 \
         ASSERT_EQ(dmGameObject::PROPERTY_RESULT_OK, dmGameObject::GetProperty(go, 0, hash(prop ".x"), desc));\
         ASSERT_EQ(dmGameObject::PROPERTY_TYPE_NUMBER, desc.m_Variant.m_Type);\
-        ASSERT_NEAR(v.getX(), desc.m_ValuePtr[0], epsilon);\
+        ASSERT_NEAR(v.getX(), desc.m_Variant.m_Number, epsilon);\
 \
         ASSERT_EQ(dmGameObject::PROPERTY_RESULT_OK, dmGameObject::GetProperty(go, 0, hash(prop ".y"), desc));\
         ASSERT_EQ(dmGameObject::PROPERTY_TYPE_NUMBER, desc.m_Variant.m_Type);\
-        ASSERT_NEAR(v.getY(), desc.m_ValuePtr[0], epsilon);\
+        ASSERT_NEAR(v.getY(), desc.m_Variant.m_Number, epsilon);\
 \
         ASSERT_EQ(dmGameObject::PROPERTY_RESULT_OK, dmGameObject::GetProperty(go, 0, hash(prop ".z"), desc));\
         ASSERT_EQ(dmGameObject::PROPERTY_TYPE_NUMBER, desc.m_Variant.m_Type);\
-        ASSERT_NEAR(v.getZ(), desc.m_ValuePtr[0], epsilon);\
+        ASSERT_NEAR(v.getZ(), desc.m_Variant.m_Number, epsilon);\
     }
 
 #define ASSERT_SET_PROP_V3(go, prop, v, epsilon)\
@@ -361,30 +361,30 @@ static dmhash_t hash(const char* s)
         ASSERT_EQ(dmGameObject::PROPERTY_RESULT_OK, dmGameObject::SetProperty(go, 0, hash(prop), var));\
         dmGameObject::PropertyDesc desc;\
         ASSERT_EQ(dmGameObject::PROPERTY_RESULT_OK, dmGameObject::GetProperty(go, 0, hash(prop), desc));\
-        ASSERT_NEAR(v.getX(), desc.m_ValuePtr[0], epsilon);\
-        ASSERT_NEAR(v.getY(), desc.m_ValuePtr[1], epsilon);\
-        ASSERT_NEAR(v.getZ(), desc.m_ValuePtr[2], epsilon);\
+        ASSERT_NEAR(v.getX(), desc.m_Variant.m_V4[0], epsilon);\
+        ASSERT_NEAR(v.getY(), desc.m_Variant.m_V4[1], epsilon);\
+        ASSERT_NEAR(v.getZ(), desc.m_Variant.m_V4[2], epsilon);\
 \
         float v0 = v.getX() + 1.0f;\
         dmhash_t id = hash(prop ".x");\
         var = dmGameObject::PropertyVar(v0);\
         ASSERT_EQ(dmGameObject::PROPERTY_RESULT_OK, dmGameObject::SetProperty(go, 0, id, var));\
         ASSERT_EQ(dmGameObject::PROPERTY_RESULT_OK, dmGameObject::GetProperty(go, 0, id, desc));\
-        ASSERT_NEAR(v0, desc.m_ValuePtr[0], epsilon);\
+        ASSERT_NEAR(v0, desc.m_Variant.m_Number, epsilon);\
 \
         v0 = v.getY() + 1.0f;\
         id = hash(prop ".y");\
         var = dmGameObject::PropertyVar(v0);\
         ASSERT_EQ(dmGameObject::PROPERTY_RESULT_OK, dmGameObject::SetProperty(go, 0, id, var));\
         ASSERT_EQ(dmGameObject::PROPERTY_RESULT_OK, dmGameObject::GetProperty(go, 0, id, desc));\
-        ASSERT_NEAR(v0, desc.m_ValuePtr[0], epsilon);\
+        ASSERT_NEAR(v0, desc.m_Variant.m_Number, epsilon);\
 \
         v0 = v.getZ() + 1.0f;\
         id = hash(prop ".z");\
         var = dmGameObject::PropertyVar(v0);\
         ASSERT_EQ(dmGameObject::PROPERTY_RESULT_OK, dmGameObject::SetProperty(go, 0, id, var));\
         ASSERT_EQ(dmGameObject::PROPERTY_RESULT_OK, dmGameObject::GetProperty(go, 0, id, desc));\
-        ASSERT_NEAR(v0, desc.m_ValuePtr[0], epsilon);\
+        ASSERT_NEAR(v0, desc.m_Variant.m_Number, epsilon);\
     }
 
 #define ASSERT_GET_PROP_V4(go, prop, v, epsilon)\
@@ -396,27 +396,27 @@ static dmhash_t hash(const char* s)
         ASSERT_EQ(hash(prop ".y"), desc.m_ElementIds[1]);\
         ASSERT_EQ(hash(prop ".z"), desc.m_ElementIds[2]);\
         ASSERT_EQ(hash(prop ".w"), desc.m_ElementIds[3]);\
-        ASSERT_NEAR(v.getX(), desc.m_ValuePtr[0], epsilon);\
-        ASSERT_NEAR(v.getY(), desc.m_ValuePtr[1], epsilon);\
-        ASSERT_NEAR(v.getZ(), desc.m_ValuePtr[2], epsilon);\
-        ASSERT_NEAR(v.getW(), desc.m_ValuePtr[3], epsilon);\
+        ASSERT_NEAR(v.getX(), desc.m_Variant.m_V4[0], epsilon);\
+        ASSERT_NEAR(v.getY(), desc.m_Variant.m_V4[1], epsilon);\
+        ASSERT_NEAR(v.getZ(), desc.m_Variant.m_V4[2], epsilon);\
+        ASSERT_NEAR(v.getW(), desc.m_Variant.m_V4[3], epsilon);\
         ASSERT_EQ(dmGameObject::PROPERTY_RESULT_OK, dmGameObject::GetProperty(go, 0, hash(prop), desc));\
 \
         ASSERT_EQ(dmGameObject::PROPERTY_RESULT_OK, dmGameObject::GetProperty(go, 0, hash(prop ".x"), desc));\
         ASSERT_EQ(dmGameObject::PROPERTY_TYPE_NUMBER, desc.m_Variant.m_Type);\
-        ASSERT_NEAR(v.getX(), desc.m_ValuePtr[0], epsilon);\
+        ASSERT_NEAR(v.getX(), desc.m_Variant.m_Number, epsilon);\
 \
         ASSERT_EQ(dmGameObject::PROPERTY_RESULT_OK, dmGameObject::GetProperty(go, 0, hash(prop ".y"), desc));\
         ASSERT_EQ(dmGameObject::PROPERTY_TYPE_NUMBER, desc.m_Variant.m_Type);\
-        ASSERT_NEAR(v.getY(), desc.m_ValuePtr[0], epsilon);\
+        ASSERT_NEAR(v.getY(), desc.m_Variant.m_Number, epsilon);\
 \
         ASSERT_EQ(dmGameObject::PROPERTY_RESULT_OK, dmGameObject::GetProperty(go, 0, hash(prop ".z"), desc));\
         ASSERT_EQ(dmGameObject::PROPERTY_TYPE_NUMBER, desc.m_Variant.m_Type);\
-        ASSERT_NEAR(v.getZ(), desc.m_ValuePtr[0], epsilon);\
+        ASSERT_NEAR(v.getZ(), desc.m_Variant.m_Number, epsilon);\
 \
         ASSERT_EQ(dmGameObject::PROPERTY_RESULT_OK, dmGameObject::GetProperty(go, 0, hash(prop ".w"), desc));\
         ASSERT_EQ(dmGameObject::PROPERTY_TYPE_NUMBER, desc.m_Variant.m_Type);\
-        ASSERT_NEAR(v.getW(), desc.m_ValuePtr[0], epsilon);\
+        ASSERT_NEAR(v.getW(), desc.m_Variant.m_Number, epsilon);\
 }
 
 #define ASSERT_SET_PROP_V4(go, prop, v, epsilon)\
@@ -425,38 +425,38 @@ static dmhash_t hash(const char* s)
         ASSERT_EQ(dmGameObject::PROPERTY_RESULT_OK, dmGameObject::SetProperty(go, 0, hash(prop), var));\
         dmGameObject::PropertyDesc desc;\
         ASSERT_EQ(dmGameObject::PROPERTY_RESULT_OK, dmGameObject::GetProperty(go, 0, hash(prop), desc));\
-        ASSERT_NEAR(v.getX(), desc.m_ValuePtr[0], epsilon);\
-        ASSERT_NEAR(v.getY(), desc.m_ValuePtr[1], epsilon);\
-        ASSERT_NEAR(v.getZ(), desc.m_ValuePtr[2], epsilon);\
-        ASSERT_NEAR(v.getW(), desc.m_ValuePtr[3], epsilon);\
+        ASSERT_NEAR(v.getX(), desc.m_Variant.m_V4[0], epsilon);\
+        ASSERT_NEAR(v.getY(), desc.m_Variant.m_V4[1], epsilon);\
+        ASSERT_NEAR(v.getZ(), desc.m_Variant.m_V4[2], epsilon);\
+        ASSERT_NEAR(v.getW(), desc.m_Variant.m_V4[3], epsilon);\
 \
         float v0 = v.getX() + 1.0f;\
         dmhash_t id = hash(prop ".x");\
         var = dmGameObject::PropertyVar(v0);\
         ASSERT_EQ(dmGameObject::PROPERTY_RESULT_OK, dmGameObject::SetProperty(go, 0, id, var));\
         ASSERT_EQ(dmGameObject::PROPERTY_RESULT_OK, dmGameObject::GetProperty(go, 0, id, desc));\
-        ASSERT_NEAR(v0, desc.m_ValuePtr[0], epsilon);\
+        ASSERT_NEAR(v0, desc.m_Variant.m_Number, epsilon);\
 \
         v0 = v.getY() + 1.0f;\
         id = hash(prop ".y");\
         var = dmGameObject::PropertyVar(v0);\
         ASSERT_EQ(dmGameObject::PROPERTY_RESULT_OK, dmGameObject::SetProperty(go, 0, id, var));\
         ASSERT_EQ(dmGameObject::PROPERTY_RESULT_OK, dmGameObject::GetProperty(go, 0, id, desc));\
-        ASSERT_NEAR(v0, desc.m_ValuePtr[0], epsilon);\
+        ASSERT_NEAR(v0, desc.m_Variant.m_Number, epsilon);\
 \
         v0 = v.getZ() + 1.0f;\
         id = hash(prop ".z");\
         var = dmGameObject::PropertyVar(v0);\
         ASSERT_EQ(dmGameObject::PROPERTY_RESULT_OK, dmGameObject::SetProperty(go, 0, id, var));\
         ASSERT_EQ(dmGameObject::PROPERTY_RESULT_OK, dmGameObject::GetProperty(go, 0, id, desc));\
-        ASSERT_NEAR(v0, desc.m_ValuePtr[0], epsilon);\
+        ASSERT_NEAR(v0, desc.m_Variant.m_Number, epsilon);\
 \
         v0 = v.getW() + 1.0f;\
         id = hash(prop ".w");\
         var = dmGameObject::PropertyVar(v0);\
         ASSERT_EQ(dmGameObject::PROPERTY_RESULT_OK, dmGameObject::SetProperty(go, 0, id, var));\
         ASSERT_EQ(dmGameObject::PROPERTY_RESULT_OK, dmGameObject::GetProperty(go, 0, id, desc));\
-        ASSERT_NEAR(v0, desc.m_ValuePtr[0], epsilon);\
+        ASSERT_NEAR(v0, desc.m_Variant.m_Number, epsilon);\
     }
 
 TEST_F(PropsTest, PropsGetSet)
@@ -563,6 +563,43 @@ TEST_F(ScriptTest, TestInstanceContext)
     dmGameObject::PostUpdate(m_Collection);
 }
 
+TEST_F(ScriptTest, TestSpatialQuery)
+{
+    lua_State* L = dmScript::GetLuaState(m_ScriptContext);
+
+    dmGameObject::SetSpatialIndexCellSize(m_Register, 10.0f);
+    dmGameObject::HCollection collection = dmGameObject::NewCollection("spatial", m_Factory, m_Register, 1024);
+
+    dmGameObject::HInstance query = dmGameObject::New(collection, "/spatial_query.goc");
+    dmGameObject::HInstance a = dmGameObject::New(collection, "/null.goc");
+    dmGameObject::HInstance b = dmGameObject::New(collection, "/null.goc");
+    ASSERT_NE((void*) 0, (void*) query);
+    ASSERT_NE((void*) 0, (void*) a);
+    ASSERT_NE((void*) 0, (void*) b);
+    ASSERT_EQ(dmGameObject::RESULT_OK, dmGameObject::SetIdentifier(collection, query, "/query"));
+    ASSERT_EQ(dmGameObject::RESULT_OK, dmGameObject::SetIdentifier(collection, a, "/a"));
+    ASSERT_EQ(dmGameObject::RESULT_OK, dmGameObject::SetIdentifier(collection, b, "/b"));
+    dmGameObject::SetPosition(query, Point3(-50, -50, 0));
+    dmGameObject::SetPosition(a, Point3(5, 5, 0));
+    dmGameObject::SetPosition(b, Point3(100, 0, 0));
+
+    ASSERT_TRUE(dmGameObject::Init(collection));
+    for (uint32_t i = 0; i < 3; ++i)
+    {
+        ASSERT_TRUE(dmGameObject::Update(collection, &m_UpdateContext));
+        ASSERT_TRUE(dmGameObject::PostUpdate(collection));
+    }
+
+    lua_getglobal(L, "spatial_query_done");
+    ASSERT_TRUE(lua_toboolean(L, -1));
+    lua_pop(L, 1);
+
+    ASSERT_TRUE(dmGameObject::Final(collection));
+    dmGameObject::DeleteCollection(collection);
+    dmGameObject::PostUpdate(m_Register);
+    dmGameObject::SetSpatialIndexCellSize(m_Register, 0.0f);
+}
+
 int main(int argc, char **argv)
 {
     dmDDF::RegisterAllTypes();
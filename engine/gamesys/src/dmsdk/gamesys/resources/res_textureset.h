@@ -31,6 +31,7 @@ namespace dmGameSystem
             m_Texture = 0;
             m_TextureSet = 0;
             m_HullSet = 0;
+            m_Version = 0;
         }
 
         dmArray<dmhash_t>                   m_HullCollisionGroups;
@@ -39,6 +40,8 @@ namespace dmGameSystem
         dmhash_t                            m_TexturePath;
         dmGameSystemDDF::TextureSet*        m_TextureSet;
         dmPhysics::HHullSet2D               m_HullSet;
+        /// Unique for each load and reload of any texture set
+        uint32_t                            m_Version;
     };
 }
 
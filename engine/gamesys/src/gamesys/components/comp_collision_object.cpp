@@ -12,11 +12,13 @@
 
 #include "comp_collision_object.h"
 
+#include <dlib/buffer.h>
 #include <dlib/dlib.h>
 #include <dlib/dstrings.h>
 #include <dlib/hash.h>
 #include <dlib/log.h>
 #include <dlib/math.h>
+#include <dlib/profile.h>
 
 #include <physics/physics.h>
 
@@ -29,6 +31,7 @@
 
 #include <gamesys/physics_ddf.h>
 #include <gamesys/gamesys_ddf.h>
+#include <dmsdk/gamesys/script.h>
 
 namespace dmGameSystem
 {
@@ -46,6 +49,40 @@ namespace dmGameSystem
     static const dmhash_t PROP_MASS = dmHashString64("mass");
     static const dmhash_t PROP_BULLET = dmHashString64("bullet");
 
+    // The streams of the events buffer passed to the listener, see physics.set_listener
+    enum CollisionEventStream
+    {
+        EVENT_STREAM_TYPE,
+        EVENT_STREAM_ID,
+        EVENT_STREAM_GROUP,
+        EVENT_STREAM_POSITION_A,
+        EVENT_STREAM_POSITION_B,
+        EVENT_STREAM_NORMAL,
+        EVENT_STREAM_RELATIVE_VELOCITY,
+        EVENT_STREAM_DISTANCE,
+        EVENT_STREAM_APPLIED_IMPULSE,
+        EVENT_STREAM_MASS,
+        EVENT_STREAM_ENTER,
+        MAX_EVENT_STREAM_COUNT
+    };
+
+    static const dmBuffer::StreamDeclaration EVENT_STREAMS[MAX_EVENT_STREAM_COUNT] =
+    {
+        {dmHashString64("type"), dmBuffer::VALUE_TYPE_UINT8, 1},
+        // Index of the ids of a and b in the ids table
+        {dmHashString64("id"), dmBuffer::VALUE_TYPE_UINT32, 2},
+        // Index of the groups of a and b in the ids table
+        {dmHashString64("group"), dmBuffer::VALUE_TYPE_UINT32, 2},
+        {dmHashString64("position_a"), dmBuffer::VALUE_TYPE_FLOAT32, 3},
+        {dmHashString64("position_b"), dmBuffer::VALUE_TYPE_FLOAT32, 3},
+        {dmHashString64("normal"), dmBuffer::VALUE_TYPE_FLOAT32, 3},
+        {dmHashString64("relative_velocity"), dmBuffer::VALUE_TYPE_FLOAT32, 3},
+        {dmHashString64("distance"), dmBuffer::VALUE_TYPE_FLOAT32, 1},
+        {dmHashString64("applied_impulse"), dmBuffer::VALUE_TYPE_FLOAT32, 1},
+        {dmHashString64("mass"), dmBuffer::VALUE_TYPE_FLOAT32, 2},
+        {dmHashString64("enter"), dmBuffer::VALUE_TYPE_UINT8, 1},
+    };
+
 
     struct CollisionComponent;
     struct JointEndPoint;
@@ -106,6 +143,61 @@ namespace dmGameSystem
         uint8_t m_StartAsEnabled : 1;
         uint8_t m_FlippedX : 1; // set if it's been flipped
         uint8_t m_FlippedY : 1;
+        // Set when a parallel step has produced a new transform, see DeferSetWorldTransform
+        uint8_t m_StepTransformSet : 1;
+        // Set when m_LastWorldMatrix holds the world matrix of the last step, see GetWorldTransforms
+        uint8_t m_LastWorldMatrixSet : 1;
+
+        Vectormath::Aos::Point3 m_StepPosition;
+        Vectormath::Aos::Quat m_StepRotation;
+        Vectormath::Aos::Matrix4 m_LastWorldMatrix;
+    };
+
+    // The events of a step, with one array per stream laid out as in EVENT_STREAMS
+    struct CollisionEvents
+    {
+        dmArray<uint8_t>        m_Streams[MAX_EVENT_STREAM_COUNT];
+        // The instance ids and group hashes referred to by the "id" and "group" streams, and their (1-based) indices
+        dmArray<dmhash_t>       m_Hashes;
+        dmHashTable64<uint32_t> m_HashIndices;
+        uint32_t                m_Count;
+    };
+
+    struct DeferredCollision
+    {
+        void* m_UserDataA;
+        void* m_UserDataB;
+        uint16_t m_GroupA;
+        uint16_t m_GroupB;
+    };
+
+    struct DeferredTrigger
+    {
+        void* m_UserDataA;
+        void* m_UserDataB;
+        uint16_t m_GroupA;
+        uint16_t m_GroupB;
+        uint8_t m_Enter;
+    };
+
+    struct DeferredRayCast
+    {
+        dmPhysics::RayCastResponse m_Response;
+        dmPhysics::RayCastRequest m_Request;
+    };
+
+    // The callbacks of a step on a worker thread, replayed on the main thread once all worlds are stepped, see StepPhysicsWorlds
+    struct DeferredStep
+    {
+        dmArray<DeferredCollision>          m_Collisions;
+        dmArray<dmPhysics::ContactPoint>    m_ContactPoints;
+        dmArray<DeferredTrigger>            m_Triggers;
+        dmArray<DeferredRayCast>            m_RayCasts;
+        dmGameObject::HCollection           m_Collection;
+        float                               m_DT;
+        uint8_t                             m_Pending : 1;
+        // Set once the world has been stepped by StepPhysicsWorlds, until the callbacks have been replayed
+        uint8_t                             m_Stepped : 1;
     };
 
     struct CollisionWorld
@@ -120,6 +212,16 @@ namespace dmGameSystem
         uint8_t m_ComponentIndex;
         uint8_t m_3D : 1;
         dmArray<CollisionComponent*> m_Components;
+        // When set, the collision, contact point and trigger events of a step are collected and passed to the listener, instead of posted as messages
+        dmScript::LuaCallbackInfo* m_EventListener;
+        // A listener set by the listener itself, which replaces it once the events have been dispatched, see SetCollisionEventListener
+        dmScript::LuaCallbackInfo* m_PendingEventListener;
+        CollisionEvents m_Events;
+        // The buffer passed to the listener, resized to the number of events of each dispatch
+        dmBuffer::HBuffer m_EventBuffer;
+        DeferredStep m_DeferredStep;
+        uint8_t m_DispatchingEvents : 1;
+        uint8_t m_EventListenerPending : 1;
     };
 
     // Forward declarations
@@ -135,6 +237,31 @@ namespace dmGameSystem
         world_transform = dmGameObject::GetWorldTransform(instance);
     }
 
+    // Only the game objects that have moved since the last step are reported as changed, by comparing their world matrices.
+    // This is cheaper than extracting the transforms from the matrices
+    static void GetWorldTransforms(void* const* user_data, dmTransform::Transform* world_transforms, uint8_t* changed, uint32_t count)
+    {
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            CollisionComponent* component = (CollisionComponent*)user_data[i];
+            if (!component)
+            {
+                changed[i] = 0;
+                continue;
+            }
+            const Vectormath::Aos::Matrix4& world_matrix = dmGameObject::GetWorldMatrix(component->m_Instance);
+            if (component->m_LastWorldMatrixSet && memcmp(&component->m_LastWorldMatrix, &world_matrix, sizeof(world_matrix)) == 0)
+            {
+                changed[i] = 0;
+                continue;
+            }
+            component->m_LastWorldMatrix = world_matrix;
+            component->m_LastWorldMatrixSet = 1;
+            world_transforms[i] = dmTransform::ToTransform(world_matrix);
+            changed[i] = 1;
+        }
+    }
+
     // TODO: Allow the SetWorldTransform to have a physics context which we can check instead!!
     static int g_NumPhysicsTransformsUpdated = 0;
 
@@ -157,15 +284,47 @@ namespace dmGameSystem
             dmGameObject::SetPosition(instance, p);
         }
         dmGameObject::SetRotation(instance, rotation);
+        // The object is moved by the physics, so its world matrix can no longer tell whether the game has moved it since the step.
+        // E.g. an object set back to where it was before the step must still move its (dynamic) body back there
+        component->m_LastWorldMatrixSet = 0;
         ++g_NumPhysicsTransformsUpdated;
     }
 
+    // Used instead of SetWorldTransform when the worlds are stepped in parallel, since the game objects must not be modified from the workers
+    static void DeferSetWorldTransform(void* user_data, const Vectormath::Aos::Point3& position, const Vectormath::Aos::Quat& rotation)
+    {
+        if (!user_data)
+            return;
+        CollisionComponent* component = (CollisionComponent*)user_data;
+        component->m_StepPosition = position;
+        component->m_StepRotation = rotation;
+        component->m_StepTransformSet = 1;
+    }
+
+    static void SetWorldTransforms(void* const* user_data, const Vectormath::Aos::Point3* positions, const Vectormath::Aos::Quat* rotations, uint32_t count)
+    {
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            SetWorldTransform(user_data[i], positions[i], rotations[i]);
+        }
+    }
+
+    static void DeferSetWorldTransforms(void* const* user_data, const Vectormath::Aos::Point3* positions, const Vectormath::Aos::Quat* rotations, uint32_t count)
+    {
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            DeferSetWorldTransform(user_data[i], positions[i], rotations[i]);
+        }
+    }
+
     dmGameObject::CreateResult CompCollisionObjectNewWorld(const dmGameObject::ComponentNewWorldParams& params)
     {
         PhysicsContext* physics_context = (PhysicsContext*)params.m_Context;
         dmPhysics::NewWorldParams world_params;
         world_params.m_GetWorldTransformCallback = GetWorldTransform;
-        world_params.m_SetWorldTransformCallback = SetWorldTransform;
+        world_params.m_SetWorldTransformCallback = physics_context->m_ParallelStep ? DeferSetWorldTransform : SetWorldTransform;
+        world_params.m_GetWorldTransformsCallback = GetWorldTransforms;
+        world_params.m_SetWorldTransformsCallback = physics_context->m_ParallelStep ? DeferSetWorldTransforms : SetWorldTransforms;
 
         dmPhysics::HWorld2D world2D;
         dmPhysics::HWorld3D world3D;
@@ -217,6 +376,30 @@ namespace dmGameSystem
             dmPhysics::DeleteWorld3D(physics_context->m_Context3D, world->m_World3D);
         else
             dmPhysics::DeleteWorld2D(physics_context->m_Context2D, world->m_World2D);
+        if (world->m_EventListener)
+        {
+            dmScript::DestroyCallback(world->m_EventListener);
+        }
+        if (world->m_PendingEventListener)
+        {
+            dmScript::DestroyCallback(world->m_PendingEventListener);
+        }
+        if (world->m_EventBuffer)
+        {
+            dmBuffer::Destroy(world->m_EventBuffer);
+        }
+        if (world->m_DeferredStep.m_Pending)
+        {
+            dmArray<void*>& step_worlds = physics_context->m_StepWorlds;
+            for (uint32_t i = 0; i < step_worlds.Size(); ++i)
+            {
+                if (step_worlds[i] == world)
+                {
+                    step_worlds.EraseSwap(i);
+                    break;
+                }
+            }
+        }
         delete world;
         return dmGameObject::CREATE_RESULT_OK;
     }
@@ -423,6 +606,8 @@ namespace dmGameSystem
         component->m_JointEndPoints = 0x0;
         component->m_FlippedX = 0;
         component->m_FlippedY = 0;
+        component->m_StepTransformSet = 0;
+        component->m_LastWorldMatrixSet = 0;
 
         CollisionWorld* world = (CollisionWorld*)params.m_World;
         if (!CreateCollisionObject(physics_context, world, params.m_Instance, component, false))
@@ -509,6 +694,171 @@ namespace dmGameSystem
         return dmGameObject::CREATE_RESULT_OK;
     }
 
+    static inline uint32_t GetEventValueSize(uint32_t stream)
+    {
+        return dmBuffer::GetSizeForValueType(EVENT_STREAMS[stream].m_Type) * EVENT_STREAMS[stream].m_Count;
+    }
+
+    template <typename T>
+    static inline T* GetEventValues(CollisionEvents* events, CollisionEventStream stream, uint32_t index)
+    {
+        return (T*)&events->m_Streams[stream][index * GetEventValueSize(stream)];
+    }
+
+    // Adds an event with all values zeroed
+    static uint32_t AddEvent(CollisionEvents* events, CollisionEventType type)
+    {
+        uint32_t index = events->m_Count++;
+        for (uint32_t i = 0; i < MAX_EVENT_STREAM_COUNT; ++i)
+        {
+            dmArray<uint8_t>& stream = events->m_Streams[i];
+            uint32_t size = GetEventValueSize(i);
+            if (stream.Remaining() < size)
+            {
+                stream.OffsetCapacity(dmMath::Max(size * 64, stream.Capacity()));
+            }
+            uint32_t offset = stream.Size();
+            stream.SetSize(offset + size);
+            memset(&stream[offset], 0, size);
+        }
+        *GetEventValues<uint8_t>(events, EVENT_STREAM_TYPE, index) = (uint8_t)type;
+        return index;
+    }
+
+    static uint32_t GetEventHashIndex(CollisionEvents* events, dmhash_t hash)
+    {
+        uint32_t* index = events->m_HashIndices.Get(hash);
+        if (index)
+        {
+            return *index;
+        }
+        if (events->m_HashIndices.Full())
+        {
+            uint32_t capacity = events->m_HashIndices.Capacity() + 64;
+            events->m_HashIndices.SetCapacity(capacity/3, capacity);
+        }
+        if (events->m_Hashes.Full())
+        {
+            events->m_Hashes.OffsetCapacity(64);
+        }
+        events->m_Hashes.Push(hash);
+        uint32_t new_index = events->m_Hashes.Size();
+        events->m_HashIndices.Put(hash, new_index);
+        return new_index;
+    }
+
+    static void SetEventPair(CollisionEvents* events, uint32_t index, dmhash_t id_a, uint64_t group_a, dmhash_t id_b, uint64_t group_b)
+    {
+        uint32_t* ids = GetEventValues<uint32_t>(events, EVENT_STREAM_ID, index);
+        ids[0] = GetEventHashIndex(events, id_a);
+        ids[1] = GetEventHashIndex(events, id_b);
+        uint32_t* groups = GetEventValues<uint32_t>(events, EVENT_STREAM_GROUP, index);
+        groups[0] = GetEventHashIndex(events, group_a);
+        groups[1] = GetEventHashIndex(events, group_b);
+    }
+
+    static void SetEventVector(CollisionEvents* events, CollisionEventStream stream, uint32_t index, const Vector3& v)
+    {
+        float* values = GetEventValues<float>(events, stream, index);
+        values[0] = v.getX();
+        values[1] = v.getY();
+        values[2] = v.getZ();
+    }
+
+    static void ClearEvents(CollisionEvents* events)
+    {
+        for (uint32_t i = 0; i < MAX_EVENT_STREAM_COUNT; ++i)
+        {
+            events->m_Streams[i].SetSize(0);
+        }
+        events->m_Hashes.SetSize(0);
+        events->m_HashIndices.Clear();
+        events->m_Count = 0;
+    }
+
+    // Passes the events collected since the last dispatch to the listener, as a buffer with one element per event and a table of the hashes it refers to
+    static void DispatchEvents(CollisionWorld* world)
+    {
+        DM_PROFILE(Physics, "DispatchEvents");
+
+        CollisionEvents* events = &world->m_Events;
+        dmScript::LuaCallbackInfo* listener = world->m_EventListener;
+
+        dmBuffer::Result r;
+        if (world->m_EventBuffer)
+        {
+            r = dmBuffer::Resize(world->m_EventBuffer, events->m_Count);
+        }
+        else
+        {
+            r = dmBuffer::Create(events->m_Count, EVENT_STREAMS, MAX_EVENT_STREAM_COUNT, &world->m_EventBuffer);
+        }
+        if (r != dmBuffer::RESULT_OK)
+        {
+            dmLogError("Could not create the physics events buffer: %d", r);
+            ClearEvents(events);
+            return;
+        }
+        dmBuffer::HBuffer buffer = world->m_EventBuffer;
+
+        for (uint32_t i = 0; i < MAX_EVENT_STREAM_COUNT; ++i)
+        {
+            uint8_t* stream = 0x0;
+            uint32_t count = 0;
+            uint32_t components = 0;
+            uint32_t stride = 0;
+            dmBuffer::GetStream(buffer, EVENT_STREAMS[i].m_Name, (void**)&stream, &count, &components, &stride);
+
+            // The stride is in values, and the buffer streams are interleaved
+            uint32_t value_size = dmBuffer::GetSizeForValueType(EVENT_STREAMS[i].m_Type);
+            uint32_t size = value_size * components;
+            const uint8_t* src = events->m_Streams[i].Begin();
+            for (uint32_t e = 0; e < count; ++e)
+            {
+                memcpy(stream, src, size);
+                stream += stride * value_size;
+                src += size;
+            }
+        }
+
+        lua_State* L = dmScript::GetCallbackLuaContext(listener);
+        DM_LUA_STACK_CHECK(L, 0);
+
+        if (dmScript::SetupCallback(listener))
+        {
+            // The buffer is reused for the next dispatch
+            dmScript::LuaHBuffer luabuf = {{buffer}, {dmScript::OWNER_C}};
+            dmScript::PushBuffer(L, luabuf);
+
+            uint32_t hash_count = events->m_Hashes.Size();
+            lua_createtable(L, hash_count, 0);
+            for (uint32_t i = 0; i < hash_count; ++i)
+            {
+                dmScript::PushHash(L, events->m_Hashes[i]);
+                lua_rawseti(L, -2, i + 1);
+            }
+
+            world->m_DispatchingEvents = 1;
+            dmScript::PCall(L, 3, 0); // instance + 2
+            world->m_DispatchingEvents = 0;
+            dmScript::TeardownCallback(listener);
+        }
+        else
+        {
+            // The script instance of the listener is gone
+            dmLogWarning("The physics listener could not be called, collision messages will be posted instead.");
+            dmScript::DestroyCallback(listener);
+            world->m_EventListener = 0x0;
+        }
+
+        ClearEvents(events);
+
+        if (world->m_EventListenerPending)
+        {
+            SetCollisionEventListener(world, world->m_PendingEventListener);
+        }
+    }
+
     struct CollisionUserData
     {
         CollisionWorld* m_World;
@@ -556,11 +906,21 @@ namespace dmGameSystem
             dmhash_t instance_a_id = dmGameObject::GetIdentifier(instance_a);
             dmhash_t instance_b_id = dmGameObject::GetIdentifier(instance_b);
 
-            dmPhysicsDDF::CollisionResponse ddf;
-
             uint64_t group_hash_a = GetLSBGroupHash(cud->m_World, group_a);
             uint64_t group_hash_b = GetLSBGroupHash(cud->m_World, group_b);
 
+            if (cud->m_World->m_EventListener)
+            {
+                CollisionEvents* events = &cud->m_World->m_Events;
+                uint32_t index = AddEvent(events, COLLISION_EVENT_TYPE_COLLISION);
+                SetEventPair(events, index, instance_a_id, group_hash_a, instance_b_id, group_hash_b);
+                SetEventVector(events, EVENT_STREAM_POSITION_A, index, Vector3(dmGameObject::GetWorldPosition(instance_a)));
+                SetEventVector(events, EVENT_STREAM_POSITION_B, index, Vector3(dmGameObject::GetWorldPosition(instance_b)));
+                return true;
+            }
+
+            dmPhysicsDDF::CollisionResponse ddf;
+
             // Broadcast to A components
             ddf.m_OwnGroup = group_hash_a;
             ddf.m_OtherGroup = group_hash_b;
@@ -599,13 +959,31 @@ namespace dmGameSystem
             dmhash_t instance_a_id = dmGameObject::GetIdentifier(instance_a);
             dmhash_t instance_b_id = dmGameObject::GetIdentifier(instance_b);
 
-            dmPhysicsDDF::ContactPointResponse ddf;
             float mass_a = dmMath::Select(-contact_point.m_MassA, 0.0f, contact_point.m_MassA);
             float mass_b = dmMath::Select(-contact_point.m_MassB, 0.0f, contact_point.m_MassB);
 
             uint64_t group_hash_a = GetLSBGroupHash(cud->m_World, contact_point.m_GroupA);
             uint64_t group_hash_b = GetLSBGroupHash(cud->m_World, contact_point.m_GroupB);
 
+            if (cud->m_World->m_EventListener)
+            {
+                CollisionEvents* events = &cud->m_World->m_Events;
+                uint32_t index = AddEvent(events, COLLISION_EVENT_TYPE_CONTACT_POINT);
+                SetEventPair(events, index, instance_a_id, group_hash_a, instance_b_id, group_hash_b);
+                SetEventVector(events, EVENT_STREAM_POSITION_A, index, Vector3(contact_point.m_PositionA));
+                SetEventVector(events, EVENT_STREAM_POSITION_B, index, Vector3(contact_point.m_PositionB));
+                SetEventVector(events, EVENT_STREAM_NORMAL, index, contact_point.m_Normal);
+                SetEventVector(events, EVENT_STREAM_RELATIVE_VELOCITY, index, contact_point.m_RelativeVelocity);
+                *GetEventValues<float>(events, EVENT_STREAM_DISTANCE, index) = contact_point.m_Distance;
+                *GetEventValues<float>(events, EVENT_STREAM_APPLIED_IMPULSE, index) = contact_point.m_AppliedImpulse;
+                float* masses = GetEventValues<float>(events, EVENT_STREAM_MASS, index);
+                masses[0] = mass_a;
+                masses[1] = mass_b;
+                return true;
+            }
+
+            dmPhysicsDDF::ContactPointResponse ddf;
+
             // Broadcast to A components
             ddf.m_Position = contact_point.m_PositionA;
             ddf.m_Normal = -contact_point.m_Normal;
@@ -659,12 +1037,21 @@ namespace dmGameSystem
         dmhash_t instance_a_id = dmGameObject::GetIdentifier(instance_a);
         dmhash_t instance_b_id = dmGameObject::GetIdentifier(instance_b);
 
-        dmPhysicsDDF::TriggerResponse ddf;
-        ddf.m_Enter = 1;
-
         uint64_t group_hash_a = GetLSBGroupHash(world, trigger_enter.m_GroupA);
         uint64_t group_hash_b = GetLSBGroupHash(world, trigger_enter.m_GroupB);
 
+        if (world->m_EventListener)
+        {
+            CollisionEvents* events = &world->m_Events;
+            uint32_t index = AddEvent(events, COLLISION_EVENT_TYPE_TRIGGER);
+            SetEventPair(events, index, instance_a_id, group_hash_a, instance_b_id, group_hash_b);
+            *GetEventValues<uint8_t>(events, EVENT_STREAM_ENTER, index) = 1;
+            return;
+        }
+
+        dmPhysicsDDF::TriggerResponse ddf;
+        ddf.m_Enter = 1;
+
         // Broadcast to A components
         ddf.m_OtherId = instance_b_id;
         ddf.m_Group = group_hash_b;
@@ -690,12 +1077,21 @@ namespace dmGameSystem
         dmhash_t instance_a_id = dmGameObject::GetIdentifier(instance_a);
         dmhash_t instance_b_id = dmGameObject::GetIdentifier(instance_b);
 
-        dmPhysicsDDF::TriggerResponse ddf;
-        ddf.m_Enter = 0;
-
         uint64_t group_hash_a = GetLSBGroupHash(world, trigger_exit.m_GroupA);
         uint64_t group_hash_b = GetLSBGroupHash(world, trigger_exit.m_GroupB);
 
+        if (world->m_EventListener)
+        {
+            CollisionEvents* events = &world->m_Events;
+            uint32_t index = AddEvent(events, COLLISION_EVENT_TYPE_TRIGGER);
+            SetEventPair(events, index, instance_a_id, group_hash_a, instance_b_id, group_hash_b);
+            *GetEventValues<uint8_t>(events, EVENT_STREAM_ENTER, index) = 0;
+            return;
+        }
+
+        dmPhysicsDDF::TriggerResponse ddf;
+        ddf.m_Enter = 0;
+
         // Broadcast to A components
         ddf.m_OtherId = instance_b_id;
         ddf.m_Group = group_hash_b;
@@ -770,6 +1166,314 @@ namespace dmGameSystem
         }
     }
 
+    static void CheckOverflow(PhysicsContext* physics_context, uint32_t collision_count, uint32_t contact_count)
+    {
+        if (collision_count >= physics_context->m_MaxCollisionCount)
+        {
+            if (!g_CollisionOverflowWarning)
+            {
+                dmLogWarning("Maximum number of collisions (%d) reached, messages have been lost. Tweak \"%s\" in the config file.", physics_context->m_MaxCollisionCount, PHYSICS_MAX_COLLISIONS_KEY);
+                g_CollisionOverflowWarning = true;
+            }
+        }
+        else
+        {
+            g_CollisionOverflowWarning = false;
+        }
+        if (contact_count >= physics_context->m_MaxContactPointCount)
+        {
+            if (!g_ContactOverflowWarning)
+            {
+                dmLogWarning("Maximum number of contacts (%d) reached, messages have been lost. Tweak \"%s\" in the config file.", physics_context->m_MaxContactPointCount, PHYSICS_MAX_CONTACTS_KEY);
+                g_ContactOverflowWarning = true;
+            }
+        }
+        else
+        {
+            g_ContactOverflowWarning = false;
+        }
+    }
+
+    // The Defer*Callback functions are called from the workers when the worlds are stepped in parallel.
+    // They only record the callbacks, which are then replayed on the main thread by CompleteDeferredStep.
+
+    static bool DeferCollisionCallback(void* user_data_a, uint16_t group_a, void* user_data_b, uint16_t group_b, void* user_data)
+    {
+        CollisionUserData* cud = (CollisionUserData*)user_data;
+        if (cud->m_Count >= cud->m_Context->m_MaxCollisionCount)
+            return false;
+        cud->m_Count += 1;
+
+        dmArray<DeferredCollision>& collisions = cud->m_World->m_DeferredStep.m_Collisions;
+        if (collisions.Full())
+            collisions.OffsetCapacity(32);
+        DeferredCollision collision;
+        collision.m_UserDataA = user_data_a;
+        collision.m_UserDataB = user_data_b;
+        collision.m_GroupA = group_a;
+        collision.m_GroupB = group_b;
+        collisions.Push(collision);
+        return true;
+    }
+
+    static bool DeferContactPointCallback(const dmPhysics::ContactPoint& contact_point, void* user_data)
+    {
+        CollisionUserData* cud = (CollisionUserData*)user_data;
+        if (cud->m_Count >= cud->m_Context->m_MaxContactPointCount)
+            return false;
+        cud->m_Count += 1;
+
+        dmArray<dmPhysics::ContactPoint>& contact_points = cud->m_World->m_DeferredStep.m_ContactPoints;
+        if (contact_points.Full())
+            contact_points.OffsetCapacity(32);
+        contact_points.Push(contact_point);
+        return true;
+    }
+
+    static void DeferTrigger(CollisionWorld* world, void* user_data_a, uint16_t group_a, void* user_data_b, uint16_t group_b, uint8_t enter)
+    {
+        dmArray<DeferredTrigger>& triggers = world->m_DeferredStep.m_Triggers;
+        if (triggers.Full())
+            triggers.OffsetCapacity(32);
+        DeferredTrigger trigger;
+        trigger.m_UserDataA = user_data_a;
+        trigger.m_UserDataB = user_data_b;
+        trigger.m_GroupA = group_a;
+        trigger.m_GroupB = group_b;
+        trigger.m_Enter = enter;
+        triggers.Push(trigger);
+    }
+
+    static void DeferTriggerEnteredCallback(const dmPhysics::TriggerEnter& trigger_enter, void* user_data)
+    {
+        DeferTrigger((CollisionWorld*)user_data, trigger_enter.m_UserDataA, trigger_enter.m_GroupA, trigger_enter.m_UserDataB, trigger_enter.m_GroupB, 1);
+    }
+
+    static void DeferTriggerExitedCallback(const dmPhysics::TriggerExit& trigger_exit, void* user_data)
+    {
+        DeferTrigger((CollisionWorld*)user_data, trigger_exit.m_UserDataA, trigger_exit.m_GroupA, trigger_exit.m_UserDataB, trigger_exit.m_GroupB, 0);
+    }
+
+    static void DeferRayCastCallback(const dmPhysics::RayCastResponse& response, const dmPhysics::RayCastRequest& request, void* user_data)
+    {
+        dmArray<DeferredRayCast>& ray_casts = ((CollisionWorld*)user_data)->m_DeferredStep.m_RayCasts;
+        if (ray_casts.Full())
+            ray_casts.OffsetCapacity(16);
+        DeferredRayCast ray_cast;
+        ray_cast.m_Response = response;
+        ray_cast.m_Request = request;
+        ray_casts.Push(ray_cast);
+    }
+
+    // Runs on a worker, and must only read the game objects
+    static void StepDeferred(PhysicsContext* physics_context, CollisionWorld* world)
+    {
+        CollisionUserData collision_user_data;
+        collision_user_data.m_World = world;
+        collision_user_data.m_Context = physics_context;
+        collision_user_data.m_Count = 0;
+        CollisionUserData contact_user_data;
+        contact_user_data.m_World = world;
+        contact_user_data.m_Context = physics_context;
+        contact_user_data.m_Count = 0;
+
+        dmPhysics::StepWorldContext step_world_context;
+        step_world_context.m_DT = world->m_DeferredStep.m_DT;
+        step_world_context.m_CollisionCallback = DeferCollisionCallback;
+        step_world_context.m_CollisionUserData = &collision_user_data;
+        step_world_context.m_ContactPointCallback = DeferContactPointCallback;
+        step_world_context.m_ContactPointUserData = &contact_user_data;
+        step_world_context.m_TriggerEnteredCallback = DeferTriggerEnteredCallback;
+        step_world_context.m_TriggerEnteredUserData = world;
+        step_world_context.m_TriggerExitedCallback = DeferTriggerExitedCallback;
+        step_world_context.m_TriggerExitedUserData = world;
+        step_world_context.m_RayCastCallback = DeferRayCastCallback;
+        step_world_context.m_RayCastUserData = world;
+
+        if (physics_context->m_3D)
+        {
+            dmPhysics::StepWorld3D(world->m_World3D, step_world_context);
+        }
+        else
+        {
+            dmPhysics::StepWorld2D(world->m_World2D, step_world_context);
+        }
+    }
+
+    static void StepDeferredRange(void* context, uint32_t begin, uint32_t end)
+    {
+        PhysicsContext* physics_context = (PhysicsContext*)context;
+        for (uint32_t i = begin; i < end; ++i)
+        {
+            StepDeferred(physics_context, (CollisionWorld*)physics_context->m_StepWorlds[i]);
+        }
+    }
+
+    // Replays the recorded callbacks of the step, and writes the new transforms to the game objects
+    static void CompleteDeferredStep(PhysicsContext* physics_context, CollisionWorld* world)
+    {
+        DM_PROFILE(Physics, "CompleteStep");
+
+        DeferredStep* step = &world->m_DeferredStep;
+
+        uint32_t ray_cast_count = step->m_RayCasts.Size();
+        for (uint32_t i = 0; i < ray_cast_count; ++i)
+        {
+            RayCastCallback(step->m_RayCasts[i].m_Response, step->m_RayCasts[i].m_Request, world);
+        }
+
+        CollisionUserData collision_user_data;
+        collision_user_data.m_World = world;
+        collision_user_data.m_Context = physics_context;
+        collision_user_data.m_Count = 0;
+        uint32_t collision_count = step->m_Collisions.Size();
+        for (uint32_t i = 0; i < collision_count; ++i)
+        {
+            const DeferredCollision& c = step->m_Collisions[i];
+            CollisionCallback(c.m_UserDataA, c.m_GroupA, c.m_UserDataB, c.m_GroupB, &collision_user_data);
+        }
+
+        CollisionUserData contact_user_data;
+        contact_user_data.m_World = world;
+        contact_user_data.m_Context = physics_context;
+        contact_user_data.m_Count = 0;
+        uint32_t contact_point_count = step->m_ContactPoints.Size();
+        for (uint32_t i = 0; i < contact_point_count; ++i)
+        {
+            ContactPointCallback(step->m_ContactPoints[i], &contact_user_data);
+        }
+
+        uint32_t trigger_count = step->m_Triggers.Size();
+        for (uint32_t i = 0; i < trigger_count; ++i)
+        {
+            const DeferredTrigger& t = step->m_Triggers[i];
+            if (t.m_Enter)
+            {
+                dmPhysics::TriggerEnter trigger_enter;
+                trigger_enter.m_UserDataA = t.m_UserDataA;
+                trigger_enter.m_UserDataB = t.m_UserDataB;
+                trigger_enter.m_GroupA = t.m_GroupA;
+                trigger_enter.m_GroupB = t.m_GroupB;
+                TriggerEnteredCallback(trigger_enter, world);
+            }
+            else
+            {
+                dmPhysics::TriggerExit trigger_exit;
+                trigger_exit.m_UserDataA = t.m_UserDataA;
+                trigger_exit.m_UserDataB = t.m_UserDataB;
+                trigger_exit.m_GroupA = t.m_GroupA;
+                trigger_exit.m_GroupB = t.m_GroupB;
+                TriggerExitedCallback(trigger_exit, world);
+            }
+        }
+
+        CheckOverflow(physics_context, collision_user_data.m_Count, contact_user_data.m_Count);
+
+        step->m_RayCasts.SetSize(0);
+        step->m_Collisions.SetSize(0);
+        step->m_ContactPoints.SetSize(0);
+        step->m_Triggers.SetSize(0);
+
+        // The events are reported with the world positions from before the step, as when stepping in the update
+        bool transforms_updated = false;
+        uint32_t component_count = world->m_Components.Size();
+        for (uint32_t i = 0; i < component_count; ++i)
+        {
+            CollisionComponent* component = world->m_Components[i];
+            if (component->m_StepTransformSet)
+            {
+                SetWorldTransform(component, component->m_StepPosition, component->m_StepRotation);
+                component->m_StepTransformSet = 0;
+                transforms_updated = true;
+            }
+        }
+        if (transforms_updated)
+        {
+            dmGameObject::UpdateTransforms(step->m_Collection);
+        }
+    }
+
+    static void RemoveStepWorld(PhysicsContext* physics_context, CollisionWorld* world)
+    {
+        // The order is kept, so that the events of the worlds are applied in the order the collections were updated
+        dmArray<void*>& step_worlds = physics_context->m_StepWorlds;
+        uint32_t world_count = step_worlds.Size();
+        for (uint32_t i = 0; i < world_count; ++i)
+        {
+            if (step_worlds[i] == world)
+            {
+                for (uint32_t j = i + 1; j < world_count; ++j)
+                {
+                    step_worlds[j - 1] = step_worlds[j];
+                }
+                step_worlds.SetSize(world_count - 1);
+                return;
+            }
+        }
+    }
+
+    // Completes the pending step of a world that is updated again before StepPhysicsWorlds, e.g. by a collection proxy
+    // with a fixed time step. Only this world is stepped, since the collections of the other worlds might be in the middle
+    // of their update.
+    static void CompletePendingStep(PhysicsContext* physics_context, CollisionWorld* world)
+    {
+        DeferredStep* step = &world->m_DeferredStep;
+        // While StepPhysicsWorlds completes the steps, the world might have been stepped, and only the callbacks are left
+        if (!step->m_Stepped)
+        {
+            RemoveStepWorld(physics_context, world);
+            StepDeferred(physics_context, world);
+        }
+        step->m_Pending = 0;
+        step->m_Stepped = 0;
+        CompleteDeferredStep(physics_context, world);
+    }
+
+    void StepPhysicsWorlds(PhysicsContext* physics_context)
+    {
+        // The worlds updated while the steps are completed are stepped by the next call
+        if (physics_context->m_SteppingWorlds)
+            return;
+
+        dmArray<void*>& step_worlds = physics_context->m_StepWorlds;
+        uint32_t world_count = step_worlds.Size();
+        if (world_count == 0)
+            return;
+
+        DM_PROFILE(Physics, "StepWorlds");
+
+        physics_context->m_SteppingWorlds = true;
+
+        // The debug drawing is done during the step, and is not thread safe
+        dmJobPool::HJobPool job_pool = physics_context->m_Debug ? 0x0 : physics_context->m_JobPool;
+        dmJobPool::ParallelFor(job_pool, world_count, 1, StepDeferredRange, physics_context);
+        for (uint32_t i = 0; i < world_count; ++i)
+        {
+            ((CollisionWorld*)step_worlds[i])->m_DeferredStep.m_Stepped = 1;
+        }
+
+        for (uint32_t i = 0; i < world_count; ++i)
+        {
+            CollisionWorld* world = (CollisionWorld*)step_worlds[i];
+            // Already completed, if the callbacks of an earlier world lead to an update of its collection
+            if (!world->m_DeferredStep.m_Stepped)
+                continue;
+            world->m_DeferredStep.m_Pending = 0;
+            world->m_DeferredStep.m_Stepped = 0;
+            CompleteDeferredStep(physics_context, world);
+        }
+
+        // Keep the worlds that were updated again while the steps were completed
+        uint32_t new_count = step_worlds.Size() - world_count;
+        for (uint32_t i = 0; i < new_count; ++i)
+        {
+            step_worlds[i] = step_worlds[world_count + i];
+        }
+        step_worlds.SetSize(new_count);
+
+        physics_context->m_SteppingWorlds = false;
+    }
+
     struct DispatchContext
     {
         PhysicsContext* m_PhysicsContext;
@@ -907,6 +1611,7 @@ namespace dmGameSystem
                     dmPhysics::DeleteCollisionObject2D(world->m_World2D, c->m_Object2D);
                     dmArray<dmPhysics::HCollisionShape2D>& shapes = resource->m_TileGridResource->m_GridShapes;
                     c->m_Object2D = dmPhysics::NewCollisionObject2D(world->m_World2D, data, &shapes.Front(), shapes.Size());
+                    c->m_LastWorldMatrixSet = 0;
 
                     SetupEmptyTileGrid(world, c);
                     SetupTileGrid(world, c);
@@ -915,6 +1620,35 @@ namespace dmGameSystem
             }
         }
 
+        world->m_LastDT = params.m_UpdateContext->m_DT;
+
+        if (physics_context->m_ParallelStep)
+        {
+            // The world is stepped together with the worlds of the other collections, in StepPhysicsWorlds
+            if (world->m_DeferredStep.m_Pending)
+            {
+                // StepPhysicsWorlds has not been called since the last update
+                CompletePendingStep(physics_context, world);
+            }
+
+            // Set before the step, since the world is drawn during the step
+            if (physics_context->m_3D)
+                dmPhysics::SetDrawDebug3D(world->m_World3D, physics_context->m_Debug);
+            else
+                dmPhysics::SetDrawDebug2D(world->m_World2D, physics_context->m_Debug);
+
+            DeferredStep* step = &world->m_DeferredStep;
+            step->m_Collection = params.m_Collection;
+            step->m_DT = params.m_UpdateContext->m_DT;
+            step->m_Pending = 1;
+
+            dmArray<void*>& step_worlds = physics_context->m_StepWorlds;
+            if (step_worlds.Full())
+                step_worlds.OffsetCapacity(4);
+            step_worlds.Push(world);
+            return result;
+        }
+
         CollisionUserData collision_user_data;
         collision_user_data.m_World = world;
         collision_user_data.m_Context = physics_context;
@@ -937,8 +1671,6 @@ namespace dmGameSystem
         step_world_context.m_RayCastCallback = RayCastCallback;
         step_world_context.m_RayCastUserData = world;
 
-        world->m_LastDT = params.m_UpdateContext->m_DT;
-
         g_NumPhysicsTransformsUpdated = 0;
 
         if (physics_context->m_3D)
@@ -952,30 +1684,7 @@ namespace dmGameSystem
 
         update_result.m_TransformsUpdated = g_NumPhysicsTransformsUpdated > 0;
 
-        if (collision_user_data.m_Count >= physics_context->m_MaxCollisionCount)
-        {
-            if (!g_CollisionOverflowWarning)
-            {
-                dmLogWarning("Maximum number of collisions (%d) reached, messages have been lost. Tweak \"%s\" in the config file.", physics_context->m_MaxCollisionCount, PHYSICS_MAX_COLLISIONS_KEY);
-                g_CollisionOverflowWarning = true;
-            }
-        }
-        else
-        {
-            g_CollisionOverflowWarning = false;
-        }
-        if (contact_user_data.m_Count >= physics_context->m_MaxContactPointCount)
-        {
-            if (!g_ContactOverflowWarning)
-            {
-                dmLogWarning("Maximum number of contacts (%d) reached, messages have been lost. Tweak \"%s\" in the config file.", physics_context->m_MaxContactPointCount, PHYSICS_MAX_CONTACTS_KEY);
-                g_ContactOverflowWarning = true;
-            }
-        }
-        else
-        {
-            g_ContactOverflowWarning = false;
-        }
+        CheckOverflow(physics_context, collision_user_data.m_Count, contact_user_data.m_Count);
         if (physics_context->m_3D)
             dmPhysics::SetDrawDebug3D(world->m_World3D, physics_context->m_Debug);
         else
@@ -996,6 +1705,12 @@ namespace dmGameSystem
         if (!CompCollisionObjectDispatchPhysicsMessages(physics_context, world, params.m_Collection))
             return dmGameObject::UPDATE_RESULT_UNKNOWN_ERROR;
 
+        // The events of the steps since the last post update, including a step in StepPhysicsWorlds
+        if (world->m_EventListener && world->m_Events.m_Count > 0)
+        {
+            DispatchEvents(world);
+        }
+
         return dmGameObject::UPDATE_RESULT_OK;
     }
 
@@ -1558,6 +2273,34 @@ namespace dmGameSystem
         return dmGameObject::GetIdentifier(component->m_Instance);
     }
 
+    void SetCollisionEventListener(void* _world, dmScript::LuaCallbackInfo* listener)
+    {
+        CollisionWorld* world = (CollisionWorld*)_world;
+        // The listener can't be destroyed while it's being called, so it's replaced once it returns, see DispatchEvents
+        if (world->m_DispatchingEvents)
+        {
+            if (world->m_PendingEventListener)
+            {
+                dmScript::DestroyCallback(world->m_PendingEventListener);
+            }
+            world->m_PendingEventListener = listener;
+            world->m_EventListenerPending = 1;
+            return;
+        }
+        if (world->m_EventListener)
+        {
+            dmScript::DestroyCallback(world->m_EventListener);
+        }
+        world->m_EventListener = listener;
+        world->m_PendingEventListener = 0x0;
+        world->m_EventListenerPending = 0;
+        // Events not yet dispatched go to the new listener. Without a listener they are not posted as messages, since the step has already reported them
+        if (!listener)
+        {
+            ClearEvents(&world->m_Events);
+        }
+    }
+
     bool IsCollision2D(void* _world)
     {
         CollisionWorld* world = (CollisionWorld*)_world;
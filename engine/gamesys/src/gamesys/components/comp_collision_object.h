@@ -21,6 +21,11 @@
 
 template <typename T> class dmArray;
 
+namespace dmScript
+{
+    struct LuaCallbackInfo;
+}
+
 namespace dmGameSystem
 {
     dmGameObject::CreateResult CompCollisionObjectNewWorld(const dmGameObject::ComponentNewWorldParams& params);
@@ -49,6 +54,14 @@ namespace dmGameSystem
 
     uint16_t CompCollisionGetGroupBitIndex(void* world, uint64_t group_hash);
 
+    // Values of the "type" stream of the events passed to the listener, see physics.set_listener
+    enum CollisionEventType
+    {
+        COLLISION_EVENT_TYPE_COLLISION      = 0,
+        COLLISION_EVENT_TYPE_CONTACT_POINT  = 1,
+        COLLISION_EVENT_TYPE_TRIGGER        = 2,
+    };
+
     // For script_physics.cpp
     void RayCast(void* world, const dmPhysics::RayCastRequest& request, dmArray<dmPhysics::RayCastResponse>& results);
     uint64_t GetLSBGroupHash(void* world, uint16_t mask);
@@ -66,6 +79,8 @@ namespace dmGameSystem
     Vectormath::Aos::Vector3 GetGravity(void* _world);
 
     bool IsCollision2D(void* _world);
+    // The world takes ownership of the listener. Setting 0x0 restores the collision messages
+    void SetCollisionEventListener(void* _world, dmScript::LuaCallbackInfo* listener);
     void SetCollisionFlipH(void* _component, bool flip);
     void SetCollisionFlipV(void* _component, bool flip);
     void WakeupCollision(void* _world, void* _component);
@@ -18,6 +18,7 @@
 #include <dlib/math.h>
 #include <dlib/message.h>
 #include <dlib/profile.h>
+#include <dlib/simd.h>
 #include <dlib/dstrings.h>
 #include <dlib/trig_lookup.h>
 #include <graphics/graphics.h>
@@ -45,6 +46,8 @@ extern uint32_t GUI_FPC_SIZE;
 
 namespace dmGameSystem
 {
+    using namespace dmSimd;
+
     dmGui::FetchTextureSetAnimResult FetchTextureSetAnimCallback(void*, dmhash_t, dmGui::TextureSetAnimDesc*);
     bool FetchRigSceneDataCallback(void* spine_scene, dmhash_t rig_scene_id, dmGui::RigSceneDataDesc* out_data);
     dmParticle::FetchAnimationResult FetchAnimationCallback(void* texture_set_ptr, dmhash_t animation, dmParticle::AnimationData* out_data); // implemention in comp_particlefx.cpp
@@ -114,6 +117,10 @@ namespace dmGameSystem
         gui_world->m_VertexDeclaration = dmGraphics::NewVertexDeclaration(dmRender::GetGraphicsContext(gui_context->m_RenderContext), ve, sizeof(ve) / sizeof(dmGraphics::VertexElement));
         // Grows automatically
         gui_world->m_ClientVertexBuffer.SetCapacity(512);
+        gui_world->m_BatchVertexStateCount = 0;
+        gui_world->m_NodeVertexStateCount = 0;
+        gui_world->m_VertexBufferUploadCount = 0;
+        gui_world->m_VertexBufferDirty = 1;
         gui_world->m_VertexBuffer = dmGraphics::NewVertexBuffer(dmRender::GetGraphicsContext(gui_context->m_RenderContext), 0, 0, dmGraphics::BUFFER_USAGE_STREAM_DRAW);
 
         uint8_t white_texture[] = { 0xff, 0xff, 0xff, 0xff,
@@ -884,6 +891,96 @@ namespace dmGameSystem
         dmRender::FlushTexts(gui_context->m_RenderContext, dmRender::RENDER_ORDER_AFTER_WORLD, MakeFinalRenderOrder(dmGui::GetRenderOrder(scene), gui_context->m_NextSortOrder++), false);
     }
 
+    // Makes room for count more vertices in the client vertex buffer
+    static void ReserveClientVertices(GuiWorld* gui_world, uint32_t count)
+    {
+        if (gui_world->m_ClientVertexBuffer.Remaining() < count) {
+            gui_world->m_ClientVertexBuffer.OffsetCapacity(dmMath::Max(128U, count));
+            // Only the vertices written this frame are kept when the buffer grows
+            uint32_t batch_count = dmMath::Min(gui_world->m_BatchVertexStates.Size(), gui_world->m_BatchVertexStateCount);
+            gui_world->m_BatchVertexStates.SetSize(batch_count);
+        }
+    }
+
+    // Returns true if the client vertex buffer still holds the vertices of the batch from the last frame, at the current position.
+    // That is the case when the batch consists of the same nodes, none of which have changed since then.
+    // Otherwise the nodes are recorded, and the caller generates the vertices and sets the vertex count of the returned batch state.
+    static bool ReuseBatchVertices(GuiWorld* gui_world, dmGui::HScene scene, const dmGui::RenderEntry* entries, const Matrix4* node_transforms,
+                                   const float* node_opacities, uint32_t node_count, dmRender::RenderObject& ro, GuiBatchVertexState** out_batch_state)
+    {
+        dmGraphics::HTexture texture = ro.m_Textures[0];
+        uint32_t texture_width = dmGraphics::GetOriginalTextureWidth(texture);
+        uint32_t texture_height = dmGraphics::GetOriginalTextureHeight(texture);
+
+        uint32_t batch_index = gui_world->m_BatchVertexStateCount++;
+        uint32_t node_start = gui_world->m_NodeVertexStateCount;
+        gui_world->m_NodeVertexStateCount += node_count;
+
+        dmArray<GuiBatchVertexState>& batch_states = gui_world->m_BatchVertexStates;
+        dmArray<GuiNodeVertexState>& node_states = gui_world->m_NodeVertexStates;
+        bool reuse = false;
+        if (batch_index < batch_states.Size())
+        {
+            const GuiBatchVertexState& batch_state = batch_states[batch_index];
+            reuse = batch_state.m_VertexStart == ro.m_VertexStart && batch_state.m_NodeStart == node_start && batch_state.m_NodeCount == node_count &&
+                    batch_state.m_Texture == texture && batch_state.m_TextureWidth == texture_width && batch_state.m_TextureHeight == texture_height;
+            for (uint32_t i = 0; reuse && i < node_count; ++i)
+            {
+                const GuiNodeVertexState& node_state = node_states[node_start + i];
+                dmGui::HNode node = entries[i].m_Node;
+                reuse = node_state.m_Node == node && node_state.m_Opacity == node_opacities[i] &&
+                        node_state.m_RenderGeneration == dmGui::GetNodeRenderGeneration(scene, node) &&
+                        memcmp(&node_state.m_Transform, &node_transforms[i], sizeof(Matrix4)) == 0;
+            }
+        }
+
+        if (reuse)
+        {
+            ro.m_VertexCount = batch_states[batch_index].m_VertexCount;
+            gui_world->m_ClientVertexBuffer.SetSize(ro.m_VertexStart + ro.m_VertexCount);
+            return true;
+        }
+
+        if (batch_states.Size() <= batch_index)
+        {
+            if (batch_states.Capacity() <= batch_index)
+            {
+                batch_states.OffsetCapacity(dmMath::Max(16U, batch_index + 1 - batch_states.Capacity()));
+            }
+            batch_states.SetSize(batch_index + 1);
+        }
+        if (node_states.Size() < node_start + node_count)
+        {
+            if (node_states.Capacity() < node_start + node_count)
+            {
+                node_states.OffsetCapacity(dmMath::Max(128U, node_start + node_count - node_states.Capacity()));
+            }
+            node_states.SetSize(node_start + node_count);
+        }
+
+        GuiBatchVertexState& batch_state = batch_states[batch_index];
+        batch_state.m_Texture = texture;
+        batch_state.m_TextureWidth = texture_width;
+        batch_state.m_TextureHeight = texture_height;
+        batch_state.m_VertexStart = ro.m_VertexStart;
+        batch_state.m_VertexCount = 0;
+        batch_state.m_NodeStart = node_start;
+        batch_state.m_NodeCount = node_count;
+        for (uint32_t i = 0; i < node_count; ++i)
+        {
+            GuiNodeVertexState& node_state = node_states[node_start + i];
+            dmGui::HNode node = entries[i].m_Node;
+            node_state.m_Transform = node_transforms[i];
+            node_state.m_Node = node;
+            node_state.m_RenderGeneration = dmGui::GetNodeRenderGeneration(scene, node);
+            node_state.m_Opacity = node_opacities[i];
+        }
+
+        gui_world->m_VertexBufferDirty = 1;
+        *out_batch_state = &batch_state;
+        return false;
+    }
+
     void RenderParticlefxNodes(dmGui::HScene scene,
                           const dmGui::RenderEntry* entries,
                           const Matrix4* node_transforms,
@@ -936,9 +1033,8 @@ namespace dmGameSystem
 
         vertex_count = dmMath::Min(vertex_count, vb_max_size / (uint32_t)sizeof(ParticleGuiVertex));
 
-        if (gui_world->m_ClientVertexBuffer.Remaining() < vertex_count) {
-            gui_world->m_ClientVertexBuffer.OffsetCapacity(dmMath::Max(128U, vertex_count));
-        }
+        ReserveClientVertices(gui_world, vertex_count);
+        gui_world->m_VertexBufferDirty = 1;
 
         ParticleGuiVertex *vb_begin = gui_world->m_ClientVertexBuffer.End();
         ParticleGuiVertex *vb_end = vb_begin;
@@ -1045,9 +1141,8 @@ namespace dmGameSystem
             ro.m_Textures[0] = gui_world->m_WhiteTexture;
         }
 
-        if (gui_world->m_ClientVertexBuffer.Remaining() < vertex_count) {
-            gui_world->m_ClientVertexBuffer.OffsetCapacity(dmMath::Max(128U, vertex_count));
-        }
+        ReserveClientVertices(gui_world, vertex_count);
+        gui_world->m_VertexBufferDirty = 1;
 
         // Fill in vertex buffer
         BoxVertex *vb_begin = gui_world->m_ClientVertexBuffer.End();
@@ -1068,6 +1163,101 @@ namespace dmGameSystem
         gui_world->m_ClientVertexBuffer.SetSize(vb_end - gui_world->m_ClientVertexBuffer.Begin());
     }
 
+    // pre-multiplied alpha
+    static inline void SetPremultipliedColor(float* out, const Vector4& color, float opacity)
+    {
+        out[0] = color.getX();
+        out[1] = color.getY();
+        out[2] = color.getZ();
+        out[3] = opacity;
+    }
+
+    // Writes a vertex with its position in node space, see TransformVertices
+    static inline void SetNodeSpaceVertex(BoxVertex* vertex, float x, float y, float u, float v)
+    {
+        vertex->m_Position[0] = x;
+        vertex->m_Position[1] = y;
+        vertex->SetUV(u, v);
+    }
+
+    // Generates the vertices of the grid nodes, as two triangles per cell
+    static void GenerateSlice9Vertices(const GuiSlice9Node* nodes, uint32_t node_count, BoxVertex* vertices)
+    {
+        BoxVertex grid[4][4];
+        for (uint32_t i = 0; i < node_count; ++i)
+        {
+            const GuiSlice9Node& node = nodes[i];
+            const uint32_t cells = node.m_Cells;
+
+            // transform * Point3(x, y, 0) = col0 * x + col1 * y + col3, so each grid line is only scaled once
+            const float* w = (const float*) node.m_Transform;
+            Float4 c0 = Load4(w + 0);
+            Float4 c1 = Load4(w + 4);
+            Float4 c3 = Load4(w + 12);
+            Float4 color = Load4(node.m_Color);
+
+            Float4 xs[4], ys[4];
+            for (uint32_t j = 0; j <= cells; ++j)
+            {
+                xs[j] = Mul4(c0, Splat4(node.m_Xs[j]));
+                ys[j] = Mul4(c1, Splat4(node.m_Ys[j]));
+            }
+
+            for (uint32_t y = 0; y <= cells; ++y)
+            {
+                for (uint32_t x = 0; x <= cells; ++x)
+                {
+                    BoxVertex& v = grid[y][x];
+                    Store3(v.m_Position, Add4(Add4(xs[x], ys[y]), c3));
+                    if (node.m_UVRotated)
+                        v.SetUV(node.m_Us[y], node.m_Vs[x]);
+                    else
+                        v.SetUV(node.m_Us[x], node.m_Vs[y]);
+                    Store4(v.m_Color, color);
+                }
+            }
+
+            BoxVertex* out = vertices + node.m_VertexStart;
+            for (uint32_t y = 0; y < cells; ++y)
+            {
+                for (uint32_t x = 0; x < cells; ++x)
+                {
+                    out[0] = grid[y][x];
+                    out[1] = grid[y][x+1];
+                    out[2] = grid[y+1][x+1];
+                    out[3] = grid[y][x];
+                    out[4] = grid[y+1][x+1];
+                    out[5] = grid[y+1][x];
+                    out += 6;
+                }
+            }
+        }
+    }
+
+    // Transforms the node space positions of the vertex ranges, and sets their colors
+    static void TransformVertices(const GuiVertexRange* ranges, uint32_t range_count, BoxVertex* vertices)
+    {
+        for (uint32_t i = 0; i < range_count; ++i)
+        {
+            const GuiVertexRange& range = ranges[i];
+
+            const float* w = (const float*) range.m_Transform;
+            Float4 c0 = Load4(w + 0);
+            Float4 c1 = Load4(w + 4);
+            Float4 c3 = Load4(w + 12);
+            Float4 color = Load4(range.m_Color);
+
+            BoxVertex* v = vertices + range.m_VertexStart;
+            BoxVertex* end = v + range.m_VertexCount;
+            for (; v != end; ++v)
+            {
+                Float4 p = Add4(Add4(Mul4(c0, Splat4(v->m_Position[0])), Mul4(c1, Splat4(v->m_Position[1]))), c3);
+                Store3(v->m_Position, p);
+                Store4(v->m_Color, color);
+            }
+        }
+    }
+
     void RenderBoxNodes(dmGui::HScene scene,
                         const dmGui::RenderEntry* entries,
                         const Matrix4* node_transforms,
@@ -1115,9 +1305,7 @@ namespace dmGameSystem
         else
             ro.m_Textures[0] = gui_world->m_WhiteTexture;
 
-        if (gui_world->m_ClientVertexBuffer.Remaining() < (max_total_vertices)) {
-            gui_world->m_ClientVertexBuffer.OffsetCapacity(dmMath::Max(128U, max_total_vertices));
-        }
+        ReserveClientVertices(gui_world, max_total_vertices);
 
         // 9-slice values are specified with reference to the original graphics and not by
         // the possibly stretched texture.
@@ -1125,7 +1313,25 @@ namespace dmGameSystem
         float org_height = (float)dmGraphics::GetOriginalTextureHeight(ro.m_Textures[0]);
         assert(org_width > 0 && org_height > 0);
 
-        int rendered_vert_count = 0;
+        GuiBatchVertexState* batch_state;
+        if (ReuseBatchVertices(gui_world, scene, entries, node_transforms, node_opacities, node_count, ro, &batch_state))
+        {
+            return;
+        }
+
+        BoxVertex* vertices = gui_world->m_ClientVertexBuffer.End();
+
+        dmArray<GuiSlice9Node>& slice9_nodes = gui_world->m_Slice9Nodes;
+        dmArray<GuiVertexRange>& vertex_ranges = gui_world->m_VertexRanges;
+        slice9_nodes.SetSize(0);
+        vertex_ranges.SetSize(0);
+        if (slice9_nodes.Capacity() < node_count)
+            slice9_nodes.SetCapacity(node_count);
+        if (vertex_ranges.Capacity() < node_count)
+            vertex_ranges.SetCapacity(node_count);
+
+        // The nodes are only set up here, their vertices are generated for the whole batch at the end
+        uint32_t rendered_vert_count = 0;
         for (uint32_t i = 0; i < node_count; ++i)
         {
             const dmGui::HNode node = entries[i].m_Node;
@@ -1134,9 +1340,7 @@ namespace dmGameSystem
                 continue;
             }
 
-            // pre-multiplied alpha
             const Vector4& color = dmGui::GetNodeProperty(scene, node, dmGui::PROPERTY_COLOR);
-            Vector4 pm_color(color.getXYZ(), node_opacities[i]);
 
             // default not uv_rotated texture coords
             const float default_tc[6] = {0, 0, 0, 1, 1, 1};
@@ -1154,32 +1358,15 @@ namespace dmGameSystem
             // render simple quad ignoring 9-slicing
             if ((!use_slice_nine && manually_set_texture) || !texture)
             {
-                BoxVertex v00;
-                v00.SetColor(pm_color);
-                v00.SetPosition(node_transforms[i] * Vectormath::Aos::Point3(0, 0, 0));
-                v00.SetUV(0, 0);
-
-                BoxVertex v10;
-                v10.SetColor(pm_color);
-                v10.SetPosition(node_transforms[i] * Vectormath::Aos::Point3(1, 0, 0));
-                v10.SetUV(1, 0);
-
-                BoxVertex v01;
-                v01.SetColor(pm_color);
-                v01.SetPosition(node_transforms[i] * Vectormath::Aos::Point3(0, 1, 0));
-                v01.SetUV(0, 1);
-
-                BoxVertex v11;
-                v11.SetColor(pm_color);
-                v11.SetPosition(node_transforms[i] * Vectormath::Aos::Point3(1, 1, 0));
-                v11.SetUV(1, 1);
-
-                gui_world->m_ClientVertexBuffer.Push(v00);
-                gui_world->m_ClientVertexBuffer.Push(v10);
-                gui_world->m_ClientVertexBuffer.Push(v11);
-                gui_world->m_ClientVertexBuffer.Push(v00);
-                gui_world->m_ClientVertexBuffer.Push(v11);
-                gui_world->m_ClientVertexBuffer.Push(v01);
+                GuiSlice9Node slice9_node;
+                slice9_node.m_Transform = &node_transforms[i];
+                SetPremultipliedColor(slice9_node.m_Color, color, node_opacities[i]);
+                slice9_node.m_Xs[0] = slice9_node.m_Ys[0] = slice9_node.m_Us[0] = slice9_node.m_Vs[0] = 0.0f;
+                slice9_node.m_Xs[1] = slice9_node.m_Ys[1] = slice9_node.m_Us[1] = slice9_node.m_Vs[1] = 1.0f;
+                slice9_node.m_VertexStart = rendered_vert_count;
+                slice9_node.m_Cells = 1;
+                slice9_node.m_UVRotated = 0;
+                slice9_nodes.Push(slice9_node);
 
                 rendered_vert_count += 6;
                 continue;
@@ -1202,8 +1389,6 @@ namespace dmGameSystem
 
                 const dmGameSystemDDF::SpriteGeometry* geometry = &texture_set_ddf->m_Geometries.m_Data[frame_index];
 
-                const Matrix4& w = node_transforms[i];
-
                 // NOTE: The original rendering code is from the comp_sprite.cpp.
                 // Compare with that one if you do any changes to either.
                 uint32_t num_points = geometry->m_Vertices.m_Count / 2;
@@ -1220,7 +1405,8 @@ namespace dmGameSystem
 
                 // Since we don't use an index buffer, we duplicate the vertices manually
                 uint32_t index_count = geometry->m_Indices.m_Count;
-                for (uint32_t index = 0; index < index_count; ++index)
+                BoxVertex* v = vertices + rendered_vert_count;
+                for (uint32_t index = 0; index < index_count; ++index, ++v)
                 {
                     uint32_t i = geometry->m_Indices.m_Data[index];
                     i = reverse ? (num_points - i - 1) : i;
@@ -1231,11 +1417,16 @@ namespace dmGameSystem
                     float x = point[0] * scaleX + 0.5f;
                     float y = point[1] * scaleY + 0.5f;
 
-                    Vector4 p = w * Point3(x, y, 0.0f);
-                    BoxVertex v(p, uv[0], uv[1], pm_color);
-                    gui_world->m_ClientVertexBuffer.Push(v);
+                    SetNodeSpaceVertex(v, x, y, uv[0], uv[1]);
                 }
 
+                GuiVertexRange range;
+                range.m_Transform = &node_transforms[i];
+                SetPremultipliedColor(range.m_Color, color, node_opacities[i]);
+                range.m_VertexStart = rendered_vert_count;
+                range.m_VertexCount = index_count;
+                vertex_ranges.Push(range);
+
                 rendered_vert_count += index_count;
                 continue;
             }
@@ -1252,7 +1443,11 @@ namespace dmGameSystem
             // 2 *-*-----*-*
             //   | |  w  | |
             // 3 *-*-----*-*
-            float us[4], vs[4], xs[4], ys[4];
+            GuiSlice9Node slice9_node;
+            float* us = slice9_node.m_Us;
+            float* vs = slice9_node.m_Vs;
+            float* xs = slice9_node.m_Xs;
+            float* ys = slice9_node.m_Ys;
 
             // v are '1-v'
             xs[0] = ys[0] = 0;
@@ -1303,59 +1498,25 @@ namespace dmGameSystem
             ys[1] = sy * slice9.getW();
             ys[2] = 1 - sy * slice9.getY();
 
-            const Matrix4* transform = &node_transforms[i];
-            Vectormath::Aos::Vector4 pts[4][4];
-            for (int y=0;y<4;y++)
-            {
-                for (int x=0;x<4;x++)
-                {
-                    pts[y][x] = (*transform * Vectormath::Aos::Point3(xs[x], ys[y], 0));
-                }
-            }
+            slice9_node.m_Transform = &node_transforms[i];
+            SetPremultipliedColor(slice9_node.m_Color, color, node_opacities[i]);
+            slice9_node.m_VertexStart = rendered_vert_count;
+            slice9_node.m_Cells = 3;
+            slice9_node.m_UVRotated = uv_rotated;
+            slice9_nodes.Push(slice9_node);
 
-            BoxVertex v00, v10, v01, v11;
-            v00.SetColor(pm_color);
-            v10.SetColor(pm_color);
-            v01.SetColor(pm_color);
-            v11.SetColor(pm_color);
-            for (int y=0;y<3;y++)
-            {
-                for (int x=0;x<3;x++)
-                {
-                    const int x0 = x;
-                    const int x1 = x+1;
-                    const int y0 = y;
-                    const int y1 = y+1;
-                    v00.SetPosition(pts[y0][x0]);
-                    v10.SetPosition(pts[y0][x1]);
-                    v01.SetPosition(pts[y1][x0]);
-                    v11.SetPosition(pts[y1][x1]);
-                    if(uv_rotated)
-                    {
-                        v00.SetUV(us[y0], vs[x0]);
-                        v10.SetUV(us[y0], vs[x1]);
-                        v01.SetUV(us[y1], vs[x0]);
-                        v11.SetUV(us[y1], vs[x1]);
-                    }
-                    else
-                    {
-                        v00.SetUV(us[x0], vs[y0]);
-                        v10.SetUV(us[x1], vs[y0]);
-                        v01.SetUV(us[x0], vs[y1]);
-                        v11.SetUV(us[x1], vs[y1]);
-                    }
-                    gui_world->m_ClientVertexBuffer.Push(v00);
-                    gui_world->m_ClientVertexBuffer.Push(v10);
-                    gui_world->m_ClientVertexBuffer.Push(v11);
-                    gui_world->m_ClientVertexBuffer.Push(v00);
-                    gui_world->m_ClientVertexBuffer.Push(v11);
-                    gui_world->m_ClientVertexBuffer.Push(v01);
-                }
-            }
             rendered_vert_count += verts_per_node;
         }
 
+        {
+            DM_PROFILE(Gui, "GenerateBoxVertices");
+            GenerateSlice9Vertices(slice9_nodes.Begin(), slice9_nodes.Size(), vertices);
+            TransformVertices(vertex_ranges.Begin(), vertex_ranges.Size(), vertices);
+        }
+        gui_world->m_ClientVertexBuffer.SetSize(ro.m_VertexStart + rendered_vert_count);
+
         ro.m_VertexCount = rendered_vert_count;
+        batch_state->m_VertexCount = rendered_vert_count;
     }
 
     // Computes max vertices required in the vertex buffer to draw a pie node with a
@@ -1425,10 +1586,23 @@ namespace dmGameSystem
             max_total_vertices += ComputeRequiredVertices(dmGui::GetNodePerimeterVertices(scene, entries[i].m_Node));
         }
 
-        if (gui_world->m_ClientVertexBuffer.Remaining() < max_total_vertices) {
-            gui_world->m_ClientVertexBuffer.OffsetCapacity(dmMath::Max(128U, max_total_vertices));
+        ReserveClientVertices(gui_world, max_total_vertices);
+
+        GuiBatchVertexState* batch_state;
+        if (ReuseBatchVertices(gui_world, scene, entries, node_transforms, node_opacities, node_count, ro, &batch_state))
+        {
+            return;
         }
 
+        BoxVertex* vertices = gui_world->m_ClientVertexBuffer.End();
+
+        dmArray<GuiVertexRange>& vertex_ranges = gui_world->m_VertexRanges;
+        vertex_ranges.SetSize(0);
+        if (vertex_ranges.Capacity() < node_count)
+            vertex_ranges.SetCapacity(node_count);
+
+        // The perimeter is generated in node space here, and all nodes are transformed at the end
+        uint32_t vertex_count = 0;
         for (uint32_t i = 0; i < node_count; ++i)
         {
             const dmGui::HNode node = entries[i].m_Node;
@@ -1439,9 +1613,6 @@ namespace dmGameSystem
 
             const Vector4& color = dmGui::GetNodeProperty(scene, node, dmGui::PROPERTY_COLOR);
 
-            // Pre-multiplied alpha
-            Vector4 pm_color(color.getXYZ(), node_opacities[i]);
-
             const uint32_t perimeterVertices = dmMath::Max<uint32_t>(4, dmGui::GetNodePerimeterVertices(scene, node));
             const float innerMultiplier = dmGui::GetNodeInnerRadius(scene, node) / size.getX();
             const dmGui::PieBounds outerBounds = dmGui::GetNodeOuterBounds(scene, node);
@@ -1510,7 +1681,7 @@ namespace dmGameSystem
                 sv = -1.0f;
             }
 
-            uint32_t sizeBefore = gui_world->m_ClientVertexBuffer.Size();
+            BoxVertex* vertex = vertices + vertex_count;
             for (uint32_t j = 0; j != generate; j++)
             {
                 float a;
@@ -1538,7 +1709,10 @@ namespace dmGameSystem
                 // make inner vertex
                 float u = 0.5f + innerMultiplier * c;
                 float v = 0.5f + innerMultiplier * s;
-                BoxVertex vInner(node_transforms[i] * Vectormath::Aos::Point3(u,v,0), u0 + ((uv_rotated ? v : u) * su), v0 + ((uv_rotated ? u : 1-v) * sv), pm_color);
+                const float inner_x = u;
+                const float inner_y = v;
+                const float inner_u = u0 + ((uv_rotated ? v : u) * su);
+                const float inner_v = v0 + ((uv_rotated ? u : 1-v) * sv);
 
                 // make outer vertex
                 float d;
@@ -1549,28 +1723,46 @@ namespace dmGameSystem
 
                 u = 0.5f + d * c;
                 v = 0.5f + d * s;
-                BoxVertex vOuter(node_transforms[i] * Vectormath::Aos::Point3(u,v,0), u0 + ((uv_rotated ? v : u) * su), v0 + ((uv_rotated ? u : 1-v) * sv), pm_color);
+                const float outer_x = u;
+                const float outer_y = v;
+                const float outer_u = u0 + ((uv_rotated ? v : u) * su);
+                const float outer_v = v0 + ((uv_rotated ? u : 1-v) * sv);
 
                 // both inner & outer are doubled at first / last entry to generate degenerate triangles
                 // for the triangle strip, allowing more than one pie to be chained together in the same
                 // drawcall.
                 if (first)
                 {
-                    gui_world->m_ClientVertexBuffer.Push(vInner);
+                    SetNodeSpaceVertex(vertex++, inner_x, inner_y, inner_u, inner_v);
                     first = false;
                 }
 
-                gui_world->m_ClientVertexBuffer.Push(vInner);
-                gui_world->m_ClientVertexBuffer.Push(vOuter);
+                SetNodeSpaceVertex(vertex++, inner_x, inner_y, inner_u, inner_v);
+                SetNodeSpaceVertex(vertex++, outer_x, outer_y, outer_u, outer_v);
 
                 if (j == generate-1)
-                    gui_world->m_ClientVertexBuffer.Push(vOuter);
+                    SetNodeSpaceVertex(vertex++, outer_x, outer_y, outer_u, outer_v);
             }
 
-            assert((gui_world->m_ClientVertexBuffer.Size() - sizeBefore) <= ComputeRequiredVertices(dmGui::GetNodePerimeterVertices(scene, entries[i].m_Node)));
+            GuiVertexRange range;
+            range.m_Transform = &node_transforms[i];
+            SetPremultipliedColor(range.m_Color, color, node_opacities[i]);
+            range.m_VertexStart = vertex_count;
+            range.m_VertexCount = vertex - (vertices + vertex_count);
+            vertex_ranges.Push(range);
+
+            assert(range.m_VertexCount <= ComputeRequiredVertices(dmGui::GetNodePerimeterVertices(scene, entries[i].m_Node)));
+            vertex_count += range.m_VertexCount;
         }
 
-        ro.m_VertexCount = gui_world->m_ClientVertexBuffer.Size() - ro.m_VertexStart;
+        {
+            DM_PROFILE(Gui, "GeneratePieVertices");
+            TransformVertices(vertex_ranges.Begin(), vertex_ranges.Size(), vertices);
+        }
+        gui_world->m_ClientVertexBuffer.SetSize(ro.m_VertexStart + vertex_count);
+
+        ro.m_VertexCount = vertex_count;
+        batch_state->m_VertexCount = vertex_count;
     }
 
     void RenderNodes(dmGui::HScene scene,
@@ -1693,10 +1885,17 @@ namespace dmGameSystem
             }
         }
 
-        dmGraphics::SetVertexBufferData(gui_world->m_VertexBuffer,
-                                        gui_world->m_ClientVertexBuffer.Size() * sizeof(BoxVertex),
-                                        gui_world->m_ClientVertexBuffer.Begin(),
-                                        dmGraphics::BUFFER_USAGE_STREAM_DRAW);
+        // The vertex buffer already holds the vertices if no batch has changed since the last upload
+        uint32_t vertex_count = gui_world->m_ClientVertexBuffer.Size();
+        if (gui_world->m_VertexBufferDirty || vertex_count > gui_world->m_VertexBufferUploadCount)
+        {
+            dmGraphics::SetVertexBufferData(gui_world->m_VertexBuffer,
+                                            vertex_count * sizeof(BoxVertex),
+                                            gui_world->m_ClientVertexBuffer.Begin(),
+                                            dmGraphics::BUFFER_USAGE_STREAM_DRAW);
+            gui_world->m_VertexBufferUploadCount = vertex_count;
+            gui_world->m_VertexBufferDirty = 0;
+        }
         DM_COUNTER("Gui.VertexCount", gui_world->m_ClientVertexBuffer.Size());
     }
 
@@ -1889,6 +2088,8 @@ namespace dmGameSystem
 
         gui_world->m_GuiRenderObjects.SetSize(0);
         gui_world->m_ClientVertexBuffer.SetSize(0);
+        gui_world->m_BatchVertexStateCount = 0;
+        gui_world->m_NodeVertexStateCount = 0;
 
         uint32_t lastEnd = 0;
 
@@ -77,6 +77,53 @@ namespace dmGameSystem
         uint32_t m_SortOrder;
     };
 
+    // The state a box or pie node had when its vertices were generated
+    struct GuiNodeVertexState
+    {
+        Vectormath::Aos::Matrix4 m_Transform;
+        dmGui::HNode            m_Node;
+        uint32_t                m_RenderGeneration;
+        float                   m_Opacity;
+    };
+
+    // The range of the client vertex buffer written by a box or pie batch, and the nodes it was generated from
+    struct GuiBatchVertexState
+    {
+        dmGraphics::HTexture    m_Texture;
+        uint32_t                m_TextureWidth;
+        uint32_t                m_TextureHeight;
+        uint32_t                m_VertexStart;
+        uint32_t                m_VertexCount;
+        uint32_t                m_NodeStart;
+        uint32_t                m_NodeCount;
+    };
+
+    // A box node drawn as a grid of quads, either nine-sliced (3x3 cells) or a plain quad (1x1 cell)
+    struct GuiSlice9Node
+    {
+        const Vectormath::Aos::Matrix4* m_Transform;
+        float                   m_Color[4];
+        // The grid lines in node space and texture space
+        float                   m_Xs[4];
+        float                   m_Ys[4];
+        float                   m_Us[4];
+        float                   m_Vs[4];
+        // Index of the first vertex of the node in the batch
+        uint32_t                m_VertexStart;
+        uint16_t                m_Cells;
+        uint16_t                m_UVRotated;
+    };
+
+    // Vertices of a node that hold node space positions, to be transformed and colored
+    struct GuiVertexRange
+    {
+        const Vectormath::Aos::Matrix4* m_Transform;
+        float                   m_Color[4];
+        // Index of the first vertex of the node in the batch
+        uint32_t                m_VertexStart;
+        uint32_t                m_VertexCount;
+    };
+
     struct GuiWorld
     {
         dmArray<GuiRenderObject>         m_GuiRenderObjects;
@@ -84,6 +131,18 @@ namespace dmGameSystem
         dmGraphics::HVertexDeclaration   m_VertexDeclaration;
         dmGraphics::HVertexBuffer        m_VertexBuffer;
         dmArray<BoxVertex>               m_ClientVertexBuffer;
+        // The box and pie batches of the last frame, in render order, used to keep the vertices of unchanged batches
+        dmArray<GuiBatchVertexState>     m_BatchVertexStates;
+        dmArray<GuiNodeVertexState>      m_NodeVertexStates;
+        uint32_t                         m_BatchVertexStateCount;
+        uint32_t                         m_NodeVertexStateCount;
+        // Vertex count of the last upload to m_VertexBuffer
+        uint32_t                         m_VertexBufferUploadCount;
+        // m_ClientVertexBuffer has changed since the last upload
+        uint8_t                          m_VertexBufferDirty : 1;
+        // Scratch buffers for generating the vertices of a batch, see RenderBoxNodes and RenderPieNodes
+        dmArray<GuiSlice9Node>           m_Slice9Nodes;
+        dmArray<GuiVertexRange>          m_VertexRanges;
         dmGraphics::HTexture             m_WhiteTexture;
         dmParticle::HParticleContext     m_ParticleContext;
         uint32_t                         m_MaxParticleFXCount;
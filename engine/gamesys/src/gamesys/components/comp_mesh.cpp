@@ -49,6 +49,11 @@ namespace dmGameSystem
         dmGameObject::HInstance         m_Instance;
         Matrix4                         m_Local;
         Matrix4                         m_World;
+        // The bounding box of the positions, used for culling
+        Vector3                         m_LocalMin;
+        Vector3                         m_LocalMax;
+        dmGameSystem::BufferResource*   m_BoundsBuffer; // The buffer (and version) the bounds were computed from
+        uint32_t                        m_BoundsVersion;
         uint32_t                        m_MixedHash;
         HComponentRenderConstants       m_RenderConstants;
         MeshResource*                   m_Resource;
@@ -68,7 +73,9 @@ namespace dmGameSystem
         /// Added to update or not
         uint8_t                         m_AddedToUpdate : 1;
         uint8_t                         m_ReHash : 1;
-        uint8_t                         :5;
+        /// Has a valid bounding box
+        uint8_t                         m_Cull : 1;
+        uint8_t                         :4;
     };
 
     struct VertexBufferInfo
@@ -268,6 +275,37 @@ namespace dmGameSystem
         return component->m_VertexDeclaration ? component->m_VertexDeclaration : component->m_Resource->m_VertexDeclaration;
     }
 
+    static void UpdateLocalBounds(MeshComponent* component, dmGameSystem::BufferResource* br)
+    {
+        component->m_BoundsBuffer = br;
+        component->m_BoundsVersion = br->m_Version;
+        component->m_Cull = 0;
+
+        const MeshResource* mr = component->m_Resource;
+        if (!mr->m_PositionStreamId || mr->m_PositionStreamType != dmBufferDDF::VALUE_TYPE_FLOAT32)
+            return;
+
+        float* positions = 0x0;
+        uint32_t count = 0;
+        uint32_t components = 0;
+        uint32_t stride = 0;
+        dmBuffer::Result r = dmBuffer::GetStream(br->m_Buffer, mr->m_PositionStreamId, (void**)&positions, &count, &components, &stride);
+        if (r != dmBuffer::RESULT_OK || count == 0 || !(components == 3 || components == 2))
+            return;
+
+        Vector3 local_min(FLT_MAX);
+        Vector3 local_max(-FLT_MAX);
+        for (uint32_t i = 0; i < count; ++i, positions += stride)
+        {
+            const Vector3 p(positions[0], positions[1], components == 3 ? positions[2] : 0.0f);
+            local_min = minPerElem(local_min, p);
+            local_max = maxPerElem(local_max, p);
+        }
+        component->m_LocalMin = local_min;
+        component->m_LocalMax = local_max;
+        component->m_Cull = 1;
+    }
+
     static void ReHash(MeshComponent* component)
     {
         // Hash resource-ptr, material-handle, textures and render constants
@@ -429,6 +467,10 @@ namespace dmGameSystem
             // Check the buffer version
             BufferResource* br = GetVerticesBuffer(&component, component.m_Resource);
             dmBuffer::GetContentVersion(br->m_Buffer, &br->m_Version);
+            if (br != component.m_BoundsBuffer || br->m_Version != component.m_BoundsVersion)
+            {
+                UpdateLocalBounds(&component, br);
+            }
 
             if (component.m_ReHash || (component.m_RenderConstants && dmGameSystem::AreRenderConstantsUpdated(component.m_RenderConstants)))
             {
@@ -796,6 +838,10 @@ namespace dmGameSystem
             write_ptr->m_Dispatch = dispatch;
             write_ptr->m_MinorOrder = 0;
             write_ptr->m_MajorOrder = dmRender::RENDER_ORDER_WORLD;
+            if (component.m_Cull)
+            {
+                dmRender::RenderListSetBounds(render_context, write_ptr, GetWorldHalfExtents(component.m_World, component.m_LocalMin, component.m_LocalMax));
+            }
             ++write_ptr;
 
         }
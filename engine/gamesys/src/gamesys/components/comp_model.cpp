@@ -53,6 +53,9 @@ namespace dmGameSystem
         dmGameObject::HInstance     m_Instance;
         dmTransform::Transform      m_Transform;
         Matrix4                     m_World;
+        /// The bounding box of the bind pose, used for culling
+        Vector3                     m_LocalMin;
+        Vector3                     m_LocalMax;
         ModelResource*              m_Resource;
         dmRig::HRigInstance         m_RigInstance;
         uint32_t                    m_MixedHash;
@@ -64,6 +67,8 @@ namespace dmGameSystem
 
         /// Node instances corresponding to the bones
         dmArray<dmGameObject::HInstance> m_NodeInstances;
+        /// Entry in ModelWorld::m_RenderList, while the model is rendered
+        dmRender::HPersistentRenderListEntry m_RenderEntry;
         uint16_t                    m_ComponentIndex;
         /// Component enablement
         uint8_t                     m_Enabled : 1;
@@ -71,11 +76,15 @@ namespace dmGameSystem
         /// Added to update or not
         uint8_t                     m_AddedToUpdate : 1;
         uint8_t                     m_ReHash : 1;
+        /// Has a valid bounding box (i.e. isn't skinned)
+        uint8_t                     m_Cull : 1;
     };
 
     struct ModelWorld
     {
         dmObjectPool<ModelComponent*>   m_Components;
+        // The render entries of the models, kept between frames so that only changed models are sorted
+        dmRender::HPersistentRenderList m_RenderList;
         dmArray<dmRender::RenderObject> m_RenderObjects;
         dmGraphics::HVertexDeclaration  m_VertexDeclaration;
         dmGraphics::HVertexBuffer*      m_VertexBuffers;
@@ -117,6 +126,7 @@ namespace dmGameSystem
         }
 
         world->m_Components.SetCapacity(context->m_MaxModelCount);
+        world->m_RenderList = dmRender::NewPersistentRenderList(context->m_MaxModelCount);
         world->m_RenderObjects.SetCapacity(context->m_MaxModelCount);
 
         dmGraphics::VertexElement ve[] =
@@ -158,6 +168,7 @@ namespace dmGameSystem
         delete [] world->m_VertexBufferData;
         delete [] world->m_VertexBuffers;
 
+        dmRender::DeletePersistentRenderList(world->m_RenderList);
         delete world;
 
         return dmGameObject::CREATE_RESULT_OK;
@@ -240,6 +251,39 @@ namespace dmGameSystem
         return component->m_Textures[index] ? component->m_Textures[index] : resource->m_Textures[index];
     }
 
+    static void UpdateLocalBounds(ModelComponent* component)
+    {
+        // The vertices of skinned models follow the bones, so there's no static box for them
+        RigSceneResource* rig_resource = component->m_Resource->m_RigScene;
+        component->m_Cull = 0;
+        if (rig_resource->m_SkeletonRes)
+            return;
+
+        const dmRigDDF::MeshSet* mesh_set = rig_resource->m_MeshSetRes->m_MeshSet;
+        if (!mesh_set)
+            return;
+
+        Vector3 local_min(FLT_MAX);
+        Vector3 local_max(-FLT_MAX);
+        for (uint32_t i = 0; i < mesh_set->m_MeshAttachments.m_Count; ++i)
+        {
+            const dmRigDDF::Mesh& mesh = mesh_set->m_MeshAttachments[i];
+            const float* positions = mesh.m_Positions.m_Data;
+            for (uint32_t j = 0; j + 2 < mesh.m_Positions.m_Count; j += 3)
+            {
+                const Vector3 p(positions[j], positions[j+1], positions[j+2]);
+                local_min = minPerElem(local_min, p);
+                local_max = maxPerElem(local_max, p);
+            }
+        }
+        if (local_min.getX() > local_max.getX())
+            return; // No vertices
+
+        component->m_LocalMin = local_min;
+        component->m_LocalMax = local_max;
+        component->m_Cull = 1;
+    }
+
     static void ReHash(ModelComponent* component)
     {
         // material, textures and render constants
@@ -373,6 +417,7 @@ namespace dmGameSystem
         component->m_DoRender = 0;
         component->m_FunctionRef = 0;
         component->m_RenderConstants = 0;
+        component->m_RenderEntry = dmRender::INVALID_PERSISTENT_RENDER_LIST_ENTRY;
 
         // Create GO<->bone representation
         // We need to make sure that bone GOs are created before we start the default animation.
@@ -416,6 +461,7 @@ namespace dmGameSystem
         }
 
         component->m_ReHash = 1;
+        UpdateLocalBounds(component);
 
         *params.m_UserData = (uintptr_t)index;
         return dmGameObject::CREATE_RESULT_OK;
@@ -437,6 +483,7 @@ namespace dmGameSystem
             dmGameSystem::DestroyRenderConstants(component->m_RenderConstants);
         }
 
+        RemoveRenderListEntry(world->m_RenderList, &component->m_RenderEntry);
         delete component;
         world->m_Components.Free(index, true);
     }
@@ -712,10 +759,12 @@ namespace dmGameSystem
         dmArray<ModelComponent*>& components = world->m_Components.m_Objects;
         const uint32_t count = components.Size();
 
-        // Prepare list submit
-        dmRender::RenderListEntry* render_list = dmRender::RenderListAlloc(render_context, count);
+        // Prepare list submit. The entries are kept between frames, and only the entries of models that changed are sorted again
+        dmRender::HPersistentRenderList render_list = world->m_RenderList;
         dmRender::HRenderListDispatch dispatch = dmRender::RenderListMakeDispatch(render_context, &RenderListDispatch, world);
-        dmRender::RenderListEntry* write_ptr = render_list;
+        dmRender::RenderListEntry entry;
+        memset(&entry, 0, sizeof(entry));
+        entry.m_MajorOrder = dmRender::RENDER_ORDER_WORLD;
 
         const uint32_t max_elements_vertices = world->m_MaxElementsVertices;
         uint32_t minor_order = 0; // Will translate to vb index.
@@ -724,7 +773,10 @@ namespace dmGameSystem
         {
             ModelComponent& component = *components[i];
             if (!component.m_DoRender)
+            {
+                RemoveRenderListEntry(render_list, &component.m_RenderEntry);
                 continue;
+            }
 
             uint32_t vertex_count = dmRig::GetVertexCount(component.m_RigInstance);
             if(vertex_count_total + vertex_count >= max_elements_vertices)
@@ -735,17 +787,20 @@ namespace dmGameSystem
             vertex_count_total += vertex_count;
 
             const Vector4 trans = component.m_World.getCol(3);
-            write_ptr->m_WorldPosition = Point3(trans.getX(), trans.getY(), trans.getZ());
-            write_ptr->m_UserData = (uintptr_t) &component;
-            write_ptr->m_BatchKey = component.m_MixedHash;
-            write_ptr->m_TagListKey = dmRender::GetMaterialTagListKey(GetMaterial(&component, component.m_Resource));
-            write_ptr->m_Dispatch = dispatch;
-            write_ptr->m_MinorOrder = minor_order;
-            write_ptr->m_MajorOrder = dmRender::RENDER_ORDER_WORLD;
-            ++write_ptr;
+            entry.m_WorldPosition = Point3(trans.getX(), trans.getY(), trans.getZ());
+            entry.m_UserData = (uintptr_t) &component;
+            entry.m_BatchKey = component.m_MixedHash;
+            entry.m_TagListKey = dmRender::GetMaterialTagListKey(GetMaterial(&component, component.m_Resource));
+            entry.m_MinorOrder = minor_order;
+            UpdateRenderListEntry(render_list, &component.m_RenderEntry, entry);
+            if (component.m_Cull)
+            {
+                dmRender::PersistentRenderListSetBounds(render_list, component.m_RenderEntry, GetWorldHalfExtents(component.m_World, component.m_LocalMin, component.m_LocalMax));
+            }
         }
 
-        dmRender::RenderListSubmit(render_context, render_list, write_ptr);
+        if (dmRender::PersistentRenderListSize(render_list) > 0)
+            dmRender::PersistentRenderListSubmit(render_context, render_list, dispatch);
         return dmGameObject::UPDATE_RESULT_OK;
     }
 
@@ -875,6 +930,7 @@ namespace dmGameSystem
         }
 
         component->m_ReHash = 1;
+        UpdateLocalBounds(component);
 
         return true;
     }
@@ -426,5 +426,47 @@ void EnableRenderObjectConstants(dmRender::RenderObject* ro, HComponentRenderCon
     }
 }
 
+Vector3 GetWorldHalfExtents(const Matrix4& world, const Vector3& local_min, const Vector3& local_max)
+{
+    // Grow the box to be symmetric around the local origin, and then take the extent of each axis
+    const Vector3 e = maxPerElem(absPerElem(local_min), absPerElem(local_max));
+    return absPerElem(world.getCol0().getXYZ()) * e.getX() +
+           absPerElem(world.getCol1().getXYZ()) * e.getY() +
+           absPerElem(world.getCol2().getXYZ()) * e.getZ();
+}
+
+static inline bool IsSameRenderListEntry(const dmRender::RenderListEntry& a, const dmRender::RenderListEntry& b)
+{
+    return a.m_UserData == b.m_UserData &&
+           a.m_TagListKey == b.m_TagListKey &&
+           a.m_BatchKey == b.m_BatchKey &&
+           a.m_MinorOrder == b.m_MinorOrder &&
+           a.m_MajorOrder == b.m_MajorOrder &&
+           a.m_WorldPosition.getX() == b.m_WorldPosition.getX() &&
+           a.m_WorldPosition.getY() == b.m_WorldPosition.getY() &&
+           a.m_WorldPosition.getZ() == b.m_WorldPosition.getZ();
+}
+
+void UpdateRenderListEntry(dmRender::HPersistentRenderList list, dmRender::HPersistentRenderListEntry* handle, const dmRender::RenderListEntry& entry)
+{
+    if (*handle == dmRender::INVALID_PERSISTENT_RENDER_LIST_ENTRY)
+    {
+        *handle = dmRender::PersistentRenderListAdd(list, entry);
+    }
+    else if (!IsSameRenderListEntry(*dmRender::PersistentRenderListGet(list, *handle), entry))
+    {
+        dmRender::PersistentRenderListUpdate(list, *handle, entry);
+    }
+}
+
+void RemoveRenderListEntry(dmRender::HPersistentRenderList list, dmRender::HPersistentRenderListEntry* handle)
+{
+    if (*handle != dmRender::INVALID_PERSISTENT_RENDER_LIST_ENTRY)
+    {
+        dmRender::PersistentRenderListRemove(list, *handle);
+        *handle = dmRender::INVALID_PERSISTENT_RENDER_LIST_ENTRY;
+    }
+}
+
 
 }
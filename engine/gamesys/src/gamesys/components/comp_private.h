@@ -30,6 +30,16 @@ namespace dmGameSystem
 
     dmGameObject::PropertyResult GetProperty(dmGameObject::PropertyDesc& out_value, dmhash_t get_property, const Vectormath::Aos::Vector4& ref_value, const PropVector4& property);
     dmGameObject::PropertyResult SetProperty(dmhash_t set_property, const dmGameObject::PropertyVar& in_value, Vectormath::Aos::Vector4& set_value, const PropVector4& property);
+
+    // The half extents (for dmRender::RenderListSetBounds) of a world space box, centered on the translation of the world transform,
+    // which contains the local space box [local_min, local_max]
+    Vectormath::Aos::Vector3 GetWorldHalfExtents(const Vectormath::Aos::Matrix4& world, const Vectormath::Aos::Vector3& local_min, const Vectormath::Aos::Vector3& local_max);
+
+    // Adds the entry to a persistent render list, or updates it if it has changed since the last call.
+    // An unchanged entry keeps its place in the sorted order of the list
+    void UpdateRenderListEntry(dmRender::HPersistentRenderList list, dmRender::HPersistentRenderListEntry* handle, const dmRender::RenderListEntry& entry);
+    // Removes the entry from the persistent render list, if it has been added
+    void RemoveRenderListEntry(dmRender::HPersistentRenderList list, dmRender::HPersistentRenderListEntry* handle);
 }
 
 #endif // DM_GAMESYS_COMP_PRIVATE_H
@@ -11,8 +11,10 @@
 // specific language governing permissions and limitations under the License.
 
 #include "comp_sprite.h"
+#include "comp_sprite_private.h"
 
 #include <string.h>
+#include <math.h>
 #include <float.h>
 #include <algorithm>
 
@@ -21,6 +23,7 @@
 #include <dlib/log.h>
 #include <dlib/message.h>
 #include <dlib/profile.h>
+#include <dlib/simd.h>
 #include <dlib/dstrings.h>
 #include <dlib/object_pool.h>
 #include <dlib/math.h>
@@ -37,73 +40,9 @@
 #include <gamesys/gamesys_ddf.h>
 
 using namespace Vectormath::Aos;
+using namespace dmSimd;
 namespace dmGameSystem
 {
-    struct SpriteComponent
-    {
-        dmGameObject::HInstance     m_Instance;
-        Vector3                     m_Position;
-        Quat                        m_Rotation;
-        Vector3                     m_Scale;
-        Vector3                     m_Size;     // The current size of the animation frame (in texels)
-        Matrix4                     m_World;
-        // Hash of the m_Resource-pointer. Hash is used to be compatible with 64-bit arch as a 32-bit value is used for sorting
-        // See GenerateKeys
-        uint32_t                    m_MixedHash;
-        int                         m_FunctionRef; // Animation callback function
-        dmMessage::URL              m_Listener;
-        uint32_t                    m_AnimationID;
-        SpriteResource*             m_Resource;
-        HComponentRenderConstants   m_RenderConstants;
-        TextureSetResource*         m_TextureSet;
-        dmRender::HMaterial         m_Material;
-        /// Currently playing animation
-        dmhash_t                    m_CurrentAnimation;
-        uint32_t                    m_CurrentAnimationFrame;
-        /// Used to scale the time step when updating the timer
-        float                       m_AnimInvDuration;
-        /// Timer in local space: [0,1]
-        float                       m_AnimTimer;
-        float                       m_PlaybackRate;
-        uint16_t                    m_ComponentIndex;
-        uint16_t                    m_AnimPingPong : 1;
-        uint16_t                    m_AnimBackwards : 1;
-        uint16_t                    m_Enabled : 1;
-        uint16_t                    m_Playing : 1;
-        uint16_t                    m_DoTick : 1;
-        uint16_t                    m_FlipHorizontal : 1;
-        uint16_t                    m_FlipVertical : 1;
-        uint16_t                    m_AddedToUpdate : 1;
-        uint16_t                    m_ReHash : 1;
-        uint16_t                    m_Padding : 7;
-    };
-
-    struct SpriteVertex
-    {
-        float x;
-        float y;
-        float z;
-        float u;
-        float v;
-    };
-
-    struct SpriteWorld
-    {
-        dmObjectPool<SpriteComponent>   m_Components;
-        dmArray<dmRender::RenderObject*> m_RenderObjects;
-        uint32_t                        m_RenderObjectsInUse;
-        dmGraphics::HVertexDeclaration  m_VertexDeclaration;
-        dmGraphics::HVertexBuffer       m_VertexBuffer;
-        SpriteVertex*                   m_VertexBufferData;
-        SpriteVertex*                   m_VertexBufferWritePtr;
-        dmGraphics::HIndexBuffer        m_IndexBuffer;
-        uint8_t*                        m_IndexBufferData;
-        uint8_t*                        m_IndexBufferWritePtr;
-        uint8_t                         m_Is16BitIndex : 1;
-        uint8_t                         m_UseGeometries : 1;
-        uint8_t                         m_ReallocBuffers : 1;
-    };
-
     DM_GAMESYS_PROP_VECTOR3(SPRITE_PROP_SCALE, scale, false);
     DM_GAMESYS_PROP_VECTOR3(SPRITE_PROP_SIZE, size, true);
 
@@ -142,6 +81,18 @@ namespace dmGameSystem
             sprite_world->m_VertexBufferData = (SpriteVertex*) malloc(memsize);
         }
 
+        // Nothing is cached in the new buffers
+        sprite_world->m_QuadGenerations.SetCapacity(max_sprite_count);
+        sprite_world->m_QuadGenerations.SetSize(max_sprite_count);
+        memset(sprite_world->m_QuadGenerations.Begin(), 0, sizeof(uint32_t) * max_sprite_count);
+        sprite_world->m_VertexBufferUploadSize = 0;
+        sprite_world->m_VertexBufferDirty = 1;
+
+        if (sprite_world->m_UseInstancing)
+        {
+            sprite_world->m_InstanceBufferData = (SpriteInstance*) realloc(sprite_world->m_InstanceBufferData, sizeof(SpriteInstance) * max_sprite_count);
+        }
+
         {
             uint32_t vertex_count = num_vertices_per_sprite * max_sprite_count;
             uint32_t size_type = vertex_count <= 65536 ? sizeof(uint16_t) : sizeof(uint32_t);
@@ -179,7 +130,9 @@ namespace dmGameSystem
 
         sprite_world->m_Components.SetCapacity(sprite_context->m_MaxSpriteCount);
         memset(sprite_world->m_Components.m_Objects.Begin(), 0, sizeof(SpriteComponent) * sprite_context->m_MaxSpriteCount);
+        sprite_world->m_RenderList = dmRender::NewPersistentRenderList(sprite_context->m_MaxSpriteCount);
         sprite_world->m_RenderObjectsInUse = 0;
+        sprite_world->m_JobPool = sprite_context->m_JobPool;
 
         dmGraphics::VertexElement ve[] =
         {
@@ -189,8 +142,42 @@ namespace dmGameSystem
 
         sprite_world->m_VertexDeclaration = dmGraphics::NewVertexDeclaration(dmRender::GetGraphicsContext(render_context), ve, sizeof(ve) / sizeof(dmGraphics::VertexElement));
 
+        sprite_world->m_UseInstancing = sprite_context->m_Instancing && dmGraphics::IsInstancingSupported(dmRender::GetGraphicsContext(render_context));
+        sprite_world->m_InstanceVertexDeclaration = 0;
+        sprite_world->m_CornerVertexDeclaration = 0;
+        sprite_world->m_CornerVertexBuffer = 0;
+        sprite_world->m_InstanceBufferData = 0;
+        if (sprite_world->m_UseInstancing)
+        {
+            dmGraphics::HContext graphics_context = dmRender::GetGraphicsContext(render_context);
+
+            dmGraphics::VertexElement corner_ve[] =
+            {
+                    {"position", 0, 2, dmGraphics::TYPE_FLOAT, false},
+            };
+            sprite_world->m_CornerVertexDeclaration = dmGraphics::NewVertexDeclaration(graphics_context, corner_ve, sizeof(corner_ve) / sizeof(dmGraphics::VertexElement));
+
+            // Same order as the quad vertices in CreateQuadVertexData
+            const float corners[] = { -0.5f, -0.5f, -0.5f, 0.5f, 0.5f, 0.5f, 0.5f, -0.5f };
+            sprite_world->m_CornerVertexBuffer = dmGraphics::NewVertexBuffer(graphics_context, sizeof(corners), corners, dmGraphics::BUFFER_USAGE_STATIC_DRAW);
+
+            dmGraphics::VertexElement instance_ve[] =
+            {
+                    {"instance_axis_x", 0, 3, dmGraphics::TYPE_FLOAT, false},
+                    {"instance_axis_y", 1, 3, dmGraphics::TYPE_FLOAT, false},
+                    {"instance_position", 2, 3, dmGraphics::TYPE_FLOAT, false},
+                    {"instance_texcoord01", 3, 4, dmGraphics::TYPE_FLOAT, false},
+                    {"instance_texcoord2", 4, 2, dmGraphics::TYPE_FLOAT, false},
+            };
+            sprite_world->m_InstanceVertexDeclaration = dmGraphics::NewVertexDeclaration(graphics_context, instance_ve, sizeof(instance_ve) / sizeof(dmGraphics::VertexElement));
+            dmGraphics::SetVertexDeclarationStepFunction(sprite_world->m_InstanceVertexDeclaration, dmGraphics::VERTEX_STEP_FUNCTION_INSTANCE);
+        }
+
         sprite_world->m_VertexBuffer = 0;
         sprite_world->m_VertexBufferData = 0;
+        sprite_world->m_VertexGeneration = 0;
+        sprite_world->m_VertexBufferUploadSize = 0;
+        sprite_world->m_VertexBufferDirty = 0;
         sprite_world->m_IndexBuffer = 0;
         sprite_world->m_IndexBufferData = 0;
 
@@ -216,6 +203,19 @@ namespace dmGameSystem
         dmGraphics::DeleteIndexBuffer(sprite_world->m_IndexBuffer);
         free(sprite_world->m_IndexBufferData);
 
+        if (sprite_world->m_UseInstancing)
+        {
+            for (uint32_t i = 0; i < sprite_world->m_InstanceVertexBuffers.Size(); ++i)
+            {
+                dmGraphics::DeleteVertexBuffer(sprite_world->m_InstanceVertexBuffers[i]);
+            }
+            dmGraphics::DeleteVertexDeclaration(sprite_world->m_InstanceVertexDeclaration);
+            dmGraphics::DeleteVertexDeclaration(sprite_world->m_CornerVertexDeclaration);
+            dmGraphics::DeleteVertexBuffer(sprite_world->m_CornerVertexBuffer);
+            free(sprite_world->m_InstanceBufferData);
+        }
+
+        dmRender::DeletePersistentRenderList(sprite_world->m_RenderList);
         delete sprite_world;
         return dmGameObject::CREATE_RESULT_OK;
     }
@@ -243,6 +243,12 @@ namespace dmGameSystem
         return component->m_Material ? component->m_Material : resource->m_Material;
     }
 
+    // Only materials written for instancing read the per sprite transform from the instance attributes,
+    // any other material is drawn from the generated vertices
+    static inline bool IsInstancingMaterial(dmRender::HMaterial material) {
+        return dmGraphics::GetAttributeLocation(dmRender::GetMaterialProgram(material), "instance_position") != -1;
+    }
+
     static inline TextureSetResource* GetTextureSet(const SpriteComponent* component, const SpriteResource* resource) {
         return component->m_TextureSet ? component->m_TextureSet : resource->m_TextureSet;
     }
@@ -279,6 +285,7 @@ namespace dmGameSystem
         if (frame != frame_current)
         {
             component->m_Size = GetSize(component, texture_set_ddf, component->m_AnimationID);
+            component->m_VertexDataChanged = 1;
         }
     }
 
@@ -290,6 +297,7 @@ namespace dmGameSystem
         {
             component->m_AnimationID = *anim_id;
             component->m_CurrentAnimation = animation;
+            component->m_VertexDataChanged = 1;
             dmGameSystemDDF::TextureSetAnimation* animation = &texture_set->m_TextureSet->m_Animations[*anim_id];
             uint32_t frame_count = animation->m_End - animation->m_Start;
             if (animation->m_Playback == dmGameSystemDDF::PLAYBACK_ONCE_PINGPONG
@@ -364,6 +372,7 @@ namespace dmGameSystem
         component->m_Enabled = 1;
         component->m_Scale = Vector3(1.0f);
         component->m_FunctionRef = 0;
+        component->m_RenderEntry = dmRender::INVALID_PERSISTENT_RENDER_LIST_ENTRY;
 
         component->m_ReHash = 1;
 
@@ -396,170 +405,291 @@ namespace dmGameSystem
         {
             dmGameSystem::DestroyRenderConstants(component->m_RenderConstants);
         }
+        RemoveRenderListEntry(sprite_world->m_RenderList, &component->m_RenderEntry);
         sprite_world->m_Components.Free(index, true);
         return dmGameObject::CREATE_RESULT_OK;
     }
 
 
-    static void CreateVertexData(SpriteWorld* sprite_world, SpriteVertex** vb_where, uint8_t** ib_where, TextureSetResource* texture_set, dmRender::RenderListEntry* buf, uint32_t* begin, uint32_t* end)
+    // Sprites per job when generating the vertices of a batch. Smaller batches are generated on the calling thread
+    static const uint32_t SPRITE_VERTEX_JOB_MIN_BATCH_SIZE = 1024;
+
+    struct CreateVertexDataContext
     {
-        DM_PROFILE(Sprite, "CreateVertexData");
+        SpriteWorld*                m_World;
+        TextureSetResource*         m_TextureSet;
+        dmRender::RenderListEntry*  m_Buf;
+        const uint32_t*             m_Begin;
+        SpriteVertex*               m_Vertices;
+        uint8_t*                    m_Indices;
+        SpriteInstance*             m_Instances;
+        // The generations of the quads of the batch, see SpriteWorld::m_QuadGenerations
+        uint32_t*                   m_QuadGenerations;
+        // Index of the first vertex of the batch in the vertex buffer
+        uint32_t                    m_VertexBase;
+    };
 
-        dmGameSystemDDF::TextureSet* texture_set_ddf = texture_set->m_TextureSet;
-        dmGameSystemDDF::TextureSetAnimation* animations = texture_set_ddf->m_Animations.m_Data;
-        uint32_t* frame_indices = texture_set_ddf->m_FrameIndices.m_Data;
+    static inline void StorePosition(SpriteVertex* vertex, Float4 p, float u, float v)
+    {
+        Store3(&vertex->x, p);
+        vertex->u = u;
+        vertex->v = v;
+    }
 
-        SpriteVertex*   vertices = *vb_where;
-        uint8_t*        indices = *ib_where;
+    static void CreateGeometryVertexData(void* _context, uint32_t begin, uint32_t end)
+    {
+        CreateVertexDataContext* context = (CreateVertexDataContext*) _context;
+        SpriteWorld* sprite_world = context->m_World;
+        dmRender::RenderListEntry* buf = context->m_Buf;
 
-        uint32_t index_type_size = sprite_world->m_Is16BitIndex ? sizeof(uint16_t) : sizeof(uint32_t);
+        dmGameSystemDDF::TextureSet* texture_set_ddf = context->m_TextureSet->m_TextureSet;
+        dmGameSystemDDF::TextureSetAnimation* animations = texture_set_ddf->m_Animations.m_Data;
+        uint32_t* frame_indices = texture_set_ddf->m_FrameIndices.m_Data;
+        const dmGameSystemDDF::SpriteGeometry* geometries = texture_set_ddf->m_Geometries.m_Data;
 
-        if (sprite_world->m_UseGeometries)
+        for (uint32_t i = begin; i != end; ++i)
         {
-            const dmGameSystemDDF::SpriteGeometry* geometries = texture_set_ddf->m_Geometries.m_Data;
+            const SpriteComponent* component = (SpriteComponent*) buf[context->m_Begin[i]].m_UserData;
 
-            // The offset for the indices
-            uint32_t vertex_offset = *vb_where - sprite_world->m_VertexBufferData;
+            const dmGameSystemDDF::TextureSetAnimation* animation_ddf = &animations[component->m_AnimationID];
 
-            for (uint32_t* i = begin; i != end; ++i)
-            {
-                const SpriteComponent* component = (SpriteComponent*) buf[*i].m_UserData;
+            uint32_t frame_index = frame_indices[animation_ddf->m_Start + component->m_CurrentAnimationFrame];
 
-                const dmGameSystemDDF::TextureSetAnimation* animation_ddf = &animations[component->m_AnimationID];
+            const dmGameSystemDDF::SpriteGeometry* geometry = &geometries[frame_index];
 
-                uint32_t frame_index = frame_indices[animation_ddf->m_Start + component->m_CurrentAnimationFrame];
+            // The offsets of this sprite were calculated up front, see CreateVertexData
+            uint32_t vertex_offset = sprite_world->m_VertexOffsets[i];
+            SpriteVertex* vertices = context->m_Vertices + vertex_offset;
+            uint8_t* indices = context->m_Indices + sprite_world->m_IndexOffsets[i];
+            vertex_offset += context->m_VertexBase;
 
-                const dmGameSystemDDF::SpriteGeometry* geometry = &geometries[frame_index];
+            uint32_t num_points = geometry->m_Vertices.m_Count / 2;
 
-                const Matrix4& w = component->m_World;
+            const float* points = geometry->m_Vertices.m_Data;
+            const float* uvs = geometry->m_Uvs.m_Data;
 
-                uint32_t num_points = geometry->m_Vertices.m_Count / 2;
+            // Depending on the sprite is flipped or not, we loop the vertices forward or backward
+            // to respect face winding (and backface culling)
+            int flipx = animation_ddf->m_FlipHorizontal ^ component->m_FlipHorizontal;
+            int flipy = animation_ddf->m_FlipVertical ^ component->m_FlipVertical;
+            int reverse = flipx ^ flipy;
 
-                const float* points = geometry->m_Vertices.m_Data;
-                const float* uvs = geometry->m_Uvs.m_Data;
+            float scaleX = flipx ? -1 : 1;
+            float scaleY = flipy ? -1 : 1;
 
-                // Depending on the sprite is flipped or not, we loop the vertices forward or backward
-                // to respect face winding (and backface culling)
-                int flipx = animation_ddf->m_FlipHorizontal ^ component->m_FlipHorizontal;
-                int flipy = animation_ddf->m_FlipVertical ^ component->m_FlipVertical;
-                int reverse = flipx ^ flipy;
+            int step = reverse ? -2 : 2;
+            points = reverse ? points + num_points*2 - 2 : points;
+            uvs = reverse ? uvs + num_points*2 - 2 : uvs;
 
-                float scaleX = flipx ? -1 : 1;
-                float scaleY = flipy ? -1 : 1;
+            // w * Point3(x, y, 0) = col0 * x + col1 * y + col3
+            const float* w = (const float*) &component->m_World;
+            Float4 c0 = Load4(w + 0);
+            Float4 c1 = Load4(w + 4);
+            Float4 c3 = Load4(w + 12);
 
-                int step = reverse ? -2 : 2;
-                points = reverse ? points + num_points*2 - 2 : points;
-                uvs = reverse ? uvs + num_points*2 - 2 : uvs;
+            for (uint32_t vert = 0; vert < num_points; ++vert, ++vertices, points += step, uvs += step)
+            {
+                float x = points[0] * scaleX; // range -0.5,+0.5
+                float y = points[1] * scaleY;
 
-                for (uint32_t vert = 0; vert < num_points; ++vert, ++vertices, points += step, uvs += step)
-                {
-                    float x = points[0] * scaleX; // range -0.5,+0.5
-                    float y = points[1] * scaleY;
-                    float u = uvs[0];
-                    float v = uvs[1];
-
-                    Vector4 p0 = w * Point3(x, y, 0.0f);
-                    vertices[0].x = ((float*)&p0)[0];
-                    vertices[0].y = ((float*)&p0)[1];
-                    vertices[0].z = ((float*)&p0)[2];
-                    vertices[0].u = u;
-                    vertices[0].v = v;
-                }
+                Float4 p = Add4(Add4(Mul4(c0, Splat4(x)), Mul4(c1, Splat4(y))), c3);
+                StorePosition(vertices, p, uvs[0], uvs[1]);
+            }
 
-                uint32_t index_count = geometry->m_Indices.m_Count;
-                uint32_t* geom_indices = geometry->m_Indices.m_Data;
-                if (sprite_world->m_Is16BitIndex)
+            uint32_t index_count = geometry->m_Indices.m_Count;
+            uint32_t* geom_indices = geometry->m_Indices.m_Data;
+            if (sprite_world->m_Is16BitIndex)
+            {
+                for (uint32_t index = 0; index < index_count; ++index)
                 {
-                    for (uint32_t index = 0; index < index_count; ++index)
-                    {
-                        ((uint16_t*)indices)[index] = vertex_offset + geom_indices[index];
-                    }
+                    ((uint16_t*)indices)[index] = vertex_offset + geom_indices[index];
                 }
-                else
+            }
+            else
+            {
+                for (uint32_t index = 0; index < index_count; ++index)
                 {
-                    for (uint32_t index = 0; index < index_count; ++index)
-                    {
-                        ((uint32_t*)indices)[index] = vertex_offset + geom_indices[index];
-                    }
+                    ((uint32_t*)indices)[index] = vertex_offset + geom_indices[index];
                 }
-                indices += index_type_size * geometry->m_Indices.m_Count;
-                vertex_offset += num_points;
             }
         }
-        else // original path using quads
+    }
+
+    static const int TEX_COORD_ORDER[] = {
+        0,1,2,2,3,0,
+        3,2,1,1,0,3,    //h
+        1,0,3,3,2,1,    //v
+        2,3,0,0,1,2     //hv
+    };
+
+    // Returns the order of the frame texture coordinates for the six quad indices, with the sprite flip applied
+    static inline const int* GetTexCoordOrder(const dmGameSystemDDF::TextureSetAnimation* animation_ddf, const SpriteComponent* component)
+    {
+        uint32_t flip_flag = 0;
+
+        // ddf values are guaranteed to be 0 or 1 when saved by the editor
+        // component values are guaranteed to be 0 or 1
+        if (animation_ddf->m_FlipHorizontal ^ component->m_FlipHorizontal)
         {
-            static int tex_coord_order[] = {
-                0,1,2,2,3,0,
-                3,2,1,1,0,3,    //h
-                1,0,3,3,2,1,    //v
-                2,3,0,0,1,2     //hv
-            };
+            flip_flag = 1;
+        }
+        if (animation_ddf->m_FlipVertical ^ component->m_FlipVertical)
+        {
+            flip_flag |= 2;
+        }
+
+        return &TEX_COORD_ORDER[flip_flag * 6];
+    }
+
+    static void CreateQuadVertexData(void* _context, uint32_t begin, uint32_t end)
+    {
+        CreateVertexDataContext* context = (CreateVertexDataContext*) _context;
+        dmRender::RenderListEntry* buf = context->m_Buf;
 
-            const float* tex_coords = (const float*) texture_set->m_TextureSet->m_TexCoords.m_Data;
+        dmGameSystemDDF::TextureSetAnimation* animations = context->m_TextureSet->m_TextureSet->m_Animations.m_Data;
+        const float* tex_coords = (const float*) context->m_TextureSet->m_TextureSet->m_TexCoords.m_Data;
 
-            for (uint32_t *i = begin;i != end; ++i)
+        Float4 half = Splat4(0.5f);
+
+        // The quad indices are filled in up front, see ReAllocateBuffers
+        SpriteVertex* vertices = context->m_Vertices + begin * 4;
+        uint32_t* generations = context->m_QuadGenerations;
+        for (uint32_t i = begin; i != end; ++i, vertices += 4)
+        {
+            const SpriteComponent* component = (SpriteComponent*) buf[context->m_Begin[i]].m_UserData;
+
+            // Still holds the vertices of this sprite from an earlier frame
+            if (generations[i] == component->m_VertexGeneration)
+                continue;
+            generations[i] = component->m_VertexGeneration;
+
+            dmGameSystemDDF::TextureSetAnimation* animation_ddf = &animations[component->m_AnimationID];
+
+            uint32_t frame_index = animation_ddf->m_Start + component->m_CurrentAnimationFrame;
+            const float* tc = &tex_coords[frame_index * 4 * 2];
+            const int* tex_lookup = GetTexCoordOrder(animation_ddf, component);
+
+            // The corners are at (+-0.5, +-0.5, 0), so w * corner = col3 +- col0 * 0.5 +- col1 * 0.5
+            const float* w = (const float*) &component->m_World;
+            Float4 x = Mul4(Load4(w + 0), half);
+            Float4 y = Mul4(Load4(w + 4), half);
+            Float4 c3 = Load4(w + 12);
+            Float4 left = Sub4(c3, x);
+            Float4 right = Add4(c3, x);
+
+            StorePosition(&vertices[0], Sub4(left, y), tc[tex_lookup[0] * 2], tc[tex_lookup[0] * 2 + 1]);
+            StorePosition(&vertices[1], Add4(left, y), tc[tex_lookup[1] * 2], tc[tex_lookup[1] * 2 + 1]);
+            StorePosition(&vertices[2], Add4(right, y), tc[tex_lookup[2] * 2], tc[tex_lookup[2] * 2 + 1]);
+            StorePosition(&vertices[3], Sub4(right, y), tc[tex_lookup[4] * 2], tc[tex_lookup[4] * 2 + 1]);
+        }
+    }
+
+    static void CreateInstanceData(void* _context, uint32_t begin, uint32_t end)
+    {
+        CreateVertexDataContext* context = (CreateVertexDataContext*) _context;
+        dmRender::RenderListEntry* buf = context->m_Buf;
+
+        dmGameSystemDDF::TextureSetAnimation* animations = context->m_TextureSet->m_TextureSet->m_Animations.m_Data;
+        const float* tex_coords = (const float*) context->m_TextureSet->m_TextureSet->m_TexCoords.m_Data;
+
+        SpriteInstance* instance = context->m_Instances + begin;
+        for (uint32_t i = begin; i != end; ++i, ++instance)
+        {
+            const SpriteComponent* component = (SpriteComponent*) buf[context->m_Begin[i]].m_UserData;
+
+            dmGameSystemDDF::TextureSetAnimation* animation_ddf = &animations[component->m_AnimationID];
+
+            uint32_t frame_index = animation_ddf->m_Start + component->m_CurrentAnimationFrame;
+            const float* tc = &tex_coords[frame_index * 4 * 2];
+            const int* tex_lookup = GetTexCoordOrder(animation_ddf, component);
+
+            const float* w = (const float*) &component->m_World;
+            memcpy(instance->m_AxisX, w + 0, sizeof(instance->m_AxisX));
+            memcpy(instance->m_AxisY, w + 4, sizeof(instance->m_AxisY));
+            memcpy(instance->m_Position, w + 12, sizeof(instance->m_Position));
+
+            for (uint32_t corner = 0; corner < 3; ++corner)
             {
-                const SpriteComponent* component = (SpriteComponent*) buf[*i].m_UserData;
+                instance->m_TexCoords[corner * 2] = tc[tex_lookup[corner] * 2];
+                instance->m_TexCoords[corner * 2 + 1] = tc[tex_lookup[corner] * 2 + 1];
+            }
+        }
+    }
 
-                dmGameSystemDDF::TextureSetAnimation* animation_ddf = &animations[component->m_AnimationID];
+    static void CreateVertexData(SpriteWorld* sprite_world, SpriteVertex** vb_where, uint8_t** ib_where, TextureSetResource* texture_set, dmRender::RenderListEntry* buf, uint32_t* begin, uint32_t* end)
+    {
+        DM_PROFILE(Sprite, "CreateVertexData");
 
-                uint32_t frame_index = animation_ddf->m_Start + component->m_CurrentAnimationFrame;
-                const float* tc = &tex_coords[frame_index * 4 * 2];
-                uint32_t flip_flag = 0;
+        uint32_t count = end - begin;
+        uint32_t index_type_size = sprite_world->m_Is16BitIndex ? sizeof(uint16_t) : sizeof(uint32_t);
 
-                // ddf values are guaranteed to be 0 or 1 when saved by the editor
-                // component values are guaranteed to be 0 or 1
-                if (animation_ddf->m_FlipHorizontal ^ component->m_FlipHorizontal)
-                {
-                    flip_flag = 1;
-                }
-                if (animation_ddf->m_FlipVertical ^ component->m_FlipVertical)
-                {
-                    flip_flag |= 2;
-                }
+        CreateVertexDataContext context;
+        context.m_World = sprite_world;
+        context.m_TextureSet = texture_set;
+        context.m_Buf = buf;
+        context.m_Begin = begin;
+        context.m_Vertices = *vb_where;
+        context.m_Indices = *ib_where;
+        context.m_VertexBase = *vb_where - sprite_world->m_VertexBufferData;
 
-                const int* tex_lookup = &tex_coord_order[flip_flag * 6];
-
-                const Matrix4& w = component->m_World;
-
-                Vector4 p0 = w * Point3(-0.5f, -0.5f, 0.0f);
-                vertices[0].x = p0.getX();
-                vertices[0].y = p0.getY();
-                vertices[0].z = p0.getZ();
-                vertices[0].u = tc[tex_lookup[0] * 2];
-                vertices[0].v = tc[tex_lookup[0] * 2 + 1];
-
-                Vector4 p1 = w * Point3(-0.5f, 0.5f, 0.0f);
-                vertices[1].x = p1.getX();
-                vertices[1].y = p1.getY();
-                vertices[1].z = p1.getZ();
-                vertices[1].u = tc[tex_lookup[1] * 2];
-                vertices[1].v = tc[tex_lookup[1] * 2 + 1];
-
-                Vector4 p2 = w * Point3(0.5f, 0.5f, 0.0f);
-                vertices[2].x = p2.getX();
-                vertices[2].y = p2.getY();
-                vertices[2].z = p2.getZ();
-                vertices[2].u = tc[tex_lookup[2] * 2];
-                vertices[2].v = tc[tex_lookup[2] * 2 + 1];
-
-                Vector4 p3 = w * Point3(0.5f, -0.5f, 0.0f);
-                vertices[3].x = p3.getX();
-                vertices[3].y = p3.getY();
-                vertices[3].z = p3.getZ();
-                vertices[3].u = tc[tex_lookup[4] * 2];
-                vertices[3].v = tc[tex_lookup[4] * 2 + 1];
-
-                // for (int f = 0; f < 4; ++f)
-                //     printf("  %u: %.2f, %.2f\t%.2f, %.2f\n", f, vertices[f].x, vertices[f].y, vertices[f].u, vertices[f].v );
-
-                vertices += 4;
-                indices += 6 * index_type_size;
+        if (sprite_world->m_UseGeometries)
+        {
+            dmGameSystemDDF::TextureSet* texture_set_ddf = texture_set->m_TextureSet;
+            dmGameSystemDDF::TextureSetAnimation* animations = texture_set_ddf->m_Animations.m_Data;
+            uint32_t* frame_indices = texture_set_ddf->m_FrameIndices.m_Data;
+            const dmGameSystemDDF::SpriteGeometry* geometries = texture_set_ddf->m_Geometries.m_Data;
+
+            // Prefix sum of the vertex and index counts, so that each sprite can be written independently
+            dmArray<uint32_t>& vertex_offsets = sprite_world->m_VertexOffsets;
+            dmArray<uint32_t>& index_offsets = sprite_world->m_IndexOffsets;
+            if (vertex_offsets.Capacity() < count)
+            {
+                vertex_offsets.SetCapacity(count);
+                index_offsets.SetCapacity(count);
+            }
+            vertex_offsets.SetSize(count);
+            index_offsets.SetSize(count);
+
+            uint32_t vertex_count = 0;
+            uint32_t index_count = 0;
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                const SpriteComponent* component = (SpriteComponent*) buf[begin[i]].m_UserData;
+                const dmGameSystemDDF::TextureSetAnimation* animation_ddf = &animations[component->m_AnimationID];
+                uint32_t frame_index = frame_indices[animation_ddf->m_Start + component->m_CurrentAnimationFrame];
+                const dmGameSystemDDF::SpriteGeometry* geometry = &geometries[frame_index];
+
+                vertex_offsets[i] = vertex_count;
+                index_offsets[i] = index_count * index_type_size;
+                vertex_count += geometry->m_Vertices.m_Count / 2;
+                index_count += geometry->m_Indices.m_Count;
             }
+
+            dmJobPool::ParallelFor(sprite_world->m_JobPool, count, SPRITE_VERTEX_JOB_MIN_BATCH_SIZE, CreateGeometryVertexData, &context);
+            sprite_world->m_VertexBufferDirty = 1;
+
+            *vb_where += vertex_count;
+            *ib_where += index_count * index_type_size;
         }
+        else // original path using quads
+        {
+            // Static sprites keep their vertices as long as they are drawn in the same place in the buffer
+            context.m_QuadGenerations = sprite_world->m_QuadGenerations.Begin() + context.m_VertexBase / 4;
+            uint32_t first_changed = 0;
+            while (first_changed < count && context.m_QuadGenerations[first_changed] == ((SpriteComponent*) buf[begin[first_changed]].m_UserData)->m_VertexGeneration)
+            {
+                ++first_changed;
+            }
 
-        *vb_where = vertices;
-        *ib_where = indices;
+            if (first_changed < count)
+            {
+                dmJobPool::ParallelFor(sprite_world->m_JobPool, count, SPRITE_VERTEX_JOB_MIN_BATCH_SIZE, CreateQuadVertexData, &context);
+                sprite_world->m_VertexBufferDirty = 1;
+            }
+
+            *vb_where += count * 4;
+            *ib_where += count * 6 * index_type_size;
+        }
     }
 
     static void RenderBatch(SpriteWorld* sprite_world, dmRender::HRenderContext render_context, dmRender::RenderListEntry *buf, uint32_t* begin, uint32_t* end)
@@ -582,37 +712,75 @@ namespace dmGameSystem
             sprite_world->m_RenderObjects.Push(ro);
         }
 
-        dmRender::RenderObject& ro = *sprite_world->m_RenderObjects[sprite_world->m_RenderObjectsInUse++];
-
-        // Fill in vertex buffer
-        SpriteVertex* vb_begin = sprite_world->m_VertexBufferWritePtr;
-        uint8_t* ib_begin = (uint8_t*)sprite_world->m_IndexBufferWritePtr;
-        SpriteVertex* vb_iter = vb_begin;
-        uint8_t* ib_iter = ib_begin;
-        CreateVertexData(sprite_world, &vb_iter, &ib_iter, texture_set, buf, begin, end);
-
-        sprite_world->m_VertexBufferWritePtr = vb_iter;
-        sprite_world->m_IndexBufferWritePtr = ib_iter;
+        uint32_t ro_index = sprite_world->m_RenderObjectsInUse++;
+        dmRender::RenderObject& ro = *sprite_world->m_RenderObjects[ro_index];
 
         ro.Init();
-        ro.m_VertexDeclaration = sprite_world->m_VertexDeclaration;
-        ro.m_VertexBuffer = sprite_world->m_VertexBuffer;
-        ro.m_IndexBuffer = sprite_world->m_IndexBuffer;
         ro.m_Material = GetMaterial(first, resource);
         ro.m_Textures[0] = texture_set->m_Texture;
         ro.m_PrimitiveType = dmGraphics::PRIMITIVE_TRIANGLES;
         ro.m_IndexType = sprite_world->m_Is16BitIndex ? dmGraphics::TYPE_UNSIGNED_SHORT : dmGraphics::TYPE_UNSIGNED_INT;
+        ro.m_IndexBuffer = sprite_world->m_IndexBuffer;
+
+        if (sprite_world->m_UseInstancing && !sprite_world->m_UseGeometries && IsInstancingMaterial(ro.m_Material))
+        {
+            uint32_t count = end - begin;
+            CreateVertexDataContext context;
+            context.m_World = sprite_world;
+            context.m_TextureSet = texture_set;
+            context.m_Buf = buf;
+            context.m_Begin = begin;
+            context.m_Instances = sprite_world->m_InstanceBufferWritePtr;
+            dmJobPool::ParallelFor(sprite_world->m_JobPool, count, SPRITE_VERTEX_JOB_MIN_BATCH_SIZE, CreateInstanceData, &context);
+
+            dmGraphics::HContext graphics_context = dmRender::GetGraphicsContext(render_context);
+            while (sprite_world->m_InstanceVertexBuffers.Size() <= ro_index)
+            {
+                if (sprite_world->m_InstanceVertexBuffers.Full())
+                {
+                    sprite_world->m_InstanceVertexBuffers.OffsetCapacity(4);
+                }
+                sprite_world->m_InstanceVertexBuffers.Push(dmGraphics::NewVertexBuffer(graphics_context, 0, 0x0, dmGraphics::BUFFER_USAGE_STREAM_DRAW));
+            }
+            dmGraphics::HVertexBuffer instance_buffer = sprite_world->m_InstanceVertexBuffers[ro_index];
+            dmGraphics::SetVertexBufferData(instance_buffer, sizeof(SpriteInstance) * count, sprite_world->m_InstanceBufferWritePtr, dmGraphics::BUFFER_USAGE_STREAM_DRAW);
+            sprite_world->m_InstanceBufferWritePtr += count;
+
+            // One quad (the first six indices, see ReAllocateBuffers) drawn once per sprite
+            ro.m_VertexDeclaration = sprite_world->m_CornerVertexDeclaration;
+            ro.m_VertexBuffer = sprite_world->m_CornerVertexBuffer;
+            ro.m_VertexStart = 0;
+            ro.m_VertexCount = 6;
+            ro.m_InstanceVertexDeclaration = sprite_world->m_InstanceVertexDeclaration;
+            ro.m_InstanceVertexBuffer = instance_buffer;
+            ro.m_InstanceCount = count;
+        }
+        else
+        {
+            // Fill in vertex buffer
+            SpriteVertex* vb_begin = sprite_world->m_VertexBufferWritePtr;
+            uint8_t* ib_begin = (uint8_t*)sprite_world->m_IndexBufferWritePtr;
+            SpriteVertex* vb_iter = vb_begin;
+            uint8_t* ib_iter = ib_begin;
+            CreateVertexData(sprite_world, &vb_iter, &ib_iter, texture_set, buf, begin, end);
 
-        // offset in bytes into element buffer
-        uint32_t index_offset = ib_begin - sprite_world->m_IndexBufferData;
+            sprite_world->m_VertexBufferWritePtr = vb_iter;
+            sprite_world->m_IndexBufferWritePtr = ib_iter;
 
-        // num elements = Number of bytes / sizeof(index_type)
-        uint32_t index_type_size = sprite_world->m_Is16BitIndex ? sizeof(uint16_t) : sizeof(uint32_t);
-        uint32_t num_elements = ((uint8_t*)sprite_world->m_IndexBufferWritePtr - (uint8_t*)ib_begin) / index_type_size;
+            ro.m_VertexDeclaration = sprite_world->m_VertexDeclaration;
+            ro.m_VertexBuffer = sprite_world->m_VertexBuffer;
+
+            // offset in bytes into element buffer
+            uint32_t index_offset = ib_begin - sprite_world->m_IndexBufferData;
 
-        // // These should be named "element" or "index" (as opposed to vertex)
-        ro.m_VertexStart = index_offset;
-        ro.m_VertexCount = num_elements;
+            // num elements = Number of bytes / sizeof(index_type)
+            uint32_t index_type_size = sprite_world->m_Is16BitIndex ? sizeof(uint16_t) : sizeof(uint32_t);
+            uint32_t num_elements = ((uint8_t*)sprite_world->m_IndexBufferWritePtr - (uint8_t*)ib_begin) / index_type_size;
+
+            // // These should be named "element" or "index" (as opposed to vertex)
+            ro.m_VertexStart = index_offset;
+            ro.m_VertexCount = num_elements;
+        }
 
         if (first->m_RenderConstants) {
             dmGameSystem::EnableRenderObjectConstants(&ro, first->m_RenderConstants);
@@ -653,6 +821,25 @@ namespace dmGameSystem
         dmRender::AddToRender(render_context, &ro);
     }
 
+    static inline void SetWorldTransform(SpriteComponent* c, const Matrix4& transform, bool sub_pixels)
+    {
+        Matrix4 world = transform;
+
+        // The "sub_pixels" is set by default
+        if (!sub_pixels) {
+            Vector4 position = world.getCol3();
+            position.setX((int) position.getX());
+            position.setY((int) position.getY());
+            world.setCol3(position);
+        }
+
+        if (memcmp(&c->m_World, &world, sizeof(world)) != 0)
+        {
+            c->m_World = world;
+            c->m_VertexDataChanged = 1;
+        }
+    }
+
     static void UpdateTransforms(SpriteWorld* sprite_world, bool sub_pixels)
     {
         DM_PROFILE(Sprite, "UpdateTransforms");
@@ -675,7 +862,7 @@ namespace dmGameSystem
                 Matrix4 local = dmTransform::ToMatrix4(dmTransform::Transform(c->m_Position, c->m_Rotation, 1.0f));
                 Matrix4 world = dmGameObject::GetWorldMatrix(c->m_Instance);
                 Vector3 size( c->m_Size.getX() * c->m_Scale.getX(), c->m_Size.getY() * c->m_Scale.getY(), 1);
-                c->m_World = appendScale(world * local, size);
+                SetWorldTransform(c, appendScale(world * local, size), sub_pixels);
             }
         } else
         {
@@ -686,19 +873,24 @@ namespace dmGameSystem
                 Matrix4 world = dmGameObject::GetWorldMatrix(c->m_Instance);
                 Matrix4 w = dmTransform::MulNoScaleZ(world, local);
                 Vector3 size( c->m_Size.getX() * c->m_Scale.getX(), c->m_Size.getY() * c->m_Scale.getY(), 1);
-                c->m_World = appendScale(w, size);
+                SetWorldTransform(c, appendScale(w, size), sub_pixels);
             }
         }
+    }
 
-        // The "sub_pixels" is set by default
-        if (!sub_pixels) {
-            for (uint32_t i = 0; i < n; ++i) {
-                SpriteComponent* c = &components[i];
-                Vector4 position = c->m_World.getCol3();
-                position.setX((int) position.getX());
-                position.setY((int) position.getY());
-                c->m_World.setCol3(position);
-            }
+    // Gives the sprite a new generation if its vertex data has changed since the last frame
+    static inline void UpdateVertexGeneration(SpriteWorld* sprite_world, SpriteComponent* component)
+    {
+        // The texture set changes version when the atlas is reloaded, or when another one is set
+        uint32_t texture_set_version = GetTextureSet(component, component->m_Resource)->m_Version;
+        if (component->m_VertexDataChanged || component->m_VertexTextureSetVersion != texture_set_version)
+        {
+            // Zero is reserved for quads that hold no sprite
+            if (++sprite_world->m_VertexGeneration == 0)
+                sprite_world->m_VertexGeneration = 1;
+            component->m_VertexGeneration = sprite_world->m_VertexGeneration;
+            component->m_VertexTextureSetVersion = texture_set_version;
+            component->m_VertexDataChanged = 0;
         }
     }
 
@@ -874,15 +1066,19 @@ namespace dmGameSystem
             case dmRender::RENDER_LIST_OPERATION_BEGIN:
                 world->m_VertexBufferWritePtr = world->m_VertexBufferData;
                 world->m_IndexBufferWritePtr = world->m_IndexBufferData;
+                world->m_InstanceBufferWritePtr = world->m_InstanceBufferData;
                 world->m_RenderObjectsInUse = 0;
                 break;
             case dmRender::RENDER_LIST_OPERATION_END:
                 {
                     uint32_t vertex_size = sizeof(SpriteVertex) * (world->m_VertexBufferWritePtr - world->m_VertexBufferData);
-                    if (vertex_size)
+                    // The buffer already holds the vertices if no sprite has changed since the last upload
+                    if (vertex_size && (world->m_VertexBufferDirty || vertex_size > world->m_VertexBufferUploadSize))
                     {
                         dmGraphics::SetVertexBufferData(world->m_VertexBuffer, vertex_size,
                                                         world->m_VertexBufferData, dmGraphics::BUFFER_USAGE_DYNAMIC_DRAW);
+                        world->m_VertexBufferUploadSize = vertex_size;
+                        world->m_VertexBufferDirty = 0;
 
                         DM_COUNTER("SpriteVertexBuffer", vertex_size);
                     }
@@ -929,33 +1125,44 @@ namespace dmGameSystem
         }
 
         // Submit all sprites as entries in the render list for sorting.
-        dmRender::RenderListEntry* render_list = dmRender::RenderListAlloc(render_context, sprite_count);
+        // The entries are kept between frames, and only the entries of sprites that changed are sorted again
+        dmRender::HPersistentRenderList render_list = sprite_world->m_RenderList;
         dmRender::HRenderListDispatch sprite_dispatch = dmRender::RenderListMakeDispatch(render_context, &RenderListDispatch, sprite_world);
-        dmRender::RenderListEntry* write_ptr = render_list;
+        dmRender::RenderListEntry entry;
+        memset(&entry, 0, sizeof(entry));
+        entry.m_MinorOrder = 0;
+        entry.m_MajorOrder = dmRender::RENDER_ORDER_WORLD;
 
         for (uint32_t i = 0; i < sprite_count; ++i)
         {
             SpriteComponent& component = components[i];
             if (!component.m_Enabled || !component.m_AddedToUpdate)
+            {
+                RemoveRenderListEntry(render_list, &component.m_RenderEntry);
                 continue;
+            }
 
             if (component.m_ReHash || (component.m_RenderConstants && dmGameSystem::AreRenderConstantsUpdated(component.m_RenderConstants)))
             {
                 ReHash(&component);
             }
 
+            UpdateVertexGeneration(sprite_world, &component);
+
             const Vector4 trans = component.m_World.getCol(3);
-            write_ptr->m_WorldPosition = Point3(trans.getX(), trans.getY(), trans.getZ());
-            write_ptr->m_UserData = (uintptr_t) &component;
-            write_ptr->m_BatchKey = component.m_MixedHash;
-            write_ptr->m_TagListKey = dmRender::GetMaterialTagListKey(GetMaterial(&component, component.m_Resource));
-            write_ptr->m_Dispatch = sprite_dispatch;
-            write_ptr->m_MinorOrder = 0;
-            write_ptr->m_MajorOrder = dmRender::RENDER_ORDER_WORLD;
-            ++write_ptr;
+            entry.m_WorldPosition = Point3(trans.getX(), trans.getY(), trans.getZ());
+            // The component moves in memory when another sprite is destroyed, which updates the entry
+            entry.m_UserData = (uintptr_t) &component;
+            entry.m_BatchKey = component.m_MixedHash;
+            entry.m_TagListKey = dmRender::GetMaterialTagListKey(GetMaterial(&component, component.m_Resource));
+            UpdateRenderListEntry(render_list, &component.m_RenderEntry, entry);
+
+            // The world transform maps the unit quad, centered on the origin
+            dmRender::PersistentRenderListSetBounds(render_list, component.m_RenderEntry, GetWorldHalfExtents(component.m_World, Vector3(-0.5f, -0.5f, 0.0f), Vector3(0.5f, 0.5f, 0.0f)));
         }
 
-        dmRender::RenderListSubmit(render_context, render_list, write_ptr);
+        if (dmRender::PersistentRenderListSize(render_list) > 0)
+            dmRender::PersistentRenderListSubmit(render_context, render_list, sprite_dispatch);
         return dmGameObject::UPDATE_RESULT_OK;
     }
 
@@ -1044,11 +1251,13 @@ namespace dmGameSystem
             {
                 dmGameSystemDDF::SetFlipHorizontal* ddf = (dmGameSystemDDF::SetFlipHorizontal*)params.m_Message->m_Data;
                 component->m_FlipHorizontal = ddf->m_Flip != 0 ? 1 : 0;
+                component->m_VertexDataChanged = 1;
             }
             else if (params.m_Message->m_Id == dmGameSystemDDF::SetFlipVertical::m_DDFDescriptor->m_NameHash)
             {
                 dmGameSystemDDF::SetFlipVertical* ddf = (dmGameSystemDDF::SetFlipVertical*)params.m_Message->m_Data;
                 component->m_FlipVertical = ddf->m_Flip != 0 ? 1 : 0;
+                component->m_VertexDataChanged = 1;
             }
             else if (params.m_Message->m_Id == dmGameSystemDDF::SetConstant::m_DDFDescriptor->m_NameHash)
             {
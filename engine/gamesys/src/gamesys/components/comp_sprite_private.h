@@ -0,0 +1,138 @@
+// Copyright 2020 The Defold Foundation
+// Licensed under the Defold License version 1.0 (the "License"); you may not use
+// this file except in compliance with the License.
+//
+// You may obtain a copy of the License, together with FAQs at
+// https://www.defold.com/license
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#ifndef DM_GAMESYS_COMP_SPRITE_PRIVATE_H
+#define DM_GAMESYS_COMP_SPRITE_PRIVATE_H
+
+#include <stdint.h>
+
+#include <dlib/array.h>
+#include <dlib/job_pool.h>
+#include <dlib/message.h>
+#include <dlib/object_pool.h>
+#include <graphics/graphics.h>
+#include <render/render.h>
+#include <gameobject/gameobject.h>
+#include <dmsdk/gamesys/render_constants.h>
+
+#include <gamesys/gamesys_ddf.h>
+
+namespace dmGameSystem
+{
+    struct SpriteResource;
+    struct TextureSetResource;
+
+    struct SpriteComponent
+    {
+        dmGameObject::HInstance     m_Instance;
+        Vectormath::Aos::Vector3    m_Position;
+        Vectormath::Aos::Quat       m_Rotation;
+        Vectormath::Aos::Vector3    m_Scale;
+        Vectormath::Aos::Vector3    m_Size;     // The current size of the animation frame (in texels)
+        Vectormath::Aos::Matrix4    m_World;
+        // Hash of the m_Resource-pointer. Hash is used to be compatible with 64-bit arch as a 32-bit value is used for sorting
+        // See GenerateKeys
+        uint32_t                    m_MixedHash;
+        int                         m_FunctionRef; // Animation callback function
+        dmMessage::URL              m_Listener;
+        uint32_t                    m_AnimationID;
+        SpriteResource*             m_Resource;
+        HComponentRenderConstants   m_RenderConstants;
+        TextureSetResource*         m_TextureSet;
+        dmRender::HMaterial         m_Material;
+        /// Currently playing animation
+        dmhash_t                    m_CurrentAnimation;
+        uint32_t                    m_CurrentAnimationFrame;
+        /// Used to scale the time step when updating the timer
+        float                       m_AnimInvDuration;
+        /// Timer in local space: [0,1]
+        float                       m_AnimTimer;
+        float                       m_PlaybackRate;
+        /// The version of the texture set the vertex data was last generated from, see TextureSetResource::m_Version
+        uint32_t                    m_VertexTextureSetVersion;
+        /// Changes whenever the vertex data of the sprite changes, see UpdateVertexGeneration
+        uint32_t                    m_VertexGeneration;
+        /// Entry in SpriteWorld::m_RenderList, while the sprite is rendered
+        dmRender::HPersistentRenderListEntry m_RenderEntry;
+        uint16_t                    m_ComponentIndex;
+        uint16_t                    m_AnimPingPong : 1;
+        uint16_t                    m_AnimBackwards : 1;
+        uint16_t                    m_Enabled : 1;
+        uint16_t                    m_Playing : 1;
+        uint16_t                    m_DoTick : 1;
+        uint16_t                    m_FlipHorizontal : 1;
+        uint16_t                    m_FlipVertical : 1;
+        uint16_t                    m_AddedToUpdate : 1;
+        uint16_t                    m_ReHash : 1;
+        uint16_t                    m_VertexDataChanged : 1;
+        uint16_t                    m_Padding : 6;
+    };
+
+    struct SpriteVertex
+    {
+        float x;
+        float y;
+        float z;
+        float u;
+        float v;
+    };
+
+    // Per instance data for the instanced path. The quad corner is a per vertex stream,
+    // see /builtins/materials/sprite_instanced.vp
+    struct SpriteInstance
+    {
+        float m_AxisX[3];       // World transform columns 0, 1 and 3
+        float m_AxisY[3];
+        float m_Position[3];
+        float m_TexCoords[6];   // The texture coordinates of the first three corners. The fourth is derived from them
+    };
+
+    struct SpriteWorld
+    {
+        dmObjectPool<SpriteComponent>   m_Components;
+        // The render entries of the sprites, kept between frames so that only changed sprites are sorted
+        dmRender::HPersistentRenderList m_RenderList;
+        dmArray<dmRender::RenderObject*> m_RenderObjects;
+        uint32_t                        m_RenderObjectsInUse;
+        dmGraphics::HVertexDeclaration  m_VertexDeclaration;
+        dmGraphics::HVertexBuffer       m_VertexBuffer;
+        SpriteVertex*                   m_VertexBufferData;
+        SpriteVertex*                   m_VertexBufferWritePtr;
+        dmGraphics::HIndexBuffer        m_IndexBuffer;
+        uint8_t*                        m_IndexBufferData;
+        uint8_t*                        m_IndexBufferWritePtr;
+        // The generation of the sprite that last wrote each quad of m_VertexBufferData, used to skip unchanged sprites
+        dmArray<uint32_t>               m_QuadGenerations;
+        uint32_t                        m_VertexGeneration;
+        // Size of the last upload to m_VertexBuffer
+        uint32_t                        m_VertexBufferUploadSize;
+        // Per sprite vertex and index (in bytes) offsets within a geometry batch
+        dmArray<uint32_t>               m_VertexOffsets;
+        dmArray<uint32_t>               m_IndexOffsets;
+        dmJobPool::HJobPool             m_JobPool;
+        // Instanced path. Each render object gets its own instance buffer, since the draw call has no instance offset
+        dmArray<dmGraphics::HVertexBuffer> m_InstanceVertexBuffers;
+        dmGraphics::HVertexDeclaration  m_InstanceVertexDeclaration;
+        dmGraphics::HVertexDeclaration  m_CornerVertexDeclaration;
+        dmGraphics::HVertexBuffer       m_CornerVertexBuffer;
+        SpriteInstance*                 m_InstanceBufferData;
+        SpriteInstance*                 m_InstanceBufferWritePtr;
+        uint8_t                         m_Is16BitIndex : 1;
+        uint8_t                         m_UseGeometries : 1;
+        uint8_t                         m_UseInstancing : 1;
+        uint8_t                         m_ReallocBuffers : 1;
+        // m_VertexBufferData has changed since the last upload
+        uint8_t                         m_VertexBufferDirty : 1;
+    };
+}
+
+#endif // DM_GAMESYS_COMP_SPRITE_PRIVATE_H
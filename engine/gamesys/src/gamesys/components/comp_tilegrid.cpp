@@ -84,6 +84,8 @@ namespace dmGameSystem
         Flags*                      m_CellFlags;
         dmArray<TileGridRegion>     m_Regions;
         dmArray<TileGridLayer>      m_Layers;
+        // One render entry per layer and region, see UpdateRenderEntries
+        dmArray<dmRender::HPersistentRenderListEntry> m_RenderEntries;
         uint32_t                    m_MixedHash;
         HComponentRenderConstants   m_RenderConstants;
         dmRender::HMaterial         m_Material;
@@ -111,6 +113,7 @@ namespace dmGameSystem
 
         dmRender::HRenderContext        m_RenderContext;
         dmArray<TileGridComponent*>     m_Components;
+        dmRender::HPersistentRenderList m_RenderList;
         dmArray<dmRender::RenderObject> m_RenderObjects;
         dmGraphics::HVertexDeclaration  m_VertexDeclaration;
 
@@ -152,6 +155,7 @@ namespace dmGameSystem
         world->m_MaxTileCount = context->m_MaxTileCount;
 
         world->m_Components.SetCapacity(world->m_MaxTilemapCount);
+        world->m_RenderList = dmRender::NewPersistentRenderList(world->m_MaxTilemapCount);
 
         world->m_VertexDeclaration = 0;
 
@@ -168,10 +172,20 @@ namespace dmGameSystem
             dmGraphics::DeleteVertexBuffer(world->m_VertexBuffer);
             free(world->m_VertexBufferData);
         }
+        dmRender::DeletePersistentRenderList(world->m_RenderList);
         delete world;
         return dmGameObject::CREATE_RESULT_OK;
     }
 
+    static void RemoveRenderEntries(TileGridWorld* world, TileGridComponent* component)
+    {
+        uint32_t n = component->m_RenderEntries.Size();
+        for (uint32_t i = 0; i < n; ++i)
+        {
+            RemoveRenderListEntry(world->m_RenderList, &component->m_RenderEntries[i]);
+        }
+    }
+
     static inline dmRender::HMaterial GetMaterial(const TileGridComponent* component) {
         return component->m_Material ? component->m_Material : component->m_Resource->m_Material;
     }
@@ -431,6 +445,8 @@ namespace dmGameSystem
                 delete [] tile_grid->m_Cells;
                 delete [] tile_grid->m_CellFlags;
 
+                RemoveRenderEntries(world, tile_grid);
+
                 if (tile_grid->m_RenderConstants)
                 {
                     dmGameSystem::DestroyRenderConstants(tile_grid->m_RenderConstants);
@@ -715,6 +731,66 @@ namespace dmGameSystem
         return num_render_entries;
     }
 
+    // The render entries are kept in the world render list between frames, and only the
+    // entries of regions that moved, changed or appeared since the last frame are updated
+    static void UpdateRenderEntries(TileGridWorld* world, TileGridComponent* component, uint32_t component_index)
+    {
+        TileGridResource* resource = component->m_Resource;
+        dmGameSystemDDF::TextureSet* texture_set_ddf = GetTextureSet(component)->m_TextureSet;
+        dmGameSystemDDF::TileGrid* tile_grid_ddf = resource->m_TileGrid;
+
+        uint32_t tile_width = texture_set_ddf->m_TileWidth;
+        uint32_t tile_height = texture_set_ddf->m_TileHeight;
+
+        uint32_t n_layers = tile_grid_ddf->m_Layers.m_Count;
+        uint32_t region_count = component->m_RegionsX * component->m_RegionsY;
+
+        // The layout changes when the tile grid is reloaded
+        uint32_t entry_count = n_layers * region_count;
+        if (component->m_RenderEntries.Size() != entry_count)
+        {
+            RemoveRenderEntries(world, component);
+            component->m_RenderEntries.SetCapacity(entry_count);
+            component->m_RenderEntries.SetSize(entry_count);
+            for (uint32_t i = 0; i < entry_count; ++i)
+            {
+                component->m_RenderEntries[i] = dmRender::INVALID_PERSISTENT_RENDER_LIST_ENTRY;
+            }
+        }
+
+        dmRender::RenderListEntry entry;
+        memset(&entry, 0, sizeof(entry));
+        entry.m_TagListKey = dmRender::GetMaterialTagListKey(GetMaterial(component));
+        entry.m_BatchKey = component->m_MixedHash;
+        entry.m_MinorOrder = 0;
+        entry.m_MajorOrder = dmRender::RENDER_ORDER_WORLD;
+
+        for (uint32_t l = 0; l < n_layers; ++l)
+        {
+            const TileGridLayer* layer = &component->m_Layers[l];
+            dmGameSystemDDF::TileLayer* layer_ddf = &tile_grid_ddf->m_Layers[l];
+            for (uint32_t y = 0, region_index = 0; y < component->m_RegionsY; ++y) {
+                for (uint32_t x = 0; x < component->m_RegionsX; ++x, ++region_index) {
+
+                    dmRender::HPersistentRenderListEntry* handle = &component->m_RenderEntries[l * region_count + region_index];
+
+                    const TileGridRegion* region = &component->m_Regions[region_index];
+                    if (!layer->m_IsVisible || !region->m_Occupied) {
+                        RemoveRenderListEntry(world->m_RenderList, handle);
+                        continue;
+                    }
+
+                    Vector4 trans = component->m_World * Point3(x * tile_width, y * tile_height, layer_ddf->m_Z);
+
+                    entry.m_WorldPosition = Point3(trans.getXYZ());
+                    entry.m_UserData = EncodeRegionInfo(component_index, l, x, y);
+
+                    UpdateRenderListEntry(world->m_RenderList, handle, entry);
+                }
+            }
+        }
+    }
+
     dmGameObject::UpdateResult CompTileGridRender(const dmGameObject::ComponentsRenderParams& params)
     {
         TilemapContext* context = (TilemapContext*)params.m_Context;
@@ -737,14 +813,13 @@ namespace dmGameSystem
         }
 
         dmRender::HRenderContext render_context = context->m_RenderContext;
-        dmRender::RenderListEntry* render_list = dmRender::RenderListAlloc(render_context, num_render_entries);
         dmRender::HRenderListDispatch dispatch = dmRender::RenderListMakeDispatch(render_context, &RenderListDispatch, world);
-        dmRender::RenderListEntry* write_ptr = render_list;
 
         for (uint32_t i = 0; i < n; ++i)
         {
             TileGridComponent* component = components[i];
             if (!component->m_Enabled || !component->m_AddedToUpdate || !component->m_Occupied) {
+                RemoveRenderEntries(world, component);
                 continue;
             }
 
@@ -753,46 +828,11 @@ namespace dmGameSystem
                 ReHash(component);
             }
 
-            TileGridResource* resource = component->m_Resource;
-            dmGameSystemDDF::TextureSet* texture_set_ddf = GetTextureSet(component)->m_TextureSet;
-            dmGameSystemDDF::TileGrid* tile_grid_ddf = resource->m_TileGrid;
-
-            uint32_t tile_width = texture_set_ddf->m_TileWidth;
-            uint32_t tile_height = texture_set_ddf->m_TileHeight;
-
-            uint32_t n_layers = tile_grid_ddf->m_Layers.m_Count;
-            for (uint32_t l = 0; l < n_layers; ++l)
-            {
-                TileGridLayer* layer = &component->m_Layers[l];
-                if (!layer->m_IsVisible)
-                    continue;
-
-                dmGameSystemDDF::TileLayer* layer_ddf = &tile_grid_ddf->m_Layers[l];
-                for (uint32_t y = 0, region_index = 0; y < component->m_RegionsY; ++y) {
-                    for (uint32_t x = 0; x < component->m_RegionsX; ++x, ++region_index) {
-
-                        TileGridRegion* region = &component->m_Regions[region_index];
-                        if (!region->m_Occupied) {
-                            continue;
-                        }
-
-                        Vector4 trans = component->m_World * Point3(x * tile_width, y * tile_height, layer_ddf->m_Z);
-
-                        write_ptr->m_WorldPosition = Point3(trans.getXYZ());
-                        write_ptr->m_UserData = EncodeRegionInfo(i, l, x, y);
-                        write_ptr->m_TagListKey = dmRender::GetMaterialTagListKey(GetMaterial(component));
-                        write_ptr->m_BatchKey = component->m_MixedHash;
-                        write_ptr->m_Dispatch = dispatch;
-                        write_ptr->m_MinorOrder = 0;
-                        write_ptr->m_MajorOrder = dmRender::RENDER_ORDER_WORLD;
-                        ++write_ptr;
-                    }
-                }
-            }
+            UpdateRenderEntries(world, component, i);
         }
 
-        if (render_list != write_ptr)
-            dmRender::RenderListSubmit(render_context, render_list, write_ptr);
+        if (dmRender::PersistentRenderListSize(world->m_RenderList) > 0)
+            dmRender::PersistentRenderListSubmit(render_context, world->m_RenderList, dispatch);
         return dmGameObject::UPDATE_RESULT_OK;
     }
 
@@ -21,6 +21,7 @@
 
 #include <dmsdk/dlib/array.h>
 #include <dmsdk/dlib/hash.h>
+#include <dlib/job_pool.h>
 #include <dmsdk/lua/lua.h>
 #include <dmsdk/gameobject/gameobject.h>
 
@@ -73,10 +74,18 @@ namespace dmGameSystem
             dmPhysics::HContext3D m_Context3D;
             dmPhysics::HContext2D m_Context2D;
         };
+        // Used to step the worlds when m_ParallelStep is set
+        dmJobPool::HJobPool m_JobPool;
+        // The collision worlds waiting for StepPhysicsWorlds
+        dmArray<void*> m_StepWorlds;
+        // Set while StepPhysicsWorlds runs, a nested call is ignored
+        bool m_SteppingWorlds;
         uint32_t m_MaxCollisionCount;
         uint32_t m_MaxContactPointCount;
         bool m_Debug;
         bool m_3D;
+        // Step the worlds together in StepPhysicsWorlds, instead of in the update of each collection
+        bool m_ParallelStep;
     };
 
     struct ParticleFXContext
@@ -87,6 +96,7 @@ namespace dmGameSystem
         }
         dmResource::HFactory m_Factory;
         dmRender::HRenderContext m_RenderContext;
+        dmJobPool::HJobPool m_JobPool;
         uint32_t m_MaxParticleFXCount;
         uint32_t m_MaxParticleCount;
         bool m_Debug;
@@ -121,8 +131,12 @@ namespace dmGameSystem
             memset(this, 0, sizeof(*this));
         }
         dmRender::HRenderContext    m_RenderContext;
+        // Used to generate the vertices of large batches in parallel. May be 0x0
+        dmJobPool::HJobPool         m_JobPool;
         uint32_t                    m_MaxSpriteCount;
         uint32_t                    m_Subpixels : 1;
+        // Draw quad sprites with one instance per sprite, if the graphics backend supports it
+        uint32_t                    m_Instancing : 1;
     };
 
     struct ModelContext
@@ -221,6 +235,14 @@ namespace dmGameSystem
                                                   TilemapContext* tilemap_context,
                                                   SoundContext* sound_context);
 
+    /**
+     * Steps the collision worlds that have been updated since the last call, when PhysicsContext::m_ParallelStep is set.
+     * The worlds are stepped concurrently on the job pool of the context, after which the transforms and the collision
+     * events are applied to the game objects on the calling thread.
+     * @param physics_context Physics context
+     */
+    void StepPhysicsWorlds(PhysicsContext* physics_context);
+
     void GuiGetURLCallback(dmGui::HScene scene, dmMessage::URL* url);
     uintptr_t GuiGetUserDataCallback(dmGui::HScene scene);
     dmhash_t GuiResolvePathCallback(dmGui::HScene scene, const char* path, uint32_t path_size);
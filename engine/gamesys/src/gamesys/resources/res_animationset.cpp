@@ -86,7 +86,7 @@ namespace dmGameSystem
 
     static dmResource::Result RegisterResourceTypeAnimationSet(dmResource::ResourceTypeRegisterContext& ctx)
     {
-        return dmResource::RegisterType(ctx.m_Factory,
+        dmResource::Result r = dmResource::RegisterType(ctx.m_Factory,
                                            ctx.m_Name,
                                            0,
                                            ResAnimationSetPreload,
@@ -94,6 +94,12 @@ namespace dmGameSystem
                                            0,
                                            ResAnimationSetDestroy,
                                            ResAnimationSetRecreate);
+        if (r != dmResource::RESULT_OK)
+        {
+            return r;
+        }
+        // Only holds the preloaded DDF data
+        return dmResource::SetThreadSafeCreate(ctx.m_Factory, ctx.m_Name, true);
     }
 }
 
@@ -20,6 +20,10 @@
 
 namespace dmGameSystem
 {
+    // Lets users of the texture set data tell a reloaded texture set from the previous one,
+    // even if the data is allocated at the same address
+    static uint32_t g_TextureSetVersion = 0;
+
     dmResource::Result AcquireResources(dmPhysics::HContext2D context, dmResource::HFactory factory,  dmGameSystemDDF::TextureSet* texture_set_ddf,
                                         TextureSetResource* tile_set, const char* filename, bool reload)
     {
@@ -33,6 +37,9 @@ namespace dmGameSystem
             }
 
             tile_set->m_TextureSet = texture_set_ddf;
+            if (++g_TextureSetVersion == 0)
+                g_TextureSetVersion = 1;
+            tile_set->m_Version = g_TextureSetVersion;
             uint16_t width = dmGraphics::GetOriginalTextureWidth(tile_set->m_Texture);
             uint16_t height = dmGraphics::GetOriginalTextureHeight(tile_set->m_Texture);
             // Check dimensions
@@ -169,6 +176,7 @@ namespace dmGameSystem
             tile_set->m_HullCollisionGroups.Swap(tmp_tile_set.m_HullCollisionGroups);
             tile_set->m_HullSet = tmp_tile_set.m_HullSet;
             tile_set->m_AnimationIds.Swap(tmp_tile_set.m_AnimationIds);
+            tile_set->m_Version = tmp_tile_set.m_Version;
             params.m_Resource->m_ResourceSize = GetResourceSize(tile_set, params.m_BufferSize);
         }
         else
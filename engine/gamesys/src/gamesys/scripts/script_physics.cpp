@@ -121,6 +121,33 @@ namespace dmGameSystem
      * @variable
      */
 
+    /*# collision event type
+     *
+     * An event in the events buffer passed to the listener set with `physics.set_listener`,
+     * corresponding to a `collision_response` message.
+     *
+     * @name physics.EVENT_TYPE_COLLISION
+     * @variable
+     */
+
+    /*# contact point event type
+     *
+     * An event in the events buffer passed to the listener set with `physics.set_listener`,
+     * corresponding to a `contact_point_response` message.
+     *
+     * @name physics.EVENT_TYPE_CONTACT_POINT
+     * @variable
+     */
+
+    /*# trigger event type
+     *
+     * An event in the events buffer passed to the listener set with `physics.set_listener`,
+     * corresponding to a `trigger_response` message.
+     *
+     * @name physics.EVENT_TYPE_TRIGGER
+     * @variable
+     */
+
     struct PhysicsScriptContext
     {
         dmMessage::HSocket m_Socket;
@@ -1116,6 +1143,104 @@ namespace dmGameSystem
         return 0;
     }
 
+    /*# sets a listener for the physics events of the collection
+     *
+     * Sets a function that is called with the collision, contact point and trigger events of the collection.
+     * The function is called at most once per frame, after the physics update, with the events of all physics
+     * steps of the frame. It is not called in a frame without events.
+     * While a listener is set, the events are not sent as `collision_response`,
+     * `contact_point_response` and `trigger_response` messages. Each event is reported once per pair of
+     * objects, instead of once to each object.
+     *
+     * The events are passed as a buffer with one element per event, and the following streams:
+     *
+     * `type`
+     * : [type:number] `physics.EVENT_TYPE_COLLISION`, `physics.EVENT_TYPE_CONTACT_POINT` or `physics.EVENT_TYPE_TRIGGER`
+     *
+     * `id`
+     * : [type:number] the indices in `ids` of the instance ids of object a and b (2 components)
+     *
+     * `group`
+     * : [type:number] the indices in `ids` of the collision groups of object a and b (2 components)
+     *
+     * `position_a`, `position_b`
+     * : [type:number] the contact point on object a and b for contact points, otherwise the world position of the objects (3 components)
+     *
+     * `normal`
+     * : [type:number] the normal of the contact point, pointing from a to b (3 components)
+     *
+     * `relative_velocity`
+     * : [type:number] the relative velocity of the objects at the contact point (3 components)
+     *
+     * `distance`, `applied_impulse`
+     * : [type:number] the penetration and the impulse of the contact point
+     *
+     * `mass`
+     * : [type:number] the mass of object a and b at a contact point, 0 for static objects (2 components)
+     *
+     * `enter`
+     * : [type:number] 1 if a trigger was entered, 0 if it was exited
+     *
+     * The same buffer is reused for the events of the next frame, so it should not be kept after the call.
+     *
+     * @name physics.set_listener
+     * @param listener [type:function(self, events, ids)|nil] the function to call, or `nil` to send messages again
+     *
+     * `self`
+     * : [type:object] The script instance that set the listener.
+     *
+     * `events`
+     * : [type:buffer] The events of the frame.
+     *
+     * `ids`
+     * : [type:table] The instance ids and group hashes referred to by the `id` and `group` streams.
+     *
+     * @examples
+     *
+     * ```lua
+     * local function physics_listener(self, events, ids)
+     *     local types = buffer.get_stream(events, "type")
+     *     local id = buffer.get_stream(events, "id")
+     *     for i = 1, #types do
+     *         if types[i] == physics.EVENT_TYPE_COLLISION then
+     *             print("collision", ids[id[i * 2 - 1]], ids[id[i * 2]])
+     *         end
+     *     end
+     * end
+     *
+     * function init(self)
+     *     physics.set_listener(physics_listener)
+     * end
+     * ```
+     */
+    static int Physics_SetListener(lua_State* L)
+    {
+        DM_LUA_STACK_CHECK(L, 0);
+
+        dmScript::GetGlobal(L, PHYSICS_CONTEXT_HASH);
+        PhysicsScriptContext* context = (PhysicsScriptContext*)lua_touserdata(L, -1);
+        lua_pop(L, 1);
+
+        dmGameObject::HInstance sender_instance = CheckGoInstance(L);
+        dmGameObject::HCollection collection = dmGameObject::GetCollection(sender_instance);
+        void* world = dmGameObject::GetWorld(collection, context->m_ComponentIndex);
+        if (world == 0x0)
+        {
+            return DM_LUA_ERROR("there is no physics world in the collection of the calling instance");
+        }
+
+        dmScript::LuaCallbackInfo* listener = 0x0;
+        if (!lua_isnil(L, 1))
+        {
+            luaL_checktype(L, 1, LUA_TFUNCTION);
+            listener = dmScript::CreateCallback(L, 1);
+        }
+
+        dmGameSystem::SetCollisionEventListener(world, listener);
+
+        return 0;
+    }
+
     static const luaL_reg PHYSICS_FUNCTIONS[] =
     {
         {"ray_cast",        Physics_RayCastAsync}, // Deprecated
@@ -1135,6 +1260,8 @@ namespace dmGameSystem
         {"set_hflip",       Physics_SetFlipH},
         {"set_vflip",       Physics_SetFlipV},
         {"wakeup",          Physics_Wakeup},
+
+        {"set_listener",    Physics_SetListener},
         {0, 0}
     };
 
@@ -1155,6 +1282,16 @@ namespace dmGameSystem
 
  #undef SETCONSTANT
 
+#define SETEVENTTYPE(name) \
+    lua_pushnumber(L, (lua_Number) dmGameSystem::COLLISION_##name); \
+    lua_setfield(L, -2, #name);\
+
+        SETEVENTTYPE(EVENT_TYPE_COLLISION)
+        SETEVENTTYPE(EVENT_TYPE_CONTACT_POINT)
+        SETEVENTTYPE(EVENT_TYPE_TRIGGER)
+
+ #undef SETEVENTTYPE
+
         lua_pop(L, 1);
 
         bool result = true;
@@ -0,0 +1,8 @@
+components {
+  id: "event-listener-script"
+  component: "/collision_object/event_listener.script"
+}
+components {
+  id: "base-co"
+  component: "/collision_object/sleepy_base.collisionobject"
+}
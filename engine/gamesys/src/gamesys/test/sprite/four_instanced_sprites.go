@@ -0,0 +1,60 @@
+components {
+  id: "sprite0"
+  component: "/sprite/instanced.sprite"
+  position {
+    x: -20.0
+    y: -10.0
+    z: 0.0
+  }
+  rotation {
+    x: 0.0
+    y: 0.0
+    z: 0.0
+    w: 1.0
+  }
+}
+components {
+  id: "sprite1"
+  component: "/sprite/instanced.sprite"
+  position {
+    x: 20.0
+    y: -10.0
+    z: 0.0
+  }
+  rotation {
+    x: 0.0
+    y: 0.0
+    z: 0.3826834
+    w: 0.9238795
+  }
+}
+components {
+  id: "sprite2"
+  component: "/sprite/instanced.sprite"
+  position {
+    x: -20.0
+    y: 10.0
+    z: 0.0
+  }
+  rotation {
+    x: 0.0
+    y: 0.0
+    z: -0.3826834
+    w: 0.9238795
+  }
+}
+components {
+  id: "sprite3"
+  component: "/sprite/instanced.sprite"
+  position {
+    x: 20.0
+    y: 10.0
+    z: 0.0
+  }
+  rotation {
+    x: 0.0
+    y: 0.0
+    z: 0.7071068
+    w: 0.7071068
+  }
+}
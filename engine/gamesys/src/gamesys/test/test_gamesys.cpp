@@ -15,9 +15,11 @@
 #include "../../../../graphics/src/graphics_private.h"
 #include "../../../../resource/src/resource_private.h"
 
+#include "gamesys/resources/res_sprite.h"
 #include "gamesys/resources/res_textureset.h"
 
 #include <stdio.h>
+#include <float.h>
 
 #include <dlib/dstrings.h>
 #include <dlib/time.h>
@@ -681,6 +683,339 @@ TEST_F(SpriteAnimTest, FlipbookAnim)
     ASSERT_TRUE(dmGameObject::Final(m_Collection));
 }
 
+// Spawns game objects with four sprites each, with different positions, rotations and scales
+static void SpawnSpriteGrid(dmResource::HFactory factory, dmGameObject::HCollection collection, uint32_t count, const char* prototype = "/sprite/four_sprites.goc")
+{
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        char id[32];
+        dmSnPrintf(id, sizeof(id), "/go%u", i);
+        Point3 position((i % 20) * 50.0f, (i / 20) * 50.0f, 0.0f);
+        dmGameObject::HInstance go = Spawn(factory, collection, prototype, dmHashString64(id), 0, 0, position, Quat::rotationZ(i * 0.1f), Vector3(1.0f + (i % 3) * 0.5f));
+        ASSERT_NE((void*)0, go);
+    }
+}
+
+// Test that the vertices generated by jobs are the same as the ones generated on the calling thread,
+// and that the corners are the ones of the scalar transform
+TEST_F(SpriteTest, ParallelVertexData)
+{
+    dmGameSystem::SpriteWorld* world = GetSpriteWorld();
+    ASSERT_NE((void*)0, world);
+
+    // More sprites than SPRITE_VERTEX_JOB_MIN_BATCH_SIZE, in a single batch
+    const uint32_t go_count = 300;
+    SpawnSpriteGrid(m_Factory, m_Collection, go_count);
+
+    dmJobPool::HJobPool pool = dmJobPool::New("sprite_test", 3);
+    world->m_JobPool = pool;
+    RenderFrame();
+
+    uint32_t vertex_count = world->m_VertexBufferWritePtr - world->m_VertexBufferData;
+    ASSERT_EQ(go_count * 4 * 4, vertex_count);
+
+    dmArray<dmGameSystem::SpriteVertex> parallel_vertices;
+    parallel_vertices.SetCapacity(vertex_count);
+    parallel_vertices.SetSize(vertex_count);
+    memcpy(parallel_vertices.Begin(), world->m_VertexBufferData, sizeof(dmGameSystem::SpriteVertex) * vertex_count);
+
+    // Generate all vertices again, on the calling thread
+    world->m_JobPool = 0;
+    memset(world->m_QuadGenerations.Begin(), 0, sizeof(uint32_t) * world->m_QuadGenerations.Size());
+    RenderFrame();
+
+    ASSERT_EQ(vertex_count, (uint32_t)(world->m_VertexBufferWritePtr - world->m_VertexBufferData));
+    ASSERT_EQ(0, memcmp(parallel_vertices.Begin(), world->m_VertexBufferData, sizeof(dmGameSystem::SpriteVertex) * vertex_count));
+
+    static const float corners[4][2] = { {-0.5f, -0.5f}, {-0.5f, 0.5f}, {0.5f, 0.5f}, {0.5f, -0.5f} };
+    dmArray<dmGameSystem::SpriteComponent>& components = world->m_Components.m_Objects;
+    for (uint32_t quad = 0; quad < vertex_count / 4; ++quad)
+    {
+        const dmGameSystem::SpriteVertex* v = &parallel_vertices[quad * 4];
+        Point3 center((v[0].x + v[2].x) * 0.5f, (v[0].y + v[2].y) * 0.5f, (v[0].z + v[2].z) * 0.5f);
+
+        // The sprite of the quad is the one positioned at its center
+        const dmGameSystem::SpriteComponent* component = 0;
+        float min_dist = FLT_MAX;
+        for (uint32_t i = 0; i < components.Size(); ++i)
+        {
+            float dist = distSqr(Point3(components[i].m_World.getCol3().getXYZ()), center);
+            if (dist < min_dist)
+            {
+                min_dist = dist;
+                component = &components[i];
+            }
+        }
+        ASSERT_NE((void*)0, component);
+
+        for (uint32_t corner = 0; corner < 4; ++corner)
+        {
+            Vector4 p = component->m_World * Point3(corners[corner][0], corners[corner][1], 0.0f);
+            ASSERT_NEAR(p.getX(), v[corner].x, 0.001f);
+            ASSERT_NEAR(p.getY(), v[corner].y, 0.001f);
+            ASSERT_NEAR(p.getZ(), v[corner].z, 0.001f);
+        }
+    }
+
+    world->m_JobPool = 0;
+    dmJobPool::Delete(pool);
+
+    ASSERT_TRUE(dmGameObject::Final(m_Collection));
+}
+
+static dmGameSystem::SpriteComponent* GetSpriteComponent(dmGameSystem::SpriteWorld* world, dmGameObject::HInstance instance)
+{
+    dmArray<dmGameSystem::SpriteComponent>& components = world->m_Components.m_Objects;
+    for (uint32_t i = 0; i < components.Size(); ++i)
+    {
+        if (components[i].m_Instance == instance)
+            return &components[i];
+    }
+    return 0;
+}
+
+// Returns the vertices of the quad last generated for the sprite
+static const dmGameSystem::SpriteVertex* GetSpriteQuad(dmGameSystem::SpriteWorld* world, const dmGameSystem::SpriteComponent* component)
+{
+    uint32_t quad_count = (world->m_VertexBufferWritePtr - world->m_VertexBufferData) / 4;
+    for (uint32_t i = 0; i < quad_count; ++i)
+    {
+        if (world->m_QuadGenerations[i] == component->m_VertexGeneration)
+            return &world->m_VertexBufferData[i * 4];
+    }
+    return 0;
+}
+
+// Returns true if the vertex buffer holds the vertices last generated
+static bool IsVertexBufferUploaded(dmGameSystem::SpriteWorld* world)
+{
+    uint32_t size = sizeof(dmGameSystem::SpriteVertex) * (world->m_VertexBufferWritePtr - world->m_VertexBufferData);
+    void* uploaded = dmGraphics::MapVertexBuffer(world->m_VertexBuffer, dmGraphics::BUFFER_ACCESS_READ_ONLY);
+    bool result = memcmp(uploaded, world->m_VertexBufferData, size) == 0;
+    dmGraphics::UnmapVertexBuffer(world->m_VertexBuffer);
+    return result;
+}
+
+// Test that only the sprites whose vertex data changed since the last frame get new vertices,
+// and that the vertex buffer is only uploaded if any sprite changed
+TEST_F(SpriteTest, VertexGenerations)
+{
+    dmGameSystem::SpriteWorld* world = GetSpriteWorld();
+    ASSERT_NE((void*)0, world);
+
+    dmGameObject::HInstance go_static = Spawn(m_Factory, m_Collection, "/sprite/valid_sprite.goc", dmHashString64("/static"), 0, 0, Point3(0, 0, 0), Quat(0, 0, 0, 1), Vector3(1, 1, 1));
+    dmGameObject::HInstance go_moving = Spawn(m_Factory, m_Collection, "/sprite/valid_sprite.goc", dmHashString64("/moving"), 0, 0, Point3(50, 0, 0), Quat(0, 0, 0, 1), Vector3(1, 1, 1));
+    dmGameObject::HInstance go_animated = Spawn(m_Factory, m_Collection, "/sprite/cursor.goc", dmHashString64("/animated"), 0, 0, Point3(100, 0, 0), Quat(0, 0, 0, 1), Vector3(1, 1, 1));
+    ASSERT_NE((void*)0, go_static);
+    ASSERT_NE((void*)0, go_moving);
+    ASSERT_NE((void*)0, go_animated);
+
+    dmGameSystem::SpriteComponent* sprite_static = GetSpriteComponent(world, go_static);
+    dmGameSystem::SpriteComponent* sprite_moving = GetSpriteComponent(world, go_moving);
+    dmGameSystem::SpriteComponent* sprite_animated = GetSpriteComponent(world, go_animated);
+
+    RenderFrame();
+    const uint32_t vertex_count = 3 * 4;
+    ASSERT_EQ(vertex_count, (uint32_t)(world->m_VertexBufferWritePtr - world->m_VertexBufferData));
+    ASSERT_TRUE(IsVertexBufferUploaded(world));
+
+    dmGameSystem::SpriteVertex vertices[vertex_count];
+    memcpy(vertices, world->m_VertexBufferData, sizeof(vertices));
+    uint32_t generation_static = sprite_static->m_VertexGeneration;
+    uint32_t generation_moving = sprite_moving->m_VertexGeneration;
+    uint32_t generation_animated = sprite_animated->m_VertexGeneration;
+    uint32_t world_generation = world->m_VertexGeneration;
+
+    // Unchanged: no vertex is written, and the buffer is not uploaded again
+    for (uint32_t i = 0; i < vertex_count; ++i)
+        world->m_VertexBufferData[i].x = -12345.0f;
+    RenderFrame();
+    ASSERT_EQ(world_generation, world->m_VertexGeneration);
+    for (uint32_t i = 0; i < vertex_count; ++i)
+        ASSERT_EQ(-12345.0f, world->m_VertexBufferData[i].x);
+    ASSERT_FALSE(IsVertexBufferUploaded(world));
+    memcpy(world->m_VertexBufferData, vertices, sizeof(vertices));
+    ASSERT_TRUE(IsVertexBufferUploaded(world));
+
+    // Moved
+    dmGameObject::SetPosition(go_moving, Point3(50, 20, 0));
+    RenderFrame();
+    ASSERT_EQ(generation_static, sprite_static->m_VertexGeneration);
+    ASSERT_EQ(generation_animated, sprite_animated->m_VertexGeneration);
+    ASSERT_NE(generation_moving, sprite_moving->m_VertexGeneration);
+    const dmGameSystem::SpriteVertex* quad = GetSpriteQuad(world, sprite_moving);
+    ASSERT_NE((void*)0, quad);
+    for (uint32_t i = 0; i < 4; ++i)
+    {
+        Vector4 p = sprite_moving->m_World * Point3(i < 2 ? -0.5f : 0.5f, (i == 1 || i == 2) ? 0.5f : -0.5f, 0.0f);
+        ASSERT_NEAR(p.getX(), quad[i].x, 0.001f);
+        ASSERT_NEAR(p.getY(), quad[i].y, 0.001f);
+    }
+    ASSERT_TRUE(IsVertexBufferUploaded(world));
+    generation_moving = sprite_moving->m_VertexGeneration;
+
+    // Flipped: the texture coordinates of the quad are mirrored
+    const dmGameSystem::SpriteVertex* static_quad = GetSpriteQuad(world, sprite_static);
+    ASSERT_NE((void*)0, static_quad);
+    dmGameSystem::SpriteVertex unflipped[4];
+    memcpy(unflipped, static_quad, sizeof(unflipped));
+
+    dmMessage::URL msg_url;
+    dmMessage::ResetURL(&msg_url);
+    msg_url.m_Socket = dmGameObject::GetMessageSocket(m_Collection);
+    msg_url.m_Path = dmHashString64("/static");
+    msg_url.m_Fragment = dmHashString64("sprite");
+    dmGameSystemDDF::SetFlipHorizontal flip_msg;
+    flip_msg.m_Flip = 1;
+    ASSERT_EQ(dmMessage::RESULT_OK, dmMessage::Post(&msg_url, &msg_url, dmGameSystemDDF::SetFlipHorizontal::m_DDFDescriptor->m_NameHash, (uintptr_t)go_static, (uintptr_t)dmGameSystemDDF::SetFlipHorizontal::m_DDFDescriptor, &flip_msg, sizeof(flip_msg), 0));
+    RenderFrame();
+    ASSERT_NE(generation_static, sprite_static->m_VertexGeneration);
+    ASSERT_EQ(generation_moving, sprite_moving->m_VertexGeneration);
+    ASSERT_EQ(generation_animated, sprite_animated->m_VertexGeneration);
+    static_quad = GetSpriteQuad(world, sprite_static);
+    ASSERT_NE((void*)0, static_quad);
+    for (uint32_t i = 0; i < 4; ++i)
+    {
+        ASSERT_EQ(unflipped[i].x, static_quad[i].x);
+        ASSERT_EQ(unflipped[i].y, static_quad[i].y);
+        ASSERT_EQ(unflipped[3 - i].u, static_quad[i].u);
+        ASSERT_EQ(unflipped[3 - i].v, static_quad[i].v);
+    }
+    ASSERT_TRUE(IsVertexBufferUploaded(world));
+    generation_static = sprite_static->m_VertexGeneration;
+
+    // Animated: the flipbook animation (1 fps) moves on to the next frame
+    const dmGameSystem::SpriteVertex* animated_quad = GetSpriteQuad(world, sprite_animated);
+    ASSERT_NE((void*)0, animated_quad);
+    dmGameSystem::SpriteVertex first_frame[4];
+    memcpy(first_frame, animated_quad, sizeof(first_frame));
+
+    m_UpdateContext.m_DT = 1.0f;
+    RenderFrame();
+    ASSERT_EQ(generation_static, sprite_static->m_VertexGeneration);
+    ASSERT_EQ(generation_moving, sprite_moving->m_VertexGeneration);
+    ASSERT_NE(generation_animated, sprite_animated->m_VertexGeneration);
+    ASSERT_EQ(1u, sprite_animated->m_CurrentAnimationFrame);
+    animated_quad = GetSpriteQuad(world, sprite_animated);
+    ASSERT_NE((void*)0, animated_quad);
+    ASSERT_NE(0, memcmp(first_frame, animated_quad, sizeof(first_frame)));
+    ASSERT_TRUE(IsVertexBufferUploaded(world));
+
+    // A reloaded texture set gives all its sprites new vertices, even if the texture set data has the same address
+    world_generation = world->m_VertexGeneration;
+    generation_animated = sprite_animated->m_VertexGeneration;
+    sprite_static->m_Resource->m_TextureSet->m_Version++;
+    m_UpdateContext.m_DT = 0.0f;
+    RenderFrame();
+    ASSERT_NE(generation_static, sprite_static->m_VertexGeneration);
+    ASSERT_NE(generation_moving, sprite_moving->m_VertexGeneration);
+    ASSERT_EQ(generation_animated, sprite_animated->m_VertexGeneration);
+    ASSERT_EQ(world_generation + 2, world->m_VertexGeneration);
+
+    ASSERT_TRUE(dmGameObject::Final(m_Collection));
+}
+
+// Test that each sprite is drawn as one instance with its world transform, in a single draw call
+TEST_F(SpriteInstancingTest, InstanceData)
+{
+    dmGameSystem::SpriteWorld* world = GetSpriteWorld();
+    ASSERT_NE((void*)0, world);
+    ASSERT_TRUE(world->m_UseInstancing);
+
+    const uint32_t go_count = 3;
+    SpawnSpriteGrid(m_Factory, m_Collection, go_count, "/sprite/four_instanced_sprites.goc");
+
+    RenderFrame();
+    ASSERT_EQ(1u, dmGraphics::GetDrawCount());
+
+    // No vertices are generated per sprite
+    ASSERT_EQ(world->m_VertexBufferData, world->m_VertexBufferWritePtr);
+
+    const uint32_t sprite_count = go_count * 4;
+    ASSERT_EQ(sprite_count, (uint32_t)(world->m_InstanceBufferWritePtr - world->m_InstanceBufferData));
+
+    // The instance records are uploaded as they are
+    ASSERT_EQ(1u, world->m_RenderObjectsInUse);
+    ASSERT_EQ(1u, world->m_InstanceVertexBuffers.Size());
+    ASSERT_EQ(sprite_count, world->m_RenderObjects[0]->m_InstanceCount);
+    void* uploaded = dmGraphics::MapVertexBuffer(world->m_InstanceVertexBuffers[0], dmGraphics::BUFFER_ACCESS_READ_ONLY);
+    ASSERT_NE((void*)0, uploaded);
+    ASSERT_EQ(0, memcmp(world->m_InstanceBufferData, uploaded, sizeof(dmGameSystem::SpriteInstance) * sprite_count));
+    ASSERT_TRUE(dmGraphics::UnmapVertexBuffer(world->m_InstanceVertexBuffers[0]));
+
+    dmArray<dmGameSystem::SpriteComponent>& components = world->m_Components.m_Objects;
+    ASSERT_EQ(sprite_count, components.Size());
+    for (uint32_t i = 0; i < sprite_count; ++i)
+    {
+        const dmGameSystem::SpriteInstance& instance = world->m_InstanceBufferData[i];
+        Point3 position(instance.m_Position[0], instance.m_Position[1], instance.m_Position[2]);
+
+        // The sprite of the instance is the one at the same position
+        const dmGameSystem::SpriteComponent* component = 0;
+        for (uint32_t j = 0; j < components.Size(); ++j)
+        {
+            if (distSqr(Point3(components[j].m_World.getCol3().getXYZ()), position) < 0.0001f)
+            {
+                component = &components[j];
+                break;
+            }
+        }
+        ASSERT_NE((void*)0, component);
+
+        Vector3 axis_x = component->m_World.getCol0().getXYZ();
+        Vector3 axis_y = component->m_World.getCol1().getXYZ();
+        ASSERT_EQ(axis_x.getX(), instance.m_AxisX[0]);
+        ASSERT_EQ(axis_x.getY(), instance.m_AxisX[1]);
+        ASSERT_EQ(axis_x.getZ(), instance.m_AxisX[2]);
+        ASSERT_EQ(axis_y.getX(), instance.m_AxisY[0]);
+        ASSERT_EQ(axis_y.getY(), instance.m_AxisY[1]);
+        ASSERT_EQ(axis_y.getZ(), instance.m_AxisY[2]);
+    }
+
+    ASSERT_TRUE(dmGameObject::Final(m_Collection));
+}
+
+// Test that sprites with a material that doesn't read the instance attributes are drawn from generated vertices
+TEST_F(SpriteInstancingTest, NonInstancingMaterial)
+{
+    dmGameSystem::SpriteWorld* world = GetSpriteWorld();
+    ASSERT_NE((void*)0, world);
+    ASSERT_TRUE(world->m_UseInstancing);
+
+    const uint32_t go_count = 3;
+    SpawnSpriteGrid(m_Factory, m_Collection, go_count, "/sprite/four_sprites.goc");
+    SpawnSpriteGrid(m_Factory, m_Collection, go_count, "/sprite/four_instanced_sprites.goc");
+
+    RenderFrame();
+    ASSERT_EQ(2u, world->m_RenderObjectsInUse);
+
+    // Each material gets its own batch, only the instancing material is drawn instanced
+    const uint32_t sprite_count = go_count * 4;
+    ASSERT_EQ(sprite_count * 4, (uint32_t)(world->m_VertexBufferWritePtr - world->m_VertexBufferData));
+    ASSERT_EQ(sprite_count, (uint32_t)(world->m_InstanceBufferWritePtr - world->m_InstanceBufferData));
+    ASSERT_TRUE(IsVertexBufferUploaded(world));
+
+    uint32_t instanced_count = 0;
+    for (uint32_t i = 0; i < world->m_RenderObjectsInUse; ++i)
+    {
+        dmRender::RenderObject* ro = world->m_RenderObjects[i];
+        if (ro->m_InstanceCount != 0)
+        {
+            ASSERT_EQ(sprite_count, ro->m_InstanceCount);
+            ASSERT_EQ(world->m_CornerVertexBuffer, ro->m_VertexBuffer);
+            ++instanced_count;
+        }
+        else
+        {
+            ASSERT_EQ(world->m_VertexBuffer, ro->m_VertexBuffer);
+            ASSERT_EQ(sprite_count * 6, ro->m_VertexCount);
+        }
+    }
+    ASSERT_EQ(1u, instanced_count);
+
+    ASSERT_TRUE(dmGameObject::Final(m_Collection));
+}
+
 // Test that animation done event reaches callback
 TEST_F(ParticleFxTest, PlayAnim)
 {
@@ -1375,6 +1710,133 @@ TEST_P(BoxRenderTest, BoxRender)
     ASSERT_TRUE(dmGameObject::Final(m_Collection));
 }
 
+static bool IsVertexBufferUploaded(dmGameSystem::GuiWorld* world)
+{
+    uint32_t size = sizeof(dmGameSystem::BoxVertex) * world->m_ClientVertexBuffer.Size();
+    void* uploaded = dmGraphics::MapVertexBuffer(world->m_VertexBuffer, dmGraphics::BUFFER_ACCESS_READ_ONLY);
+    bool result = memcmp(uploaded, world->m_ClientVertexBuffer.Begin(), size) == 0;
+    dmGraphics::UnmapVertexBuffer(world->m_VertexBuffer);
+    return result;
+}
+
+// Test that only the batches with changed nodes get new vertices, and that the vertex buffer
+// is only uploaded if any batch changed. The boxes alternate textures, so each is a batch of its own.
+TEST_F(GuiTest, ReuseBatchVertices)
+{
+    ASSERT_TRUE(dmGameObject::Init(m_Collection));
+
+    dmGameObject::HInstance go = Spawn(m_Factory, m_Collection, "/gui/render_reuse.goc", dmHashString64("/go"), 0, 0, Point3(0, 0, 0), Quat(0, 0, 0, 1), Vector3(1, 1, 1));
+    ASSERT_NE((void*)0, go);
+
+    dmGameSystem::GuiWorld* world = (dmGameSystem::GuiWorld*)m_GuiContext.m_Worlds[0];
+    dmGui::HScene scene = world->m_Components[0]->m_Scene;
+
+    RenderFrame();
+    ASSERT_EQ(3u, world->m_BatchVertexStates.Size());
+    ASSERT_FALSE(world->m_VertexBufferDirty);
+    ASSERT_TRUE(IsVertexBufferUploaded(world));
+
+    const uint32_t vertex_count = world->m_ClientVertexBuffer.Size();
+    ASSERT_LT(0u, vertex_count);
+    ASSERT_EQ(vertex_count, world->m_VertexBufferUploadCount);
+
+    dmArray<dmGameSystem::BoxVertex> vertices;
+    vertices.SetCapacity(vertex_count);
+    vertices.SetSize(vertex_count);
+    memcpy(vertices.Begin(), world->m_ClientVertexBuffer.Begin(), vertex_count * sizeof(dmGameSystem::BoxVertex));
+
+    // Unchanged: no vertex is written, and the buffer is not uploaded again
+    for (uint32_t i = 0; i < vertex_count; ++i)
+        world->m_ClientVertexBuffer[i].m_Position[0] = -12345.0f;
+    RenderFrame();
+    ASSERT_EQ(vertex_count, world->m_ClientVertexBuffer.Size());
+    for (uint32_t i = 0; i < vertex_count; ++i)
+        ASSERT_EQ(-12345.0f, world->m_ClientVertexBuffer[i].m_Position[0]);
+    ASSERT_FALSE(IsVertexBufferUploaded(world));
+
+    // Moving the middle box only regenerates its own batch, and the whole buffer is uploaded
+    dmGui::HNode box2 = dmGui::GetNodeById(scene, "box2");
+    ASSERT_NE((dmGui::HNode)0, box2);
+    dmGui::SetNodePosition(scene, box2, Point3(15.0f, 0.0f, 0.0f));
+    RenderFrame();
+    ASSERT_EQ(vertex_count, world->m_ClientVertexBuffer.Size());
+    ASSERT_EQ(vertex_count, world->m_VertexBufferUploadCount);
+    ASSERT_FALSE(world->m_VertexBufferDirty);
+    ASSERT_TRUE(IsVertexBufferUploaded(world));
+
+    const dmGameSystem::GuiBatchVertexState& batch = world->m_BatchVertexStates[1];
+    ASSERT_LT(0u, batch.m_VertexCount);
+    for (uint32_t i = 0; i < vertex_count; ++i)
+    {
+        const dmGameSystem::BoxVertex& v = world->m_ClientVertexBuffer[i];
+        if (i >= batch.m_VertexStart && i < batch.m_VertexStart + batch.m_VertexCount)
+        {
+            // The box moved 5 units along x, everything else is unchanged
+            ASSERT_NEAR(vertices[i].m_Position[0] + 5.0f, v.m_Position[0], 0.0001f);
+            ASSERT_EQ(vertices[i].m_Position[1], v.m_Position[1]);
+            ASSERT_EQ(vertices[i].m_UV[0], v.m_UV[0]);
+            ASSERT_EQ(vertices[i].m_UV[1], v.m_UV[1]);
+        }
+        else
+        {
+            ASSERT_EQ(-12345.0f, v.m_Position[0]);
+        }
+    }
+
+    ASSERT_TRUE(dmGameObject::Final(m_Collection));
+}
+
+// Renders nine-sliced box nodes and pie nodes that all move every frame.
+// Built with DM_GAMESYS_BENCHMARK, it renders more frames and prints the vertex throughput
+TEST_F(GuiTest, RenderMovingNodes)
+{
+    ASSERT_TRUE(dmGameObject::Init(m_Collection));
+
+    dmGameObject::HInstance go = Spawn(m_Factory, m_Collection, "/gui/render_bench.goc", dmHashString64("/go"), 0, 0, Point3(0, 0, 0), Quat(0, 0, 0, 1), Vector3(1, 1, 1));
+    ASSERT_NE((void*)0, go);
+
+    dmGameSystem::GuiWorld* world = (dmGameSystem::GuiWorld*)m_GuiContext.m_Worlds[0];
+
+#if defined(DM_GAMESYS_BENCHMARK)
+    const uint32_t frame_count = 100;
+    uint64_t elapsed = 0;
+#else
+    const uint32_t frame_count = 2;
+#endif
+    uint64_t vertex_count = 0;
+    for (uint32_t i = 0; i < frame_count; ++i)
+    {
+        ASSERT_TRUE(dmGameObject::Update(m_Collection, &m_UpdateContext));
+
+        dmRender::RenderListBegin(m_RenderContext);
+#if defined(DM_GAMESYS_BENCHMARK)
+        uint64_t start = dmTime::GetTime();
+        dmGameObject::Render(m_Collection);
+        elapsed += dmTime::GetTime() - start;
+#else
+        dmGameObject::Render(m_Collection);
+#endif
+        dmRender::RenderListEnd(m_RenderContext);
+        dmRender::DrawRenderList(m_RenderContext, 0x0, 0x0);
+
+        vertex_count += world->m_ClientVertexBuffer.Size();
+
+        ASSERT_TRUE(dmGameObject::PostUpdate(m_Collection));
+        dmGraphics::Flip(m_GraphicsContext);
+    }
+
+    // 400 nine-sliced boxes of 54 vertices each, and 400 pies
+    ASSERT_LT(400u * 54u * frame_count, vertex_count);
+
+#if defined(DM_GAMESYS_BENCHMARK)
+    float ms = (elapsed ? elapsed : 1) / 1000.0f;
+    printf("Gui render: %u vertices per frame, %.2f ms per frame, %.0f vertices/ms\n",
+        (uint32_t)(vertex_count / frame_count), ms / frame_count, vertex_count / ms);
+#endif
+
+    ASSERT_TRUE(dmGameObject::Final(m_Collection));
+}
+
 /* Gamepad connected */
 
 TEST_F(GamepadConnectedTest, TestGamepadConnectedInputEvent)
@@ -1484,8 +1946,215 @@ TEST_F(CollisionObject2DTest, WakingCollisionObjectTest)
     }
 
     ASSERT_TRUE(dmGameObject::Final(m_Collection));
+}
+
+// Test case for delivering the physics events to a listener instead of as messages
+TEST_F(CollisionObject2DTest, EventListenerTest)
+{
+    dmHashEnableReverseHash(true);
+    lua_State* L = dmScript::GetLuaState(m_ScriptContext);
+
+    dmGameSystem::ScriptLibContext scriptlibcontext;
+    scriptlibcontext.m_Factory = m_Factory;
+    scriptlibcontext.m_Register = m_Register;
+    scriptlibcontext.m_LuaState = L;
+    dmGameSystem::InitializeScriptLibs(scriptlibcontext);
+
+    // the base sets the listener, and the bodies are placed standing on it
+    dmGameObject::HInstance base_go = Spawn(m_Factory, m_Collection, "/collision_object/event_listener_base.goc", dmHashString64("/base-go"), 0, 0, Point3(50, -10, 0), Quat(0, 0, 0, 1), Vector3(1, 1, 1));
+    ASSERT_NE((void*)0, base_go);
+    dmGameObject::HInstance body1_go = Spawn(m_Factory, m_Collection, "/collision_object/sleepy_body.goc", dmHashString64("/body1-go"), 0, 0, Point3(10, 10, 0), Quat(0, 0, 0, 1), Vector3(1, 1, 1));
+    ASSERT_NE((void*)0, body1_go);
+    dmGameObject::HInstance body2_go = Spawn(m_Factory, m_Collection, "/collision_object/sleepy_body.goc", dmHashString64("/body2-go"), 0, 0, Point3(50, 10, 0), Quat(0, 0, 0, 1), Vector3(1, 1, 1));
+    ASSERT_NE((void*)0, body2_go);
+
+    // iterate until the lua env signals the end of the test, which fails the test if it doesn't happen
+    bool tests_done = false;
+    for (uint32_t i = 0; i < 100 && !tests_done; ++i)
+    {
+        ASSERT_TRUE(dmGameObject::Update(m_Collection, &m_UpdateContext));
+        ASSERT_TRUE(dmGameObject::PostUpdate(m_Collection));
+
+        lua_getglobal(L, "tests_done");
+        tests_done = lua_toboolean(L, -1);
+        lua_pop(L, 1);
+    }
+    ASSERT_TRUE(tests_done);
+
+    ASSERT_TRUE(dmGameObject::Final(m_Collection));
+}
+
+// Test case for a listener that clears and replaces itself while it's being called
+TEST_F(CollisionObject2DTest, EventListenerReplaceTest)
+{
+    dmHashEnableReverseHash(true);
+    lua_State* L = dmScript::GetLuaState(m_ScriptContext);
+
+    dmGameSystem::ScriptLibContext scriptlibcontext;
+    scriptlibcontext.m_Factory = m_Factory;
+    scriptlibcontext.m_Register = m_Register;
+    scriptlibcontext.m_LuaState = L;
+    dmGameSystem::InitializeScriptLibs(scriptlibcontext);
+
+    dmGameObject::HInstance base_go = Spawn(m_Factory, m_Collection, "/collision_object/event_listener_replace_base.goc", dmHashString64("/base-go"), 0, 0, Point3(50, -10, 0), Quat(0, 0, 0, 1), Vector3(1, 1, 1));
+    ASSERT_NE((void*)0, base_go);
+    dmGameObject::HInstance body_go = Spawn(m_Factory, m_Collection, "/collision_object/sleepy_body.goc", dmHashString64("/body-go"), 0, 0, Point3(50, 10, 0), Quat(0, 0, 0, 1), Vector3(1, 1, 1));
+    ASSERT_NE((void*)0, body_go);
+
+    bool tests_done = false;
+    for (uint32_t i = 0; i < 100 && !tests_done; ++i)
+    {
+        ASSERT_TRUE(dmGameObject::Update(m_Collection, &m_UpdateContext));
+        ASSERT_TRUE(dmGameObject::PostUpdate(m_Collection));
+
+        lua_getglobal(L, "tests_done");
+        tests_done = lua_toboolean(L, -1);
+        lua_pop(L, 1);
+    }
+    ASSERT_TRUE(tests_done);
+
+    ASSERT_TRUE(dmGameObject::Final(m_Collection));
+}
+
+// Test case for a dynamic body that is held in place by setting the position of its game object every frame
+TEST_F(CollisionObject2DDynamicTransformsTest, PinnedBodyTest)
+{
+    const Point3 pin(10, 100, 0);
+    dmGameObject::HInstance body_go = Spawn(m_Factory, m_Collection, "/collision_object/sleepy_body.goc", dmHashString64("/body-go"), 0, 0, pin, Quat(0, 0, 0, 1), Vector3(1, 1, 1));
+    ASSERT_NE((void*)0, body_go);
+
+    for (uint32_t i = 0; i < 60; ++i)
+    {
+        // the same position every frame, which is where the object was before the last step
+        dmGameObject::SetPosition(body_go, pin);
+        ASSERT_TRUE(dmGameObject::Update(m_Collection, &m_UpdateContext));
+        ASSERT_TRUE(dmGameObject::PostUpdate(m_Collection));
+    }
+
+    // the body only falls during the last step, instead of for the full second (5 units)
+    ASSERT_NEAR(pin.getY(), dmGameObject::GetPosition(body_go).getY(), 0.5f);
+    ASSERT_NEAR(pin.getX(), dmGameObject::GetPosition(body_go).getX(), 0.001f);
+
+    ASSERT_TRUE(dmGameObject::Final(m_Collection));
+}
+
+// Test case for stepping the physics worlds on a job pool, with the events and transforms applied afterwards
+TEST_F(CollisionObject2DParallelTest, ParallelStepTest)
+{
+    dmHashEnableReverseHash(true);
+    lua_State* L = dmScript::GetLuaState(m_ScriptContext);
+
+    dmGameSystem::ScriptLibContext scriptlibcontext;
+    scriptlibcontext.m_Factory = m_Factory;
+    scriptlibcontext.m_Register = m_Register;
+    scriptlibcontext.m_LuaState = L;
+    dmGameSystem::InitializeScriptLibs(scriptlibcontext);
+
+    m_PhysicsContext.m_JobPool = dmJobPool::New("physics_test", 2);
+
+    // same setup as the EventListenerTest, but with the first body dropped onto the base
+    dmGameObject::HInstance base_go = Spawn(m_Factory, m_Collection, "/collision_object/event_listener_base.goc", dmHashString64("/base-go"), 0, 0, Point3(50, -10, 0), Quat(0, 0, 0, 1), Vector3(1, 1, 1));
+    ASSERT_NE((void*)0, base_go);
+    dmGameObject::HInstance body1_go = Spawn(m_Factory, m_Collection, "/collision_object/sleepy_body.goc", dmHashString64("/body1-go"), 0, 0, Point3(10, 30, 0), Quat(0, 0, 0, 1), Vector3(1, 1, 1));
+    ASSERT_NE((void*)0, body1_go);
+    dmGameObject::HInstance body2_go = Spawn(m_Factory, m_Collection, "/collision_object/sleepy_body.goc", dmHashString64("/body2-go"), 0, 0, Point3(50, 10, 0), Quat(0, 0, 0, 1), Vector3(1, 1, 1));
+    ASSERT_NE((void*)0, body2_go);
+
+    bool tests_done = false;
+    for (uint32_t i = 0; i < 100 && !tests_done; ++i)
+    {
+        ASSERT_TRUE(dmGameObject::Update(m_Collection, &m_UpdateContext));
+        dmGameSystem::StepPhysicsWorlds(&m_PhysicsContext);
+        ASSERT_TRUE(dmGameObject::PostUpdate(m_Collection));
+
+        lua_getglobal(L, "tests_done");
+        tests_done = lua_toboolean(L, -1);
+        lua_pop(L, 1);
+    }
+    ASSERT_TRUE(tests_done);
+
+    // the transform of the falling body has been written back
+    ASSERT_GT(30.0f, dmGameObject::GetWorldPosition(body1_go).getY());
+    ASSERT_TRUE(m_PhysicsContext.m_StepWorlds.Empty());
+
+    ASSERT_TRUE(dmGameObject::Final(m_Collection));
+
+    dmJobPool::Delete(m_PhysicsContext.m_JobPool);
+    m_PhysicsContext.m_JobPool = 0x0;
 }
 
+// Runs bodies falling in several collections, where the first collection is updated twice per frame, as by a collection
+// proxy with a fixed time step. Returns the positions of the bodies.
+static void RunFallingBodies(dmResource::HFactory factory, dmGameObject::HRegister regist, dmGameSystem::PhysicsContext* physics_context, const dmGameObject::UpdateContext* update_context, Point3* positions)
+{
+    const uint32_t collection_count = 3;
+    const uint32_t body_count = 2;
+    dmGameObject::HCollection collections[collection_count];
+    dmGameObject::HInstance bodies[collection_count * body_count];
+    for (uint32_t i = 0; i < collection_count; ++i)
+    {
+        char name[32];
+        dmSnPrintf(name, sizeof(name), "falling%u", i);
+        collections[i] = dmGameObject::NewCollection(name, factory, regist, 1024);
+        for (uint32_t j = 0; j < body_count; ++j)
+        {
+            dmSnPrintf(name, sizeof(name), "/body%u-go", j);
+            bodies[i * body_count + j] = Spawn(factory, collections[i], "/collision_object/sleepy_body.goc", dmHashString64(name), 0, 0, Point3(10.0f + 40.0f * j, 10.0f * (i + 1), 0), Quat(0, 0, 0, 1), Vector3(1, 1, 1));
+            ASSERT_NE((void*)0, bodies[i * body_count + j]);
+        }
+    }
+
+    for (uint32_t frame = 0; frame < 30; ++frame)
+    {
+        ASSERT_TRUE(dmGameObject::Update(collections[0], update_context));
+        for (uint32_t i = 0; i < collection_count; ++i)
+        {
+            ASSERT_TRUE(dmGameObject::Update(collections[i], update_context));
+        }
+        dmGameSystem::StepPhysicsWorlds(physics_context);
+        for (uint32_t i = 0; i < collection_count; ++i)
+        {
+            ASSERT_TRUE(dmGameObject::PostUpdate(collections[i]));
+        }
+    }
+    ASSERT_TRUE(physics_context->m_StepWorlds.Empty());
+
+    for (uint32_t i = 0; i < collection_count * body_count; ++i)
+    {
+        positions[i] = dmGameObject::GetWorldPosition(bodies[i]);
+    }
+    for (uint32_t i = 0; i < collection_count; ++i)
+    {
+        dmGameObject::DeleteCollection(collections[i]);
+    }
+    dmGameObject::PostUpdate(regist);
+}
+
+// Test case for stepping the worlds of several collections on a job pool, with the same result as stepping them in their updates
+TEST_F(CollisionObject2DParallelTest, ParallelStepCollections)
+{
+    Point3 expected[6];
+    m_PhysicsContext.m_ParallelStep = false;
+    RunFallingBodies(m_Factory, m_Register, &m_PhysicsContext, &m_UpdateContext, expected);
+
+    Point3 positions[6];
+    m_PhysicsContext.m_ParallelStep = true;
+    m_PhysicsContext.m_JobPool = dmJobPool::New("physics_test", 2);
+    RunFallingBodies(m_Factory, m_Register, &m_PhysicsContext, &m_UpdateContext, positions);
+    dmJobPool::Delete(m_PhysicsContext.m_JobPool);
+    m_PhysicsContext.m_JobPool = 0x0;
+
+    for (uint32_t i = 0; i < 6; ++i)
+    {
+        // The bodies have fallen
+        ASSERT_GT(10.0f * (i / 2 + 1), expected[i].getY());
+        ASSERT_NEAR(expected[i].getX(), positions[i].getX(), 0.0001f);
+        ASSERT_NEAR(expected[i].getY(), positions[i].getY(), 0.0001f);
+    }
+    // The first collection has been stepped twice per frame
+    ASSERT_GT(expected[2].getY() - 10.0f, expected[0].getY());
+}
+
 // Test case for collision-object properties
 TEST_F(CollisionObject2DTest, PropertiesTest)
 {
@@ -23,6 +23,7 @@
 #include "gamesys/gamesys.h"
 #include "gamesys/scripts/script_buffer.h"
 #include "../components/comp_gui_private.h" // BoxVertex
+#include "../components/comp_sprite_private.h" // SpriteWorld
 
 #include <dmsdk/script/script.h>
 #include <dmsdk/gamesys/script.h>
@@ -40,7 +41,11 @@ struct Params
 struct ProjectOptions {
   uint32_t m_MaxCollisionCount;
   uint32_t m_MaxContactPointCount;
+  uint32_t m_MaxSpriteCount;
+  bool m_SpriteInstancing;
   bool m_3D;
+  bool m_ParallelStep;
+  bool m_AllowDynamicTransforms;
 };
 
 template<typename T>
@@ -69,6 +74,7 @@ public:
         this->m_projectOptions.m_MaxCollisionCount = 0;
         this->m_projectOptions.m_MaxContactPointCount = 0;
         this->m_projectOptions.m_3D = false;
+        this->m_projectOptions.m_MaxSpriteCount = 32;
     }
 protected:
     virtual void SetUp();
@@ -115,6 +121,24 @@ public:
     }
 };
 
+// steps the physics worlds in dmGameSystem::StepPhysicsWorlds instead of in the collection update
+class CollisionObject2DParallelTest : public CollisionObject2DTest
+{
+public:
+    CollisionObject2DParallelTest() {
+      m_projectOptions.m_ParallelStep = true;
+    }
+};
+
+// lets the game objects move their dynamic bodies
+class CollisionObject2DDynamicTransformsTest : public CollisionObject2DTest
+{
+public:
+    CollisionObject2DDynamicTransformsTest() {
+      m_projectOptions.m_AllowDynamicTransforms = true;
+    }
+};
+
 class ResourceTest : public GamesysTest<const char*>
 {
 public:
@@ -196,6 +220,45 @@ public:
     virtual ~SpriteAnimTest() {}
 };
 
+// renders enough sprites to split the vertex generation of a batch into jobs
+class SpriteTest : public GamesysTest<const char*>
+{
+public:
+    SpriteTest() {
+      m_projectOptions.m_MaxSpriteCount = 2048;
+    }
+protected:
+    dmGameSystem::SpriteWorld* GetSpriteWorld()
+    {
+        dmResource::ResourceType resource_type;
+        if (dmResource::GetTypeFromExtension(m_Factory, "spritec", &resource_type) != dmResource::RESULT_OK)
+            return 0;
+        uint32_t component_index;
+        if (!dmGameObject::FindComponentType(m_Register, resource_type, &component_index))
+            return 0;
+        return (dmGameSystem::SpriteWorld*)dmGameObject::GetWorld(m_Collection, component_index);
+    }
+
+    void RenderFrame()
+    {
+        ASSERT_TRUE(dmGameObject::Update(m_Collection, &m_UpdateContext));
+        dmRender::RenderListBegin(m_RenderContext);
+        dmGameObject::Render(m_Collection);
+        dmRender::RenderListEnd(m_RenderContext);
+        dmRender::DrawRenderList(m_RenderContext, 0x0, 0x0);
+        ASSERT_TRUE(dmGameObject::PostUpdate(m_Collection));
+        dmGraphics::Flip(m_GraphicsContext);
+    }
+};
+
+class SpriteInstancingTest : public SpriteTest
+{
+public:
+    SpriteInstancingTest() {
+      m_projectOptions.m_SpriteInstancing = true;
+    }
+};
+
 class ParticleFxTest : public GamesysTest<const char*>
 {
 public:
@@ -293,6 +356,17 @@ class GuiTest : public GamesysTest<const char*>
 {
 public:
     virtual ~GuiTest() {}
+protected:
+    void RenderFrame()
+    {
+        ASSERT_TRUE(dmGameObject::Update(m_Collection, &m_UpdateContext));
+        dmRender::RenderListBegin(m_RenderContext);
+        dmGameObject::Render(m_Collection);
+        dmRender::RenderListEnd(m_RenderContext);
+        dmRender::DrawRenderList(m_RenderContext, 0x0, 0x0);
+        ASSERT_TRUE(dmGameObject::PostUpdate(m_Collection));
+        dmGraphics::Flip(m_GraphicsContext);
+    }
 };
 
 class SoundTest : public GamesysTest<const char*>
@@ -366,7 +440,10 @@ void GamesysTest<T>::SetUp()
     m_PhysicsContext.m_MaxCollisionCount = this->m_projectOptions.m_MaxCollisionCount;
     m_PhysicsContext.m_MaxContactPointCount = this->m_projectOptions.m_MaxContactPointCount;
     m_PhysicsContext.m_3D = this->m_projectOptions.m_3D;
-    m_PhysicsContext.m_Context2D = dmPhysics::NewContext2D(dmPhysics::NewContextParams());
+    m_PhysicsContext.m_ParallelStep = this->m_projectOptions.m_ParallelStep;
+    dmPhysics::NewContextParams physics_context_params;
+    physics_context_params.m_AllowDynamicTransforms = this->m_projectOptions.m_AllowDynamicTransforms;
+    m_PhysicsContext.m_Context2D = dmPhysics::NewContext2D(physics_context_params);
 
     m_ParticleFXContext.m_Factory = m_Factory;
     m_ParticleFXContext.m_RenderContext = m_RenderContext;
@@ -374,7 +451,8 @@ void GamesysTest<T>::SetUp()
     m_ParticleFXContext.m_MaxParticleCount = 256;
 
     m_SpriteContext.m_RenderContext = m_RenderContext;
-    m_SpriteContext.m_MaxSpriteCount = 32;
+    m_SpriteContext.m_MaxSpriteCount = this->m_projectOptions.m_MaxSpriteCount;
+    m_SpriteContext.m_Instancing = this->m_projectOptions.m_SpriteInstancing;
 
     m_CollectionProxyContext.m_Factory = m_Factory;
     m_CollectionProxyContext.m_MaxCollectionProxyCount = 8;
@@ -472,6 +472,18 @@ namespace dmGraphics
     {
         g_functions.m_Draw(context, prim_type, first, count);
     }
+    bool IsInstancingSupported(HContext context)
+    {
+        return g_functions.m_IsInstancingSupported(context);
+    }
+    void SetVertexDeclarationStepFunction(HVertexDeclaration vertex_declaration, VertexStepFunction step_function)
+    {
+        g_functions.m_SetVertexDeclarationStepFunction(vertex_declaration, step_function);
+    }
+    void DrawElementsInstanced(HContext context, PrimitiveType prim_type, uint32_t first, uint32_t count, Type type, HIndexBuffer index_buffer, uint32_t instance_count)
+    {
+        g_functions.m_DrawElementsInstanced(context, prim_type, first, count, type, index_buffer, instance_count);
+    }
     HVertexProgram NewVertexProgram(HContext context, ShaderDesc::Shader* ddf)
     {
         return g_functions.m_NewVertexProgram(context, ddf);
@@ -532,6 +544,10 @@ namespace dmGraphics
     {
         return g_functions.m_GetUniformLocation(prog, name);
     }
+    int32_t  GetAttributeLocation(HProgram prog, const char* name)
+    {
+        return g_functions.m_GetAttributeLocation(prog, name);
+    }
     void SetConstantV4(HContext context, const Vectormath::Aos::Vector4* data, int base_register)
     {
         g_functions.m_SetConstantV4(context, data, base_register);
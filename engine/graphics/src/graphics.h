@@ -174,6 +174,13 @@ namespace dmGraphics
         MEMORY_TYPE_MAIN = 0,
     };
 
+    // How often the streams of a vertex declaration advance
+    enum VertexStepFunction
+    {
+        VERTEX_STEP_FUNCTION_VERTEX   = 0,
+        VERTEX_STEP_FUNCTION_INSTANCE = 1,
+    };
+
     enum WindowState
     {
         WINDOW_STATE_OPENED             = 0x00020001,
@@ -495,6 +502,35 @@ namespace dmGraphics
     void DrawElements(HContext context, PrimitiveType prim_type, uint32_t first, uint32_t count, Type type, HIndexBuffer index_buffer);
     void Draw(HContext context, PrimitiveType prim_type, uint32_t first, uint32_t count);
 
+    /**
+     * Check if instanced drawing is supported by the graphics context
+     * @param context Graphics context
+     * @return true if DrawElementsInstanced and VERTEX_STEP_FUNCTION_INSTANCE are supported
+     */
+    bool IsInstancingSupported(HContext context);
+
+    /**
+     * Set how often the streams of a vertex declaration advance. Declarations are per vertex by default.
+     * A per instance declaration is enabled together with a per vertex declaration, and both must be
+     * enabled with a program so that their streams are bound by name
+     * @param vertex_declaration Vertex declaration
+     * @param step_function VERTEX_STEP_FUNCTION_VERTEX or VERTEX_STEP_FUNCTION_INSTANCE
+     */
+    void SetVertexDeclarationStepFunction(HVertexDeclaration vertex_declaration, VertexStepFunction step_function);
+
+    /**
+     * Draw instance_count instances of the indexed primitives.
+     * Only valid if IsInstancingSupported() returns true
+     * @param context Graphics context
+     * @param prim_type Primitive type
+     * @param first Offset in bytes into the index buffer
+     * @param count Number of indices per instance
+     * @param type Index type
+     * @param index_buffer Index buffer
+     * @param instance_count Number of instances
+     */
+    void DrawElementsInstanced(HContext context, PrimitiveType prim_type, uint32_t first, uint32_t count, Type type, HIndexBuffer index_buffer, uint32_t instance_count);
+
     HVertexProgram NewVertexProgram(HContext context, ShaderDesc::Shader* ddf);
     HFragmentProgram NewFragmentProgram(HContext context, ShaderDesc::Shader* ddf);
     HProgram NewProgram(HContext context, HVertexProgram vertex_program, HFragmentProgram fragment_program);
@@ -515,6 +551,14 @@ namespace dmGraphics
     uint32_t GetUniformCount(HProgram prog);
     int32_t  GetUniformLocation(HProgram prog, const char* name);
 
+    /**
+     * Get the location of a vertex attribute of a program, to check if the program uses it
+     * @param prog Program
+     * @param name Attribute name
+     * @return The attribute location, or -1 if the program doesn't have an active attribute with the name
+     */
+    int32_t  GetAttributeLocation(HProgram prog, const char* name);
+
     void SetConstantV4(HContext context, const Vectormath::Aos::Vector4* data, int base_register);
     void SetConstantM4(HContext context, const Vectormath::Aos::Vector4* data, int base_register);
     void SetSampler(HContext context, int32_t location, int32_t unit);
@@ -146,6 +146,55 @@ namespace dmGraphics
         return true;
     }
 
+    static bool IsPrecision(const char* string, uint32_t count)
+    {
+        return STRNCMP("lowp", string, count) || STRNCMP("mediump", string, count) || STRNCMP("highp", string, count);
+    }
+
+    bool GLSLAttributeParse(const char* buffer, AttributeCallback cb, uintptr_t userdata)
+    {
+        if (buffer == 0x0)
+            return true;
+        const char* word_end = buffer;
+        const char* word_start = buffer;
+        uint32_t size = 0;
+        while (*word_end != '\0')
+        {
+            NextWord(&word_start, &word_end, &size);
+
+            if (size > 0)
+            {
+                if (STRNCMP("attribute", word_start, size))
+                {
+                    // Type, possibly after a precision
+                    NextWord(&word_start, &word_end, &size);
+                    if (IsPrecision(word_start, size))
+                    {
+                        NextWord(&word_start, &word_end, &size);
+                    }
+                    if (size == 0)
+                    {
+                        return false;
+                    }
+
+                    // Name
+                    NextWord(&word_start, &word_end, &size);
+                    if (size < 2)
+                    {
+                        return false;
+                    }
+                    cb(word_start, size-1, userdata);
+                }
+                else
+                {
+                    word_start = SkipWS(SkipLine(word_end));
+                    word_end = word_start;
+                }
+            }
+        }
+        return true;
+    }
+
 #undef STRNCMP
 
 }
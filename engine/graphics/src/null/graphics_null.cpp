@@ -486,11 +486,15 @@ namespace dmGraphics
         delete vertex_declaration;
     }
 
-    static void EnableVertexStream(HContext context, uint16_t stream, uint16_t size, Type type, uint16_t stride, const void* vertex_buffer)
+    static VertexStream* GetVertexStreams(HContext context, HVertexDeclaration vertex_declaration)
+    {
+        return vertex_declaration->m_StepFunction == VERTEX_STEP_FUNCTION_INSTANCE ? context->m_InstanceStreams : context->m_VertexStreams;
+    }
+
+    static void EnableVertexStream(VertexStream* streams, uint16_t stream, uint16_t size, Type type, uint16_t stride, const void* vertex_buffer)
     {
-        assert(context);
         assert(vertex_buffer);
-        VertexStream& s = context->m_VertexStreams[stream];
+        VertexStream& s = streams[stream];
         assert(s.m_Source == 0x0);
         assert(s.m_Buffer == 0x0);
         s.m_Source = vertex_buffer;
@@ -498,10 +502,9 @@ namespace dmGraphics
         s.m_Stride = stride;
     }
 
-    static void DisableVertexStream(HContext context, uint16_t stream)
+    static void DisableVertexStream(VertexStream* streams, uint16_t stream)
     {
-        assert(context);
-        VertexStream& s = context->m_VertexStreams[stream];
+        VertexStream& s = streams[stream];
         s.m_Size = 0;
         if (s.m_Buffer != 0x0)
         {
@@ -517,6 +520,7 @@ namespace dmGraphics
         assert(vertex_declaration);
         assert(vertex_buffer);
         VertexBuffer* vb = (VertexBuffer*)vertex_buffer;
+        VertexStream* streams = GetVertexStreams(context, vertex_declaration);
         uint16_t stride = 0;
         for (uint32_t i = 0; i < vertex_declaration->m_Count; ++i)
             stride += vertex_declaration->m_Elements[i].m_Size * TYPE_SIZE[vertex_declaration->m_Elements[i].m_Type - dmGraphics::TYPE_BYTE];
@@ -526,7 +530,7 @@ namespace dmGraphics
             VertexElement& ve = vertex_declaration->m_Elements[i];
             if (ve.m_Size > 0)
             {
-                EnableVertexStream(context, i, ve.m_Size, ve.m_Type, stride, &vb->m_Buffer[offset]);
+                EnableVertexStream(streams, i, ve.m_Size, ve.m_Type, stride, &vb->m_Buffer[offset]);
                 offset += ve.m_Size * TYPE_SIZE[ve.m_Type - dmGraphics::TYPE_BYTE];
             }
         }
@@ -541,9 +545,15 @@ namespace dmGraphics
     {
         assert(context);
         assert(vertex_declaration);
+        VertexStream* streams = GetVertexStreams(context, vertex_declaration);
         for (uint32_t i = 0; i < vertex_declaration->m_Count; ++i)
             if (vertex_declaration->m_Elements[i].m_Size > 0)
-                DisableVertexStream(context, i);
+                DisableVertexStream(streams, i);
+    }
+
+    static void NullSetVertexDeclarationStepFunction(HVertexDeclaration vertex_declaration, VertexStepFunction step_function)
+    {
+        vertex_declaration->m_StepFunction = step_function;
     }
 
     void NullHashVertexDeclaration(HashState32 *state, HVertexDeclaration vertex_declaration)
@@ -597,10 +607,9 @@ namespace dmGraphics
         return ~0;
     }
 
-    static void NullDrawElements(HContext context, PrimitiveType prim_type, uint32_t first, uint32_t count, Type type, HIndexBuffer index_buffer)
+    // Gathers the indexed vertices of the enabled streams, so that tests can inspect what was drawn
+    static void CopyVertexStreams(HContext context, uint32_t first, uint32_t count, Type type, HIndexBuffer index_buffer)
     {
-        assert(context);
-        assert(index_buffer);
         for (uint32_t i = 0; i < MAX_VERTEX_STREAM_COUNT; ++i)
         {
             VertexStream& vs = context->m_VertexStreams[i];
@@ -619,6 +628,43 @@ namespace dmGraphics
                     memcpy(&((char*)vs.m_Buffer)[i * vs.m_Size], &((char*)vs.m_Source)[index * vs.m_Stride], vs.m_Size);
             }
         }
+    }
+
+    static void NullDrawElements(HContext context, PrimitiveType prim_type, uint32_t first, uint32_t count, Type type, HIndexBuffer index_buffer)
+    {
+        assert(context);
+        assert(index_buffer);
+        CopyVertexStreams(context, first, count, type, index_buffer);
+
+        if (g_Flipped)
+        {
+            g_Flipped = 0;
+            g_DrawCount = 0;
+        }
+        g_DrawCount++;
+    }
+
+    static bool NullIsInstancingSupported(HContext context)
+    {
+        return true;
+    }
+
+    static void NullDrawElementsInstanced(HContext context, PrimitiveType prim_type, uint32_t first, uint32_t count, Type type, HIndexBuffer index_buffer, uint32_t instance_count)
+    {
+        assert(context);
+        assert(index_buffer);
+        CopyVertexStreams(context, first, count, type, index_buffer);
+
+        for (uint32_t i = 0; i < MAX_VERTEX_STREAM_COUNT; ++i)
+        {
+            VertexStream& vs = context->m_InstanceStreams[i];
+            if (vs.m_Size > 0)
+            {
+                vs.m_Buffer = new char[vs.m_Size * instance_count];
+                for (uint32_t j = 0; j < instance_count; ++j)
+                    memcpy(&((char*)vs.m_Buffer)[j * vs.m_Size], &((char*)vs.m_Source)[j * vs.m_Stride], vs.m_Size);
+            }
+        }
 
         if (g_Flipped)
         {
@@ -657,6 +703,7 @@ namespace dmGraphics
     };
 
     static void NullUniformCallback(const char* name, uint32_t name_length, dmGraphics::Type type, uintptr_t userdata);
+    static void NullAttributeCallback(const char* name, uint32_t name_length, uintptr_t userdata);
 
     struct Uniform
     {
@@ -674,7 +721,10 @@ namespace dmGraphics
             m_VP = vp;
             m_FP = fp;
             if (m_VP != 0x0)
+            {
                 GLSLUniformParse(m_VP->m_Data, NullUniformCallback, (uintptr_t)this);
+                GLSLAttributeParse(m_VP->m_Data, NullAttributeCallback, (uintptr_t)this);
+            }
             if (m_FP != 0x0)
                 GLSLUniformParse(m_FP->m_Data, NullUniformCallback, (uintptr_t)this);
         }
@@ -683,11 +733,15 @@ namespace dmGraphics
         {
             for(uint32_t i = 0; i < m_Uniforms.Size(); ++i)
                 delete[] m_Uniforms[i].m_Name;
+            for(uint32_t i = 0; i < m_Attributes.Size(); ++i)
+                delete[] m_Attributes[i];
         }
 
         VertexProgram* m_VP;
         FragmentProgram* m_FP;
         dmArray<Uniform> m_Uniforms;
+        // Attribute names, the index is the location
+        dmArray<char*> m_Attributes;
     };
 
     static void NullUniformCallback(const char* name, uint32_t name_length, dmGraphics::Type type, uintptr_t userdata)
@@ -704,6 +758,17 @@ namespace dmGraphics
         program->m_Uniforms.Push(uniform);
     }
 
+    static void NullAttributeCallback(const char* name, uint32_t name_length, uintptr_t userdata)
+    {
+        Program* program = (Program*) userdata;
+        if(program->m_Attributes.Full())
+            program->m_Attributes.OffsetCapacity(16);
+        name_length++;
+        char* attribute = new char[name_length];
+        dmStrlCpy(attribute, name, name_length);
+        program->m_Attributes.Push(attribute);
+    }
+
     static HProgram NullNewProgram(HContext context, HVertexProgram vertex_program, HFragmentProgram fragment_program)
     {
         VertexProgram* vertex = 0x0;
@@ -834,6 +899,20 @@ namespace dmGraphics
         return -1;
     }
 
+    static int32_t NullGetAttributeLocation(HProgram prog, const char* name)
+    {
+        Program* program = (Program*)prog;
+        uint32_t count = program->m_Attributes.Size();
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            if (strcmp(program->m_Attributes[i], name) == 0)
+            {
+                return (int32_t)i;
+            }
+        }
+        return -1;
+    }
+
     static void NullSetViewport(HContext context, int32_t x, int32_t y, int32_t width, int32_t height)
     {
         assert(context);
@@ -1256,6 +1335,9 @@ namespace dmGraphics
         fn_table.m_HashVertexDeclaration = NullHashVertexDeclaration;
         fn_table.m_DrawElements = NullDrawElements;
         fn_table.m_Draw = NullDraw;
+        fn_table.m_IsInstancingSupported = NullIsInstancingSupported;
+        fn_table.m_SetVertexDeclarationStepFunction = NullSetVertexDeclarationStepFunction;
+        fn_table.m_DrawElementsInstanced = NullDrawElementsInstanced;
         fn_table.m_NewVertexProgram = NullNewVertexProgram;
         fn_table.m_NewFragmentProgram = NullNewFragmentProgram;
         fn_table.m_NewProgram = NullNewProgram;
@@ -1271,6 +1353,7 @@ namespace dmGraphics
         fn_table.m_GetUniformName = NullGetUniformName;
         fn_table.m_GetUniformCount = NullGetUniformCount;
         fn_table.m_GetUniformLocation = NullGetUniformLocation;
+        fn_table.m_GetAttributeLocation = NullGetAttributeLocation;
         fn_table.m_SetConstantV4 = NullSetConstantV4;
         fn_table.m_SetConstantM4 = NullSetConstantM4;
         fn_table.m_SetSampler = NullSetSampler;
@@ -51,8 +51,9 @@ namespace dmGraphics
 
     struct VertexDeclaration
     {
-        uint32_t        m_Count;
-        VertexElement   m_Elements[MAX_VERTEX_STREAM_COUNT];
+        uint32_t            m_Count;
+        VertexElement       m_Elements[MAX_VERTEX_STREAM_COUNT];
+        VertexStepFunction  m_StepFunction;
     };
 
     struct VertexBuffer
@@ -81,6 +82,8 @@ namespace dmGraphics
         Context(const ContextParams& params);
 
         VertexStream                m_VertexStreams[MAX_VERTEX_STREAM_COUNT];
+        // Streams of the enabled per instance vertex declaration
+        VertexStream                m_InstanceStreams[MAX_VERTEX_STREAM_COUNT];
         Vectormath::Aos::Vector4    m_ProgramRegisters[MAX_REGISTER_COUNT];
         HTexture                    m_Textures[MAX_TEXTURE_COUNT];
         FrameBuffer                 m_MainFrameBuffer;
@@ -348,6 +348,10 @@ static void LogFrameBufferError(GLenum status)
     // The alternative is a matrix of conditional typedefs, linked statically/dynamically or core. OpenGL function prototypes does not change, so this is safe.
     typedef void (* DM_PFNGLINVALIDATEFRAMEBUFFERPROC) (GLenum target, GLsizei numAttachments, const GLenum *attachments);
     DM_PFNGLINVALIDATEFRAMEBUFFERPROC PFN_glInvalidateFramebuffer = NULL;
+    typedef void (* DM_PFNGLVERTEXATTRIBDIVISORPROC) (GLuint index, GLuint divisor);
+    DM_PFNGLVERTEXATTRIBDIVISORPROC PFN_glVertexAttribDivisor = NULL;
+    typedef void (* DM_PFNGLDRAWELEMENTSINSTANCEDPROC) (GLenum mode, GLsizei count, GLenum type, const GLvoid* indices, GLsizei instance_count);
+    DM_PFNGLDRAWELEMENTSINSTANCEDPROC PFN_glDrawElementsInstanced = NULL;
 
     Context* g_Context = 0x0;
 
@@ -940,6 +944,15 @@ static uintptr_t GetExtProcAddress(const char* name, const char* extension_name,
         }
 
         DMGRAPHICS_GET_PROC_ADDRESS_EXT(PFN_glInvalidateFramebuffer, "glDiscardFramebuffer", "discard_framebuffer", "glInvalidateFramebuffer", DM_PFNGLINVALIDATEFRAMEBUFFERPROC, extensions);
+        // The divisor comes from *_instanced_arrays, and the draw call from *_draw_instanced.
+        // Only GL_EXT_instanced_arrays (GLES) provides both, GL_ARB_instanced_arrays has no draw call
+        DMGRAPHICS_GET_PROC_ADDRESS_EXT(PFN_glVertexAttribDivisor, "glVertexAttribDivisor", "instanced_arrays", "glVertexAttribDivisor", DM_PFNGLVERTEXATTRIBDIVISORPROC, extensions);
+        DMGRAPHICS_GET_PROC_ADDRESS_EXT(PFN_glDrawElementsInstanced, "glDrawElementsInstanced", "draw_instanced", "glDrawElementsInstanced", DM_PFNGLDRAWELEMENTSINSTANCEDPROC, extensions);
+        if (PFN_glDrawElementsInstanced == 0x0 && IsExtensionSupported("GL_EXT_instanced_arrays", extensions))
+        {
+            PFN_glDrawElementsInstanced = (DM_PFNGLDRAWELEMENTSINSTANCEDPROC) glfwGetProcAddress("glDrawElementsInstancedEXT");
+        }
+        context->m_InstancingSupport = PFN_glVertexAttribDivisor != NULL && PFN_glDrawElementsInstanced != NULL;
 
         if (IsExtensionSupported("GL_IMG_texture_compression_pvrtc", extensions) ||
             IsExtensionSupported("WEBGL_compressed_texture_pvrtc", extensions))
@@ -1466,11 +1479,23 @@ static uintptr_t GetExtProcAddress(const char* name, const char* extension_name,
         delete vertex_declaration;
     }
 
+    static void OpenGLEnableVertexDeclarationProgram(HContext context, HVertexDeclaration vertex_declaration, HVertexBuffer vertex_buffer, HProgram program);
+
     static void OpenGLEnableVertexDeclaration(HContext context, HVertexDeclaration vertex_declaration, HVertexBuffer vertex_buffer)
     {
         assert(context);
         assert(vertex_buffer);
         assert(vertex_declaration);
+
+        // Per instance streams are drawn together with per vertex streams, which already use the first
+        // stream indices, so they are bound to the attribute locations of the current program instead
+        if (vertex_declaration->m_StepFunction == VERTEX_STEP_FUNCTION_INSTANCE)
+        {
+            assert(context->m_CurrentProgram);
+            OpenGLEnableVertexDeclarationProgram(context, vertex_declaration, vertex_buffer, context->m_CurrentProgram);
+            return;
+        }
+
         #define BUFFER_OFFSET(i) ((char*)0x0 + (i))
 
         glBindBufferARB(GL_ARRAY_BUFFER, vertex_buffer);
@@ -1550,6 +1575,12 @@ static uintptr_t GetExtProcAddress(const char* name, const char* extension_name,
                 BUFFER_OFFSET(vertex_declaration->m_Streams[i].m_Offset) );   //The starting point of the VBO, for the vertices
 
                 CHECK_GL_ERROR;
+
+                if (vertex_declaration->m_StepFunction == VERTEX_STEP_FUNCTION_INSTANCE)
+                {
+                    PFN_glVertexAttribDivisor(vertex_declaration->m_Streams[i].m_PhysicalIndex, 1);
+                    CHECK_GL_ERROR;
+                }
             }
         }
 
@@ -1561,10 +1592,29 @@ static uintptr_t GetExtProcAddress(const char* name, const char* extension_name,
         assert(context);
         assert(vertex_declaration);
 
-        for (uint32_t i=0; i<vertex_declaration->m_StreamCount; i++)
+        if (vertex_declaration->m_StepFunction == VERTEX_STEP_FUNCTION_INSTANCE)
         {
-            glDisableVertexAttribArray(i);
-            CHECK_GL_ERROR;
+            // The per instance streams are always bound to the attribute locations of the program,
+            // see OpenGLEnableVertexDeclaration
+            for (uint32_t i=0; i<vertex_declaration->m_StreamCount; i++)
+            {
+                int16_t index = vertex_declaration->m_Streams[i].m_PhysicalIndex;
+                if (index != -1)
+                {
+                    PFN_glVertexAttribDivisor(index, 0);
+                    CHECK_GL_ERROR;
+                    glDisableVertexAttribArray(index);
+                    CHECK_GL_ERROR;
+                }
+            }
+        }
+        else
+        {
+            for (uint32_t i=0; i<vertex_declaration->m_StreamCount; i++)
+            {
+                glDisableVertexAttribArray(i);
+                CHECK_GL_ERROR;
+            }
         }
 
         glBindBufferARB(GL_ARRAY_BUFFER_ARB, 0);
@@ -1607,6 +1657,31 @@ static uintptr_t GetExtProcAddress(const char* name, const char* extension_name,
         CHECK_GL_ERROR
     }
 
+    static bool OpenGLIsInstancingSupported(HContext context)
+    {
+        return context->m_InstancingSupport;
+    }
+
+    static void OpenGLSetVertexDeclarationStepFunction(HVertexDeclaration vertex_declaration, VertexStepFunction step_function)
+    {
+        vertex_declaration->m_StepFunction = step_function;
+    }
+
+    static void OpenGLDrawElementsInstanced(HContext context, PrimitiveType prim_type, uint32_t first, uint32_t count, Type type, HIndexBuffer index_buffer, uint32_t instance_count)
+    {
+        assert(context);
+        assert(index_buffer);
+        assert(context->m_InstancingSupport);
+        DM_PROFILE(Graphics, "DrawElementsInstanced");
+        DM_COUNTER("DrawCalls", 1);
+
+        glBindBufferARB(GL_ELEMENT_ARRAY_BUFFER, index_buffer);
+        CHECK_GL_ERROR;
+
+        PFN_glDrawElementsInstanced(GetOpenGLPrimitiveType(prim_type), count, GetOpenGLType(type), (GLvoid*)(uintptr_t) first, instance_count);
+        CHECK_GL_ERROR
+    }
+
     static void OpenGLDraw(HContext context, PrimitiveType prim_type, uint32_t first, uint32_t count)
     {
         assert(context);
@@ -1801,15 +1876,15 @@ static uintptr_t GetExtProcAddress(const char* name, const char* extension_name,
 
     static void OpenGLEnableProgram(HContext context, HProgram program)
     {
-        (void) context;
         glUseProgram(program);
         CHECK_GL_ERROR;
+        context->m_CurrentProgram = program;
     }
 
     static void OpenGLDisableProgram(HContext context)
     {
-        (void) context;
         glUseProgram(0);
+        context->m_CurrentProgram = 0;
     }
 
     static bool TryLinkProgram(HVertexProgram vert_program, HFragmentProgram frag_program)
@@ -1885,6 +1960,17 @@ static uintptr_t GetExtProcAddress(const char* name, const char* extension_name,
         return (uint32_t) location;
     }
 
+    static int32_t OpenGLGetAttributeLocation(HProgram prog, const char* name)
+    {
+        GLint location = glGetAttribLocation(prog, name);
+        if (location == -1)
+        {
+            // Clear error if attribute isn't found
+            CLEAR_GL_ERROR
+        }
+        return (int32_t) location;
+    }
+
     static void OpenGLSetViewport(HContext context, int32_t x, int32_t y, int32_t width, int32_t height)
     {
         assert(context);
@@ -3000,6 +3086,9 @@ static uintptr_t GetExtProcAddress(const char* name, const char* extension_name,
         fn_table.m_HashVertexDeclaration = OpenGLHashVertexDeclaration;
         fn_table.m_DrawElements = OpenGLDrawElements;
         fn_table.m_Draw = OpenGLDraw;
+        fn_table.m_IsInstancingSupported = OpenGLIsInstancingSupported;
+        fn_table.m_SetVertexDeclarationStepFunction = OpenGLSetVertexDeclarationStepFunction;
+        fn_table.m_DrawElementsInstanced = OpenGLDrawElementsInstanced;
         fn_table.m_NewVertexProgram = OpenGLNewVertexProgram;
         fn_table.m_NewFragmentProgram = OpenGLNewFragmentProgram;
         fn_table.m_NewProgram = OpenGLNewProgram;
@@ -3015,6 +3104,7 @@ static uintptr_t GetExtProcAddress(const char* name, const char* extension_name,
         fn_table.m_GetUniformName = OpenGLGetUniformName;
         fn_table.m_GetUniformCount = OpenGLGetUniformCount;
         fn_table.m_GetUniformLocation = OpenGLGetUniformLocation;
+        fn_table.m_GetAttributeLocation = OpenGLGetAttributeLocation;
         fn_table.m_SetConstantV4 = OpenGLSetConstantV4;
         fn_table.m_SetConstantM4 = OpenGLSetConstantM4;
         fn_table.m_SetSampler = OpenGLSetSampler;
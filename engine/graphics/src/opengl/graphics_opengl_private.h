@@ -51,8 +51,11 @@ namespace dmGraphics
         uint64_t                m_TextureFormatSupport;
         uint32_t                m_DepthBufferBits;
         uint32_t                m_FrameBufferInvalidateBits;
+        // The program set with EnableProgram, used to resolve the attribute locations of per instance streams
+        HProgram                m_CurrentProgram;
         uint8_t                 m_FrameBufferInvalidateAttachments : 1;
         uint8_t                 m_PackedDepthStencil : 1;
+        uint8_t                 m_InstancingSupport : 1;
         uint8_t                 m_WindowOpened : 1;
         uint8_t                 m_VerifyGraphicsCalls : 1;
         uint8_t                 m_RenderDocSupport : 1;
@@ -96,11 +99,12 @@ namespace dmGraphics
             bool        m_Normalize;
         };
 
-        Stream      m_Streams[8];
-        uint16_t    m_StreamCount;
-        uint16_t    m_Stride;
-        HProgram    m_BoundForProgram;
-        uint32_t    m_ModificationVersion;
+        Stream              m_Streams[8];
+        uint16_t            m_StreamCount;
+        uint16_t            m_Stride;
+        HProgram            m_BoundForProgram;
+        uint32_t            m_ModificationVersion;
+        VertexStepFunction  m_StepFunction;
 
     };
     // TODO: Why this one here!? Not used?
@@ -77,6 +77,30 @@ TEST_F(dmGLSLUniformTest, IntroductionJunk)
     ASSERT_EQ(dmGraphics::TYPE_SAMPLER_2D, uniform.m_Type);
 }
 
+static void AttributeCallback(const char* name, uint32_t name_length, uintptr_t userdata)
+{
+    char* names = (char*)userdata;
+    strncat(names, name, name_length);
+    strcat(names, " ");
+}
+
+TEST_F(dmGLSLUniformTest, Attributes)
+{
+    char names[128] = "";
+    const char* program = ""
+            "uniform highp mat4 view_proj;\n"
+            "attribute highp vec4 position;\n"
+            "attribute vec2 texcoord0;\n"
+            "varying mediump vec2 var_texcoord0;\n"
+            "void main()\n"
+            "{\n"
+            "    gl_Position = view_proj * vec4(position.xyz, 1.0);\n"
+            "}\n";
+    bool result = dmGraphics::GLSLAttributeParse(program, AttributeCallback, (uintptr_t)names);
+    ASSERT_TRUE(result);
+    ASSERT_STREQ("position texcoord0 ", names);
+}
+
 int main(int argc, char **argv)
 {
     jc_test_init(&argc, argv);
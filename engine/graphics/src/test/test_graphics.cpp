@@ -327,6 +327,54 @@ TEST_F(dmGraphicsTest, Drawing)
     dmGraphics::DeleteVertexDeclaration(vd);
 }
 
+TEST_F(dmGraphicsTest, DrawingInstanced)
+{
+    ASSERT_TRUE(dmGraphics::IsInstancingSupported(m_Context));
+
+    float v[] = { 0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f };
+    uint16_t i[] = { 0, 1, 2 };
+    float instances[] = { 10.0f, 11.0f, 12.0f, 20.0f, 21.0f, 22.0f };
+
+    dmGraphics::VertexElement ve[] =
+    {
+        {"position", 0, 2, dmGraphics::TYPE_FLOAT, false },
+    };
+    dmGraphics::VertexElement ive[] =
+    {
+        {"offset", 0, 2, dmGraphics::TYPE_FLOAT, false },
+        {"scale", 1, 1, dmGraphics::TYPE_FLOAT, false },
+    };
+    dmGraphics::HVertexDeclaration vd = dmGraphics::NewVertexDeclaration(m_Context, ve, 1);
+    dmGraphics::HVertexDeclaration ivd = dmGraphics::NewVertexDeclaration(m_Context, ive, 2);
+    dmGraphics::SetVertexDeclarationStepFunction(ivd, dmGraphics::VERTEX_STEP_FUNCTION_INSTANCE);
+    dmGraphics::HVertexBuffer vb = dmGraphics::NewVertexBuffer(m_Context, sizeof(v), v, dmGraphics::BUFFER_USAGE_STREAM_DRAW);
+    dmGraphics::HVertexBuffer ivb = dmGraphics::NewVertexBuffer(m_Context, sizeof(instances), instances, dmGraphics::BUFFER_USAGE_STREAM_DRAW);
+    dmGraphics::HIndexBuffer ib = dmGraphics::NewIndexBuffer(m_Context, sizeof(i), i, dmGraphics::BUFFER_USAGE_STREAM_DRAW);
+
+    dmGraphics::EnableVertexDeclaration(m_Context, vd, vb);
+    dmGraphics::EnableVertexDeclaration(m_Context, ivd, ivb);
+    dmGraphics::DrawElementsInstanced(m_Context, dmGraphics::PRIMITIVE_TRIANGLES, 0, 3, dmGraphics::TYPE_UNSIGNED_SHORT, ib, 2);
+
+    // The per vertex streams are indexed, the per instance streams advance once per instance
+    ASSERT_EQ(0, memcmp(v, m_Context->m_VertexStreams[0].m_Buffer, sizeof(v)));
+    float offsets[] = { 10.0f, 11.0f, 20.0f, 21.0f };
+    ASSERT_EQ(0, memcmp(offsets, m_Context->m_InstanceStreams[0].m_Buffer, sizeof(offsets)));
+    float scales[] = { 12.0f, 22.0f };
+    ASSERT_EQ(0, memcmp(scales, m_Context->m_InstanceStreams[1].m_Buffer, sizeof(scales)));
+
+    dmGraphics::DisableVertexDeclaration(m_Context, ivd);
+    ASSERT_EQ(0u, m_Context->m_InstanceStreams[0].m_Size);
+    ASSERT_EQ(0u, m_Context->m_InstanceStreams[1].m_Size);
+    ASSERT_NE(0u, m_Context->m_VertexStreams[0].m_Size);
+    dmGraphics::DisableVertexDeclaration(m_Context, vd);
+
+    dmGraphics::DeleteIndexBuffer(ib);
+    dmGraphics::DeleteVertexBuffer(ivb);
+    dmGraphics::DeleteVertexBuffer(vb);
+    dmGraphics::DeleteVertexDeclaration(ivd);
+    dmGraphics::DeleteVertexDeclaration(vd);
+}
+
 static inline dmGraphics::ShaderDesc::Shader MakeDDFShader(const char* data, uint32_t count)
 {
     dmGraphics::ShaderDesc::Shader ddf;
@@ -1988,6 +1988,22 @@ bail:
         vkCmdDraw(vk_command_buffer, count, 1, first, 0);
     }
 
+    // The pipelines are created with a single per vertex binding, so instancing is not supported yet
+    static bool VulkanIsInstancingSupported(HContext context)
+    {
+        return false;
+    }
+
+    static void VulkanSetVertexDeclarationStepFunction(HVertexDeclaration vertex_declaration, VertexStepFunction step_function)
+    {
+        assert(step_function == VERTEX_STEP_FUNCTION_VERTEX);
+    }
+
+    static void VulkanDrawElementsInstanced(HContext context, PrimitiveType prim_type, uint32_t first, uint32_t count, Type type, HIndexBuffer index_buffer, uint32_t instance_count)
+    {
+        assert(0 && "Instanced drawing is not supported");
+    }
+
     static void CreateShaderResourceBindings(ShaderModule* shader, ShaderDesc::Shader* ddf, uint32_t dynamicAlignment)
     {
         if (ddf->m_Uniforms.m_Count > 0)
@@ -2433,6 +2449,22 @@ bail:
         return -1;
     }
 
+    static int32_t VulkanGetAttributeLocation(HProgram prog, const char* name)
+    {
+        assert(prog);
+        Program* program_ptr = (Program*) prog;
+        ShaderModule* vs     = program_ptr->m_VertexModule;
+        dmhash_t name_hash   = dmHashString64(name);
+        for (uint32_t i = 0; i < vs->m_AttributeCount; ++i)
+        {
+            if (vs->m_Attributes[i].m_NameHash == name_hash)
+            {
+                return vs->m_Attributes[i].m_Binding;
+            }
+        }
+        return -1;
+    }
+
     static void VulkanSetConstantV4(HContext context, const Vectormath::Aos::Vector4* data, int base_register)
     {
         assert(context->m_CurrentProgram);
@@ -3400,6 +3432,9 @@ bail:
         fn_table.m_HashVertexDeclaration = VulkanHashVertexDeclaration;
         fn_table.m_DrawElements = VulkanDrawElements;
         fn_table.m_Draw = VulkanDraw;
+        fn_table.m_IsInstancingSupported = VulkanIsInstancingSupported;
+        fn_table.m_SetVertexDeclarationStepFunction = VulkanSetVertexDeclarationStepFunction;
+        fn_table.m_DrawElementsInstanced = VulkanDrawElementsInstanced;
         fn_table.m_NewVertexProgram = VulkanNewVertexProgram;
         fn_table.m_NewFragmentProgram = VulkanNewFragmentProgram;
         fn_table.m_NewProgram = VulkanNewProgram;
@@ -3415,6 +3450,7 @@ bail:
         fn_table.m_GetUniformName = VulkanGetUniformName;
         fn_table.m_GetUniformCount = VulkanGetUniformCount;
         fn_table.m_GetUniformLocation = VulkanGetUniformLocation;
+        fn_table.m_GetAttributeLocation = VulkanGetAttributeLocation;
         fn_table.m_SetConstantV4 = VulkanSetConstantV4;
         fn_table.m_SetConstantM4 = VulkanSetConstantM4;
         fn_table.m_SetSampler = VulkanSetSampler;
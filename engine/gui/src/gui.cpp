@@ -401,6 +401,7 @@ namespace dmGui
         scene->m_RenderTail = INVALID_INDEX;
         scene->m_NextVersionNumber = 0;
         scene->m_RenderOrder = 0;
+        scene->m_RenderListDirty = 1;
         scene->m_Width = context->m_DefaultProjectWidth;
         scene->m_Height = context->m_DefaultProjectHeight;
         scene->m_FetchTextureSetAnimCallback = params->m_FetchTextureSetAnimCallback;
@@ -497,6 +498,7 @@ namespace dmGui
             {
                 nodes[i].m_Node.m_Texture     = texture;
                 nodes[i].m_Node.m_TextureType = texture_type;
+                ++nodes[i].m_RenderGeneration;
             }
         }
         return RESULT_OK;
@@ -520,6 +522,7 @@ namespace dmGui
 
                 node.m_Texture     = 0;
                 node.m_TextureType = NODE_TEXTURE_TYPE_NONE;
+                ++nodes[i].m_RenderGeneration;
             }
         }
     }
@@ -538,6 +541,7 @@ namespace dmGui
             }
             node.m_Texture = 0;
             node.m_TextureType = NODE_TEXTURE_TYPE_NONE;
+            ++nodes[i].m_RenderGeneration;
         }
     }
 
@@ -811,6 +815,7 @@ Result DeleteDynamicTexture(HScene scene, const dmhash_t texture_hash)
             if (nodes[i].m_Node.m_LayerHash == layer_hash)
                 nodes[i].m_Node.m_LayerIndex = index;
         }
+        scene->m_RenderListDirty = 1;
         return RESULT_OK;
     }
 
@@ -1064,6 +1069,7 @@ Result DeleteDynamicTexture(HScene scene, const dmhash_t texture_hash)
                 if (DynamicTexture* texture = scene->m_DynamicTextures.Get(node.m_TextureHash)) {
                     node.m_Texture = texture->m_Handle;
                     node.m_TextureType = NODE_TEXTURE_TYPE_DYNAMIC;
+                    ++nodes[j].m_RenderGeneration;
                 }
             }
         }
@@ -1082,6 +1088,7 @@ Result DeleteDynamicTexture(HScene scene, const dmhash_t texture_hash)
                 if (node.m_TextureHash == texture_hash) {
                     node.m_Texture = 0;
                     node.m_TextureType = NODE_TEXTURE_TYPE_NONE;
+                    ++nodes[j].m_RenderGeneration;
                     // Do not break here. Texture may be used multiple times.
                 }
             }
@@ -1398,23 +1405,43 @@ Result DeleteDynamicTexture(HScene scene, const dmhash_t texture_hash)
         UpdateDynamicTextures(scene, params, context);
         DeferredDeleteDynamicTextures(scene, params, context);
 
-        c->m_RenderNodes.SetSize(0);
+        // The render entries only depend on the hierarchy, order, layers, clipping and enabled state of the nodes,
+        // so they are kept until any of those change
+        if (scene->m_RenderListDirty)
+        {
+            uint32_t capacity = scene->m_NodePool.Size() * 2;
+            if (capacity > scene->m_RenderEntries.Capacity())
+            {
+                scene->m_RenderEntries.SetCapacity(capacity);
+                scene->m_ClippingNodes.SetCapacity(capacity);
+            }
+            scene->m_RenderEntries.SetSize(0);
+            scene->m_ClippingNodes.SetSize(0);
+            CollectNodes(scene, scene->m_ClippingNodes, scene->m_RenderEntries);
+            std::sort(scene->m_RenderEntries.Begin(), scene->m_RenderEntries.End(), RenderEntrySortPred(scene));
+            scene->m_RenderListDirty = 0;
+        }
+
+        const dmArray<RenderEntry>& render_entries = scene->m_RenderEntries;
+        dmArray<InternalClippingNode>& clippers = scene->m_ClippingNodes;
+        uint32_t node_count = render_entries.Size();
+
         c->m_RenderTransforms.SetSize(0);
         c->m_RenderOpacities.SetSize(0);
-        c->m_StencilClippingNodes.SetSize(0);
         c->m_StencilScopes.SetSize(0);
         c->m_StencilScopeIndices.SetSize(0);
+        if (node_count > c->m_RenderTransforms.Capacity())
+        {
+            c->m_RenderTransforms.SetCapacity(node_count);
+            c->m_RenderOpacities.SetCapacity(node_count);
+            c->m_StencilScopes.SetCapacity(node_count);
+            c->m_StencilScopeIndices.SetCapacity(node_count);
+        }
         uint32_t capacity = scene->m_NodePool.Size() * 2;
-        if (capacity > c->m_RenderNodes.Capacity())
+        if (capacity > c->m_SceneTraversalCache.m_Data.Capacity())
         {
-            c->m_RenderNodes.SetCapacity(capacity);
-            c->m_RenderTransforms.SetCapacity(capacity);
-            c->m_RenderOpacities.SetCapacity(capacity);
             c->m_SceneTraversalCache.m_Data.SetCapacity(capacity);
             c->m_SceneTraversalCache.m_Data.SetSize(capacity);
-            c->m_StencilClippingNodes.SetCapacity(capacity);
-            c->m_StencilScopes.SetCapacity(capacity);
-            c->m_StencilScopeIndices.SetCapacity(capacity);
         }
 
         c->m_SceneTraversalCache.m_NodeIndex = 0;
@@ -1423,27 +1450,10 @@ Result DeleteDynamicTexture(HScene scene, const dmhash_t texture_hash)
             c->m_SceneTraversalCache.m_Version = 0;
         }
 
-        Matrix4 node_transform;
-        CollectNodes(scene, c->m_StencilClippingNodes, c->m_RenderNodes);
-        uint32_t node_count = c->m_RenderNodes.Size();
-        std::sort(c->m_RenderNodes.Begin(), c->m_RenderNodes.End(), RenderEntrySortPred(scene));
         Matrix4 transform;
-
-        if (c->m_RenderNodes.Capacity() > c->m_RenderTransforms.Capacity())
-        {
-            uint32_t new_capacity = c->m_RenderNodes.Capacity();
-            c->m_RenderTransforms.SetCapacity(new_capacity);
-            c->m_RenderOpacities.SetCapacity(new_capacity);
-            c->m_SceneTraversalCache.m_Data.SetCapacity(new_capacity);
-            c->m_SceneTraversalCache.m_Data.SetSize(new_capacity);
-            c->m_StencilClippingNodes.SetCapacity(new_capacity);
-            c->m_StencilScopes.SetCapacity(new_capacity);
-            c->m_StencilScopeIndices.SetCapacity(new_capacity);
-        }
-
         for (uint32_t i = 0; i < node_count; ++i)
         {
-            const RenderEntry& entry = c->m_RenderNodes[i];
+            const RenderEntry& entry = render_entries[i];
             uint16_t index = entry.m_Node & 0xffff;
             InternalNode* n = &scene->m_Nodes[index];
             float opacity = 1.0f;
@@ -1452,12 +1462,12 @@ Result DeleteDynamicTexture(HScene scene, const dmhash_t texture_hash)
             c->m_RenderTransforms.Push(transform);
             c->m_RenderOpacities.Push(opacity);
             if (n->m_ClipperIndex != INVALID_INDEX) {
-                InternalClippingNode* clipper = &c->m_StencilClippingNodes[n->m_ClipperIndex];
+                InternalClippingNode* clipper = &clippers[n->m_ClipperIndex];
                 if (clipper->m_NodeIndex == index) {
                     if (clipper->m_VisibleRenderKey == entry.m_RenderKey) {
                         StencilScope* scope = 0x0;
                         if (clipper->m_ParentIndex != INVALID_INDEX) {
-                            scope = &c->m_StencilClippingNodes[clipper->m_ParentIndex].m_ChildScope;
+                            scope = &clippers[clipper->m_ParentIndex].m_ChildScope;
                         }
                         c->m_StencilScopes.Push(scope);
                     } else {
@@ -1472,7 +1482,7 @@ Result DeleteDynamicTexture(HScene scene, const dmhash_t texture_hash)
         }
 
         scene->m_ResChanged = 0;
-        params.m_RenderNodes(scene, c->m_RenderNodes.Begin(), c->m_RenderTransforms.Begin(), c->m_RenderOpacities.Begin(), (const StencilScope**)c->m_StencilScopes.Begin(), c->m_RenderNodes.Size(), context);
+        params.m_RenderNodes(scene, render_entries.Begin(), c->m_RenderTransforms.Begin(), c->m_RenderOpacities.Begin(), (const StencilScope**)c->m_StencilScopes.Begin(), node_count, context);
     }
 
     void RenderScene(HScene scene, RenderNodes render_nodes, void* context)
@@ -2039,6 +2049,7 @@ Result DeleteDynamicTexture(HScene scene, const dmhash_t texture_hash)
             dmParticle::DestroyInstance(scene->m_ParticlefxContext, c->m_Instance);
         }
         scene->m_AliveParticlefxs.SetSize(0);
+        scene->m_RenderListDirty = 1;
 
         ClearLayouts(scene);
         return result;
@@ -2127,6 +2138,7 @@ Result DeleteDynamicTexture(HScene scene, const dmhash_t texture_hash)
 
                 dmParticle::DestroyInstance(scene->m_ParticlefxContext, c->m_Instance);
                 scene->m_AliveParticlefxs.EraseSwap(i);
+                scene->m_RenderListDirty = 1;
                 --count;
             }
             else
@@ -2327,6 +2339,7 @@ Result DeleteDynamicTexture(HScene scene, const dmhash_t texture_hash)
         node->m_ChildTail = INVALID_INDEX;
         node->m_SceneTraversalCacheVersion = INVALID_INDEX;
         node->m_ClipperIndex = INVALID_INDEX;
+        ++node->m_RenderGeneration;
         scene->m_NextVersionNumber = (version + 1) % ((1 << 16) - 1);
 
         HNode hnode = GetNodeHandle(node);
@@ -2418,6 +2431,7 @@ Result DeleteDynamicTexture(HScene scene, const dmhash_t texture_hash)
             tail = &parent_n->m_ChildTail;
         }
         n->m_ParentIndex = parent_index;
+        scene->m_RenderListDirty = 1;
         if (prev_n != 0x0)
         {
             if (*tail == prev_n->m_Index)
@@ -2453,6 +2467,7 @@ Result DeleteDynamicTexture(HScene scene, const dmhash_t texture_hash)
 
     static void RemoveFromNodeList(HScene scene, InternalNode* n)
     {
+        scene->m_RenderListDirty = 1;
         // Remove from list
         if (n->m_PrevIndex != INVALID_INDEX)
             scene->m_Nodes[n->m_PrevIndex].m_NextIndex = n->m_NextIndex;
@@ -2569,6 +2584,7 @@ Result DeleteDynamicTexture(HScene scene, const dmhash_t texture_hash)
         scene->m_Nodes.SetSize(0);
         scene->m_RenderHead = INVALID_INDEX;
         scene->m_RenderTail = INVALID_INDEX;
+        scene->m_RenderListDirty = 1;
         scene->m_NodePool.Clear();
         scene->m_Animations.SetSize(0);
     }
@@ -2663,6 +2679,8 @@ Result DeleteDynamicTexture(HScene scene, const dmhash_t texture_hash)
 
         node.m_LocalTransform.setUpper3x3(Matrix3::rotation(r) * Matrix3::scale( mulPerElem(node.m_LocalAdjustScale, prop_scale).getXYZ() ));
         node.m_LocalTransform.setTranslation(position.getXYZ());
+        // All property changes mark the local transform as dirty
+        ++n->m_RenderGeneration;
 
         if (scene->m_AdjustReference == ADJUST_REFERENCE_PARENT && n->m_ParentIndex != INVALID_INDEX)
         {
@@ -2685,9 +2703,11 @@ Result DeleteDynamicTexture(HScene scene, const dmhash_t texture_hash)
                 memcpy(n->m_Properties, n->m_ResetPointProperties, sizeof(n->m_Properties));
                 n->m_DirtyLocal = 1;
                 n->m_State = n->m_ResetPointState;
+                ++node->m_RenderGeneration;
             }
         }
         scene->m_Animations.SetSize(0);
+        scene->m_RenderListDirty = 1;
     }
 
     uint16_t GetRenderOrder(HScene scene)
@@ -2701,6 +2721,12 @@ Result DeleteDynamicTexture(HScene scene, const dmhash_t texture_hash)
         return (NodeType)n->m_Node.m_NodeType;
     }
 
+    uint32_t GetNodeRenderGeneration(HScene scene, HNode node)
+    {
+        InternalNode* n = GetNode(scene, node);
+        return n->m_RenderGeneration;
+    }
+
     Point3 GetNodePosition(HScene scene, HNode node)
     {
         InternalNode* n = GetNode(scene, node);
@@ -2856,6 +2882,7 @@ Result DeleteDynamicTexture(HScene scene, const dmhash_t texture_hash)
         InternalNode* n = GetNode(scene, node);
         if (n->m_Node.m_TextureType == NODE_TEXTURE_TYPE_TEXTURE_SET)
             CancelNodeFlipbookAnim(scene, node);
+        ++n->m_RenderGeneration;
         if (TextureInfo* texture_info = scene->m_Textures.Get(texture_id)) {
             n->m_Node.m_TextureHash = texture_id;
             n->m_Node.m_Texture = texture_info->m_TextureSource;
@@ -3253,6 +3280,7 @@ Result DeleteDynamicTexture(HScene scene, const dmhash_t texture_hash)
             InternalNode* n = GetNode(scene, node);
             n->m_Node.m_LayerHash = layer_id;
             n->m_Node.m_LayerIndex = *layer_index;
+            scene->m_RenderListDirty = 1;
             return RESULT_OK;
         }
         else
@@ -3292,6 +3320,7 @@ Result DeleteDynamicTexture(HScene scene, const dmhash_t texture_hash)
 
         cursor = dmMath::Clamp(cursor, 0.0f, 1.0f);
         n->m_Node.m_FlipbookAnimPosition = cursor;
+        ++n->m_RenderGeneration;
         if (n->m_Node.m_FlipbookAnimHash) {
             Animation* anim = GetComponentAnimation(scene, node, &n->m_Node.m_FlipbookAnimPosition);
             if (anim) {
@@ -3523,6 +3552,7 @@ Result DeleteDynamicTexture(HScene scene, const dmhash_t texture_hash)
         component->m_Prototype = particlefx_prototype;
         component->m_Instance = inst;
         component->m_Node = node;
+        scene->m_RenderListDirty = 1;
 
         n->m_Node.m_ParticlefxPrototype = particlefx_prototype;
         n->m_Node.m_ParticleInstance = inst;
@@ -3556,6 +3586,7 @@ Result DeleteDynamicTexture(HScene scene, const dmhash_t texture_hash)
     {
         InternalNode* n = GetNode(scene, node);
         n->m_Node.m_ClippingMode = mode;
+        scene->m_RenderListDirty = 1;
     }
 
     ClippingMode GetNodeClippingMode(HScene scene, HNode node)
@@ -3568,6 +3599,7 @@ Result DeleteDynamicTexture(HScene scene, const dmhash_t texture_hash)
     {
         InternalNode* n = GetNode(scene, node);
         n->m_Node.m_ClippingVisible = (uint32_t) visible;
+        scene->m_RenderListDirty = 1;
     }
 
     bool GetNodeClippingVisible(HScene scene, HNode node)
@@ -3580,6 +3612,7 @@ Result DeleteDynamicTexture(HScene scene, const dmhash_t texture_hash)
     {
         InternalNode* n = GetNode(scene, node);
         n->m_Node.m_ClippingInverted = (uint32_t) inverted;
+        scene->m_RenderListDirty = 1;
     }
 
     bool GetNodeClippingInverted(HScene scene, HNode node)
@@ -3646,24 +3679,28 @@ Result DeleteDynamicTexture(HScene scene, const dmhash_t texture_hash)
     {
         InternalNode* n = GetNode(scene, node);
         n->m_Node.m_OuterBounds = bounds;
+        ++n->m_RenderGeneration;
     }
 
     void SetNodePerimeterVertices(HScene scene, HNode node, uint32_t vertices)
     {
         InternalNode* n = GetNode(scene, node);
         n->m_Node.m_PerimeterVertices = vertices;
+        ++n->m_RenderGeneration;
     }
 
     void SetNodeInnerRadius(HScene scene, HNode node, float radius)
     {
         InternalNode* n = GetNode(scene, node);
         n->m_Node.m_Properties[PROPERTY_PIE_PARAMS].setX(radius);
+        ++n->m_RenderGeneration;
     }
 
     void SetNodePieFillAngle(HScene scene, HNode node, float fill_angle)
     {
         InternalNode* n = GetNode(scene, node);
         n->m_Node.m_Properties[PROPERTY_PIE_PARAMS].setY(fill_angle);
+        ++n->m_RenderGeneration;
     }
 
     PieBounds GetNodeOuterBounds(HScene scene, HNode node)
@@ -3712,6 +3749,7 @@ Result DeleteDynamicTexture(HScene scene, const dmhash_t texture_hash)
     {
         InternalNode* n = GetNode(scene, node);
         n->m_Node.m_IsBone = is_bone;
+        ++n->m_RenderGeneration;
     }
 
     void SetNodeAdjustMode(HScene scene, HNode node, AdjustMode adjust_mode)
@@ -3724,6 +3762,7 @@ Result DeleteDynamicTexture(HScene scene, const dmhash_t texture_hash)
     {
         InternalNode* n = GetNode(scene, node);
         n->m_Node.m_SizeMode = (uint32_t) size_mode;
+        ++n->m_RenderGeneration;
         if((n->m_Node.m_SizeMode != SIZE_MODE_MANUAL) && (n->m_Node.m_NodeType != NODE_TYPE_SPINE) && (n->m_Node.m_NodeType != NODE_TYPE_PARTICLEFX))
         {
             if (TextureInfo* texture_info = scene->m_Textures.Get(n->m_Node.m_TextureHash))
@@ -3998,6 +4037,7 @@ Result DeleteDynamicTexture(HScene scene, const dmhash_t texture_hash)
         anim->m_FirstUpdate = 0.0f;
         anim->m_Elapsed = elapsed;
         n->m_Node.m_FlipbookAnimPosition = offset;
+        ++n->m_RenderGeneration;
     }
 
     static inline FetchTextureSetAnimResult FetchTextureSetAnim(HScene scene, InternalNode* n, dmhash_t anim)
@@ -4021,6 +4061,8 @@ Result DeleteDynamicTexture(HScene scene, const dmhash_t texture_hash)
         // update animationdata, compare state to current and early bail if equal
         TextureSetAnimDesc& anim_desc = n->m_Node.m_TextureSetAnimDesc;
         const TextureSetAnimDesc::State state_previous = anim_desc.m_State;
+        // The texture coordinates may have changed even if the state has not
+        ++n->m_RenderGeneration;
         if(FetchTextureSetAnim(scene, n, anim_hash)!=FETCH_ANIMATION_OK)
         {
             // general error in retreiving animation. This could be it being deleted or otherwise changed erraneously
@@ -4053,6 +4095,7 @@ Result DeleteDynamicTexture(HScene scene, const dmhash_t texture_hash)
         InternalNode* n = GetNode(scene, node);
         n->m_Node.m_FlipbookAnimPosition = 0.0f;
         n->m_Node.m_FlipbookAnimHash = 0x0;
+        ++n->m_RenderGeneration;
 
         if(anim == 0x0)
         {
@@ -4171,6 +4214,7 @@ Result DeleteDynamicTexture(HScene scene, const dmhash_t texture_hash)
     {
         InternalNode* n = GetNode(scene, node);
         n->m_Node.m_Enabled = enabled;
+        scene->m_RenderListDirty = 1;
         if(enabled)
         {
             SetDirtyLocalRecursive(scene, node);
@@ -915,6 +915,16 @@ namespace dmGui
 
     NodeType GetNodeType(HScene scene, HNode node);
 
+    /**
+     * Get the render generation of a node. It changes whenever the node changes in a way that affects its vertices,
+     * apart from the world transform and opacity that are passed to the render callback.
+     * Renderers use it to keep the vertices of unchanged nodes between frames.
+     * @param scene
+     * @param node
+     * @return
+     */
+    uint32_t GetNodeRenderGeneration(HScene scene, HNode node);
+
     Point3 GetNodePosition(HScene scene, HNode node);
     Matrix4 GetNodeWorldTransform(HScene scene, HNode node);
 
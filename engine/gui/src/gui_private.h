@@ -88,10 +88,8 @@ namespace dmGui
         uint32_t                        m_DefaultProjectHeight;
         uint32_t                        m_Dpi;
         dmArray<HScene>                 m_Scenes;
-        dmArray<RenderEntry>            m_RenderNodes;
         dmArray<Matrix4>                m_RenderTransforms;
         dmArray<float>                	m_RenderOpacities;
-        dmArray<InternalClippingNode>   m_StencilClippingNodes;
         dmArray<StencilScope*>          m_StencilScopes;
         dmArray<uint16_t>               m_StencilScopeIndices;
         dmArray<HNode>                  m_ScratchBoneNodes;
@@ -181,6 +179,8 @@ namespace dmGui
         uint16_t        m_ClipperIndex;
         uint16_t        m_Deleted : 1; // Set to true for deferred deletion
         uint16_t        m_Padding : 15;
+        // Increased whenever the node changes in a way that affects its vertices, apart from its world transform and opacity
+        uint32_t        m_RenderGeneration;
     };
 
     struct NodeProxy
@@ -302,6 +302,11 @@ namespace dmGui
         uint16_t                m_RenderOrder; // For the render-key
         uint16_t                m_NextLayerIndex;
         uint16_t                m_ResChanged : 1;
+        // The render entries and clippers need to be collected again, see RenderScene
+        uint16_t                m_RenderListDirty : 1;
+        // Sorted render entries and the clippers they refer to, kept between frames
+        dmArray<RenderEntry>    m_RenderEntries;
+        dmArray<InternalClippingNode> m_ClippingNodes;
         uint32_t                m_Width;
         uint32_t                m_Height;
         dmScript::ScriptWorld*  m_ScriptWorld;
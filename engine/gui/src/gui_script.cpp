@@ -2037,6 +2037,7 @@ namespace dmGui
         InternalNode* n = LuaCheckNode(L, 1, &hnode);
         int clipping_mode = (int) luaL_checknumber(L, 2);
         n->m_Node.m_ClippingMode = (ClippingMode) clipping_mode;
+        GetScene(L)->m_RenderListDirty = 1;
         return 0;
     }
 
@@ -2068,6 +2069,7 @@ namespace dmGui
         InternalNode* n = LuaCheckNode(L, 1, &hnode);
         int visible = lua_toboolean(L, 2);
         n->m_Node.m_ClippingVisible = visible;
+        GetScene(L)->m_RenderListDirty = 1;
         return 0;
     }
 
@@ -2099,6 +2101,7 @@ namespace dmGui
         InternalNode* n = LuaCheckNode(L, 1, &hnode);
         int inverted = lua_toboolean(L, 2);
         n->m_Node.m_ClippingInverted = inverted;
+        GetScene(L)->m_RenderListDirty = 1;
         return 0;
     }
 
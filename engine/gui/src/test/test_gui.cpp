@@ -4034,6 +4034,89 @@ TEST_F(dmGuiTest, MoveNodes)
     ASSERT_EQ(2u, order[n3]);
 }
 
+// The render entries are kept between frames until the node hierarchy changes
+TEST_F(dmGuiTest, RetainedRenderList)
+{
+    Vector3 size(10, 10, 0);
+    Point3 pos(size * 0.5f);
+    dmGui::HNode n1 = dmGui::NewNode(m_Scene, pos, size, dmGui::NODE_TYPE_BOX);
+    dmGui::HNode n2 = dmGui::NewNode(m_Scene, pos, size, dmGui::NODE_TYPE_BOX);
+
+    std::map<dmGui::HNode, uint16_t> order;
+    dmGui::RenderScene(m_Scene, RenderNodesOrder, &order);
+    ASSERT_FALSE(m_Scene->m_RenderListDirty);
+    ASSERT_EQ(2U, order.size());
+
+    // Property changes keep the render list
+    dmGui::SetNodeProperty(m_Scene, n1, dmGui::PROPERTY_COLOR, Vector4(1.0f, 0.0f, 0.0f, 1.0f));
+    dmGui::SetNodePosition(m_Scene, n2, Point3(1.0f, 2.0f, 0.0f));
+    ASSERT_FALSE(m_Scene->m_RenderListDirty);
+    dmGui::RenderScene(m_Scene, RenderNodesOrder, &order);
+    ASSERT_EQ(0u, order[n1]);
+    ASSERT_EQ(1u, order[n2]);
+
+    dmGui::MoveNodeAbove(m_Scene, n1, n2);
+    ASSERT_TRUE(m_Scene->m_RenderListDirty);
+    dmGui::RenderScene(m_Scene, RenderNodesOrder, &order);
+    ASSERT_EQ(1u, order[n1]);
+    ASSERT_EQ(0u, order[n2]);
+
+    dmGui::SetNodeEnabled(m_Scene, n2, false);
+    dmGui::RenderScene(m_Scene, RenderNodesOrder, &order);
+    ASSERT_EQ(1U, order.size());
+    ASSERT_EQ(0u, order[n1]);
+
+    dmGui::SetNodeEnabled(m_Scene, n2, true);
+    dmGui::SetNodeClippingMode(m_Scene, n2, dmGui::CLIPPING_MODE_STENCIL);
+    ASSERT_TRUE(m_Scene->m_RenderListDirty);
+    dmGui::SetNodeParent(m_Scene, n1, n2, false);
+    dmGui::RenderScene(m_Scene, RenderNodesOrder, &order);
+    ASSERT_EQ(2U, order.size());
+
+    dmGui::DeleteNode(m_Scene, n1, true);
+    dmGui::UpdateScene(m_Scene, 1.0f / 60.0f);
+    dmGui::RenderScene(m_Scene, RenderNodesOrder, &order);
+    ASSERT_EQ(1U, order.size());
+    ASSERT_EQ(1U, order.count(n2));
+}
+
+// The render generation only changes when the node does
+TEST_F(dmGuiTest, RenderGeneration)
+{
+    Vector3 size(10, 10, 0);
+    Point3 pos(size * 0.5f);
+    dmGui::HNode n1 = dmGui::NewNode(m_Scene, pos, size, dmGui::NODE_TYPE_BOX);
+    dmGui::HNode n2 = dmGui::NewNode(m_Scene, pos, size, dmGui::NODE_TYPE_BOX);
+    dmGui::SetNodeParent(m_Scene, n2, n1, false);
+
+    std::map<dmGui::HNode, uint16_t> order;
+    dmGui::RenderScene(m_Scene, RenderNodesOrder, &order);
+    uint32_t generation1 = dmGui::GetNodeRenderGeneration(m_Scene, n1);
+    uint32_t generation2 = dmGui::GetNodeRenderGeneration(m_Scene, n2);
+
+    dmGui::UpdateScene(m_Scene, 1.0f / 60.0f);
+    dmGui::RenderScene(m_Scene, RenderNodesOrder, &order);
+    ASSERT_EQ(generation1, dmGui::GetNodeRenderGeneration(m_Scene, n1));
+    ASSERT_EQ(generation2, dmGui::GetNodeRenderGeneration(m_Scene, n2));
+
+    // Changes to the parent only affect the world transform and opacity of the child
+    dmGui::SetNodeProperty(m_Scene, n1, dmGui::PROPERTY_COLOR, Vector4(1.0f, 0.0f, 0.0f, 1.0f));
+    dmGui::RenderScene(m_Scene, RenderNodesOrder, &order);
+    ASSERT_NE(generation1, dmGui::GetNodeRenderGeneration(m_Scene, n1));
+    ASSERT_EQ(generation2, dmGui::GetNodeRenderGeneration(m_Scene, n2));
+
+    generation2 = dmGui::GetNodeRenderGeneration(m_Scene, n2);
+    dmGui::SetNodePerimeterVertices(m_Scene, n2, 16);
+    ASSERT_NE(generation2, dmGui::GetNodeRenderGeneration(m_Scene, n2));
+
+    // Animations change the generation every frame they run
+    generation1 = dmGui::GetNodeRenderGeneration(m_Scene, n1);
+    dmGui::AnimateNodeHash(m_Scene, n1, dmGui::GetPropertyHash(dmGui::PROPERTY_COLOR), Vector4(0.0f, 0.0f, 0.0f, 0.0f), dmEasing::Curve(dmEasing::TYPE_LINEAR), dmGui::PLAYBACK_ONCE_FORWARD, 1.0f, 0.0f, 0x0, 0x0, 0x0);
+    dmGui::UpdateScene(m_Scene, 1.0f / 60.0f);
+    dmGui::RenderScene(m_Scene, RenderNodesOrder, &order);
+    ASSERT_NE(generation1, dmGui::GetNodeRenderGeneration(m_Scene, n1));
+}
+
 TEST_F(dmGuiTest, MoveNodesScript)
 {
     // Setup
@@ -20,6 +20,7 @@
 #include <dlib/vmath.h>
 #include <dlib/profile.h>
 #include <dlib/time.h>
+#include <dlib/simd.h>
 
 #include "particle.h"
 #include "particle_private.h"
@@ -28,6 +29,7 @@ namespace dmParticle
 {
     using namespace dmParticleDDF;
     using namespace Vectormath::Aos;
+    using namespace dmSimd;
 
     const static float EPSILON = 0.0001f;
     const static Vector3 PARTICLE_LOCAL_BASE_DIR = Vector3::yAxis();
@@ -254,6 +256,7 @@ namespace dmParticle
         {
             Emitter* emitter = &i->m_Emitters[emitter_i];
             emitter->m_Particles.SetCapacity(0);
+            emitter->m_Streams.m_Data.SetCapacity(0);
             emitter->m_RenderConstants.SetCapacity(0);
         }
         delete i;
@@ -275,6 +278,15 @@ namespace dmParticle
                 instance->m_NumAwakeEmitters -= 1;
             }
 
+            if (instance->m_DeferStateChanges)
+            {
+                assert(emitter->m_PendingStateChangeCount < MAX_PENDING_STATE_CHANGES);
+                PendingStateChange& change = emitter->m_PendingStateChanges[emitter->m_PendingStateChangeCount++];
+                change.m_NumAwakeEmitters = instance->m_NumAwakeEmitters;
+                change.m_State = state;
+                return;
+            }
+
             instance->m_EmitterStateChangedData.m_StateChangedCallback(
                 instance->m_NumAwakeEmitters,
                 emitter->m_Id,
@@ -283,6 +295,21 @@ namespace dmParticle
         }
     }
 
+    static void ReportPendingStateChanges(Instance* instance, Emitter* emitter)
+    {
+        uint32_t count = emitter->m_PendingStateChangeCount;
+        emitter->m_PendingStateChangeCount = 0;
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            const PendingStateChange& change = emitter->m_PendingStateChanges[i];
+            instance->m_EmitterStateChangedData.m_StateChangedCallback(
+                change.m_NumAwakeEmitters,
+                emitter->m_Id,
+                change.m_State,
+                instance->m_EmitterStateChangedData.m_UserData);
+        }
+    }
+
     static bool IsSleeping(Emitter* emitter);
     static void UpdateEmitter(Prototype* prototype, Instance* instance, EmitterPrototype* emitter_prototype, Emitter* emitter, dmParticleDDF::Emitter* emitter_ddf, float dt);
 
@@ -360,6 +387,7 @@ namespace dmParticle
                 for (uint32_t emitter_i = prototype_emitter_count; emitter_i < emitter_count; ++emitter_i)
                 {
                     emitters[emitter_i].m_Particles.SetCapacity(0);
+                    emitters[emitter_i].m_Streams.m_Data.SetCapacity(0);
                 }
             }
             emitters.SetCapacity(prototype_emitter_count);
@@ -573,10 +601,11 @@ namespace dmParticle
 
     // helper functions in update
     static void FetchAnimation(Emitter* emitter, EmitterPrototype* prototype, FetchAnimationCallback fetch_animation_callback);
+    static void UpdateEmitterBounds(Instance* instance, Emitter* emitter, dmParticleDDF::Emitter* ddf);
     static void UpdateParticles(Instance* instance, Emitter* emitter, dmParticleDDF::Emitter* emitter_ddf, float dt);
     static void UpdateEmitterState(Instance* instance, Emitter* emitter, EmitterPrototype* emitter_prototype, dmParticleDDF::Emitter* emitter_ddf, float dt);
     static void EvaluateEmitterProperties(Emitter* emitter, Property* emitter_properties, float duration, float properties[EMITTER_KEY_COUNT]);
-    static void EvaluateParticleProperties(Emitter* emitter, Property* particle_properties, dmParticleDDF::Emitter* emitter_ddf, float dt);
+    static void EvaluateParticleProperties(Emitter* emitter, EmitterPrototype* prototype, dmParticleDDF::Emitter* emitter_ddf, float dt);
     static uint32_t UpdateRenderData(HParticleContext context, Instance* instance, Emitter* emitter, dmParticleDDF::Emitter* ddf, const Vector4& color, uint32_t vertex_index, void* vertex_buffer, uint32_t vertex_buffer_size, float dt, ParticleVertexFormat format);
     static void GenerateKeys(Emitter* emitter, float max_particle_life_time);
     static void SortParticles(Emitter* emitter);
@@ -654,12 +683,156 @@ namespace dmParticle
         context->m_Stats.m_Particles = vertex_index / 6; // Debug data for editor playback
     }
 
+    // Particles generated or updated per frame before the work is spread over the job pool. Less work is done on the calling thread
+    static const uint32_t PARTICLE_JOB_MIN_PARTICLE_COUNT = 1024;
+
+    struct GenerateVertexDataContext
+    {
+        HParticleContext        m_Context;
+        Instance**              m_Instances;
+        EmitterRenderData* const* m_Emitters;
+        // The first vertex of each emitter, and after the last emitter the end of the vertices
+        uint32_t*               m_VertexIndices;
+        const Vector4*          m_Color;
+        void*                   m_VertexBuffer;
+        uint32_t                m_VertexSize;
+        float                   m_DT;
+        ParticleVertexFormat    m_VertexFormat;
+    };
+
+    static void GenerateEmitterVertexData(void* _context, uint32_t begin, uint32_t end)
+    {
+        GenerateVertexDataContext* context = (GenerateVertexDataContext*) _context;
+        for (uint32_t i = begin; i < end; ++i)
+        {
+            Instance* inst = context->m_Instances[i];
+            if (inst == 0x0)
+                continue;
+            uint32_t emitter_index = context->m_Emitters[i]->m_EmitterIndex;
+            Emitter* emitter = &inst->m_Emitters[emitter_index];
+            dmParticleDDF::Emitter* emitter_ddf = &inst->m_Prototype->m_DDF->m_Emitters[emitter_index];
+            // The end of the range of the emitter acts as the end of the buffer, so the particles that did not fit are treated the same way
+            uint32_t vertex_buffer_size = context->m_VertexIndices[i + 1] * context->m_VertexSize;
+            UpdateRenderData(context->m_Context, inst, emitter, emitter_ddf, *context->m_Color, context->m_VertexIndices[i], context->m_VertexBuffer, vertex_buffer_size, context->m_DT, context->m_VertexFormat);
+        }
+    }
+
+    void GenerateVertexData(HParticleContext context, float dt, EmitterRenderData* const* emitters, uint32_t emitter_count, const Vector4& color, void* vertex_buffer, uint32_t vertex_buffer_size, uint32_t* out_vertex_buffer_size, ParticleVertexFormat vertex_format)
+    {
+        DM_PROFILE(Particle, "GenerateVertexData");
+
+        uint32_t vertex_size = sizeof(Vertex);
+        if (vertex_format == PARTICLE_GUI)
+        {
+            vertex_size = sizeof(ParticleGuiVertex);
+        }
+
+        uint32_t vertex_index = *out_vertex_buffer_size / vertex_size;
+        if (vertex_buffer == 0x0 || vertex_buffer_size == 0)
+        {
+            return;
+        }
+
+        dmArray<Instance*>& instances = context->m_VertexInstances;
+        dmArray<uint32_t>& vertex_indices = context->m_VertexIndices;
+        if (instances.Capacity() < emitter_count)
+        {
+            instances.SetCapacity(emitter_count);
+            vertex_indices.SetCapacity(emitter_count + 1);
+        }
+        instances.SetSize(emitter_count);
+        vertex_indices.SetSize(emitter_count + 1);
+
+        // Assign the ranges of the vertex buffer up front, in emitter order, so the emitters can be generated independently
+        const uint32_t vertices_per_particle = 6;
+        uint32_t max_vertex_count = vertex_buffer_size / vertex_size;
+        uint32_t particle_count = 0;
+        for (uint32_t i = 0; i < emitter_count; ++i)
+        {
+            vertex_indices[i] = vertex_index;
+            Instance* inst = GetInstance(context, emitters[i]->m_Instance);
+            if (inst != 0x0 && IsSleeping(inst))
+            {
+                inst = 0x0;
+            }
+            instances[i] = inst;
+            if (inst != 0x0)
+            {
+                Emitter* emitter = &inst->m_Emitters[emitters[i]->m_EmitterIndex];
+                uint32_t emitter_particle_count = emitter->m_Particles.Size();
+                uint32_t free_particle_count = vertex_index + vertices_per_particle <= max_vertex_count ? (max_vertex_count - vertex_index) / vertices_per_particle : 0;
+                emitter_particle_count = dmMath::Min(emitter_particle_count, free_particle_count);
+                vertex_index += emitter_particle_count * vertices_per_particle;
+                particle_count += emitter_particle_count;
+            }
+        }
+        vertex_indices[emitter_count] = vertex_index;
+
+        GenerateVertexDataContext job_context;
+        job_context.m_Context = context;
+        job_context.m_Instances = instances.Begin();
+        job_context.m_Emitters = emitters;
+        job_context.m_VertexIndices = vertex_indices.Begin();
+        job_context.m_Color = &color;
+        job_context.m_VertexBuffer = vertex_buffer;
+        job_context.m_VertexSize = vertex_size;
+        job_context.m_DT = dt;
+        job_context.m_VertexFormat = vertex_format;
+        dmJobPool::HJobPool job_pool = particle_count >= PARTICLE_JOB_MIN_PARTICLE_COUNT ? context->m_JobPool : 0x0;
+        dmJobPool::ParallelFor(job_pool, emitter_count, 1, GenerateEmitterVertexData, &job_context);
+
+        *out_vertex_buffer_size = vertex_index * vertex_size;
+
+        context->m_Stats.m_Particles = vertex_index / 6; // Debug data for editor playback
+    }
+
+    void SetJobPool(HParticleContext context, dmJobPool::HJobPool job_pool)
+    {
+        context->m_JobPool = job_pool;
+    }
+
+    struct UpdateInstancesContext
+    {
+        HParticleContext    m_Context;
+        const uint32_t*     m_InstanceIndices;
+        float               m_DT;
+        // Set if the instances are updated on the worker threads
+        bool                m_DeferStateChanges;
+    };
+
+    // The emitters of an instance are updated by the same job, since they share the instance state
+    static void UpdateInstances(void* _context, uint32_t begin, uint32_t end)
+    {
+        UpdateInstancesContext* context = (UpdateInstancesContext*) _context;
+        float dt = context->m_DT;
+        for (uint32_t i = begin; i < end; ++i)
+        {
+            Instance* instance = context->m_Context->m_Instances[context->m_InstanceIndices[i]];
+            Prototype* prototype = instance->m_Prototype;
+            // The state changed callbacks are called on the calling thread, after the update
+            instance->m_DeferStateChanges = context->m_DeferStateChanges;
+            uint32_t emitter_count = instance->m_Emitters.Size();
+            for (uint32_t emitter_i = 0; emitter_i < emitter_count; ++emitter_i)
+            {
+                Emitter* emitter = &instance->m_Emitters[emitter_i];
+                EmitterPrototype* emitter_prototype = &prototype->m_Emitters[emitter_i];
+                dmParticleDDF::Emitter* emitter_ddf = &prototype->m_DDF->m_Emitters[emitter_i];
+
+                UpdateEmitterVelocity(instance, emitter, emitter_ddf, dt);
+                UpdateEmitter(prototype, instance, emitter_prototype, emitter, emitter_ddf, dt);
+            }
+            instance->m_DeferStateChanges = 0;
+        }
+    }
+
     void Update(HParticleContext context, float dt, FetchAnimationCallback fetch_animation_callback)
     {
         DM_PROFILE(Particle, "Update");
 
+        dmArray<uint32_t>& update_instances = context->m_UpdateInstances;
+        update_instances.SetSize(0);
         uint32_t size = context->m_Instances.Size();
-        uint32_t TotalAliveParticles = 0;
+        uint32_t particle_count = 0;
         for (uint32_t i = 0; i < size; i++)
         {
             Instance* instance = context->m_Instances[i];
@@ -675,13 +848,36 @@ namespace dmParticle
                 {
                     Emitter* emitter = &instance->m_Emitters[emitter_i];
                     emitter->m_VertexCount = 0;
+                    emitter->m_RenderData.m_HasBounds = 0;
                     dmParticleDDF::Emitter* emitter_ddf = &instance->m_Prototype->m_DDF->m_Emitters[emitter_i];
                     UpdateEmitterVelocity(instance, emitter, emitter_ddf, dt);
                 }
                 continue;
             }
-            uint32_t instance_handle = instance->m_VersionNumber << 16 | i;
             instance->m_PlayTime += dt;
+            update_instances.Push(i);
+            uint32_t emitter_count = instance->m_Emitters.Size();
+            for (uint32_t emitter_i = 0; emitter_i < emitter_count; ++emitter_i)
+            {
+                particle_count += instance->m_Emitters[emitter_i].m_Particles.Size();
+            }
+        }
+
+        UpdateInstancesContext job_context;
+        job_context.m_Context = context;
+        job_context.m_InstanceIndices = update_instances.Begin();
+        job_context.m_DT = dt;
+        dmJobPool::HJobPool job_pool = particle_count >= PARTICLE_JOB_MIN_PARTICLE_COUNT ? context->m_JobPool : 0x0;
+        job_context.m_DeferStateChanges = job_pool != 0x0 && dmJobPool::GetWorkerCount(job_pool) > 0 && update_instances.Size() > 1;
+        dmJobPool::ParallelFor(job_pool, update_instances.Size(), 1, UpdateInstances, &job_context);
+
+        uint32_t TotalAliveParticles = 0;
+        uint32_t update_count = update_instances.Size();
+        for (uint32_t i = 0; i < update_count; ++i)
+        {
+            uint32_t index = update_instances[i];
+            Instance* instance = context->m_Instances[index];
+            uint32_t instance_handle = instance->m_VersionNumber << 16 | index;
             Prototype* prototype = instance->m_Prototype;
             uint32_t emitter_count = instance->m_Emitters.Size();
             for (uint32_t emitter_i = 0; emitter_i < emitter_count; ++emitter_i)
@@ -690,11 +886,11 @@ namespace dmParticle
                 EmitterPrototype* emitter_prototype = &prototype->m_Emitters[emitter_i];
                 dmParticleDDF::Emitter* emitter_ddf = &prototype->m_DDF->m_Emitters[emitter_i];
 
-                UpdateEmitterVelocity(instance, emitter, emitter_ddf, dt);
-                UpdateEmitter(prototype, instance, emitter_prototype, emitter, emitter_ddf, dt);
+                ReportPendingStateChanges(instance, emitter);
                 TotalAliveParticles += (uint32_t)emitter->m_Particles.Size();
                 FetchAnimation(emitter, emitter_prototype, fetch_animation_callback);
                 UpdateEmitterRenderData(instance_handle, emitter_i, instance, emitter, emitter_ddf);
+                UpdateEmitterBounds(instance, emitter, emitter_ddf);
 
                 if (emitter->m_ReHash)
                     ReHashEmitter(emitter);
@@ -1290,10 +1486,20 @@ namespace dmParticle
         }
     }
 
-    void EvaluateParticleProperties(Emitter* emitter, Property* particle_properties, dmParticleDDF::Emitter* emitter_ddf, float dt)
+    // Same as SAMPLE_PROP for the four lanes starting at lane, t being the distance from the segment start
+    static inline Float4 SampleLanes4(const ParticlePropertySegment& segment, uint32_t lane, Float4 t)
     {
-        float properties[PARTICLE_KEY_COUNT];
-        // TODO Optimize this
+        return Add4(Mul4(t, Load4(&segment.m_K[lane])), Load4(&segment.m_Y[lane]));
+    }
+
+    void EvaluateParticleProperties(Emitter* emitter, EmitterPrototype* prototype, dmParticleDDF::Emitter* emitter_ddf, float dt)
+    {
+        const ParticlePropertySegment* segments = prototype->m_ParticleSegments;
+        const Property* particle_properties = prototype->m_ParticleProperties;
+        const Float4 zero = Splat4(0.0f);
+        const Float4 one = Splat4(1.0f);
+        const ParticleOrientation orientation = emitter_ddf->m_ParticleOrientation;
+        float properties[PARTICLE_LANE_COUNT];
         dmArray<Particle>& particles = emitter->m_Particles;
         uint32_t count = particles.Size();
         for (uint32_t i = 0; i < count; ++i)
@@ -1302,31 +1508,22 @@ namespace dmParticle
             float x = dmMath::Select(-particle->GetMaxLifeTime(), 0.0f, 1.0f - particle->GetTimeLeft() * particle->GetooMaxLifeTime());
             uint32_t segment_index = dmMath::Min((uint32_t)(x * PROPERTY_SAMPLE_COUNT), PROPERTY_SAMPLE_COUNT - 1);
 
-            SAMPLE_PROP(particle_properties[PARTICLE_KEY_SCALE].m_Segments[segment_index], x, properties[PARTICLE_KEY_SCALE])
-            SAMPLE_PROP(particle_properties[PARTICLE_KEY_RED].m_Segments[segment_index], x, properties[PARTICLE_KEY_RED])
-            SAMPLE_PROP(particle_properties[PARTICLE_KEY_GREEN].m_Segments[segment_index], x, properties[PARTICLE_KEY_GREEN])
-            SAMPLE_PROP(particle_properties[PARTICLE_KEY_BLUE].m_Segments[segment_index], x, properties[PARTICLE_KEY_BLUE])
-            SAMPLE_PROP(particle_properties[PARTICLE_KEY_ALPHA].m_Segments[segment_index], x, properties[PARTICLE_KEY_ALPHA])
-            SAMPLE_PROP(particle_properties[PARTICLE_KEY_STRETCH_FACTOR_X].m_Segments[segment_index], x, properties[PARTICLE_KEY_STRETCH_FACTOR_X])
-            SAMPLE_PROP(particle_properties[PARTICLE_KEY_STRETCH_FACTOR_Y].m_Segments[segment_index], x, properties[PARTICLE_KEY_STRETCH_FACTOR_Y])
+            // The segment start is exact, since it is a multiple of a power of two
+            const ParticlePropertySegment& segment = segments[segment_index];
+            Float4 t = Splat4(x - segment_index * (1.0f / PROPERTY_SAMPLE_COUNT));
+            Float4 color_factors = SampleLanes4(segment, PARTICLE_LANE_RED, t);
+            Store4(&properties[PARTICLE_LANE_SCALE], SampleLanes4(segment, PARTICLE_LANE_SCALE, t));
+
             Vector4 c = particle->GetSourceColor();
-            particle->SetScale(Vector3(properties[PARTICLE_KEY_SCALE]));
-            particle->SetColor(Vector4(dmMath::Clamp(c.getX() * properties[PARTICLE_KEY_RED], 0.0f, 1.0f),
-                    dmMath::Clamp(c.getY() * properties[PARTICLE_KEY_GREEN], 0.0f, 1.0f),
-                    dmMath::Clamp(c.getZ() * properties[PARTICLE_KEY_BLUE], 0.0f, 1.0f),
-                    dmMath::Clamp(c.getW() * properties[PARTICLE_KEY_ALPHA], 0.0f, 1.0f)));
-            particle->m_StretchFactorX = particle->m_SourceStretchFactorX + (properties[PARTICLE_KEY_STRETCH_FACTOR_X]);
-            particle->m_StretchFactorY = particle->m_SourceStretchFactorY + (properties[PARTICLE_KEY_STRETCH_FACTOR_Y]);
-        }
+            Store4(properties, Min4(Max4(Mul4(Set4(c.getX(), c.getY(), c.getZ(), c.getW()), color_factors), zero), one));
+            particle->SetScale(Vector3(properties[PARTICLE_LANE_SCALE]));
+            particle->SetColor(Vector4(properties[PARTICLE_LANE_RED], properties[PARTICLE_LANE_GREEN], properties[PARTICLE_LANE_BLUE], properties[PARTICLE_LANE_ALPHA]));
+            particle->m_StretchFactorX = particle->m_SourceStretchFactorX + (properties[PARTICLE_LANE_STRETCH_FACTOR_X]);
+            particle->m_StretchFactorY = particle->m_SourceStretchFactorY + (properties[PARTICLE_LANE_STRETCH_FACTOR_Y]);
 
-        if (emitter_ddf->m_ParticleOrientation == PARTICLE_ORIENTATION_MOVEMENT_DIRECTION) {
-            for (uint32_t i = 0; i < count; ++i)
+            if (orientation == PARTICLE_ORIENTATION_MOVEMENT_DIRECTION)
             {
-                Particle* particle = &particles[i];
-                float x = dmMath::Select(-particle->GetMaxLifeTime(), 0.0f, 1.0f - particle->GetTimeLeft() * particle->GetooMaxLifeTime());
-                uint32_t segment_index = dmMath::Min((uint32_t)(x * PROPERTY_SAMPLE_COUNT), PROPERTY_SAMPLE_COUNT - 1);
-                SAMPLE_PROP(particle_properties[PARTICLE_KEY_ROTATION].m_Segments[segment_index], x, properties[PARTICLE_KEY_ROTATION])
-                particle->SetRotation(particle->GetSourceRotation() * dmVMath::QuatFromAngle(2, DEG_RAD * properties[PARTICLE_KEY_ROTATION]));
+                particle->SetRotation(particle->GetSourceRotation() * dmVMath::QuatFromAngle(2, DEG_RAD * properties[PARTICLE_LANE_ROTATION]));
                 if (lengthSqr(particle->m_Velocity) > EPSILON)
                 {
                     Vector3 vel_norm = normalize(particle->m_Velocity);
@@ -1337,68 +1534,136 @@ namespace dmParticle
                     particle->SetRotation(q);
                 }
             }
-
-        } else if (emitter_ddf->m_ParticleOrientation == PARTICLE_ORIENTATION_ANGULAR_VELOCITY) {
-            for (uint32_t i = 0; i < count; ++i)
+            else if (orientation == PARTICLE_ORIENTATION_ANGULAR_VELOCITY)
             {
-                Particle* particle = &particles[i];
-                float x = dmMath::Select(-particle->GetMaxLifeTime(), 0.0f, 1.0f - particle->GetTimeLeft() * particle->GetooMaxLifeTime());
-                uint32_t segment_index = dmMath::Min((uint32_t)(x * PROPERTY_SAMPLE_COUNT), PROPERTY_SAMPLE_COUNT - 1);
-                SAMPLE_PROP(particle_properties[PARTICLE_KEY_ANGULAR_VELOCITY].m_Segments[segment_index], x, properties[PARTICLE_KEY_ANGULAR_VELOCITY])
-                particle->SetRotation(particle->GetRotation() * Quat::rotationZ(DEG_RAD * (particle->m_SourceAngularVelocity * (properties[PARTICLE_KEY_ANGULAR_VELOCITY])) * dt));
+                float angular_velocity;
+                SAMPLE_PROP(particle_properties[PARTICLE_KEY_ANGULAR_VELOCITY].m_Segments[segment_index], x, angular_velocity)
+                particle->SetRotation(particle->GetRotation() * Quat::rotationZ(DEG_RAD * (particle->m_SourceAngularVelocity * angular_velocity) * dt));
             }
-
-        } else {
-            for (uint32_t i = 0; i < count; ++i)
+            else
             {
-                Particle* particle = &particles[i];
-                float x = dmMath::Select(-particle->GetMaxLifeTime(), 0.0f, 1.0f - particle->GetTimeLeft() * particle->GetooMaxLifeTime());
-                uint32_t segment_index = dmMath::Min((uint32_t)(x * PROPERTY_SAMPLE_COUNT), PROPERTY_SAMPLE_COUNT - 1);
-                SAMPLE_PROP(particle_properties[PARTICLE_KEY_ROTATION].m_Segments[segment_index], x, properties[PARTICLE_KEY_ROTATION])
-                particle->SetRotation(particle->GetSourceRotation() * dmVMath::QuatFromAngle(2, DEG_RAD * properties[PARTICLE_KEY_ROTATION]));
+                particle->SetRotation(particle->GetSourceRotation() * dmVMath::QuatFromAngle(2, DEG_RAD * properties[PARTICLE_LANE_ROTATION]));
             }
         }
+    }
 
+    static inline float* GetStream(ParticleStreams& streams, ParticleStream stream)
+    {
+        return streams.m_Data.Begin() + stream * streams.m_Stride;
     }
 
-    void ApplyAcceleration(dmArray<Particle>& particles, Property* modifier_properties, const Quat& rotation, float scale, float emitter_t, float dt)
+    static void GatherParticleStreams(const dmArray<Particle>& particles, ParticleStreams& streams)
     {
         uint32_t particle_count = particles.Size();
+        uint32_t stride = (particle_count + 3) & ~3u;
+        uint32_t size = stride * PARTICLE_STREAM_COUNT;
+        if (streams.m_Data.Capacity() < size)
+        {
+            // Room for all of the particles the emitter can have, to not reallocate while it's spawning
+            streams.m_Data.SetCapacity(((particles.Capacity() + 3) & ~3u) * PARTICLE_STREAM_COUNT);
+        }
+        streams.m_Data.SetSize(size);
+        streams.m_Stride = stride;
+
+        float* px = GetStream(streams, PARTICLE_STREAM_POSITION_X);
+        float* py = GetStream(streams, PARTICLE_STREAM_POSITION_Y);
+        float* pz = GetStream(streams, PARTICLE_STREAM_POSITION_Z);
+        float* vx = GetStream(streams, PARTICLE_STREAM_VELOCITY_X);
+        float* vy = GetStream(streams, PARTICLE_STREAM_VELOCITY_Y);
+        float* vz = GetStream(streams, PARTICLE_STREAM_VELOCITY_Z);
+        float* sf = GetStream(streams, PARTICLE_STREAM_SPREAD_FACTOR);
+        for (uint32_t i = 0; i < particle_count; ++i)
+        {
+            const Particle& p = particles[i];
+            px[i] = p.m_Position.getX();
+            py[i] = p.m_Position.getY();
+            pz[i] = p.m_Position.getZ();
+            vx[i] = p.m_Velocity.getX();
+            vy[i] = p.m_Velocity.getY();
+            vz[i] = p.m_Velocity.getZ();
+            sf[i] = p.m_SpreadFactor;
+        }
+        for (uint32_t i = particle_count; i < stride; ++i)
+        {
+            px[i] = py[i] = pz[i] = 0.0f;
+            vx[i] = vy[i] = vz[i] = 0.0f;
+            sf[i] = 0.0f;
+        }
+    }
+
+    void ApplyAcceleration(ParticleStreams& streams, Property* modifier_properties, const Quat& rotation, float scale, float emitter_t, float dt)
+    {
         Vector3 acc_step = rotate(rotation, ACCELERATION_LOCAL_DIR) * dt * scale;
         const Property& magnitude_property = modifier_properties[MODIFIER_KEY_MAGNITUDE];
         uint32_t segment_index = dmMath::Min((uint32_t)(emitter_t * PROPERTY_SAMPLE_COUNT), PROPERTY_SAMPLE_COUNT - 1);
         float magnitude;
         SAMPLE_PROP(magnitude_property.m_Segments[segment_index], emitter_t, magnitude)
-        float mag_spread = magnitude_property.m_Spread;
-        for (uint32_t i = 0; i < particle_count; ++i)
+
+        const Float4 acc_x = Splat4(acc_step.getX());
+        const Float4 acc_y = Splat4(acc_step.getY());
+        const Float4 acc_z = Splat4(acc_step.getZ());
+        const Float4 mag = Splat4(magnitude);
+        const Float4 mag_spread = Splat4(magnitude_property.m_Spread);
+        float* vx = GetStream(streams, PARTICLE_STREAM_VELOCITY_X);
+        float* vy = GetStream(streams, PARTICLE_STREAM_VELOCITY_Y);
+        float* vz = GetStream(streams, PARTICLE_STREAM_VELOCITY_Z);
+        const float* sf = GetStream(streams, PARTICLE_STREAM_SPREAD_FACTOR);
+        uint32_t stride = streams.m_Stride;
+        for (uint32_t i = 0; i < stride; i += 4)
         {
-            Particle* particle = &particles[i];
-            particle->SetVelocity(particle->GetVelocity() + acc_step * (magnitude + mag_spread * particle->GetSpreadFactor()));
+            Float4 a = Add4(mag, Mul4(mag_spread, Load4(sf + i)));
+            Store4(vx + i, Add4(Load4(vx + i), Mul4(acc_x, a)));
+            Store4(vy + i, Add4(Load4(vy + i), Mul4(acc_y, a)));
+            Store4(vz + i, Add4(Load4(vz + i), Mul4(acc_z, a)));
         }
     }
 
-    void ApplyDrag(dmArray<Particle>& particles, Property* modifier_properties, dmParticleDDF::Modifier* modifier_ddf, const Quat& rotation, float emitter_t, float dt)
+    void ApplyDrag(ParticleStreams& streams, Property* modifier_properties, dmParticleDDF::Modifier* modifier_ddf, const Quat& rotation, float emitter_t, float dt)
     {
-        uint32_t particle_count = particles.Size();
         Vector3 direction = rotate(rotation, DRAG_LOCAL_DIR);
         const Property& magnitude_property = modifier_properties[MODIFIER_KEY_MAGNITUDE];
         uint32_t segment_index = dmMath::Min((uint32_t)(emitter_t * PROPERTY_SAMPLE_COUNT), PROPERTY_SAMPLE_COUNT - 1);
         float magnitude;
         SAMPLE_PROP(magnitude_property.m_Segments[segment_index], emitter_t, magnitude)
-        float mag_spread = magnitude_property.m_Spread;
-        for (uint32_t i = 0; i < particle_count; ++i)
-        {
-            Particle* particle = &particles[i];
-            Vector3 v = particle->GetVelocity();
-            if (modifier_ddf->m_UseDirection)
-                v = projection(Point3(particle->GetVelocity()), direction) * direction;
+
+        const Float4 dir_x = Splat4(direction.getX());
+        const Float4 dir_y = Splat4(direction.getY());
+        const Float4 dir_z = Splat4(direction.getZ());
+        const Float4 mag = Splat4(magnitude);
+        const Float4 mag_spread = Splat4(magnitude_property.m_Spread);
+        const Float4 dt4 = Splat4(dt);
+        const Float4 one = Splat4(1.0f);
+        const bool use_direction = modifier_ddf->m_UseDirection;
+        float* vx = GetStream(streams, PARTICLE_STREAM_VELOCITY_X);
+        float* vy = GetStream(streams, PARTICLE_STREAM_VELOCITY_Y);
+        float* vz = GetStream(streams, PARTICLE_STREAM_VELOCITY_Z);
+        const float* sf = GetStream(streams, PARTICLE_STREAM_SPREAD_FACTOR);
+        uint32_t stride = streams.m_Stride;
+        for (uint32_t i = 0; i < stride; i += 4)
+        {
+            Float4 v_x = Load4(vx + i);
+            Float4 v_y = Load4(vy + i);
+            Float4 v_z = Load4(vz + i);
+            // The part of the velocity which is dragged
+            Float4 d_x = v_x;
+            Float4 d_y = v_y;
+            Float4 d_z = v_z;
+            if (use_direction)
+            {
+                Float4 projection = Add4(Add4(Mul4(v_x, dir_x), Mul4(v_y, dir_y)), Mul4(v_z, dir_z));
+                d_x = Mul4(dir_x, projection);
+                d_y = Mul4(dir_y, projection);
+                d_z = Mul4(dir_z, projection);
+            }
             // Applied drag > 1 means the particle would travel in the reverse direction
-            float applied_drag = dmMath::Min((magnitude + mag_spread * particle->GetSpreadFactor()) * dt, 1.0f);
-            particle->SetVelocity(particle->GetVelocity() - v * applied_drag);
+            Float4 applied_drag = Min4(Mul4(Add4(mag, Mul4(mag_spread, Load4(sf + i))), dt4), one);
+            Store4(vx + i, Sub4(v_x, Mul4(d_x, applied_drag)));
+            Store4(vy + i, Sub4(v_y, Mul4(d_y, applied_drag)));
+            Store4(vz + i, Sub4(v_z, Mul4(d_z, applied_drag)));
         }
     }
 
-    static Vector3 GetParticleDir(Particle* particle)
+    static Vector3 GetParticleDir(const Particle* particle)
     {
         return rotate(particle->GetRotation(), PARTICLE_LOCAL_BASE_DIR);
     }
@@ -1413,7 +1678,8 @@ namespace dmParticle
         return result;
     }
 
-    void ApplyRadial(dmArray<Particle>& particles, Property* modifier_properties, const Point3& position, float scale, float emitter_t, float dt)
+    // The radial and vortex modifiers normalize per particle, and fall back to the particle rotation, so they stay scalar over the streams
+    void ApplyRadial(ParticleStreams& streams, const dmArray<Particle>& particles, Property* modifier_properties, const Point3& position, float scale, float emitter_t, float dt)
     {
         uint32_t particle_count = particles.Size();
         const Property& magnitude_property = modifier_properties[MODIFIER_KEY_MAGNITUDE];
@@ -1426,22 +1692,30 @@ namespace dmParticle
         float max_distance = max_distance_property.m_Segments[0].m_Y * scale;
         float max_sq_distance = max_distance * max_distance;
         float applied_factor = dt * scale;
+        const float* px = GetStream(streams, PARTICLE_STREAM_POSITION_X);
+        const float* py = GetStream(streams, PARTICLE_STREAM_POSITION_Y);
+        const float* pz = GetStream(streams, PARTICLE_STREAM_POSITION_Z);
+        float* vx = GetStream(streams, PARTICLE_STREAM_VELOCITY_X);
+        float* vy = GetStream(streams, PARTICLE_STREAM_VELOCITY_Y);
+        float* vz = GetStream(streams, PARTICLE_STREAM_VELOCITY_Z);
+        const float* sf = GetStream(streams, PARTICLE_STREAM_SPREAD_FACTOR);
         for (uint32_t i = 0; i < particle_count; ++i)
         {
-            Particle* particle = &particles[i];
-            Vector3 delta = particle->GetPosition() - position;
+            Vector3 delta = Point3(px[i], py[i], pz[i]) - position;
             float delta_sq_len = lengthSqr(delta);
-            float applied_magnitude = magnitude + mag_spread * particle->GetSpreadFactor();
+            float applied_magnitude = magnitude + mag_spread * sf[i];
             // 0 acc delta lies outside max dist
             float a = dmMath::Select(max_sq_distance - delta_sq_len, applied_magnitude, 0.0f);
-            Vector3 dir = normalize(NonZeroVector3(delta, delta_sq_len, GetParticleDir(particle)));
-            particle->SetVelocity(particle->GetVelocity() + dir * a * applied_factor);
+            Vector3 dir = normalize(NonZeroVector3(delta, delta_sq_len, GetParticleDir(&particles[i])));
+            Vector3 acc = dir * a * applied_factor;
+            vx[i] += acc.getX();
+            vy[i] += acc.getY();
+            vz[i] += acc.getZ();
         }
     }
 
-    void ApplyVortex(dmArray<Particle>& particles, Property* modifier_properties, const Point3& position, const Quat& rotation, float scale, float emitter_t, float dt)
+    void ApplyVortex(ParticleStreams& streams, uint32_t particle_count, Property* modifier_properties, const Point3& position, const Quat& rotation, float scale, float emitter_t, float dt)
     {
-        uint32_t particle_count = particles.Size();
         const Property& magnitude_property = modifier_properties[MODIFIER_KEY_MAGNITUDE];
         const Property& max_distance_property = modifier_properties[MODIFIER_KEY_MAX_DISTANCE];
         uint32_t segment_index = dmMath::Min((uint32_t)(emitter_t * PROPERTY_SAMPLE_COUNT), PROPERTY_SAMPLE_COUNT - 1);
@@ -1454,11 +1728,17 @@ namespace dmParticle
         Vector3 axis = rotate(rotation, VORTEX_LOCAL_AXIS);
         Vector3 start = rotate(rotation, VORTEX_LOCAL_START_DIR);
         float applied_factor = dt * scale;
+        const float* px = GetStream(streams, PARTICLE_STREAM_POSITION_X);
+        const float* py = GetStream(streams, PARTICLE_STREAM_POSITION_Y);
+        const float* pz = GetStream(streams, PARTICLE_STREAM_POSITION_Z);
+        float* vx = GetStream(streams, PARTICLE_STREAM_VELOCITY_X);
+        float* vy = GetStream(streams, PARTICLE_STREAM_VELOCITY_Y);
+        float* vz = GetStream(streams, PARTICLE_STREAM_VELOCITY_Z);
+        const float* sf = GetStream(streams, PARTICLE_STREAM_SPREAD_FACTOR);
         for (uint32_t i = 0; i < particle_count; ++i)
         {
-            Particle* particle = &particles[i];
             // delta from vortex position
-            Vector3 delta = particle->GetPosition() - position;
+            Vector3 delta = Point3(px[i], py[i], pz[i]) - position;
             // normal from vortex axis (non-unit)
             Vector3 normal = delta - projection(Point3(delta), axis) * axis;
             // tangent is the direction of the vortex acceleration
@@ -1469,8 +1749,46 @@ namespace dmParticle
             tangent = normalize(tangent);
             // use normal for max distance test
             float normal_sq_len = lengthSqr(normal);
-            float acceleration = dmMath::Select(max_sq_distance - normal_sq_len, magnitude + mag_spread * particle->GetSpreadFactor(), 0.0f);
-            particle->SetVelocity(particle->GetVelocity() + tangent * acceleration * applied_factor);
+            float acceleration = dmMath::Select(max_sq_distance - normal_sq_len, magnitude + mag_spread * sf[i], 0.0f);
+            Vector3 acc = tangent * acceleration * applied_factor;
+            vx[i] += acc.getX();
+            vy[i] += acc.getY();
+            vz[i] += acc.getZ();
+        }
+    }
+
+    // Integrates the positions, and copies the positions and velocities back to the particles
+    static void IntegrateParticleStreams(dmArray<Particle>& particles, ParticleStreams& streams, dmParticleDDF::Emitter* ddf, float dt)
+    {
+        float* px = GetStream(streams, PARTICLE_STREAM_POSITION_X);
+        float* py = GetStream(streams, PARTICLE_STREAM_POSITION_Y);
+        float* pz = GetStream(streams, PARTICLE_STREAM_POSITION_Z);
+        const float* vx = GetStream(streams, PARTICLE_STREAM_VELOCITY_X);
+        const float* vy = GetStream(streams, PARTICLE_STREAM_VELOCITY_Y);
+        const float* vz = GetStream(streams, PARTICLE_STREAM_VELOCITY_Z);
+        const Float4 dt4 = Splat4(dt);
+        uint32_t stride = streams.m_Stride;
+        for (uint32_t i = 0; i < stride; i += 4)
+        {
+            // NOTE This velocity integration has a larger error than normal since we don't use the velocity at the
+            // beginning of the frame, but it's ok since particle movement does not need to be very exact
+            Store4(px + i, Add4(Load4(px + i), Mul4(Load4(vx + i), dt4)));
+            Store4(py + i, Add4(Load4(py + i), Mul4(Load4(vy + i), dt4)));
+            Store4(pz + i, Add4(Load4(pz + i), Mul4(Load4(vz + i), dt4)));
+        }
+
+        uint32_t particle_count = particles.Size();
+        for (uint32_t i = 0; i < particle_count; ++i)
+        {
+            Particle* p = &particles[i];
+            p->m_Position = Point3(px[i], py[i], pz[i]);
+            p->m_Velocity = Vector3(vx[i], vy[i], vz[i]);
+
+            p->m_Scale[0] += p->m_Scale[0] * p->m_StretchFactorX;
+            if (!ddf->m_StretchWithVelocity)
+                p->m_Scale[1] += p->m_Scale[1] * p->m_StretchFactorY;
+            else
+                p->m_Scale[1] += p->m_Scale[1] * p->m_StretchFactorY * length(p->m_Velocity) * STRETCH_SCALING;
         }
     }
 
@@ -1500,7 +1818,9 @@ namespace dmParticle
         DM_PROFILE(Particle, "Simulate");
 
         dmArray<Particle>& particles = emitter->m_Particles;
-        EvaluateParticleProperties(emitter, prototype->m_ParticleProperties, ddf, dt);
+        ParticleStreams& streams = emitter->m_Streams;
+        EvaluateParticleProperties(emitter, prototype, ddf, dt);
+        GatherParticleStreams(particles, streams);
         float emitter_t = dmMath::Select(-ddf->m_Duration, 0.0f, emitter->m_Timer / ddf->m_Duration);
         float scale = 1.0f;
         if (ddf->m_Space == EMISSION_SPACE_WORLD)
@@ -1516,44 +1836,31 @@ namespace dmParticle
             case dmParticleDDF::MODIFIER_TYPE_ACCELERATION:
                 {
                     Quat rotation = CalculateModifierRotation(instance, ddf, modifier_ddf);
-                    ApplyAcceleration(particles, modifier->m_Properties, rotation, scale, emitter_t, dt);
+                    ApplyAcceleration(streams, modifier->m_Properties, rotation, scale, emitter_t, dt);
                 }
                 break;
             case dmParticleDDF::MODIFIER_TYPE_DRAG:
                 {
                     Quat rotation = CalculateModifierRotation(instance, ddf, modifier_ddf);
-                    ApplyDrag(particles, modifier->m_Properties, modifier_ddf, rotation, emitter_t, dt);
+                    ApplyDrag(streams, modifier->m_Properties, modifier_ddf, rotation, emitter_t, dt);
                 }
                 break;
             case dmParticleDDF::MODIFIER_TYPE_RADIAL:
                 {
                     Point3 position = CalculateModifierPosition(instance, ddf, modifier_ddf);
-                    ApplyRadial(particles, modifier->m_Properties, position, scale, emitter_t, dt);
+                    ApplyRadial(streams, particles, modifier->m_Properties, position, scale, emitter_t, dt);
                 }
                 break;
             case dmParticleDDF::MODIFIER_TYPE_VORTEX:
                 {
                     Point3 position = CalculateModifierPosition(instance, ddf, modifier_ddf);
                     Quat rotation = CalculateModifierRotation(instance, ddf, modifier_ddf);
-                    ApplyVortex(particles, modifier->m_Properties, position, rotation, scale, emitter_t, dt);
+                    ApplyVortex(streams, particles.Size(), modifier->m_Properties, position, rotation, scale, emitter_t, dt);
                 }
                 break;
             }
         }
-        uint32_t particle_count = particles.Size();
-        for (uint32_t i = 0; i < particle_count; ++i)
-        {
-            Particle* p = &particles[i];
-            // NOTE This velocity integration has a larger error than normal since we don't use the velocity at the
-            // beginning of the frame, but it's ok since particle movement does not need to be very exact
-            p->SetPosition(p->GetPosition() + p->m_Velocity * dt);
-
-            p->m_Scale[0] += p->m_Scale[0] * p->m_StretchFactorX;
-            if (!ddf->m_StretchWithVelocity)
-                p->m_Scale[1] += p->m_Scale[1] * p->m_StretchFactorY;
-            else
-                p->m_Scale[1] += p->m_Scale[1] * p->m_StretchFactorY * length(p->m_Velocity) * STRETCH_SCALING;
-        }
+        IntegrateParticleStreams(particles, streams, ddf, dt);
     }
 
     void DebugRender(HParticleContext context, void* user_context, RenderLineCallback render_line_callback)
@@ -1667,6 +1974,31 @@ namespace dmParticle
         }
     }
 
+    static void InterleaveParticleProperties(const Property* particle_properties, ParticlePropertySegment* out_segments)
+    {
+        static const ParticleKey lane_keys[PARTICLE_LANE_COUNT] =
+        {
+            PARTICLE_KEY_RED,
+            PARTICLE_KEY_GREEN,
+            PARTICLE_KEY_BLUE,
+            PARTICLE_KEY_ALPHA,
+            PARTICLE_KEY_SCALE,
+            PARTICLE_KEY_STRETCH_FACTOR_X,
+            PARTICLE_KEY_STRETCH_FACTOR_Y,
+            PARTICLE_KEY_ROTATION,
+        };
+        for (uint32_t i = 0; i < PROPERTY_SAMPLE_COUNT; ++i)
+        {
+            ParticlePropertySegment& segment = out_segments[i];
+            for (uint32_t lane = 0; lane < PARTICLE_LANE_COUNT; ++lane)
+            {
+                const LinearSegment& s = particle_properties[lane_keys[lane]].m_Segments[i];
+                segment.m_Y[lane] = s.m_Y;
+                segment.m_K[lane] = s.m_K;
+            }
+        }
+    }
+
     void LoadResources(Prototype* prototype, dmParticleDDF::ParticleFX* ddf)
     {
         uint32_t emitter_count = ddf->m_Emitters.m_Count;
@@ -1729,6 +2061,7 @@ namespace dmParticle
                     dmLogWarning("The key %d is not a valid particle key.", p.m_Key);
                 }
             }
+            InterleaveParticleProperties(emitter->m_ParticleProperties, emitter->m_ParticleSegments);
             uint32_t modifier_count = emitter_ddf->m_Modifiers.m_Count;
             emitter->m_Modifiers.SetCapacity(modifier_count);
             emitter->m_Modifiers.SetSize(modifier_count);
@@ -1867,6 +2200,64 @@ namespace dmParticle
         render_data.m_EmitterIndex = emitter_index;
     }
 
+    // The world space bounding box of the particle quads (see UpdateRenderData), used for culling
+    static void UpdateEmitterBounds(Instance* instance, Emitter* emitter, dmParticleDDF::Emitter* ddf)
+    {
+        EmitterRenderData& render_data = emitter->m_RenderData;
+        render_data.m_HasBounds = 0;
+
+        uint32_t particle_count = emitter->m_Particles.Size();
+        if (particle_count == 0)
+            return;
+
+        // The largest extent of a quad, relative to its size
+        const AnimationData& anim_data = emitter->m_AnimationData;
+        bool anim_playing = anim_data.m_Playback != ANIM_PLAYBACK_NONE && anim_data.m_EndTile - anim_data.m_StartTile > 1;
+        bool anim_auto_size = (ddf->m_SizeMode == SIZE_MODE_AUTO) && (anim_data.m_TexDims != 0x0) && anim_playing;
+        float extent_factor = 0.5f;
+        if (anim_auto_size)
+        {
+            extent_factor = 0.0f;
+            for (uint32_t tile = anim_data.m_StartTile; tile < anim_data.m_EndTile; ++tile)
+            {
+                const float* td = &anim_data.m_TexDims[tile << 1];
+                extent_factor = dmMath::Max(extent_factor, dmMath::Max(td[0], td[1]) * 0.5f);
+            }
+        }
+
+        Vector3 min_p(FLT_MAX);
+        Vector3 max_p(-FLT_MAX);
+        float max_size = 0.0f;
+        for (uint32_t i = 0; i < particle_count; ++i)
+        {
+            const Particle* particle = &emitter->m_Particles[i];
+            const Vector3 p(particle->GetPosition());
+            min_p = minPerElem(min_p, p);
+            max_p = maxPerElem(max_p, p);
+            const Vector3 scale = particle->GetScale();
+            float size = dmMath::Max(fabsf(scale.getX()), fabsf(scale.getY()));
+            if (!anim_auto_size)
+                size *= fabsf(particle->GetSourceSize());
+            max_size = dmMath::Max(max_size, size);
+        }
+
+        // Any rotation of the quad is within the radius of its corners
+        Vector3 half_extents = (max_p - min_p) * 0.5f + Vector3(max_size * extent_factor * 1.4143f);
+        Point3 center = Point3((min_p + max_p) * 0.5f);
+        if (ddf->m_Space == EMISSION_SPACE_EMITTER)
+        {
+            const dmTransform::TransformS1& transform = instance->m_WorldTransform;
+            const Matrix3 rotation(transform.GetRotation());
+            center = dmTransform::Apply(transform, center);
+            half_extents = (absPerElem(rotation.getCol0()) * half_extents.getX() +
+                            absPerElem(rotation.getCol1()) * half_extents.getY() +
+                            absPerElem(rotation.getCol2()) * half_extents.getZ()) * fabsf(transform.GetScale());
+        }
+        render_data.m_BoundsMin = center - half_extents;
+        render_data.m_BoundsMax = center + half_extents;
+        render_data.m_HasBounds = 1;
+    }
+
     // Update render data for all emitters on an instance
     void UpdateRenderData(HParticleContext context, HInstance instance, uint32_t emitter_index)
     {
@@ -16,6 +16,7 @@
 #include <dmsdk/vectormath/cpp/vectormath_aos.h>
 #include <dlib/configfile.h>
 #include <dlib/hash.h>
+#include <dlib/job_pool.h>
 #include <ddf/ddf.h>
 #include "particle/particle_ddf.h"
 
@@ -149,6 +150,10 @@ namespace dmParticle
         uint32_t                    m_EmitterIndex;
         uint32_t                    m_MixedHash;
         uint32_t                    m_MixedHashNoMaterial;
+        /// World space bounding box of the particles, valid if m_HasBounds is set
+        Point3                      m_BoundsMin;
+        Point3                      m_BoundsMax;
+        uint32_t                    m_HasBounds;
     };
 
     /**
@@ -351,8 +356,18 @@ namespace dmParticle
      */
     DM_PARTICLE_PROTO(bool, IsSleeping, HParticleContext context, HInstance instance);
 
+    /**
+     * Set the job pool used to update the instances and to generate their vertex data in parallel.
+     * Without a job pool, everything runs on the calling thread.
+     * @param context Particle context
+     * @param job_pool Job pool, or 0x0
+     */
+    void SetJobPool(HParticleContext context, dmJobPool::HJobPool job_pool);
+
     /**
      * Update the instances within the specified context.
+     * The instances are updated in parallel if the context has a job pool. The emitter state changed callbacks
+     * and the fetch animation callback are always called on the calling thread.
      * @param context Context of the instances to update.
      * @param dt Time step.
      */
@@ -380,6 +395,21 @@ namespace dmParticle
      */
     DM_PARTICLE_PROTO(void, GenerateVertexData, HParticleContext context, float dt, HInstance instance, uint32_t emitter_index, const Vector4& color, void* vertex_buffer, uint32_t vertex_buffer_size, uint32_t* out_vertex_buffer_size, ParticleVertexFormat vertex_format);
 
+    /**
+     * Generates vertex data for several emitters, in parallel if the context has a job pool.
+     * The result is the same as calling GenerateVertexData for each emitter in order. Each emitter is assigned
+     * the range of the vertex buffer following the previous emitter, and the particles that don't fit are not rendered.
+     * @param context Particle context
+     * @param dt Time step.
+     * @param emitters Render data of the emitters, see GetEmitterRenderData
+     * @param emitter_count Number of emitters
+     * @param vertex_buffer Vertex buffer into which to store the particle vertex data. If this is 0x0, no data will be generated.
+     * @param vertex_buffer_size Size in bytes of the supplied vertex buffer.
+     * @param out_vertex_buffer_size Size in bytes of the total data written to vertex buffer.
+     * @param vertex_format Which vertex format to use
+     */
+    void GenerateVertexData(HParticleContext context, float dt, EmitterRenderData* const* emitters, uint32_t emitter_count, const Vector4& color, void* vertex_buffer, uint32_t vertex_buffer_size, uint32_t* out_vertex_buffer_size, ParticleVertexFormat vertex_format);
+
     /**
      * Debug render the status of the instances within the specified context.
      * @param context Context of the instances to render.
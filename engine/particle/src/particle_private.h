@@ -101,6 +101,44 @@ namespace dmParticle
         float       m_SourceAngularVelocity;
     };
 
+    /// The streams of ParticleStreams
+    enum ParticleStream
+    {
+        PARTICLE_STREAM_POSITION_X      = 0,
+        PARTICLE_STREAM_POSITION_Y      = 1,
+        PARTICLE_STREAM_POSITION_Z      = 2,
+        PARTICLE_STREAM_VELOCITY_X      = 3,
+        PARTICLE_STREAM_VELOCITY_Y      = 4,
+        PARTICLE_STREAM_VELOCITY_Z      = 5,
+        PARTICLE_STREAM_SPREAD_FACTOR   = 6,
+        PARTICLE_STREAM_COUNT           = 7,
+    };
+
+    /**
+     * The fields of the particles which the modifiers and the integration work on, with one stream per component.
+     * They are copied from the particles before the simulation and back after it, so that the simulation runs four particles at a time.
+     * The particles themselves stay the authority, since spawning, sorting and the render data work on whole particles.
+     */
+    struct ParticleStreams
+    {
+        /// PARTICLE_STREAM_COUNT streams of m_Stride floats each
+        dmArray<float>  m_Data;
+        /// The particle count rounded up to a multiple of four. The padding is zero.
+        uint32_t        m_Stride;
+    };
+
+    /// An emitter changes state at most three times per update, from prespawn to sleeping
+    static const uint32_t MAX_PENDING_STATE_CHANGES = 3;
+
+    /**
+     * Emitter state change made during an update, reported to the callback when the update is done.
+     */
+    struct PendingStateChange
+    {
+        uint32_t        m_NumAwakeEmitters;
+        EmitterState    m_State;
+    };
+
     /**
      * Representation of an emitter.
      */
@@ -114,6 +152,8 @@ namespace dmParticle
         AnimationData           m_AnimationData;
         /// Particle buffer.
         dmArray<Particle>       m_Particles;
+        /// Scratch streams used while simulating the particles.
+        ParticleStreams         m_Streams;
         dmArray<RenderConstant> m_RenderConstants;
         Vector3                 m_Velocity;
         Point3                  m_LastPosition;
@@ -123,6 +163,9 @@ namespace dmParticle
         uint32_t                m_VertexIndex;
         /// Number of vertices of the render data for the particles spawned by this emitter.
         uint32_t                m_VertexCount;
+        /// State changes not yet reported to the callback, see Instance::m_DeferStateChanges
+        PendingStateChange      m_PendingStateChanges[MAX_PENDING_STATE_CHANGES];
+        uint32_t                m_PendingStateChangeCount;
         /// Used to see when the emitter should stop spawning particles.
         float                   m_Timer;
         /// The amount of particles to spawn. It is accumulated over frames to handle spawn rates below the timestep.
@@ -159,6 +202,7 @@ namespace dmParticle
         , m_PlayTime(0.0f)
         , m_VersionNumber(0)
         , m_ScaleAlongZ(0)
+        , m_DeferStateChanges(0)
         {
             m_WorldTransform.SetIdentity();
         }
@@ -179,6 +223,8 @@ namespace dmParticle
         uint16_t                m_VersionNumber;
         /// Whether the scale of the world transform should be used along Z.
         uint16_t                m_ScaleAlongZ : 1;
+        /// Whether emitter state changes are stored in the emitter, instead of calling the callback. Set while the instance is updated.
+        uint16_t                m_DeferStateChanges : 1;
     };
 
     /**
@@ -187,7 +233,8 @@ namespace dmParticle
     struct Context
     {
         Context(uint32_t max_instance_count, uint32_t max_particle_count)
-        : m_MaxParticleCount(max_particle_count)
+        : m_JobPool(0)
+        , m_MaxParticleCount(max_particle_count)
         , m_NextVersionNumber(1)
         , m_InstanceSeeding(0)
         {
@@ -199,6 +246,7 @@ namespace dmParticle
                 memset(&m_Instances.Front(), 0, max_instance_count * sizeof(Instance*));
             }
             m_InstanceIndexPool.SetCapacity(max_instance_count);
+            m_UpdateInstances.SetCapacity(max_instance_count);
         }
 
         ~Context()
@@ -210,6 +258,13 @@ namespace dmParticle
         dmArray<Instance*>  m_Instances;
         /// Index pool used to index the instance buffer.
         dmIndexPool16       m_InstanceIndexPool;
+        /// Indices of the instances to update, collected each update
+        dmArray<uint32_t>   m_UpdateInstances;
+        /// Scratch buffers of GenerateVertexData, per emitter
+        dmArray<Instance*>  m_VertexInstances;
+        dmArray<uint32_t>   m_VertexIndices;
+        /// Job pool for the parallel update and vertex generation. May be 0x0
+        dmJobPool::HJobPool m_JobPool;
         /// Maximum number of particles allowed
         uint32_t            m_MaxParticleCount;
         /// Version number used to create new handles.
@@ -233,6 +288,31 @@ namespace dmParticle
         float m_Spread;
     };
 
+    /// The lanes of a ParticlePropertySegment. The color lanes come first so they can be applied to the particle color at once.
+    enum ParticlePropertyLane
+    {
+        PARTICLE_LANE_RED               = 0,
+        PARTICLE_LANE_GREEN             = 1,
+        PARTICLE_LANE_BLUE              = 2,
+        PARTICLE_LANE_ALPHA             = 3,
+        PARTICLE_LANE_SCALE             = 4,
+        PARTICLE_LANE_STRETCH_FACTOR_X  = 5,
+        PARTICLE_LANE_STRETCH_FACTOR_Y  = 6,
+        PARTICLE_LANE_ROTATION          = 7,
+        PARTICLE_LANE_COUNT             = 8,
+    };
+
+    /**
+     * The particle properties of one segment of the particle life time, with the values of all properties adjacent.
+     * A particle then needs one lookup, instead of one per property, and the properties are evaluated with SIMD.
+     * The segment starts at segment_index / PROPERTY_SAMPLE_COUNT, which is the m_X of the corresponding LinearSegment.
+     */
+    struct ParticlePropertySegment
+    {
+        float m_Y[PARTICLE_LANE_COUNT];
+        float m_K[PARTICLE_LANE_COUNT];
+    };
+
     struct ModifierPrototype
     {
         Property m_Properties[dmParticleDDF::MODIFIER_KEY_COUNT];
@@ -256,6 +336,8 @@ namespace dmParticle
         Property                    m_Properties[dmParticleDDF::EMITTER_KEY_COUNT];
         /// Particle properties
         Property                    m_ParticleProperties[dmParticleDDF::PARTICLE_KEY_COUNT];
+        /// Particle properties interleaved per segment, see ParticlePropertySegment
+        ParticlePropertySegment     m_ParticleSegments[PROPERTY_SAMPLE_COUNT];
         dmArray<ModifierPrototype>  m_Modifiers;
         dmhash_t                    m_Animation;
         /// Tile source to use when rendering particles.
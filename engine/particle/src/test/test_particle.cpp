@@ -17,8 +17,10 @@
 #include <map>
 
 #include <dlib/dstrings.h>
+#include <dlib/job_pool.h>
 #include <dlib/log.h>
 #include <dlib/math.h>
+#include <dlib/thread.h>
 #include <dlib/vmath.h>
 
 #include <ddf/ddf.h>
@@ -1272,6 +1274,90 @@ TEST_F(ParticleTest, EvaluateParticleProperty)
     dmParticle::DestroyInstance(m_Context, instance);
 }
 
+// The life time properties of a particle, sampled one property at a time from the LinearSegment tables
+struct ScalarLifeProperties
+{
+    Vector4 m_Color;
+    float m_Scale;
+    float m_StretchFactorX;
+    float m_StretchFactorY;
+    Quat m_Rotation;
+};
+
+static float SampleScalar(const dmParticle::Property& property, float x, uint32_t segment_index)
+{
+    const dmParticle::LinearSegment& s = property.m_Segments[segment_index];
+    return (x - s.m_X) * s.m_K + s.m_Y;
+}
+
+static void EvaluateLifePropertiesScalar(const dmParticle::EmitterPrototype* prototype, const dmParticle::Particle* particle, ScalarLifeProperties* out)
+{
+    const dmParticle::Property* properties = prototype->m_ParticleProperties;
+    float x = dmMath::Select(-particle->GetMaxLifeTime(), 0.0f, 1.0f - particle->GetTimeLeft() * particle->GetooMaxLifeTime());
+    uint32_t segment_index = dmMath::Min((uint32_t)(x * dmParticle::PROPERTY_SAMPLE_COUNT), dmParticle::PROPERTY_SAMPLE_COUNT - 1);
+
+    Vector4 c = particle->GetSourceColor();
+    out->m_Color = Vector4(dmMath::Clamp(c.getX() * SampleScalar(properties[dmParticleDDF::PARTICLE_KEY_RED], x, segment_index), 0.0f, 1.0f),
+                           dmMath::Clamp(c.getY() * SampleScalar(properties[dmParticleDDF::PARTICLE_KEY_GREEN], x, segment_index), 0.0f, 1.0f),
+                           dmMath::Clamp(c.getZ() * SampleScalar(properties[dmParticleDDF::PARTICLE_KEY_BLUE], x, segment_index), 0.0f, 1.0f),
+                           dmMath::Clamp(c.getW() * SampleScalar(properties[dmParticleDDF::PARTICLE_KEY_ALPHA], x, segment_index), 0.0f, 1.0f));
+    out->m_Scale = SampleScalar(properties[dmParticleDDF::PARTICLE_KEY_SCALE], x, segment_index);
+    out->m_StretchFactorX = particle->m_SourceStretchFactorX + SampleScalar(properties[dmParticleDDF::PARTICLE_KEY_STRETCH_FACTOR_X], x, segment_index);
+    out->m_StretchFactorY = particle->m_SourceStretchFactorY + SampleScalar(properties[dmParticleDDF::PARTICLE_KEY_STRETCH_FACTOR_Y], x, segment_index);
+    float rotation = SampleScalar(properties[dmParticleDDF::PARTICLE_KEY_ROTATION], x, segment_index);
+    out->m_Rotation = particle->GetSourceRotation() * dmVMath::QuatFromAngle(2, (float) (M_PI / 180.0) * rotation);
+}
+
+/**
+ * Verify that the life time properties evaluated from the interleaved segments with SIMD
+ * are the ones sampled from each property table
+ */
+TEST_F(ParticleTest, EvaluateParticlePropertiesScalar)
+{
+    const float dt = 1.0f / 60.0f;
+
+    ASSERT_TRUE(LoadPrototype("life_properties.particlefxc", &m_Prototype));
+    dmParticle::HInstance instance = dmParticle::CreateInstance(m_Context, m_Prototype, 0x0);
+    dmParticle::Emitter* e = GetEmitter(m_Context, instance, 0);
+    const dmParticle::EmitterPrototype* prototype = &m_Prototype->m_Emitters[0];
+
+    dmParticle::StartInstance(m_Context, instance);
+
+    uint32_t clamped_count = 0;
+    for (uint32_t frame = 0; frame < 30; ++frame)
+    {
+        dmParticle::Update(m_Context, dt, 0x0);
+        ASSERT_LT(0U, e->m_Particles.Size());
+
+        for (uint32_t i = 0; i < e->m_Particles.Size(); ++i)
+        {
+            const dmParticle::Particle* particle = &e->m_Particles[i];
+            ScalarLifeProperties expected;
+            EvaluateLifePropertiesScalar(prototype, particle, &expected);
+
+            // The tolerance allows for the scalar reference being compiled with fused multiply-adds
+            const float tolerance = 0.000001f;
+            Vector4 color = particle->GetColor();
+            ASSERT_NEAR(expected.m_Color.getX(), color.getX(), tolerance);
+            ASSERT_NEAR(expected.m_Color.getY(), color.getY(), tolerance);
+            ASSERT_NEAR(expected.m_Color.getZ(), color.getZ(), tolerance);
+            ASSERT_NEAR(expected.m_Color.getW(), color.getW(), tolerance);
+            ASSERT_NEAR(expected.m_Scale, particle->GetScale().getX(), tolerance);
+            ASSERT_NEAR(expected.m_StretchFactorX, particle->m_StretchFactorX, tolerance);
+            ASSERT_NEAR(expected.m_StretchFactorY, particle->m_StretchFactorY, tolerance);
+            ASSERT_NEAR(expected.m_Rotation.getZ(), particle->GetRotation().getZ(), tolerance);
+            ASSERT_NEAR(expected.m_Rotation.getW(), particle->GetRotation().getW(), tolerance);
+
+            if (color.getX() == 1.0f || color.getY() == 0.0f)
+                ++clamped_count;
+        }
+    }
+    // The life time red and green factors make some of the colors go out of range
+    ASSERT_LT(0U, clamped_count);
+
+    dmParticle::DestroyInstance(m_Context, instance);
+}
+
 /**
  * Verify that particles are scaled with the instance
  */
@@ -2092,6 +2178,226 @@ TEST_F(ParticleTest, Stats)
     dmParticle::DestroyInstance(m_Context, instance);
 }
 
+// Runs instance_count instances of bench.particlefx, and generates the vertices of all of their emitters each frame
+static void RunBenchInstances(uint32_t instance_count, dmJobPool::HJobPool job_pool, uint32_t frame_count, dmArray<dmParticle::Vertex>& vertices)
+{
+    const float dt = 1.0f / 60.0f;
+    const uint32_t max_particle_count = instance_count * 200;
+
+    dmParticle::HPrototype prototype = 0x0;
+    ASSERT_TRUE(LoadPrototype("bench.particlefxc", &prototype));
+    dmParticle::HParticleContext context = dmParticle::CreateContext(instance_count, max_particle_count);
+    dmParticle::SetJobPool(context, job_pool);
+
+    uint32_t vertex_buffer_size = dmParticle::GetVertexBufferSize(max_particle_count, dmParticle::PARTICLE_GO);
+    vertices.SetCapacity(vertex_buffer_size / sizeof(dmParticle::Vertex));
+    vertices.SetSize(vertices.Capacity());
+
+    dmArray<dmParticle::HInstance> instances;
+    dmArray<dmParticle::EmitterRenderData*> emitters;
+    instances.SetCapacity(instance_count);
+    emitters.SetCapacity(instance_count);
+    for (uint32_t i = 0; i < instance_count; ++i)
+    {
+        dmParticle::HInstance instance = dmParticle::CreateInstance(context, prototype, 0x0);
+        // Same seeds in every run, so the runs can be compared
+        dmParticle::Emitter* emitter = GetEmitter(context, instance, 0);
+        emitter->m_OriginalSeed = i + 1;
+        emitter->m_Seed = i + 1;
+        dmParticle::SetPosition(context, instance, Point3((float)i, 0.0f, 0.0f));
+        dmParticle::StartInstance(context, instance);
+        dmParticle::EmitterRenderData* render_data = 0x0;
+        dmParticle::GetEmitterRenderData(context, instance, 0, &render_data);
+        instances.Push(instance);
+        emitters.Push(render_data);
+    }
+
+    uint32_t out_vertex_buffer_size = 0;
+    for (uint32_t i = 0; i < frame_count; ++i)
+    {
+        dmParticle::Update(context, dt, 0x0);
+        out_vertex_buffer_size = 0;
+        dmParticle::GenerateVertexData(context, dt, emitters.Begin(), emitters.Size(), Vector4(1,1,1,1), (void*)vertices.Begin(), vertex_buffer_size, &out_vertex_buffer_size, dmParticle::PARTICLE_GO);
+    }
+    vertices.SetSize(out_vertex_buffer_size / sizeof(dmParticle::Vertex));
+
+    for (uint32_t i = 0; i < instance_count; ++i)
+    {
+        dmParticle::DestroyInstance(context, instances[i]);
+    }
+    dmParticle::DestroyContext(context);
+    dmParticle::DeletePrototype(prototype);
+}
+
+// The job pool only changes which thread updates each instance
+TEST(dmParticleJobPool, SameOutput)
+{
+    dmJobPool::HJobPool job_pool = dmJobPool::New("particle_test", 3);
+    dmArray<dmParticle::Vertex> expected;
+    dmArray<dmParticle::Vertex> vertices;
+    RunBenchInstances(16, 0x0, 60, expected);
+    RunBenchInstances(16, job_pool, 60, vertices);
+    dmJobPool::Delete(job_pool);
+
+    // Enough particles for the work to be spread over the job pool
+    ASSERT_LT(1024U * 6, expected.Size());
+    ASSERT_EQ(expected.Size(), vertices.Size());
+    ASSERT_EQ(0, memcmp(expected.Begin(), vertices.Begin(), expected.Size() * sizeof(dmParticle::Vertex)));
+}
+
+// The budget is assigned to the emitters in order, regardless of the job pool
+TEST(dmParticleJobPool, VertexBufferFull)
+{
+    const float dt = 1.0f / 60.0f;
+    dmJobPool::HJobPool job_pool = dmJobPool::New("particle_test", 3);
+    dmParticle::HPrototype prototype = 0x0;
+    ASSERT_TRUE(LoadPrototype("bench.particlefxc", &prototype));
+    dmParticle::HParticleContext context = dmParticle::CreateContext(8, 8 * 200);
+    dmParticle::SetJobPool(context, job_pool);
+
+    dmParticle::EmitterRenderData* emitters[8];
+    dmParticle::HInstance instances[8];
+    for (uint32_t i = 0; i < 8; ++i)
+    {
+        instances[i] = dmParticle::CreateInstance(context, prototype, 0x0);
+        dmParticle::StartInstance(context, instances[i]);
+        dmParticle::GetEmitterRenderData(context, instances[i], 0, &emitters[i]);
+    }
+    for (uint32_t i = 0; i < 10; ++i)
+    {
+        dmParticle::Update(context, dt, 0x0);
+    }
+
+    // Room for ten particles, which is less than the first emitter has
+    ASSERT_LT(10U, ParticleCount(GetEmitter(context, instances[0], 0)));
+    uint32_t vertex_buffer_size = dmParticle::GetVertexBufferSize(10, dmParticle::PARTICLE_GO);
+    dmParticle::Vertex vertex_buffer[10 * 6];
+    uint32_t out_vertex_buffer_size = 0;
+    dmParticle::GenerateVertexData(context, dt, emitters, 8, Vector4(1,1,1,1), (void*)vertex_buffer, vertex_buffer_size, &out_vertex_buffer_size, dmParticle::PARTICLE_GO);
+    ASSERT_EQ(vertex_buffer_size, out_vertex_buffer_size);
+
+    ASSERT_EQ(0U, GetEmitter(context, instances[0], 0)->m_VertexIndex);
+    ASSERT_EQ(10U * 6, GetEmitter(context, instances[0], 0)->m_VertexCount);
+    for (uint32_t i = 1; i < 8; ++i)
+    {
+        ASSERT_EQ(0U, GetEmitter(context, instances[i], 0)->m_VertexCount);
+    }
+
+    for (uint32_t i = 0; i < 8; ++i)
+    {
+        dmParticle::DestroyInstance(context, instances[i]);
+    }
+    dmParticle::DestroyContext(context);
+    dmParticle::DeletePrototype(prototype);
+    dmJobPool::Delete(job_pool);
+}
+
+struct StateChange
+{
+    uint32_t                    m_Instance;
+    uint32_t                    m_NumAwakeEmitters;
+    dmhash_t                    m_EmitterId;
+    dmParticle::EmitterState    m_State;
+    bool                        m_CallingThread;
+};
+
+struct StateChangeRecorder
+{
+    dmArray<StateChange>*   m_Changes;
+    dmThread::TlsKey        m_CallingThreadKey;
+    uint32_t                m_Instance;
+};
+
+static void RecordStateChange(uint32_t num_awake_emitters, dmhash_t emitter_id, dmParticle::EmitterState emitter_state, void* user_data)
+{
+    StateChangeRecorder* recorder = (StateChangeRecorder*) user_data;
+    if (recorder->m_Changes->Full())
+        recorder->m_Changes->OffsetCapacity(64);
+    StateChange change;
+    change.m_Instance = recorder->m_Instance;
+    change.m_NumAwakeEmitters = num_awake_emitters;
+    change.m_EmitterId = emitter_id;
+    change.m_State = emitter_state;
+    change.m_CallingThread = dmThread::GetTlsValue(recorder->m_CallingThreadKey) != 0x0;
+    recorder->m_Changes->Push(change);
+}
+
+// Runs emitters that play once next to enough looping emitters for the update to be spread over the job pool,
+// and records the state changes of the emitters that play once
+static void RunStateChangedInstances(dmJobPool::HJobPool job_pool, dmArray<StateChange>& changes)
+{
+    const uint32_t bench_count = 16;
+    const uint32_t once_count = 4;
+
+    dmThread::TlsKey key = dmThread::AllocTls();
+    dmThread::SetTlsValue(key, &changes);
+
+    dmParticle::HPrototype bench_prototype = 0x0;
+    dmParticle::HPrototype once_prototype = 0x0;
+    ASSERT_TRUE(LoadPrototype("bench.particlefxc", &bench_prototype));
+    ASSERT_TRUE(LoadPrototype("once_three_emitters.particlefxc", &once_prototype));
+    dmParticle::HParticleContext context = dmParticle::CreateContext(bench_count + once_count, bench_count * 200 + once_count * 1024);
+    dmParticle::SetJobPool(context, job_pool);
+
+    dmParticle::HInstance instances[bench_count + once_count];
+    for (uint32_t i = 0; i < bench_count; ++i)
+    {
+        instances[i] = dmParticle::CreateInstance(context, bench_prototype, 0x0);
+        dmParticle::StartInstance(context, instances[i]);
+    }
+    for (uint32_t i = 0; i < 30; ++i)
+    {
+        dmParticle::Update(context, 1.0f / 60.0f, 0x0);
+    }
+
+    StateChangeRecorder recorders[once_count];
+    for (uint32_t i = 0; i < once_count; ++i)
+    {
+        recorders[i].m_Changes = &changes;
+        recorders[i].m_CallingThreadKey = key;
+        recorders[i].m_Instance = i;
+        dmParticle::EmitterStateChangedData callback_data;
+        callback_data.m_StateChangedCallback = RecordStateChange;
+        callback_data.m_UserData = &recorders[i];
+        instances[bench_count + i] = dmParticle::CreateInstance(context, once_prototype, &callback_data);
+        dmParticle::StartInstance(context, instances[bench_count + i]); // Prespawn
+    }
+    dmParticle::Update(context, 1.2f, 0x0); // Spawning & Postspawn
+    dmParticle::Update(context, 1.2f, 0x0); // Sleeping
+
+    for (uint32_t i = 0; i < bench_count + once_count; ++i)
+    {
+        dmParticle::DestroyInstance(context, instances[i]);
+    }
+    dmParticle::DestroyContext(context);
+    dmParticle::DeletePrototype(bench_prototype);
+    dmParticle::DeletePrototype(once_prototype);
+    dmThread::FreeTls(key);
+}
+
+// The state changes of emitters updated on the job pool are reported once each, in the same order, on the calling thread
+TEST(dmParticleJobPool, StateChangedCallback)
+{
+    dmJobPool::HJobPool job_pool = dmJobPool::New("particle_test", 3);
+    dmArray<StateChange> expected;
+    dmArray<StateChange> changes;
+    RunStateChangedInstances(0x0, expected);
+    RunStateChangedInstances(job_pool, changes);
+    dmJobPool::Delete(job_pool);
+
+    // Prespawn, spawning, postspawn and sleeping, for each of the three emitters of each instance
+    ASSERT_EQ(4U * 12, expected.Size());
+    ASSERT_EQ(expected.Size(), changes.Size());
+    for (uint32_t i = 0; i < changes.Size(); ++i)
+    {
+        ASSERT_TRUE(changes[i].m_CallingThread);
+        ASSERT_EQ(expected[i].m_Instance, changes[i].m_Instance);
+        ASSERT_EQ(expected[i].m_NumAwakeEmitters, changes[i].m_NumAwakeEmitters);
+        ASSERT_EQ(expected[i].m_EmitterId, changes[i].m_EmitterId);
+        ASSERT_EQ(expected[i].m_State, changes[i].m_State);
+    }
+}
+
 int main(int argc, char **argv)
 {
     jc_test_init(&argc, argv);
@@ -0,0 +1,229 @@
+// Copyright 2020 The Defold Foundation
+// Licensed under the Defold License version 1.0 (the "License"); you may not use
+// this file except in compliance with the License.
+//
+// You may obtain a copy of the License, together with FAQs at
+// https://www.defold.com/license
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#define JC_TEST_IMPLEMENTATION
+#include <jc_test/jc_test.h>
+#include <stdio.h>
+
+#include <dlib/array.h>
+#include <dlib/dstrings.h>
+#include <dlib/job_pool.h>
+#include <dlib/log.h>
+#include <dlib/math.h>
+#include <dlib/time.h>
+#include <dlib/vmath.h>
+
+#include "../particle.h"
+#include "../particle_private.h"
+
+using namespace Vectormath::Aos;
+
+#if defined(__NX__)
+    #define MOUNTFS "host:/"
+#else
+    #define MOUNTFS ""
+#endif
+
+// The particle effects are compiled by the test_particle target
+static bool LoadPrototype(const char* filename, dmParticle::HPrototype* prototype)
+{
+    char path[128];
+    dmSnPrintf(path, 128, MOUNTFS "build/default/src/test/%s", filename);
+    const uint32_t MAX_FILE_SIZE = 4 * 1024;
+    unsigned char buffer[MAX_FILE_SIZE];
+    uint32_t file_size = 0;
+
+    FILE* f = fopen(path, "rb");
+    if (f)
+    {
+        file_size = fread(buffer, 1, MAX_FILE_SIZE, f);
+        fclose(f);
+        *prototype = dmParticle::NewPrototype(buffer, file_size);
+        return *prototype != 0x0;
+    }
+    else
+    {
+        dmLogWarning("Particle FX could not be loaded: %s.", path);
+        return false;
+    }
+}
+
+static dmParticle::Emitter* GetEmitter(dmParticle::HParticleContext context, dmParticle::HInstance instance, uint32_t index)
+{
+    return &context->m_Instances[instance & 0xffff]->m_Emitters[index];
+}
+
+// The life time properties of a particle, sampled one property at a time from the LinearSegment tables
+struct ScalarLifeProperties
+{
+    Vector4 m_Color;
+    float m_Scale;
+    float m_StretchFactorX;
+    float m_StretchFactorY;
+    Quat m_Rotation;
+};
+
+static float SampleScalar(const dmParticle::Property& property, float x, uint32_t segment_index)
+{
+    const dmParticle::LinearSegment& s = property.m_Segments[segment_index];
+    return (x - s.m_X) * s.m_K + s.m_Y;
+}
+
+static void EvaluateLifePropertiesScalar(const dmParticle::EmitterPrototype* prototype, const dmParticle::Particle* particle, ScalarLifeProperties* out)
+{
+    const dmParticle::Property* properties = prototype->m_ParticleProperties;
+    float x = dmMath::Select(-particle->GetMaxLifeTime(), 0.0f, 1.0f - particle->GetTimeLeft() * particle->GetooMaxLifeTime());
+    uint32_t segment_index = dmMath::Min((uint32_t)(x * dmParticle::PROPERTY_SAMPLE_COUNT), dmParticle::PROPERTY_SAMPLE_COUNT - 1);
+
+    Vector4 c = particle->GetSourceColor();
+    out->m_Color = Vector4(dmMath::Clamp(c.getX() * SampleScalar(properties[dmParticleDDF::PARTICLE_KEY_RED], x, segment_index), 0.0f, 1.0f),
+                           dmMath::Clamp(c.getY() * SampleScalar(properties[dmParticleDDF::PARTICLE_KEY_GREEN], x, segment_index), 0.0f, 1.0f),
+                           dmMath::Clamp(c.getZ() * SampleScalar(properties[dmParticleDDF::PARTICLE_KEY_BLUE], x, segment_index), 0.0f, 1.0f),
+                           dmMath::Clamp(c.getW() * SampleScalar(properties[dmParticleDDF::PARTICLE_KEY_ALPHA], x, segment_index), 0.0f, 1.0f));
+    out->m_Scale = SampleScalar(properties[dmParticleDDF::PARTICLE_KEY_SCALE], x, segment_index);
+    out->m_StretchFactorX = particle->m_SourceStretchFactorX + SampleScalar(properties[dmParticleDDF::PARTICLE_KEY_STRETCH_FACTOR_X], x, segment_index);
+    out->m_StretchFactorY = particle->m_SourceStretchFactorY + SampleScalar(properties[dmParticleDDF::PARTICLE_KEY_STRETCH_FACTOR_Y], x, segment_index);
+    float rotation = SampleScalar(properties[dmParticleDDF::PARTICLE_KEY_ROTATION], x, segment_index);
+    out->m_Rotation = particle->GetSourceRotation() * dmVMath::QuatFromAngle(2, (float) (M_PI / 180.0) * rotation);
+}
+
+// The life time properties of 10000 particles, evaluated by the update and by the scalar reference
+TEST(dmParticleBenchmark, EvaluateParticleProperties)
+{
+    const float dt = 1.0f / 60.0f;
+    const uint32_t max_particle_count = 10000;
+    const uint32_t frame_count = 120;
+
+    dmParticle::HPrototype prototype = 0x0;
+    ASSERT_TRUE(LoadPrototype("life_properties.particlefxc", &prototype));
+    dmParticle::HParticleContext context = dmParticle::CreateContext(1, max_particle_count);
+    dmParticle::HInstance instance = dmParticle::CreateInstance(context, prototype, 0x0);
+    dmParticle::Emitter* e = GetEmitter(context, instance, 0);
+    dmParticle::StartInstance(context, instance);
+
+    // Fill the emitter
+    for (uint32_t i = 0; i < 60; ++i)
+    {
+        dmParticle::Update(context, dt, 0x0);
+    }
+    uint32_t particle_count = e->m_Particles.Size();
+    ASSERT_LT(max_particle_count / 2, particle_count);
+
+    uint64_t start = dmTime::GetTime();
+    for (uint32_t i = 0; i < frame_count; ++i)
+    {
+        dmParticle::Update(context, dt, 0x0);
+    }
+    uint64_t update_elapsed = dmTime::GetTime() - start;
+
+    ScalarLifeProperties properties;
+    float checksum = 0.0f;
+    start = dmTime::GetTime();
+    for (uint32_t i = 0; i < frame_count; ++i)
+    {
+        for (uint32_t j = 0; j < e->m_Particles.Size(); ++j)
+        {
+            EvaluateLifePropertiesScalar(&prototype->m_Emitters[0], &e->m_Particles[j], &properties);
+            checksum += properties.m_Scale;
+        }
+    }
+    uint64_t scalar_elapsed = dmTime::GetTime() - start;
+
+    printf("Updated %u particles: %.3f ms per frame. Scalar reference of the life time properties only: %.3f ms per frame (%f)\n",
+            particle_count, update_elapsed / (1000.0f * frame_count), scalar_elapsed / (1000.0f * frame_count), checksum);
+
+    dmParticle::DestroyInstance(context, instance);
+    dmParticle::DestroyContext(context);
+    dmParticle::DeletePrototype(prototype);
+}
+
+// Runs instance_count instances of bench.particlefx, and generates the vertices of all of their emitters each frame
+static void RunBenchInstances(uint32_t instance_count, dmJobPool::HJobPool job_pool, uint32_t frame_count, dmArray<dmParticle::Vertex>& vertices, uint64_t* elapsed)
+{
+    const float dt = 1.0f / 60.0f;
+    const uint32_t max_particle_count = instance_count * 200;
+
+    dmParticle::HPrototype prototype = 0x0;
+    ASSERT_TRUE(LoadPrototype("bench.particlefxc", &prototype));
+    dmParticle::HParticleContext context = dmParticle::CreateContext(instance_count, max_particle_count);
+    dmParticle::SetJobPool(context, job_pool);
+
+    uint32_t vertex_buffer_size = dmParticle::GetVertexBufferSize(max_particle_count, dmParticle::PARTICLE_GO);
+    vertices.SetCapacity(vertex_buffer_size / sizeof(dmParticle::Vertex));
+    vertices.SetSize(vertices.Capacity());
+
+    dmArray<dmParticle::HInstance> instances;
+    dmArray<dmParticle::EmitterRenderData*> emitters;
+    instances.SetCapacity(instance_count);
+    emitters.SetCapacity(instance_count);
+    for (uint32_t i = 0; i < instance_count; ++i)
+    {
+        dmParticle::HInstance instance = dmParticle::CreateInstance(context, prototype, 0x0);
+        // Same seeds in every run, so the runs can be compared
+        dmParticle::Emitter* emitter = GetEmitter(context, instance, 0);
+        emitter->m_OriginalSeed = i + 1;
+        emitter->m_Seed = i + 1;
+        dmParticle::SetPosition(context, instance, Point3((float)i, 0.0f, 0.0f));
+        dmParticle::StartInstance(context, instance);
+        dmParticle::EmitterRenderData* render_data = 0x0;
+        dmParticle::GetEmitterRenderData(context, instance, 0, &render_data);
+        instances.Push(instance);
+        emitters.Push(render_data);
+    }
+
+    uint32_t out_vertex_buffer_size = 0;
+    uint64_t start = dmTime::GetTime();
+    for (uint32_t i = 0; i < frame_count; ++i)
+    {
+        dmParticle::Update(context, dt, 0x0);
+        out_vertex_buffer_size = 0;
+        dmParticle::GenerateVertexData(context, dt, emitters.Begin(), emitters.Size(), Vector4(1,1,1,1), (void*)vertices.Begin(), vertex_buffer_size, &out_vertex_buffer_size, dmParticle::PARTICLE_GO);
+    }
+    *elapsed = dmTime::GetTime() - start;
+    vertices.SetSize(out_vertex_buffer_size / sizeof(dmParticle::Vertex));
+
+    for (uint32_t i = 0; i < instance_count; ++i)
+    {
+        dmParticle::DestroyInstance(context, instances[i]);
+    }
+    dmParticle::DestroyContext(context);
+    dmParticle::DeletePrototype(prototype);
+}
+
+// The update and the vertex generation of 200 emitters, with and without a job pool
+TEST(dmParticleBenchmark, UpdateEmitters)
+{
+    const uint32_t worker_counts[] = {0, 3};
+    const uint32_t instance_count = 200;
+    const uint32_t frame_count = 120;
+
+    for (uint32_t w = 0; w < DM_ARRAY_SIZE(worker_counts); ++w)
+    {
+        dmJobPool::HJobPool job_pool = dmJobPool::New("particle_test", worker_counts[w]);
+        dmArray<dmParticle::Vertex> vertices;
+        uint64_t elapsed = 0;
+        RunBenchInstances(instance_count, job_pool, frame_count, vertices, &elapsed);
+        dmJobPool::Delete(job_pool);
+
+        ASSERT_LT(0U, vertices.Size());
+        printf("Updated %u emitters with %u worker threads: %u frames in %.3f ms, %.3f ms per frame, %u particles\n",
+                instance_count, worker_counts[w], frame_count, elapsed / 1000.0f, elapsed / (1000.0f * frame_count), vertices.Size() / 6);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    jc_test_init(&argc, argv);
+
+    int ret = jc_test_run_all();
+    return ret;
+}
@@ -25,8 +25,11 @@
 #include <cstdio>
 using namespace std;
 
+// Defold modification: only compiled with B2_COLLISION_STATS, see b2Distance.cpp
+#if defined(B2_COLLISION_STATS)
 int32 b2_toiCalls, b2_toiIters, b2_toiMaxIters;
 int32 b2_toiRootIters, b2_toiMaxRootIters;
+#endif
 
 struct b2SeparationFunction
 {
@@ -256,7 +259,9 @@ struct b2SeparationFunction
 // by computing the largest time at which separation is maintained.
 void b2TimeOfImpact(b2TOIOutput* output, const b2TOIInput* input)
 {
+#if defined(B2_COLLISION_STATS)
 	++b2_toiCalls;
+#endif
 
 	output->state = b2TOIOutput::e_unknown;
 	output->t = input->tMax;
@@ -444,7 +449,9 @@ void b2TimeOfImpact(b2TOIOutput* output, const b2TOIInput* input)
 				}
 
 				++rootIterCount;
+#if defined(B2_COLLISION_STATS)
 				++b2_toiRootIters;
+#endif
 
 				if (rootIterCount == 50)
 				{
@@ -452,7 +459,9 @@ void b2TimeOfImpact(b2TOIOutput* output, const b2TOIInput* input)
 				}
 			}
 
+#if defined(B2_COLLISION_STATS)
 			b2_toiMaxRootIters = b2Max(b2_toiMaxRootIters, rootIterCount);
+#endif
 
 			++pushBackIter;
 
@@ -463,7 +472,9 @@ void b2TimeOfImpact(b2TOIOutput* output, const b2TOIInput* input)
 		}
 
 		++iter;
+#if defined(B2_COLLISION_STATS)
 		++b2_toiIters;
+#endif
 
 		if (done)
 		{
@@ -479,5 +490,7 @@ void b2TimeOfImpact(b2TOIOutput* output, const b2TOIInput* input)
 		}
 	}
 
+#if defined(B2_COLLISION_STATS)
 	b2_toiMaxIters = b2Max(b2_toiMaxIters, iter);
+#endif
 }
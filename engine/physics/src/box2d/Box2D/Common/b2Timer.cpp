@@ -30,11 +30,12 @@ b2Timer::b2Timer()
 
 	if (s_invFrequency == 0.0f)
 	{
+		// Defold modification: only the final value is stored, since timers can be created on several threads at the same time
 		QueryPerformanceFrequency(&largeInteger);
-		s_invFrequency = float64(largeInteger.QuadPart);
-		if (s_invFrequency > 0.0f)
+		float64 frequency = float64(largeInteger.QuadPart);
+		if (frequency > 0.0f)
 		{
-			s_invFrequency = 1000.0f / s_invFrequency;
+			s_invFrequency = 1000.0f / frequency;
 		}
 	}
 
@@ -62,6 +62,14 @@ b2World::b2World(const b2Vec2& gravity)
 	m_contactManager.m_allocator = &m_blockAllocator;
 
 	memset(&m_profile, 0, sizeof(b2Profile));
+
+	// Defold modification: register the contact types when the first world is created, instead of when the
+	// first contact is created, since several worlds can be stepped at the same time (see StepPhysicsWorlds)
+	if (b2Contact::s_initialized == false)
+	{
+		b2Contact::InitializeRegisters();
+		b2Contact::s_initialized = true;
+	}
 }
 
 b2World::~b2World()
@@ -123,6 +123,26 @@ namespace dmPhysics
      * @param rotation Rotation that the external object will obtain
      */
     typedef void (*SetWorldTransformCallback)(void* user_data, const Vectormath::Aos::Point3& position, const Vectormath::Aos::Quat& rotation);
+    /**
+     * Callback used to propagate the world transforms of several external objects into the physics simulation at once.
+     * The objects whose world transforms are the same as in the previous call are flagged as unchanged, and their
+     * world transforms are not written.
+     *
+     * @param user_data Array of user data pointing to the external objects
+     * @param world_transforms Array of world transforms output parameter
+     * @param changed Array of flags output parameter, 0 if the world transform of the object has not changed
+     * @param count Number of objects
+     */
+    typedef void (*GetWorldTransformsCallback)(void* const* user_data, dmTransform::Transform* world_transforms, uint8_t* changed, uint32_t count);
+    /**
+     * Callback used to propagate the world transforms from the physics simulation to several external objects at once.
+     *
+     * @param user_data Array of user data pointing to the external objects
+     * @param positions Array of positions that the external objects will obtain
+     * @param rotations Array of rotations that the external objects will obtain
+     * @param count Number of objects
+     */
+    typedef void (*SetWorldTransformsCallback)(void* const* user_data, const Vectormath::Aos::Point3* positions, const Vectormath::Aos::Quat* rotations, uint32_t count);
 
     /**
      * Callback used to signal collisions.
@@ -299,6 +319,10 @@ namespace dmPhysics
         GetWorldTransformCallback m_GetWorldTransformCallback;
         /// param set_world_transform Callback for copying the transform from the collision object to the corresponding user data
         SetWorldTransformCallback m_SetWorldTransformCallback;
+        /// Optional callback for copying the transforms of all collision objects of a step at once, 2D only
+        GetWorldTransformsCallback m_GetWorldTransformsCallback;
+        /// Optional callback for copying the transforms to all the user data of a step at once, 2D only
+        SetWorldTransformsCallback m_SetWorldTransformsCallback;
     };
 
     /**
@@ -52,6 +52,8 @@ namespace dmPhysics
     , m_ContactListener(this)
     , m_GetWorldTransformCallback(params.m_GetWorldTransformCallback)
     , m_SetWorldTransformCallback(params.m_SetWorldTransformCallback)
+    , m_GetWorldTransformsCallback(params.m_GetWorldTransformsCallback)
+    , m_SetWorldTransformsCallback(params.m_SetWorldTransformsCallback)
     , m_AllowDynamicTransforms(context->m_AllowDynamicTransforms)
     {
     	m_RayCastRequests.SetCapacity(context->m_RayCastLimit);
@@ -349,11 +351,8 @@ namespace dmPhysics
         return dmMath::Min(v[0], v[1]);
     }
 
-    static void UpdateScale(HWorld2D world, b2Body* body)
+    static void UpdateScale(HWorld2D world, b2Body* body, dmTransform::Transform& world_transform)
     {
-        dmTransform::Transform world_transform;
-        (*world->m_GetWorldTransformCallback)(body->GetUserData(), world_transform);
-
         float object_scale = GetUniformScale2D(world_transform);
 
         b2Fixture* fix = body->GetFixtureList();
@@ -395,6 +394,27 @@ namespace dmPhysics
         }
     }
 
+    // Makes room for all bodies of the world in the sync buffers
+    static void ReserveSyncBuffers(HWorld2D world)
+    {
+        uint32_t body_count = (uint32_t)world->m_World.GetBodyCount();
+        if (world->m_SyncBodies.Capacity() < body_count)
+        {
+            world->m_SyncBodies.SetCapacity(body_count);
+            world->m_SyncUserData.SetCapacity(body_count);
+            world->m_SyncTransforms.SetCapacity(body_count);
+            world->m_SyncChanged.SetCapacity(body_count);
+            world->m_SyncPositions.SetCapacity(body_count);
+            world->m_SyncRotations.SetCapacity(body_count);
+        }
+        world->m_SyncBodies.SetSize(body_count);
+        world->m_SyncUserData.SetSize(body_count);
+        world->m_SyncTransforms.SetSize(body_count);
+        world->m_SyncChanged.SetSize(body_count);
+        world->m_SyncPositions.SetSize(body_count);
+        world->m_SyncRotations.SetSize(body_count);
+    }
+
     void StepWorld2D(HWorld2D world, const StepWorldContext& step_context)
     {
         float dt = step_context.m_DT;
@@ -405,45 +425,84 @@ namespace dmPhysics
         const float POS_EPSILON = 0.00005f * scale;
         const float ROT_EPSILON = 0.00007f;
         // Update transforms of kinematic bodies
-        if (world->m_GetWorldTransformCallback)
+        if (world->m_GetWorldTransformCallback || world->m_GetWorldTransformsCallback)
         {
             DM_PROFILE(Physics, "UpdateKinematic");
+            ReserveSyncBuffers(world);
+            // Gather the bodies that follow the transforms of their objects, to retrieve the transforms in one go
+            b2Body** bodies = world->m_SyncBodies.Begin();
+            void** user_data = world->m_SyncUserData.Begin();
+            uint32_t count = 0;
             for (b2Body* body = world->m_World.GetBodyList(); body; body = body->GetNext())
             {
-                bool retrieve_gameworld_transform = world->m_AllowDynamicTransforms && body->GetType() != b2_staticBody;
+                if ((world->m_AllowDynamicTransforms && body->GetType() != b2_staticBody) || body->GetType() == b2_kinematicBody)
+                {
+                    bodies[count] = body;
+                    user_data[count] = body->GetUserData();
+                    ++count;
+                }
+            }
 
-                // translate & rotation
-                if (retrieve_gameworld_transform || body->GetType() == b2_kinematicBody)
+            dmTransform::Transform* world_transforms = world->m_SyncTransforms.Begin();
+            uint8_t* changed = world->m_SyncChanged.Begin();
+            if (world->m_GetWorldTransformsCallback)
+            {
+                (*world->m_GetWorldTransformsCallback)(user_data, world_transforms, changed, count);
+            }
+            else
+            {
+                for (uint32_t i = 0; i < count; ++i)
                 {
-                    Vectormath::Aos::Point3 old_position = GetWorldPosition2D(context, body);
-                    dmTransform::Transform world_transform;
-                    (*world->m_GetWorldTransformCallback)(body->GetUserData(), world_transform);
-                    Vectormath::Aos::Point3 position = Vectormath::Aos::Point3(world_transform.GetTranslation());
-                    // Ignore z-component
-                    position.setZ(0.0f);
-                    Vectormath::Aos::Quat rotation = world_transform.GetRotation();
-                    float dp = distSqr(old_position, position);
-                    float angle = atan2(2.0f * (rotation.getW() * rotation.getZ() + rotation.getX() * rotation.getY()), 1.0f - 2.0f * (rotation.getY() * rotation.getY() + rotation.getZ() * rotation.getZ()));
-                    float old_angle = body->GetAngle();
-                    float da = old_angle - angle;
-
-                    if (dp > POS_EPSILON || fabsf(da) > ROT_EPSILON)
-                    {
-                        b2Vec2 b2_position;
-                        ToB2(position, b2_position, scale);
-                        body->SetTransform(b2_position, angle);
-                        body->SetSleepingAllowed(false);
-                    }
-                    else
+                    (*world->m_GetWorldTransformCallback)(user_data[i], world_transforms[i]);
+                    changed[i] = 1;
+                }
+            }
+
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                b2Body* body = bodies[i];
+                if (!changed[i])
+                {
+                    // The body is where the object was left, unless it is a kinematic body that moves by a velocity of its own
+                    if (body->GetType() != b2_kinematicBody || !world->m_GetWorldTransformCallback ||
+                        (body->GetLinearVelocity().LengthSquared() == 0.0f && body->GetAngularVelocity() == 0.0f))
                     {
                         body->SetSleepingAllowed(true);
+                        continue;
                     }
+                    (*world->m_GetWorldTransformCallback)(user_data[i], world_transforms[i]);
+                }
+
+                bool retrieve_gameworld_transform = world->m_AllowDynamicTransforms && body->GetType() != b2_staticBody;
+
+                // translate & rotation
+                dmTransform::Transform& world_transform = world_transforms[i];
+                Vectormath::Aos::Point3 old_position = GetWorldPosition2D(context, body);
+                Vectormath::Aos::Point3 position = Vectormath::Aos::Point3(world_transform.GetTranslation());
+                // Ignore z-component
+                position.setZ(0.0f);
+                Vectormath::Aos::Quat rotation = world_transform.GetRotation();
+                float dp = distSqr(old_position, position);
+                float angle = atan2(2.0f * (rotation.getW() * rotation.getZ() + rotation.getX() * rotation.getY()), 1.0f - 2.0f * (rotation.getY() * rotation.getY() + rotation.getZ() * rotation.getZ()));
+                float old_angle = body->GetAngle();
+                float da = old_angle - angle;
+
+                if (dp > POS_EPSILON || fabsf(da) > ROT_EPSILON)
+                {
+                    b2Vec2 b2_position;
+                    ToB2(position, b2_position, scale);
+                    body->SetTransform(b2_position, angle);
+                    body->SetSleepingAllowed(false);
+                }
+                else
+                {
+                    body->SetSleepingAllowed(true);
                 }
 
                 // Scaling
                 if(retrieve_gameworld_transform)
                 {
-                    UpdateScale(world, body);
+                    UpdateScale(world, body, world_transform);
                 }
             }
         }
@@ -453,16 +512,33 @@ namespace dmPhysics
             world->m_World.Step(dt, 10, 10);
             float inv_scale = world->m_Context->m_InvScale;
             // Update transforms of dynamic bodies
-            if (world->m_SetWorldTransformCallback)
+            if (world->m_SetWorldTransformCallback || world->m_SetWorldTransformsCallback)
             {
+                ReserveSyncBuffers(world);
+                void** user_data = world->m_SyncUserData.Begin();
+                Vectormath::Aos::Point3* positions = world->m_SyncPositions.Begin();
+                Vectormath::Aos::Quat* rotations = world->m_SyncRotations.Begin();
+                uint32_t count = 0;
                 for (b2Body* body = world->m_World.GetBodyList(); body; body = body->GetNext())
                 {
                     if (body->GetType() == b2_dynamicBody && body->IsActive())
                     {
-                        Vectormath::Aos::Point3 position;
-                        FromB2(body->GetPosition(), position, inv_scale);
-                        Vectormath::Aos::Quat rotation = Vectormath::Aos::Quat::rotationZ(body->GetAngle());
-                        (*world->m_SetWorldTransformCallback)(body->GetUserData(), position, rotation);
+                        user_data[count] = body->GetUserData();
+                        FromB2(body->GetPosition(), positions[count], inv_scale);
+                        rotations[count] = Vectormath::Aos::Quat::rotationZ(body->GetAngle());
+                        ++count;
+                    }
+                }
+
+                if (world->m_SetWorldTransformsCallback)
+                {
+                    (*world->m_SetWorldTransformsCallback)(user_data, positions, rotations, count);
+                }
+                else
+                {
+                    for (uint32_t i = 0; i < count; ++i)
+                    {
+                        (*world->m_SetWorldTransformCallback)(user_data[i], positions[i], rotations[i]);
                     }
                 }
             }
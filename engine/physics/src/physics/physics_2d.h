@@ -49,6 +49,15 @@ namespace dmPhysics
         ContactListener             m_ContactListener;
         GetWorldTransformCallback   m_GetWorldTransformCallback;
         SetWorldTransformCallback   m_SetWorldTransformCallback;
+        GetWorldTransformsCallback  m_GetWorldTransformsCallback;
+        SetWorldTransformsCallback  m_SetWorldTransformsCallback;
+        // Scratch buffers used to sync the transforms of the bodies in StepWorld2D
+        dmArray<b2Body*>                 m_SyncBodies;
+        dmArray<void*>                   m_SyncUserData;
+        dmArray<dmTransform::Transform>  m_SyncTransforms;
+        dmArray<uint8_t>                 m_SyncChanged;
+        dmArray<Vectormath::Aos::Point3> m_SyncPositions;
+        dmArray<Vectormath::Aos::Quat>   m_SyncRotations;
         uint8_t                     m_AllowDynamicTransforms:1;
         uint8_t                     :7;
     };
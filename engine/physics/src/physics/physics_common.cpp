@@ -42,6 +42,8 @@ namespace dmPhysics
     , m_WorldMax(WORLD_EXTENT, WORLD_EXTENT, WORLD_EXTENT)
     , m_GetWorldTransformCallback(0x0)
     , m_SetWorldTransformCallback(0x0)
+    , m_GetWorldTransformsCallback(0x0)
+    , m_SetWorldTransformsCallback(0x0)
     {
 
     }
@@ -1700,6 +1700,78 @@ TYPED_TEST(PhysicsTest, SetGridShapeEnable)
     dmPhysics::DeleteHullSet2D(hull_set);
 }
 
+static bool g_ReportChanged = true;
+static uint32_t g_SetWorldTransformsCount = 0;
+
+static void GetWorldTransforms(void* const* user_data, dmTransform::Transform* world_transforms, uint8_t* changed, uint32_t count)
+{
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        changed[i] = g_ReportChanged;
+        if (g_ReportChanged)
+            GetWorldTransform(user_data[i], world_transforms[i]);
+    }
+}
+
+static void SetWorldTransforms(void* const* user_data, const Vectormath::Aos::Point3* positions, const Vectormath::Aos::Quat* rotations, uint32_t count)
+{
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        SetWorldTransform(user_data[i], positions[i], rotations[i]);
+    }
+    g_SetWorldTransformsCount += count;
+}
+
+TYPED_TEST(PhysicsTest, BatchedTransformSync)
+{
+    dmPhysics::NewWorldParams world_params;
+    world_params.m_GetWorldTransformCallback = GetWorldTransform;
+    world_params.m_SetWorldTransformCallback = SetWorldTransform;
+    world_params.m_GetWorldTransformsCallback = GetWorldTransforms;
+    world_params.m_SetWorldTransformsCallback = SetWorldTransforms;
+    dmPhysics::HWorld2D world = dmPhysics::NewWorld2D(TestFixture::m_Context, world_params);
+
+    typename TypeParam::CollisionShapeType shape = (*TestFixture::m_Test.m_NewBoxShapeFunc)(TestFixture::m_Context, Vector3(1.0f, 1.0f, 1.0f));
+
+    VisualObject kinematic_vo;
+    dmPhysics::CollisionObjectData data;
+    data.m_Type = dmPhysics::COLLISION_OBJECT_TYPE_KINEMATIC;
+    data.m_Mass = 0.0f;
+    data.m_UserData = &kinematic_vo;
+    typename TypeParam::CollisionObjectType kinematic_co = (*TestFixture::m_Test.m_NewCollisionObjectFunc)(world, data, &shape, 1u);
+
+    VisualObject dynamic_vo;
+    dynamic_vo.m_Position = Point3(10.0f, 10.0f, 0.0f);
+    data.m_Type = dmPhysics::COLLISION_OBJECT_TYPE_DYNAMIC;
+    data.m_Mass = 1.0f;
+    data.m_UserData = &dynamic_vo;
+    typename TypeParam::CollisionObjectType dynamic_co = (*TestFixture::m_Test.m_NewCollisionObjectFunc)(world, data, &shape, 1u);
+
+    // The dynamic body falls, and its transform is written back in one batch per step
+    g_ReportChanged = true;
+    g_SetWorldTransformsCount = 0;
+    kinematic_vo.m_Position = Point3(5.0f, 0.0f, 0.0f);
+    dmPhysics::StepWorld2D(world, TestFixture::m_StepWorldContext);
+    ASSERT_EQ(1u, g_SetWorldTransformsCount);
+    ASSERT_GT(10.0f, dynamic_vo.m_Position.getY());
+    ASSERT_NEAR(5.0f, (*TestFixture::m_Test.m_GetWorldPositionFunc)(TestFixture::m_Context, kinematic_co).getX(), 0.001f);
+
+    // The objects reported as unchanged are left alone
+    g_ReportChanged = false;
+    kinematic_vo.m_Position = Point3(7.0f, 0.0f, 0.0f);
+    dmPhysics::StepWorld2D(world, TestFixture::m_StepWorldContext);
+    ASSERT_NEAR(5.0f, (*TestFixture::m_Test.m_GetWorldPositionFunc)(TestFixture::m_Context, kinematic_co).getX(), 0.001f);
+
+    g_ReportChanged = true;
+    dmPhysics::StepWorld2D(world, TestFixture::m_StepWorldContext);
+    ASSERT_NEAR(7.0f, (*TestFixture::m_Test.m_GetWorldPositionFunc)(TestFixture::m_Context, kinematic_co).getX(), 0.001f);
+
+    (*TestFixture::m_Test.m_DeleteCollisionObjectFunc)(world, dynamic_co);
+    (*TestFixture::m_Test.m_DeleteCollisionObjectFunc)(world, kinematic_co);
+    (*TestFixture::m_Test.m_DeleteCollisionShapeFunc)(shape);
+    dmPhysics::DeleteWorld2D(TestFixture::m_Context, world);
+}
+
 int main(int argc, char **argv)
 {
     jc_test_init(&argc, argv);
@@ -171,7 +171,10 @@ namespace dmRender
      * @member m_DestinationBlendFactor [type: dmGraphics::BlendFactor] the destination blend factor
      * @member m_StencilTestParams [type: dmRender::StencilTestParams] the stencil test params
      * @member m_VertexStart [type: uint32_t] the vertex start
-     * @member m_VertexCount [type: uint32_t] the vertex count
+     * @member m_VertexCount [type: uint32_t] the vertex count (the index count per instance when instanced)
+     * @member m_InstanceVertexBuffer [type: dmGraphics::HVertexBuffer] the per instance vertex buffer
+     * @member m_InstanceVertexDeclaration [type: dmGraphics::HVertexDeclaration] the per instance vertex declaration
+     * @member m_InstanceCount [type: uint32_t] the number of instances to draw. 0 draws the object without instancing
      * @member m_SetBlendFactors [type: uint8_t:1] use the blend factors
      * @member m_SetStencilTest [type: uint8_t:1] use the stencil test
      */
@@ -199,6 +202,9 @@ namespace dmRender
         StencilTestParams               m_StencilTestParams;
         uint32_t                        m_VertexStart;
         uint32_t                        m_VertexCount;
+        dmGraphics::HVertexBuffer       m_InstanceVertexBuffer;
+        dmGraphics::HVertexDeclaration  m_InstanceVertexDeclaration;
+        uint32_t                        m_InstanceCount;
         uint8_t                         m_SetBlendFactors : 1;
         uint8_t                         m_SetStencilTest : 1;
         uint8_t                         m_SetFaceWinding : 1;
@@ -220,6 +226,9 @@ namespace dmRender
      * @param m_MajorOrder [type: uint32_t:2] If RENDER_ORDER_WORLD, then sorting is done based on the world position.
                                               Otherwise the sorting uses the m_Order value directly.
      * @param m_Dispatch [type: uint32_t:8] The dispatch function callback (dmRender::HRenderListDispatch)
+     * @param m_Cull [type: uint32_t:1] If set, the entry is skipped when its bounding box is outside the view frustum.
+                                        Set by RenderListSetBounds. Only used if m_MajorOrder == RENDER_ORDER_WORLD
+     * @param m_BoundsIndex [type: uint32_t] the index of the bounding box set by RenderListSetBounds
      */
     struct RenderListEntry
     {
@@ -231,6 +240,8 @@ namespace dmRender
         uint32_t m_MinorOrder:4;
         uint32_t m_MajorOrder:2;
         uint32_t m_Dispatch:8;
+        uint32_t m_Cull:1;
+        uint32_t m_BoundsIndex;
     };
 
     /*#
@@ -309,7 +320,7 @@ namespace dmRender
     HRenderListDispatch RenderListMakeDispatch(HRenderContext context, RenderListDispatchFn fn, void* user_data);
 
     /*#
-     * Allocates an array of render entries
+     * Allocates an array of render entries. The entries are zero initialized
      * @note Do not store a pointer into this array, as they're reused next frame
      * @name RenderListAlloc
      * @param context [type: dmRender::HRenderContext] the context
@@ -327,6 +338,16 @@ namespace dmRender
      */
     void RenderListSubmit(HRenderContext context, RenderListEntry* begin, RenderListEntry* end);
 
+    /*#
+     * Sets the bounding box of a render entry, which makes it eligible for frustum culling.
+     * Entries without a bounding box are never culled.
+     * @name RenderListSetBounds
+     * @param context [type: dmRender::HRenderContext] the context
+     * @param entry [type: dmRender::RenderListEntry*] the entry (allocated with RenderListAlloc)
+     * @param half_extents [type: dmVMath::Vector3] the half size of the world space bounding box, centered on m_WorldPosition
+     */
+    void RenderListSetBounds(HRenderContext context, RenderListEntry* entry, const dmVMath::Vector3& half_extents);
+
     /*#
      * Adds a render object to the current render frame
      * @name AddToRender
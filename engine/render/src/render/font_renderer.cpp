@@ -19,6 +19,7 @@
 #include <dlib/memory.h>
 #include <dlib/static_assert.h>
 #include <dlib/array.h>
+#include <dlib/hash.h>
 #include <dlib/log.h>
 #include <dlib/math.h>
 #include <dlib/profile.h>
@@ -80,6 +81,43 @@ namespace dmRender
 
     }
 
+    // Max number of lines in a laid out text
+    static const uint32_t MAX_TEXT_LINES = 128;
+    // Number of laid out texts kept per font map
+    static const uint32_t TEXT_LAYOUT_CACHE_SIZE = 256;
+
+    // A visible glyph of a laid out text, positioned relative to the start of its line
+    struct TextLayoutGlyph
+    {
+        Glyph*      m_Glyph;
+        int16_t     m_X;
+        uint16_t    m_Line;
+    };
+
+    // A text broken into lines, with the glyphs looked up and advanced
+    // The alignment and leading are applied when the vertices are created, since they don't affect the layout
+    struct TextLayout
+    {
+        uint64_t            m_Key;
+        // The text and parameters the layout was made for, compared on a cache hit in case of a hash collision
+        char*               m_Text;
+        uint32_t            m_TextLength;
+        uint32_t            m_TextCapacity;
+        float               m_KeyWidth;
+        float               m_KeyTracking;
+        TextLayoutGlyph*    m_Glyphs;
+        float*              m_LineWidths;
+        uint32_t            m_GlyphCount;
+        uint32_t            m_GlyphCapacity;
+        uint32_t            m_LineCount;
+        uint32_t            m_LineCapacity;
+        float               m_Width;
+        uint8_t             m_Valid : 1;
+        uint8_t             m_KeyLineBreak : 1;
+        // Set when the layout is used, and cleared when the cache cursor passes it, see GetTextLayout
+        uint8_t             m_Used : 1;
+    };
+
     struct FontMap
     {
         FontMap()
@@ -103,12 +141,23 @@ namespace dmRender
         , m_CacheCellMaxAscent(0)
         , m_CacheCellPadding(0)
         , m_LayerMask(FACE)
+        , m_TextLayouts(0)
+        , m_TextLayoutCursor(0)
         {
 
         }
 
         ~FontMap()
         {
+            if (m_TextLayouts) {
+                for (uint32_t i = 0; i < TEXT_LAYOUT_CACHE_SIZE; ++i)
+                {
+                    free(m_TextLayouts[i].m_Text);
+                    free(m_TextLayouts[i].m_Glyphs);
+                    free(m_TextLayouts[i].m_LineWidths);
+                }
+                free(m_TextLayouts);
+            }
             if (m_GlyphData) {
                 free(m_GlyphData);
             }
@@ -156,10 +205,28 @@ namespace dmRender
         uint32_t                m_CacheCellMaxAscent;
         uint8_t                 m_CacheCellPadding;
         uint8_t                 m_LayerMask;
+
+        // Recently laid out texts, allocated on first use
+        TextLayout*             m_TextLayouts;
+        dmHashTable64<uint32_t> m_TextLayoutIndices;
+        uint32_t                m_TextLayoutCursor;
     };
 
     static float GetLineTextMetrics(HFontMap font_map, float tracking, const char* text, int n, bool measure_trailing_space);
 
+    // The layouts point to the glyphs, so they must be cleared whenever the glyphs change
+    static void ClearTextLayouts(HFontMap font_map)
+    {
+        if (!font_map->m_TextLayouts)
+            return;
+        for (uint32_t i = 0; i < TEXT_LAYOUT_CACHE_SIZE; ++i)
+        {
+            font_map->m_TextLayouts[i].m_Valid = 0;
+            font_map->m_TextLayouts[i].m_Used = 0;
+        }
+        font_map->m_TextLayoutIndices.Clear();
+    }
+
     static void InitFontmap(FontMapParams& params, dmGraphics::TextureParams& tex_params, uint8_t init_val)
     {
         uint8_t bpp = params.m_GlyphChannels;
@@ -195,6 +262,9 @@ namespace dmRender
         FontMap* font_map = new FontMap();
         font_map->m_Material = 0;
 
+        font_map->m_TextLayouts = (TextLayout*) calloc(TEXT_LAYOUT_CACHE_SIZE, sizeof(TextLayout));
+        font_map->m_TextLayoutIndices.SetCapacity(TEXT_LAYOUT_CACHE_SIZE / 2, TEXT_LAYOUT_CACHE_SIZE);
+
         const dmArray<Glyph>& glyphs = params.m_Glyphs;
         font_map->m_Glyphs.SetCapacity((3 * glyphs.Size()) / 2, glyphs.Size());
         for (uint32_t i = 0; i < glyphs.Size(); ++i) {
@@ -294,6 +364,7 @@ namespace dmRender
     void SetFontMap(HFontMap font_map, FontMapParams& params)
     {
         const dmArray<Glyph>& glyphs = params.m_Glyphs;
+        ClearTextLayouts(font_map);
         font_map->m_Glyphs.Clear();
         font_map->m_Glyphs.SetCapacity((3 * glyphs.Size()) / 2, glyphs.Size());
         for (uint32_t i = 0; i < glyphs.Size(); ++i) {
@@ -484,6 +555,125 @@ namespace dmRender
         }
     };
 
+    static Glyph* GetGlyph(HFontMap font_map, uint32_t c);
+
+    // Returns the layout of the text, from the cache if it has been laid out recently.
+    // The layout stays valid until the next call.
+    static const TextLayout* GetTextLayout(HFontMap font_map, const char* text, float width, bool line_break, float tracking)
+    {
+        if (!line_break) {
+            width = FLT_MAX;
+        }
+
+        uint32_t text_length = strlen(text);
+        uint8_t line_break_key = line_break;
+        HashState64 key_state;
+        dmHashInit64(&key_state, false);
+        dmHashUpdateBuffer64(&key_state, text, text_length);
+        dmHashUpdateBuffer64(&key_state, &width, sizeof(width));
+        dmHashUpdateBuffer64(&key_state, &tracking, sizeof(tracking));
+        dmHashUpdateBuffer64(&key_state, &line_break_key, sizeof(line_break_key));
+        uint64_t key = dmHashFinal64(&key_state);
+
+        uint32_t slot;
+        TextLayout* layout;
+        uint32_t* index = font_map->m_TextLayoutIndices.Get(key);
+        if (index) {
+            slot = *index;
+            layout = &font_map->m_TextLayouts[slot];
+            layout->m_Used = 1;
+            if (layout->m_TextLength == text_length && memcmp(layout->m_Text, text, text_length) == 0
+                && layout->m_KeyWidth == width && layout->m_KeyTracking == tracking && layout->m_KeyLineBreak == line_break_key) {
+                return layout;
+            }
+            // A different text with the same key, the slot is laid out again for this text
+        } else {
+            // Replace the first layout that hasn't been used since the cursor passed it the last time
+            do {
+                slot = font_map->m_TextLayoutCursor;
+                font_map->m_TextLayoutCursor = (slot + 1) % TEXT_LAYOUT_CACHE_SIZE;
+                layout = &font_map->m_TextLayouts[slot];
+                if (layout->m_Used) {
+                    layout->m_Used = 0;
+                    continue;
+                }
+                break;
+            } while (true);
+
+            if (layout->m_Valid) {
+                font_map->m_TextLayoutIndices.Erase(layout->m_Key);
+            }
+        }
+
+        if (!layout->m_Text || layout->m_TextCapacity < text_length) {
+            layout->m_TextCapacity = dmMath::Max(text_length, 16U);
+            layout->m_Text = (char*) realloc(layout->m_Text, layout->m_TextCapacity);
+        }
+        memcpy(layout->m_Text, text, text_length);
+        layout->m_TextLength = text_length;
+        layout->m_KeyWidth = width;
+        layout->m_KeyTracking = tracking;
+        layout->m_KeyLineBreak = line_break_key;
+
+        // Trailing space characters should be ignored when measuring and
+        // rendering multiline text.
+        // For single line text we still want to include spaces when the text
+        // layout is calculated (https://github.com/defold/defold/issues/5911)
+        bool measure_trailing_space = !line_break;
+
+        TextLine lines[MAX_TEXT_LINES];
+        LayoutMetrics lm(font_map, tracking);
+        uint32_t line_count = Layout(text, width, lines, MAX_TEXT_LINES, &layout->m_Width, lm, measure_trailing_space);
+
+        uint32_t max_glyph_count = 0;
+        for (uint32_t line = 0; line < line_count; ++line) {
+            max_glyph_count += lines[line].m_Count;
+        }
+        if (layout->m_GlyphCapacity < max_glyph_count) {
+            layout->m_GlyphCapacity = dmMath::Max(max_glyph_count, 16U);
+            layout->m_Glyphs = (TextLayoutGlyph*) realloc(layout->m_Glyphs, layout->m_GlyphCapacity * sizeof(TextLayoutGlyph));
+        }
+        if (layout->m_LineCapacity < line_count) {
+            layout->m_LineCapacity = dmMath::Max(line_count, 4U);
+            layout->m_LineWidths = (float*) realloc(layout->m_LineWidths, layout->m_LineCapacity * sizeof(float));
+        }
+
+        uint32_t glyph_count = 0;
+        for (uint32_t line = 0; line < line_count; ++line) {
+            const TextLine& l = lines[line];
+            layout->m_LineWidths[line] = l.m_Width;
+
+            int16_t x = 0;
+            const char* cursor = &text[l.m_Index];
+            for (int j = 0; j < l.m_Count; ++j)
+            {
+                uint32_t c = dmUtf8::NextChar(&cursor);
+                Glyph* g = GetGlyph(font_map, c);
+                if (!g) {
+                    continue;
+                }
+
+                if (g->m_Width > 0) {
+                    TextLayoutGlyph& layout_glyph = layout->m_Glyphs[glyph_count++];
+                    layout_glyph.m_Glyph = g;
+                    layout_glyph.m_X = x;
+                    layout_glyph.m_Line = (uint16_t) line;
+                }
+                x += (int16_t)(g->m_Advance + tracking);
+            }
+        }
+
+        layout->m_Key = key;
+        layout->m_GlyphCount = glyph_count;
+        layout->m_LineCount = line_count;
+        layout->m_Valid = 1;
+        layout->m_Used = 1;
+        if (!index) {
+            font_map->m_TextLayoutIndices.Put(key, slot);
+        }
+        return layout;
+    }
+
     static dmhash_t g_TextureSizeRecipHash = dmHashString64("texture_size_recip");
 
     void DrawText(HRenderContext render_context, HFontMap font_map, HMaterial material, uint64_t batch_key, const DrawTextParams& params)
@@ -666,26 +856,14 @@ namespace dmRender
 
     static int CreateFontVertexDataInternal(TextContext& text_context, HFontMap font_map, const char* text, const TextEntry& te, float recip_w, float recip_h, GlyphVertex* vertices, uint32_t num_vertices)
     {
-        float width = te.m_Width;
-        if (!te.m_LineBreak) {
-            width = FLT_MAX;
-        }
         float line_height = font_map->m_MaxAscent + font_map->m_MaxDescent;
         float leading = line_height * te.m_Leading;
         float tracking = line_height * te.m_Tracking;
 
-        const uint32_t max_lines = 128;
-        TextLine lines[max_lines];
-
-        // Trailing space characters should be ignored when measuring and
-        // rendering multiline text.
-        // For single line text we still want to include spaces when the text
-        // layout is calculated (https://github.com/defold/defold/issues/5911)
-        bool measure_trailing_space = !te.m_LineBreak;
-
-        LayoutMetrics lm(font_map, tracking);
-        float layout_width;
-        int line_count = Layout(text, width, lines, max_lines, &layout_width, lm, measure_trailing_space);
+        const TextLayout* layout = GetTextLayout(font_map, text, te.m_Width, te.m_LineBreak, tracking);
+        const TextLayoutGlyph* layout_glyphs = layout->m_Glyphs;
+        const uint32_t glyph_count = layout->m_GlyphCount;
+        int line_count = layout->m_LineCount;
         float x_offset = OffsetX(te.m_Align, te.m_Width);
         float y_offset = OffsetY(te.m_VAlign, te.m_Height, font_map->m_MaxAscent, font_map->m_MaxDescent, te.m_Leading, line_count);
 
@@ -730,240 +908,214 @@ namespace dmRender
             layer_count += HAS_LAYER(layer_mask,OUTLINE) + HAS_LAYER(layer_mask,SHADOW);
 
             // Calculate number of valid glyphs
-            for (int line = 0; line < line_count; ++line)
+            for (uint32_t i = 0; i < glyph_count; ++i)
             {
-                TextLine& l = lines[line];
-                const char* cursor = &text[l.m_Index];
-                bool inner_break = false;
+                Glyph* g = layout_glyphs[i].m_Glyph;
 
-                for (int j = 0; j < l.m_Count; ++j)
+                if ((vertexindex + vertices_per_quad) * layer_count > num_vertices)
                 {
-                    uint32_t c = dmUtf8::NextChar(&cursor);
-                    Glyph* g   = GetGlyph(font_map, c);
-
-                    if (!g)
-                    {
-                        continue;
-                    }
-
-                    if ((vertexindex + vertices_per_quad) * layer_count > num_vertices)
-                    {
-                        inner_break = true;
-                        break;
-                    }
-
-                    if (g->m_Width > 0)
-                    {
-                        int16_t px_cell_offset_y = font_map->m_CacheCellMaxAscent - (int16_t)g->m_Ascent;
-
-                        // Prepare the cache here aswell since we only count glyphs we definitely
-                        // will render.
-                        if (!g->m_InCache)
-                        {
-                            AddGlyphToCache(font_map, text_context, g, px_cell_offset_y);
-                        }
+                    break;
+                }
 
-                        if (g->m_InCache)
-                        {
-                            valid_glyph_count++;
+                int16_t px_cell_offset_y = font_map->m_CacheCellMaxAscent - (int16_t)g->m_Ascent;
 
-                            vertexindex += vertices_per_quad;
-                        }
-                    }
+                // Prepare the cache here aswell since we only count glyphs we definitely
+                // will render.
+                if (!g->m_InCache)
+                {
+                    AddGlyphToCache(font_map, text_context, g, px_cell_offset_y);
                 }
 
-                if (inner_break)
+                if (g->m_InCache)
                 {
-                    break;
+                    valid_glyph_count++;
+
+                    vertexindex += vertices_per_quad;
                 }
             }
 
             vertexindex = 0;
         }
 
-        for (int line = 0; line < line_count; ++line) {
-            TextLine& l = lines[line];
-            int16_t x = (int16_t)(x_offset - OffsetX(te.m_Align, l.m_Width) + 0.5f);
-            int16_t y = (int16_t) (y_offset - line * leading + 0.5f);
-            const char* cursor = &text[l.m_Index];
-            int n = l.m_Count;
-            for (int j = 0; j < n; ++j)
+        // The layout only holds the glyphs with a width, ordered by line
+        int line = -1;
+        int16_t line_x = 0;
+        int16_t y = 0;
+        for (uint32_t i = 0; i < glyph_count; ++i)
+        {
+            const TextLayoutGlyph& layout_glyph = layout_glyphs[i];
+            Glyph* g = layout_glyph.m_Glyph;
+            if (layout_glyph.m_Line != line)
             {
-                uint32_t c = dmUtf8::NextChar(&cursor);
+                line = layout_glyph.m_Line;
+                line_x = (int16_t)(x_offset - OffsetX(te.m_Align, layout->m_LineWidths[line]) + 0.5f);
+                y = (int16_t) (y_offset - line * leading + 0.5f);
+            }
+            int16_t x = line_x + layout_glyph.m_X;
 
-                Glyph* g =  GetGlyph(font_map, c);
-                if (!g) {
-                    continue;
-                }
+            // Look ahead and see if we can produce vertices for the next glyph or not
+            if ((vertexindex + vertices_per_quad) * layer_count > num_vertices)
+            {
+                dmLogWarning("Character buffer exceeded (size: %d), increase the \"graphics.max_characters\" property in your game.project file.", num_vertices / 6);
+                return vertexindex * layer_count;
+            }
 
-                // Look ahead and see if we can produce vertices for the next glyph or not
-                if ((vertexindex + vertices_per_quad) * layer_count > num_vertices)
-                {
-                    dmLogWarning("Character buffer exceeded (size: %d), increase the \"graphics.max_characters\" property in your game.project file.", num_vertices / 6);
-                    return vertexindex * layer_count;
-                }
+            int16_t width   = (int16_t) g->m_Width;
+            int16_t descent = (int16_t) g->m_Descent;
+            int16_t ascent  = (int16_t) g->m_Ascent;
 
-                if (g->m_Width > 0)
-                {
-                    int16_t width   = (int16_t) g->m_Width;
-                    int16_t descent = (int16_t) g->m_Descent;
-                    int16_t ascent  = (int16_t) g->m_Ascent;
+            // Calculate y-offset in cache-cell space by moving glyphs down to baseline
+            int16_t px_cell_offset_y = font_map->m_CacheCellMaxAscent - ascent;
 
-                    // Calculate y-offset in cache-cell space by moving glyphs down to baseline
-                    int16_t px_cell_offset_y = font_map->m_CacheCellMaxAscent - ascent;
+            if (!g->m_InCache) {
+                AddGlyphToCache(font_map, text_context, g, px_cell_offset_y);
+            }
 
-                    if (!g->m_InCache) {
-                        AddGlyphToCache(font_map, text_context, g, px_cell_offset_y);
-                    }
+            if (g->m_InCache) {
+                g->m_Frame = text_context.m_Frame;
 
-                    if (g->m_InCache) {
-                        g->m_Frame = text_context.m_Frame;
-
-                        uint32_t face_index = vertexindex + vertices_per_quad * valid_glyph_count * (layer_count-1);
-
-                        // Set face vertices first, this will always hold since we can't have less than 1 layer
-                        GlyphVertex& v1_layer_face = vertices[face_index];
-                        GlyphVertex& v2_layer_face = vertices[face_index + 1];
-                        GlyphVertex& v3_layer_face = vertices[face_index + 2];
-                        GlyphVertex& v4_layer_face = vertices[face_index + 3];
-                        GlyphVertex& v5_layer_face = vertices[face_index + 4];
-                        GlyphVertex& v6_layer_face = vertices[face_index + 5];
-
-                        (Vector4&) v1_layer_face.m_Position = te.m_Transform * Vector4(x + g->m_LeftBearing, y - descent, 0, 1);
-                        (Vector4&) v2_layer_face.m_Position = te.m_Transform * Vector4(x + g->m_LeftBearing, y + ascent, 0, 1);
-                        (Vector4&) v3_layer_face.m_Position = te.m_Transform * Vector4(x + g->m_LeftBearing + width, y - descent, 0, 1);
-                        (Vector4&) v6_layer_face.m_Position = te.m_Transform * Vector4(x + g->m_LeftBearing + width, y + ascent, 0, 1);
-
-                        v1_layer_face.m_UV[0] = (g->m_X + font_map->m_CacheCellPadding) * recip_w;
-                        v1_layer_face.m_UV[1] = (g->m_Y + font_map->m_CacheCellPadding + ascent + descent + px_cell_offset_y) * recip_h;
-
-                        v2_layer_face.m_UV[0] = (g->m_X + font_map->m_CacheCellPadding) * recip_w;
-                        v2_layer_face.m_UV[1] = (g->m_Y + font_map->m_CacheCellPadding + px_cell_offset_y) * recip_h;
-
-                        v3_layer_face.m_UV[0] = (g->m_X + font_map->m_CacheCellPadding + g->m_Width) * recip_w;
-                        v3_layer_face.m_UV[1] = (g->m_Y + font_map->m_CacheCellPadding + ascent + descent + px_cell_offset_y) * recip_h;
-
-                        v6_layer_face.m_UV[0] = (g->m_X + font_map->m_CacheCellPadding + g->m_Width) * recip_w;
-                        v6_layer_face.m_UV[1] = (g->m_Y + font_map->m_CacheCellPadding + px_cell_offset_y) * recip_h;
-
-                        #define SET_VERTEX_FONT_PROPERTIES(v) \
-                            v.m_FaceColor[0]    = face_color[0]; \
-                            v.m_FaceColor[1]    = face_color[1]; \
-                            v.m_FaceColor[2]    = face_color[2]; \
-                            v.m_FaceColor[3]    = face_color[3]; \
-                            v.m_OutlineColor[0] = outline_color[0]; \
-                            v.m_OutlineColor[1] = outline_color[1]; \
-                            v.m_OutlineColor[2] = outline_color[2]; \
-                            v.m_OutlineColor[3] = outline_color[3]; \
-                            v.m_ShadowColor[0]  = shadow_color[0]; \
-                            v.m_ShadowColor[1]  = shadow_color[1]; \
-                            v.m_ShadowColor[2]  = shadow_color[2]; \
-                            v.m_ShadowColor[3]  = shadow_color[3]; \
-                            v.m_FaceColor[0]    = face_color[0]; \
-                            v.m_FaceColor[1]    = face_color[1]; \
-                            v.m_FaceColor[2]    = face_color[2]; \
-                            v.m_FaceColor[3]    = face_color[3]; \
-                            v.m_SdfParams[0]    = sdf_edge_value; \
-                            v.m_SdfParams[1]    = sdf_outline; \
-                            v.m_SdfParams[2]    = sdf_smoothing; \
-                            v.m_SdfParams[3]    = sdf_shadow;
-
-                        SET_VERTEX_FONT_PROPERTIES(v1_layer_face)
-                        SET_VERTEX_FONT_PROPERTIES(v2_layer_face)
-                        SET_VERTEX_FONT_PROPERTIES(v3_layer_face)
-                        SET_VERTEX_FONT_PROPERTIES(v6_layer_face)
-
-                        #undef SET_VERTEX_FONT_PROPERTIES
-
-                        v4_layer_face = v3_layer_face;
-                        v5_layer_face = v2_layer_face;
-
-                        #define SET_VERTEX_LAYER_MASK(v,f,o,s) \
-                            v.m_LayerMasks[0] = f; \
-                            v.m_LayerMasks[1] = o; \
-                            v.m_LayerMasks[2] = s;
-
-                        // Set outline vertices
-                        if (HAS_LAYER(layer_mask,OUTLINE))
-                        {
-                            uint32_t outline_index = vertexindex + vertices_per_quad * valid_glyph_count * (layer_count-2);
-
-                            GlyphVertex& v1_layer_outline = vertices[outline_index];
-                            GlyphVertex& v2_layer_outline = vertices[outline_index + 1];
-                            GlyphVertex& v3_layer_outline = vertices[outline_index + 2];
-                            GlyphVertex& v4_layer_outline = vertices[outline_index + 3];
-                            GlyphVertex& v5_layer_outline = vertices[outline_index + 4];
-                            GlyphVertex& v6_layer_outline = vertices[outline_index + 5];
-
-                            v1_layer_outline = v1_layer_face;
-                            v2_layer_outline = v2_layer_face;
-                            v3_layer_outline = v3_layer_face;
-                            v4_layer_outline = v4_layer_face;
-                            v5_layer_outline = v5_layer_face;
-                            v6_layer_outline = v6_layer_face;
-
-                            SET_VERTEX_LAYER_MASK(v1_layer_outline,0,1,0)
-                            SET_VERTEX_LAYER_MASK(v2_layer_outline,0,1,0)
-                            SET_VERTEX_LAYER_MASK(v3_layer_outline,0,1,0)
-                            SET_VERTEX_LAYER_MASK(v4_layer_outline,0,1,0)
-                            SET_VERTEX_LAYER_MASK(v5_layer_outline,0,1,0)
-                            SET_VERTEX_LAYER_MASK(v6_layer_outline,0,1,0)
-                        }
-
-                        // Set shadow vertices
-                        if (HAS_LAYER(layer_mask,SHADOW))
-                        {
-                            uint32_t shadow_index = vertexindex;
-                            float shadow_x        = font_map->m_ShadowX;
-                            float shadow_y        = font_map->m_ShadowY;
-
-                            GlyphVertex& v1_layer_shadow = vertices[shadow_index];
-                            GlyphVertex& v2_layer_shadow = vertices[shadow_index + 1];
-                            GlyphVertex& v3_layer_shadow = vertices[shadow_index + 2];
-                            GlyphVertex& v4_layer_shadow = vertices[shadow_index + 3];
-                            GlyphVertex& v5_layer_shadow = vertices[shadow_index + 4];
-                            GlyphVertex& v6_layer_shadow = vertices[shadow_index + 5];
-
-                            v1_layer_shadow = v1_layer_face;
-                            v2_layer_shadow = v2_layer_face;
-                            v3_layer_shadow = v3_layer_face;
-                            v6_layer_shadow = v6_layer_face;
-
-                            // Shadow offsets must be calculated since we need to offset in local space (before vertex transformation)
-                            (Vector4&) v1_layer_shadow.m_Position = te.m_Transform * Vector4(x + g->m_LeftBearing + shadow_x, y - descent + shadow_y, 0, 1);
-                            (Vector4&) v2_layer_shadow.m_Position = te.m_Transform * Vector4(x + g->m_LeftBearing + shadow_x, y + ascent + shadow_y, 0, 1);
-                            (Vector4&) v3_layer_shadow.m_Position = te.m_Transform * Vector4(x + g->m_LeftBearing + shadow_x + width, y - descent + shadow_y, 0, 1);
-                            (Vector4&) v6_layer_shadow.m_Position = te.m_Transform * Vector4(x + g->m_LeftBearing + shadow_x + width, y + ascent + shadow_y, 0, 1);
-
-                            v4_layer_shadow = v3_layer_shadow;
-                            v5_layer_shadow = v2_layer_shadow;
-
-                            SET_VERTEX_LAYER_MASK(v1_layer_shadow,0,0,1)
-                            SET_VERTEX_LAYER_MASK(v2_layer_shadow,0,0,1)
-                            SET_VERTEX_LAYER_MASK(v3_layer_shadow,0,0,1)
-                            SET_VERTEX_LAYER_MASK(v4_layer_shadow,0,0,1)
-                            SET_VERTEX_LAYER_MASK(v5_layer_shadow,0,0,1)
-                            SET_VERTEX_LAYER_MASK(v6_layer_shadow,0,0,1)
-                        }
-
-                        // If we only have one layer, we need to set the mask to (1,1,1)
-                        // so that we can use the same calculations for both single and multi.
-                        // The mask is set last for layer 1 since we copy the vertices to
-                        // all other layers to avoid re-calculating their data.
-                        uint8_t is_one_layer = layer_count > 1 ? 0 : 1;
-                        SET_VERTEX_LAYER_MASK(v1_layer_face,1,is_one_layer,is_one_layer)
-                        SET_VERTEX_LAYER_MASK(v2_layer_face,1,is_one_layer,is_one_layer)
-                        SET_VERTEX_LAYER_MASK(v3_layer_face,1,is_one_layer,is_one_layer)
-                        SET_VERTEX_LAYER_MASK(v4_layer_face,1,is_one_layer,is_one_layer)
-                        SET_VERTEX_LAYER_MASK(v5_layer_face,1,is_one_layer,is_one_layer)
-                        SET_VERTEX_LAYER_MASK(v6_layer_face,1,is_one_layer,is_one_layer)
-
-                        #undef SET_VERTEX_LAYER_MASK
-
-                        vertexindex += vertices_per_quad;
-                    }
+                uint32_t face_index = vertexindex + vertices_per_quad * valid_glyph_count * (layer_count-1);
+
+                // Set face vertices first, this will always hold since we can't have less than 1 layer
+                GlyphVertex& v1_layer_face = vertices[face_index];
+                GlyphVertex& v2_layer_face = vertices[face_index + 1];
+                GlyphVertex& v3_layer_face = vertices[face_index + 2];
+                GlyphVertex& v4_layer_face = vertices[face_index + 3];
+                GlyphVertex& v5_layer_face = vertices[face_index + 4];
+                GlyphVertex& v6_layer_face = vertices[face_index + 5];
+
+                (Vector4&) v1_layer_face.m_Position = te.m_Transform * Vector4(x + g->m_LeftBearing, y - descent, 0, 1);
+                (Vector4&) v2_layer_face.m_Position = te.m_Transform * Vector4(x + g->m_LeftBearing, y + ascent, 0, 1);
+                (Vector4&) v3_layer_face.m_Position = te.m_Transform * Vector4(x + g->m_LeftBearing + width, y - descent, 0, 1);
+                (Vector4&) v6_layer_face.m_Position = te.m_Transform * Vector4(x + g->m_LeftBearing + width, y + ascent, 0, 1);
+
+                v1_layer_face.m_UV[0] = (g->m_X + font_map->m_CacheCellPadding) * recip_w;
+                v1_layer_face.m_UV[1] = (g->m_Y + font_map->m_CacheCellPadding + ascent + descent + px_cell_offset_y) * recip_h;
+
+                v2_layer_face.m_UV[0] = (g->m_X + font_map->m_CacheCellPadding) * recip_w;
+                v2_layer_face.m_UV[1] = (g->m_Y + font_map->m_CacheCellPadding + px_cell_offset_y) * recip_h;
+
+                v3_layer_face.m_UV[0] = (g->m_X + font_map->m_CacheCellPadding + g->m_Width) * recip_w;
+                v3_layer_face.m_UV[1] = (g->m_Y + font_map->m_CacheCellPadding + ascent + descent + px_cell_offset_y) * recip_h;
+
+                v6_layer_face.m_UV[0] = (g->m_X + font_map->m_CacheCellPadding + g->m_Width) * recip_w;
+                v6_layer_face.m_UV[1] = (g->m_Y + font_map->m_CacheCellPadding + px_cell_offset_y) * recip_h;
+
+                #define SET_VERTEX_FONT_PROPERTIES(v) \
+                    v.m_FaceColor[0]    = face_color[0]; \
+                    v.m_FaceColor[1]    = face_color[1]; \
+                    v.m_FaceColor[2]    = face_color[2]; \
+                    v.m_FaceColor[3]    = face_color[3]; \
+                    v.m_OutlineColor[0] = outline_color[0]; \
+                    v.m_OutlineColor[1] = outline_color[1]; \
+                    v.m_OutlineColor[2] = outline_color[2]; \
+                    v.m_OutlineColor[3] = outline_color[3]; \
+                    v.m_ShadowColor[0]  = shadow_color[0]; \
+                    v.m_ShadowColor[1]  = shadow_color[1]; \
+                    v.m_ShadowColor[2]  = shadow_color[2]; \
+                    v.m_ShadowColor[3]  = shadow_color[3]; \
+                    v.m_FaceColor[0]    = face_color[0]; \
+                    v.m_FaceColor[1]    = face_color[1]; \
+                    v.m_FaceColor[2]    = face_color[2]; \
+                    v.m_FaceColor[3]    = face_color[3]; \
+                    v.m_SdfParams[0]    = sdf_edge_value; \
+                    v.m_SdfParams[1]    = sdf_outline; \
+                    v.m_SdfParams[2]    = sdf_smoothing; \
+                    v.m_SdfParams[3]    = sdf_shadow;
+
+                SET_VERTEX_FONT_PROPERTIES(v1_layer_face)
+                SET_VERTEX_FONT_PROPERTIES(v2_layer_face)
+                SET_VERTEX_FONT_PROPERTIES(v3_layer_face)
+                SET_VERTEX_FONT_PROPERTIES(v6_layer_face)
+
+                #undef SET_VERTEX_FONT_PROPERTIES
+
+                v4_layer_face = v3_layer_face;
+                v5_layer_face = v2_layer_face;
+
+                #define SET_VERTEX_LAYER_MASK(v,f,o,s) \
+                    v.m_LayerMasks[0] = f; \
+                    v.m_LayerMasks[1] = o; \
+                    v.m_LayerMasks[2] = s;
+
+                // Set outline vertices
+                if (HAS_LAYER(layer_mask,OUTLINE))
+                {
+                    uint32_t outline_index = vertexindex + vertices_per_quad * valid_glyph_count * (layer_count-2);
+
+                    GlyphVertex& v1_layer_outline = vertices[outline_index];
+                    GlyphVertex& v2_layer_outline = vertices[outline_index + 1];
+                    GlyphVertex& v3_layer_outline = vertices[outline_index + 2];
+                    GlyphVertex& v4_layer_outline = vertices[outline_index + 3];
+                    GlyphVertex& v5_layer_outline = vertices[outline_index + 4];
+                    GlyphVertex& v6_layer_outline = vertices[outline_index + 5];
+
+                    v1_layer_outline = v1_layer_face;
+                    v2_layer_outline = v2_layer_face;
+                    v3_layer_outline = v3_layer_face;
+                    v4_layer_outline = v4_layer_face;
+                    v5_layer_outline = v5_layer_face;
+                    v6_layer_outline = v6_layer_face;
+
+                    SET_VERTEX_LAYER_MASK(v1_layer_outline,0,1,0)
+                    SET_VERTEX_LAYER_MASK(v2_layer_outline,0,1,0)
+                    SET_VERTEX_LAYER_MASK(v3_layer_outline,0,1,0)
+                    SET_VERTEX_LAYER_MASK(v4_layer_outline,0,1,0)
+                    SET_VERTEX_LAYER_MASK(v5_layer_outline,0,1,0)
+                    SET_VERTEX_LAYER_MASK(v6_layer_outline,0,1,0)
                 }
-                x += (int16_t)(g->m_Advance + tracking);
+
+                // Set shadow vertices
+                if (HAS_LAYER(layer_mask,SHADOW))
+                {
+                    uint32_t shadow_index = vertexindex;
+                    float shadow_x        = font_map->m_ShadowX;
+                    float shadow_y        = font_map->m_ShadowY;
+
+                    GlyphVertex& v1_layer_shadow = vertices[shadow_index];
+                    GlyphVertex& v2_layer_shadow = vertices[shadow_index + 1];
+                    GlyphVertex& v3_layer_shadow = vertices[shadow_index + 2];
+                    GlyphVertex& v4_layer_shadow = vertices[shadow_index + 3];
+                    GlyphVertex& v5_layer_shadow = vertices[shadow_index + 4];
+                    GlyphVertex& v6_layer_shadow = vertices[shadow_index + 5];
+
+                    v1_layer_shadow = v1_layer_face;
+                    v2_layer_shadow = v2_layer_face;
+                    v3_layer_shadow = v3_layer_face;
+                    v6_layer_shadow = v6_layer_face;
+
+                    // Shadow offsets must be calculated since we need to offset in local space (before vertex transformation)
+                    (Vector4&) v1_layer_shadow.m_Position = te.m_Transform * Vector4(x + g->m_LeftBearing + shadow_x, y - descent + shadow_y, 0, 1);
+                    (Vector4&) v2_layer_shadow.m_Position = te.m_Transform * Vector4(x + g->m_LeftBearing + shadow_x, y + ascent + shadow_y, 0, 1);
+                    (Vector4&) v3_layer_shadow.m_Position = te.m_Transform * Vector4(x + g->m_LeftBearing + shadow_x + width, y - descent + shadow_y, 0, 1);
+                    (Vector4&) v6_layer_shadow.m_Position = te.m_Transform * Vector4(x + g->m_LeftBearing + shadow_x + width, y + ascent + shadow_y, 0, 1);
+
+                    v4_layer_shadow = v3_layer_shadow;
+                    v5_layer_shadow = v2_layer_shadow;
+
+                    SET_VERTEX_LAYER_MASK(v1_layer_shadow,0,0,1)
+                    SET_VERTEX_LAYER_MASK(v2_layer_shadow,0,0,1)
+                    SET_VERTEX_LAYER_MASK(v3_layer_shadow,0,0,1)
+                    SET_VERTEX_LAYER_MASK(v4_layer_shadow,0,0,1)
+                    SET_VERTEX_LAYER_MASK(v5_layer_shadow,0,0,1)
+                    SET_VERTEX_LAYER_MASK(v6_layer_shadow,0,0,1)
+                }
+
+                // If we only have one layer, we need to set the mask to (1,1,1)
+                // so that we can use the same calculations for both single and multi.
+                // The mask is set last for layer 1 since we copy the vertices to
+                // all other layers to avoid re-calculating their data.
+                uint8_t is_one_layer = layer_count > 1 ? 0 : 1;
+                SET_VERTEX_LAYER_MASK(v1_layer_face,1,is_one_layer,is_one_layer)
+                SET_VERTEX_LAYER_MASK(v2_layer_face,1,is_one_layer,is_one_layer)
+                SET_VERTEX_LAYER_MASK(v3_layer_face,1,is_one_layer,is_one_layer)
+                SET_VERTEX_LAYER_MASK(v4_layer_face,1,is_one_layer,is_one_layer)
+                SET_VERTEX_LAYER_MASK(v5_layer_face,1,is_one_layer,is_one_layer)
+                SET_VERTEX_LAYER_MASK(v6_layer_face,1,is_one_layer,is_one_layer)
+
+                #undef SET_VERTEX_LAYER_MASK
+
+                vertexindex += vertices_per_quad;
             }
         }
 
@@ -1085,6 +1237,33 @@ namespace dmRender
     }
 
 
+    // The half extents of the laid out text (see CreateFontVertexDataInternal), around the translation of the text transform
+    static Vector3 GetTextHalfExtents(TextContext& text_context, const TextEntry& te)
+    {
+        HFontMap font_map = te.m_FontMap;
+        const char* text = &text_context.m_TextBuffer[te.m_StringOffset];
+        float line_height = font_map->m_MaxAscent + font_map->m_MaxDescent;
+        float leading = line_height * te.m_Leading;
+        float tracking = line_height * te.m_Tracking;
+
+        const TextLayout* layout = GetTextLayout(font_map, text, te.m_Width, te.m_LineBreak, tracking);
+        uint32_t line_count = dmMath::Max<uint32_t>(layout->m_LineCount, 1);
+        float x_offset = OffsetX(te.m_Align, te.m_Width);
+        float y_offset = OffsetY(te.m_VAlign, te.m_Height, font_map->m_MaxAscent, font_map->m_MaxDescent, te.m_Leading, line_count);
+
+        // Each line is aligned within the widest one. The margin covers the glyph bearings, outline and shadow
+        float margin = line_height + dmMath::Max(fabsf(font_map->m_ShadowX), fabsf(font_map->m_ShadowY));
+        float min_x = x_offset - OffsetX(te.m_Align, layout->m_Width) - margin;
+        float max_x = min_x + layout->m_Width + margin * 2.0f;
+        float min_y = y_offset - (line_count - 1) * leading - font_map->m_MaxDescent - margin;
+        float max_y = y_offset + font_map->m_MaxAscent + margin;
+
+        // Grow the box to be symmetric around the origin, and take the extent along each axis
+        float ex = dmMath::Max(fabsf(min_x), fabsf(max_x));
+        float ey = dmMath::Max(fabsf(min_y), fabsf(max_y));
+        return absPerElem(te.m_Transform.getCol0().getXYZ()) * ex + absPerElem(te.m_Transform.getCol1().getXYZ()) * ey;
+    }
+
     void FlushTexts(HRenderContext render_context, uint32_t major_order, uint32_t render_order, bool final)
     {
         DM_PROFILE(Render, "FlushTexts");
@@ -1111,6 +1290,10 @@ namespace dmRender
                     write_ptr->m_BatchKey = te.m_BatchKey;
                     write_ptr->m_TagListKey = dmRender::GetMaterialTagListKey(te.m_Material);
                     write_ptr->m_Dispatch = dispatch;
+                    if (major_order == RENDER_ORDER_WORLD)
+                    {
+                        dmRender::RenderListSetBounds(render_context, write_ptr, GetTextHalfExtents(text_context, te));
+                    }
                     write_ptr++;
                 }
                 dmRender::RenderListSubmit(render_context, render_list, write_ptr);
@@ -1154,25 +1337,11 @@ namespace dmRender
         metrics->m_MaxAscent = font_map->m_MaxAscent;
         metrics->m_MaxDescent = font_map->m_MaxDescent;
 
-        if (!line_break) {
-            width = FLT_MAX;
-        }
-
-        const uint32_t max_lines = 128;
-        dmRender::TextLine lines[max_lines];
-
         float line_height = font_map->m_MaxAscent + font_map->m_MaxDescent;
 
-        // Trailing space characters should be ignored when measuring and
-        // rendering multiline text.
-        // For single line text we still want to include spaces when the text
-        // layout is calculated (https://github.com/defold/defold/issues/5911)
-        bool measure_trailing_space = !line_break;
-
-        LayoutMetrics lm(font_map, tracking * line_height);
-        float layout_width;
-        uint32_t num_lines = Layout(text, width, lines, max_lines, &layout_width, lm, measure_trailing_space);
-        metrics->m_Width = layout_width;
+        const TextLayout* layout = GetTextLayout(font_map, text, width, line_break, tracking * line_height);
+        uint32_t num_lines = layout->m_LineCount;
+        metrics->m_Width = layout->m_Width;
         metrics->m_Height = num_lines * (line_height * leading) - line_height * (leading - 1.0f);
     }
 
@@ -1181,6 +1350,13 @@ namespace dmRender
         uint32_t size = sizeof(FontMap);
         size += font_map->m_Glyphs.Capacity()*(sizeof(Glyph)+sizeof(uint32_t));
         size += dmGraphics::GetTextureResourceSize(font_map->m_Texture);
+        size += TEXT_LAYOUT_CACHE_SIZE * sizeof(TextLayout);
+        size += font_map->m_TextLayoutIndices.Capacity()*(sizeof(dmHashTable64<uint32_t>::Entry)+sizeof(uint32_t));
+        for (uint32_t i = 0; i < TEXT_LAYOUT_CACHE_SIZE; ++i)
+        {
+            const TextLayout& layout = font_map->m_TextLayouts[i];
+            size += layout.m_TextCapacity + layout.m_GlyphCapacity*sizeof(TextLayoutGlyph) + layout.m_LineCapacity*sizeof(float);
+        }
         return size;
     }
 
@@ -153,7 +153,7 @@ namespace dmRender
             {
                 case dmRenderDDF::MaterialDesc::CONSTANT_TYPE_USER:
                 {
-                    dmGraphics::SetConstantV4(graphics_context, &constant.m_Value, location);
+                    StateCacheSetConstantV4(render_context, &constant.m_Value, location);
                     break;
                 }
                 case dmRenderDDF::MaterialDesc::CONSTANT_TYPE_VIEWPROJ:
@@ -164,27 +164,27 @@ namespace dmRender
                         ndc_matrix.setElem(2, 2, 0.5f );
                         ndc_matrix.setElem(3, 2, 0.5f );
                         const Matrix4 view_projection = ndc_matrix * render_context->m_ViewProj;
-                        dmGraphics::SetConstantM4(graphics_context, (Vector4*)&view_projection, location);
+                        StateCacheSetConstantM4(render_context, (Vector4*)&view_projection, location);
                     }
                     else
                     {
-                        dmGraphics::SetConstantM4(graphics_context, (Vector4*)&render_context->m_ViewProj, location);
+                        StateCacheSetConstantM4(render_context, (Vector4*)&render_context->m_ViewProj, location);
                     }
                     break;
                 }
                 case dmRenderDDF::MaterialDesc::CONSTANT_TYPE_WORLD:
                 {
-                    dmGraphics::SetConstantM4(graphics_context, (Vector4*)&ro->m_WorldTransform, location);
+                    StateCacheSetConstantM4(render_context, (Vector4*)&ro->m_WorldTransform, location);
                     break;
                 }
                 case dmRenderDDF::MaterialDesc::CONSTANT_TYPE_TEXTURE:
                 {
-                    dmGraphics::SetConstantM4(graphics_context, (Vector4*)&ro->m_TextureTransform, location);
+                    StateCacheSetConstantM4(render_context, (Vector4*)&ro->m_TextureTransform, location);
                     break;
                 }
                 case dmRenderDDF::MaterialDesc::CONSTANT_TYPE_VIEW:
                 {
-                    dmGraphics::SetConstantM4(graphics_context, (Vector4*)&render_context->m_View, location);
+                    StateCacheSetConstantM4(render_context, (Vector4*)&render_context->m_View, location);
                     break;
                 }
                 case dmRenderDDF::MaterialDesc::CONSTANT_TYPE_PROJECTION:
@@ -197,11 +197,11 @@ namespace dmRender
                         ndc_matrix.setElem(2, 2, 0.5f );
                         ndc_matrix.setElem(3, 2, 0.5f );
                         const Matrix4 proj = ndc_matrix * render_context->m_Projection;
-                        dmGraphics::SetConstantM4(graphics_context, (Vector4*)&proj, location);
+                        StateCacheSetConstantM4(render_context, (Vector4*)&proj, location);
                     }
                     else
                     {
-                        dmGraphics::SetConstantM4(graphics_context, (Vector4*)&render_context->m_Projection, location);
+                        StateCacheSetConstantM4(render_context, (Vector4*)&render_context->m_Projection, location);
                     }
                     break;
                 }
@@ -214,7 +214,7 @@ namespace dmRender
                         // It is always affine however
                         normalT = affineInverse(normalT);
                         normalT = transpose(normalT);
-                        dmGraphics::SetConstantM4(graphics_context, (Vector4*)&normalT, location);
+                        StateCacheSetConstantM4(render_context, (Vector4*)&normalT, location);
                     }
                     break;
                 }
@@ -222,7 +222,7 @@ namespace dmRender
                 {
                     {
                         Matrix4 world_view = render_context->m_View * ro->m_WorldTransform;
-                        dmGraphics::SetConstantM4(graphics_context, (Vector4*)&world_view, location);
+                        StateCacheSetConstantM4(render_context, (Vector4*)&world_view, location);
                     }
                     break;
                 }
@@ -234,12 +234,12 @@ namespace dmRender
                         ndc_matrix.setElem(2, 2, 0.5f );
                         ndc_matrix.setElem(3, 2, 0.5f );
                         const Matrix4 world_view_projection = ndc_matrix * render_context->m_ViewProj * ro->m_WorldTransform;
-                        dmGraphics::SetConstantM4(graphics_context, (Vector4*)&world_view_projection, location);
+                        StateCacheSetConstantM4(render_context, (Vector4*)&world_view_projection, location);
                     }
                     else
                     {
                         const Matrix4 world_view_projection = render_context->m_ViewProj * ro->m_WorldTransform;
-                        dmGraphics::SetConstantM4(graphics_context, (Vector4*)&world_view_projection, location);
+                        StateCacheSetConstantM4(render_context, (Vector4*)&world_view_projection, location);
                     }
                     break;
                 }
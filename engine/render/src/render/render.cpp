@@ -13,6 +13,7 @@
 #include <assert.h>
 #include <string.h>
 #include <float.h>
+#include <math.h>
 #include <algorithm>
 
 #include <dlib/hash.h>
@@ -141,6 +142,7 @@ namespace dmRender
         }
 
         memset(context->m_Textures, 0, sizeof(dmGraphics::HTexture) * RenderObject::MAX_TEXTURE_COUNT);
+        memset(&context->m_StateCache, 0, sizeof(context->m_StateCache));
 
         InitializeTextContext(context, params.m_MaxCharacters);
 
@@ -179,6 +181,8 @@ namespace dmRender
         render_context->m_RenderListSortIndices.SetSize(0);
         render_context->m_RenderListDispatch.SetSize(0);
         render_context->m_RenderListRanges.SetSize(0);
+        render_context->m_RenderListSegments.SetSize(0);
+        render_context->m_RenderListBounds.SetSize(0);
     }
 
     HRenderListDispatch RenderListMakeDispatch(HRenderContext render_context, RenderListDispatchFn fn, void *user_data)
@@ -215,11 +219,12 @@ namespace dmRender
 
         uint32_t size = render_list.Size();
         render_list.SetSize(size + entries);
+        // Entries that don't opt in to culling are never culled
+        memset(render_list.Begin() + size, 0, sizeof(RenderListEntry) * entries);
         return (render_list.Begin() + size);
     }
 
-    // Submit a range of entries (pointers must be from a range allocated by RenderListAlloc, and not between two alloc calls).
-    void RenderListSubmit(HRenderContext render_context, RenderListEntry *begin, RenderListEntry *end)
+    static void RenderListSubmitRange(HRenderContext render_context, RenderListEntry *begin, RenderListEntry *end, bool sorted)
     {
         if (end == begin) {
             return;
@@ -235,23 +240,248 @@ namespace dmRender
         for (RenderListEntry* i=begin;i!=end;i++)
             *insert++ = i - base;
 
+        RenderListSegment segment;
+        segment.m_Start = render_context->m_RenderListSortIndices.Size();
+        segment.m_Count = end - begin;
+        segment.m_Sorted = sorted ? 1 : 0;
+        if (render_context->m_RenderListSegments.Full())
+        {
+            render_context->m_RenderListSegments.OffsetCapacity(16);
+        }
+        render_context->m_RenderListSegments.Push(segment);
+
         render_context->m_RenderListSortIndices.SetSize(render_context->m_RenderListSortIndices.Size() + (end - begin));
 
         // invalidate the ranges if this is a call to the debug rendering (happening in the middle of the frame)
         render_context->m_RenderListRanges.SetSize(0);
     }
 
-    struct RenderListSorter
+    // Submit a range of entries (pointers must be from a range allocated by RenderListAlloc, and not between two alloc calls).
+    void RenderListSubmit(HRenderContext render_context, RenderListEntry *begin, RenderListEntry *end)
+    {
+        RenderListSubmitRange(render_context, begin, end, false);
+    }
+
+    static void RenderListPushBounds(HRenderContext render_context, RenderListEntry* entry, const RenderListBounds& bounds)
+    {
+        dmArray<RenderListBounds>& render_list_bounds = render_context->m_RenderListBounds;
+        if (render_list_bounds.Full())
+        {
+            render_list_bounds.OffsetCapacity(dmMath::Max<uint32_t>(256, render_list_bounds.Capacity()));
+        }
+        entry->m_Cull = 1;
+        entry->m_BoundsIndex = render_list_bounds.Size();
+        render_list_bounds.Push(bounds);
+    }
+
+    // The bounds are kept out of line, since most entries aren't culled
+    void RenderListSetBounds(HRenderContext render_context, RenderListEntry* entry, const Vector3& half_extents)
+    {
+        RenderListBounds bounds;
+        bounds.m_HalfExtents[0] = half_extents.getX();
+        bounds.m_HalfExtents[1] = half_extents.getY();
+        bounds.m_HalfExtents[2] = half_extents.getZ();
+        RenderListPushBounds(render_context, entry, bounds);
+    }
+
+    struct PersistentRenderListSorter
     {
         bool operator()(uint32_t a, uint32_t b) const
         {
-            const RenderListSortValue& u = values[a];
-            const RenderListSortValue& v = values[b];
-            return u.m_SortKey < v.m_SortKey;
+            return m_Entries[a].m_TagListKey < m_Entries[b].m_TagListKey;
         }
-        RenderListSortValue* values;
+        const RenderListEntry* m_Entries;
     };
 
+    HPersistentRenderList NewPersistentRenderList(uint32_t capacity)
+    {
+        PersistentRenderList* list = new PersistentRenderList;
+        capacity = dmMath::Max<uint32_t>(capacity, 16);
+        list->m_Entries.SetCapacity(capacity);
+        list->m_Entries.SetSize(capacity);
+        list->m_Flags.SetCapacity(capacity);
+        list->m_Flags.SetSize(capacity);
+        memset(list->m_Flags.Begin(), 0, capacity);
+        list->m_Handles.SetCapacity(capacity);
+        list->m_NumRemoved = 0;
+        return list;
+    }
+
+    void DeletePersistentRenderList(HPersistentRenderList list)
+    {
+        delete list;
+    }
+
+    HPersistentRenderListEntry PersistentRenderListAdd(HPersistentRenderList list, const RenderListEntry& entry)
+    {
+        if (list->m_Handles.Remaining() == 0)
+        {
+            const uint32_t old_capacity = list->m_Handles.Capacity();
+            const uint32_t capacity = old_capacity * 2;
+            list->m_Entries.SetCapacity(capacity);
+            list->m_Entries.SetSize(capacity);
+            list->m_Flags.SetCapacity(capacity);
+            list->m_Flags.SetSize(capacity);
+            memset(list->m_Flags.Begin() + old_capacity, 0, capacity - old_capacity);
+            if (!list->m_Bounds.Empty())
+            {
+                list->m_Bounds.SetCapacity(capacity);
+                list->m_Bounds.SetSize(capacity);
+            }
+            list->m_Handles.SetCapacity(capacity);
+        }
+
+        uint32_t handle = list->m_Handles.Pop();
+        list->m_Entries[handle] = entry;
+        list->m_Entries[handle].m_Cull = 0; // Until PersistentRenderListSetBounds is called
+        // The handle may still be in the sorted order if it was removed and reused before the next submit,
+        // but since it's dirty it will be removed from there when the order is updated
+        list->m_Flags[handle] = PERSISTENT_ENTRY_FLAG_ALLOCATED;
+        PersistentRenderListSetDirty(list, handle);
+        return handle;
+    }
+
+    void PersistentRenderListRemove(HPersistentRenderList list, HPersistentRenderListEntry handle)
+    {
+        assert(list->m_Flags[handle] & PERSISTENT_ENTRY_FLAG_ALLOCATED);
+        list->m_Flags[handle] &= ~(PERSISTENT_ENTRY_FLAG_ALLOCATED | PERSISTENT_ENTRY_FLAG_DIRTY);
+        list->m_Handles.Push(handle);
+        list->m_NumRemoved++;
+    }
+
+    void PersistentRenderListUpdate(HPersistentRenderList list, HPersistentRenderListEntry handle, const RenderListEntry& entry)
+    {
+        assert(list->m_Flags[handle] & PERSISTENT_ENTRY_FLAG_ALLOCATED);
+        // The bounds are kept, until they're set again
+        const uint32_t cull = list->m_Entries[handle].m_Cull;
+        list->m_Entries[handle] = entry;
+        list->m_Entries[handle].m_Cull = cull;
+        PersistentRenderListSetDirty(list, handle);
+    }
+
+    RenderListEntry* PersistentRenderListGet(HPersistentRenderList list, HPersistentRenderListEntry handle)
+    {
+        assert(list->m_Flags[handle] & PERSISTENT_ENTRY_FLAG_ALLOCATED);
+        return &list->m_Entries[handle];
+    }
+
+    void PersistentRenderListSetDirty(HPersistentRenderList list, HPersistentRenderListEntry handle)
+    {
+        uint8_t& flags = list->m_Flags[handle];
+        assert(flags & PERSISTENT_ENTRY_FLAG_ALLOCATED);
+        if (flags & PERSISTENT_ENTRY_FLAG_DIRTY)
+            return;
+        flags |= PERSISTENT_ENTRY_FLAG_DIRTY;
+        if (list->m_Dirty.Full())
+        {
+            list->m_Dirty.OffsetCapacity(dmMath::Max<uint32_t>(64, list->m_Dirty.Capacity()));
+        }
+        list->m_Dirty.Push(handle);
+    }
+
+    void PersistentRenderListSetBounds(HPersistentRenderList list, HPersistentRenderListEntry handle, const Vector3& half_extents)
+    {
+        assert(list->m_Flags[handle] & PERSISTENT_ENTRY_FLAG_ALLOCATED);
+        if (list->m_Bounds.Empty())
+        {
+            const uint32_t capacity = list->m_Entries.Size();
+            list->m_Bounds.SetCapacity(capacity);
+            list->m_Bounds.SetSize(capacity);
+        }
+        RenderListBounds& bounds = list->m_Bounds[handle];
+        bounds.m_HalfExtents[0] = half_extents.getX();
+        bounds.m_HalfExtents[1] = half_extents.getY();
+        bounds.m_HalfExtents[2] = half_extents.getZ();
+        // The bounds aren't part of the sort order, so the entry isn't marked dirty
+        list->m_Entries[handle].m_Cull = 1;
+    }
+
+    uint32_t PersistentRenderListSize(HPersistentRenderList list)
+    {
+        return list->m_Handles.Size();
+    }
+
+    // Removes the freed and dirty handles from the sorted order, and merges the (sorted) dirty handles back in
+    static void UpdatePersistentRenderListOrder(HPersistentRenderList list)
+    {
+        if (list->m_Dirty.Empty() && list->m_NumRemoved == 0)
+            return;
+
+        DM_PROFILE(Render, "UpdatePersistentRenderListOrder");
+
+        uint8_t* flags = list->m_Flags.Begin();
+
+        // Keep the handles that are still clean (and allocated)
+        uint32_t* order = list->m_Order.Begin();
+        uint32_t num_clean = 0;
+        for (uint32_t i = 0; i < list->m_Order.Size(); ++i)
+        {
+            uint32_t handle = order[i];
+            uint8_t f = flags[handle];
+            if ((f & PERSISTENT_ENTRY_FLAG_ALLOCATED) && !(f & PERSISTENT_ENTRY_FLAG_DIRTY))
+            {
+                order[num_clean++] = handle;
+            }
+        }
+        list->m_Order.SetSize(num_clean);
+
+        // Dirty handles may have been removed after they were marked
+        uint32_t* dirty = list->m_Dirty.Begin();
+        uint32_t num_dirty = 0;
+        for (uint32_t i = 0; i < list->m_Dirty.Size(); ++i)
+        {
+            uint32_t handle = dirty[i];
+            if (flags[handle] & PERSISTENT_ENTRY_FLAG_DIRTY)
+            {
+                flags[handle] = PERSISTENT_ENTRY_FLAG_ALLOCATED;
+                dirty[num_dirty++] = handle;
+            }
+        }
+
+        PersistentRenderListSorter sort;
+        sort.m_Entries = list->m_Entries.Begin();
+        std::stable_sort(dirty, dirty + num_dirty, sort);
+
+        const uint32_t size = num_clean + num_dirty;
+        if (list->m_Scratch.Capacity() < size)
+        {
+            list->m_Scratch.SetCapacity(list->m_Handles.Capacity());
+        }
+        list->m_Scratch.SetSize(size);
+        std::merge(order, order + num_clean, dirty, dirty + num_dirty, list->m_Scratch.Begin(), sort);
+        list->m_Order.Swap(list->m_Scratch);
+
+        list->m_Dirty.SetSize(0);
+        list->m_NumRemoved = 0;
+    }
+
+    void PersistentRenderListSubmit(HRenderContext render_context, HPersistentRenderList list, HRenderListDispatch dispatch)
+    {
+        DM_PROFILE(Render, "PersistentRenderListSubmit");
+
+        UpdatePersistentRenderListOrder(list);
+
+        const uint32_t count = list->m_Order.Size();
+        if (count == 0)
+            return;
+
+        RenderListEntry* render_list = RenderListAlloc(render_context, count);
+        const RenderListEntry* entries = list->m_Entries.Begin();
+        const uint32_t* order = list->m_Order.Begin();
+        const RenderListBounds* bounds = list->m_Bounds.Begin();
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            uint32_t handle = order[i];
+            render_list[i] = entries[handle];
+            render_list[i].m_Dispatch = dispatch;
+            if (render_list[i].m_Cull)
+            {
+                RenderListPushBounds(render_context, &render_list[i], bounds[handle]);
+            }
+        }
+        RenderListSubmitRange(render_context, render_list, render_list + count, true);
+    }
+
     void RenderListEnd(HRenderContext render_context)
     {
         // Unflushed leftovers are assumed to be the debug rendering
@@ -308,6 +538,7 @@ namespace dmRender
     {
         context->m_RenderObjects.SetSize(0);
         ClearDebugRenderObjects(context);
+        StateCacheResetStats(context);
 
         // Should probably be moved and/or refactored, see case 2261
         // (Cannot reset the text buffer until all render objects are dispatched)
@@ -357,7 +588,6 @@ namespace dmRender
 
     void ApplyRenderObjectConstants(HRenderContext render_context, HMaterial material, const RenderObject* ro)
     {
-        dmGraphics::HContext graphics_context = dmRender::GetGraphicsContext(render_context);
         if(!material)
         {
             for (uint32_t i = 0; i < RenderObject::MAX_CONSTANT_COUNT; ++i)
@@ -365,7 +595,7 @@ namespace dmRender
                 const Constant* c = &ro->m_Constants[i];
                 if (c->m_Location != -1)
                 {
-                    dmGraphics::SetConstantV4(graphics_context, &c->m_Value, c->m_Location);
+                    StateCacheSetConstantV4(render_context, &c->m_Value, c->m_Location);
                 }
             }
             return;
@@ -378,7 +608,7 @@ namespace dmRender
                 int32_t* location = material->m_NameHashToLocation.Get(ro->m_Constants[i].m_NameHash);
                 if (location)
                 {
-                    dmGraphics::SetConstantV4(graphics_context, &c->m_Value, *location);
+                    StateCacheSetConstantV4(render_context, &c->m_Value, *location);
                 }
             }
         }
@@ -398,6 +628,40 @@ namespace dmRender
         return false;
     }
 
+    // Marks an entry as culled in the sort values. Not a valid z value, since the float part is a NaN
+    static const uint64_t CULLED_SORT_KEY = 0xFFFFFFFFFFFFFFFFULL;
+
+    // The planes of the view frustum, pointing inwards (Gribb & Hartmann)
+    static void GetFrustumPlanes(const Matrix4& view_proj, Vector4 planes[6])
+    {
+        const Matrix4 m = transpose(view_proj);
+        const Vector4 r0 = m.getCol0();
+        const Vector4 r1 = m.getCol1();
+        const Vector4 r2 = m.getCol2();
+        const Vector4 r3 = m.getCol3();
+        planes[0] = r3 + r0;
+        planes[1] = r3 - r0;
+        planes[2] = r3 + r1;
+        planes[3] = r3 - r1;
+        planes[4] = r3 + r2;
+        planes[5] = r3 - r2;
+    }
+
+    static inline bool IsOutsideFrustum(const Vector4 planes[6], const Point3& c, const RenderListBounds& bounds)
+    {
+        const float* e = bounds.m_HalfExtents;
+        for (uint32_t i = 0; i < 6; ++i)
+        {
+            const Vector4& p = planes[i];
+            // Distance from the center, plus the extent of the box along the plane normal
+            float d = p.getX() * c.getX() + p.getY() * c.getY() + p.getZ() * c.getZ() + p.getW();
+            float r = fabsf(p.getX()) * e[0] + fabsf(p.getY()) * e[1] + fabsf(p.getZ()) * e[2];
+            if (d + r < 0.0f)
+                return true;
+        }
+        return false;
+    }
+
     // Compute new sort values for everything that matches tag_mask
     static void MakeSortBuffer(HRenderContext context, uint32_t tag_count, dmhash_t* tags)
     {
@@ -412,9 +676,13 @@ namespace dmRender
 
         RenderListSortValue* sort_values = context->m_RenderListSortValues.Begin();
         RenderListEntry* entries = context->m_RenderList.Begin();
+        const RenderListBounds* bounds = context->m_RenderListBounds.Begin();
 
         const Matrix4& transform = context->m_ViewProj;
 
+        Vector4 frustum_planes[6];
+        GetFrustumPlanes(transform, frustum_planes);
+
         float minZW = FLT_MAX;
         float maxZW = -FLT_MAX;
 
@@ -442,6 +710,12 @@ namespace dmRender
                 if (entry->m_MajorOrder != RENDER_ORDER_WORLD)
                     continue; // Could perhaps break here, if we also sorted on the major order (cost more when I tested it /MAWE)
 
+                if (entry->m_Cull && IsOutsideFrustum(frustum_planes, entry->m_WorldPosition, bounds[entry->m_BoundsIndex]))
+                {
+                    sort_values[idx].m_SortKey = CULLED_SORT_KEY;
+                    continue;
+                }
+
                 const Vector4 res = transform * entry->m_WorldPosition;
                 const float zw = res.getZ() / res.getW();
                 sort_values[idx].m_ZW = zw;
@@ -466,6 +740,9 @@ namespace dmRender
                 uint32_t idx = context->m_RenderListSortIndices[i];
                 RenderListEntry* entry = &entries[idx];
 
+                if (entry->m_Cull && entry->m_MajorOrder == RENDER_ORDER_WORLD && sort_values[idx].m_SortKey == CULLED_SORT_KEY)
+                    continue;
+
                 sort_values[idx].m_MajorOrder = entry->m_MajorOrder;
                 if (entry->m_MajorOrder == RENDER_ORDER_WORLD)
                 {
@@ -520,6 +797,123 @@ namespace dmRender
         FindRenderListRanges(first, high - first, size - (high - rangefirst), entries, comp, ctx, callback);
     }
 
+    // LSD radix sort, 8 bits per pass.
+    // Passes where all keys share the same digit are skipped, which is common for
+    // the dispatch, major and minor order bits.
+    void RadixSortRenderList(uint32_t* indices, uint32_t count, const RenderListSortValue* values, uint64_t* keys, uint64_t* keys_tmp, uint32_t* indices_tmp)
+    {
+        const uint32_t num_passes = sizeof(uint64_t);
+        const uint32_t num_buckets = 256;
+
+        if (count < 2)
+            return;
+
+        uint32_t histograms[num_passes][num_buckets];
+        memset(histograms, 0, sizeof(histograms));
+
+        // Gather the keys into a linear array, and count all digits in one go
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            uint64_t key = values[indices[i]].m_SortKey;
+            keys[i] = key;
+            for (uint32_t pass = 0; pass < num_passes; ++pass)
+            {
+                histograms[pass][(key >> (pass * 8)) & 0xff]++;
+            }
+        }
+
+        uint64_t* src_keys = keys;
+        uint32_t* src_indices = indices;
+        uint64_t* dst_keys = keys_tmp;
+        uint32_t* dst_indices = indices_tmp;
+
+        for (uint32_t pass = 0; pass < num_passes; ++pass)
+        {
+            const uint32_t shift = pass * 8;
+            uint32_t* histogram = histograms[pass];
+
+            if (histogram[(src_keys[0] >> shift) & 0xff] == count)
+                continue;
+
+            uint32_t offset = 0;
+            for (uint32_t i = 0; i < num_buckets; ++i)
+            {
+                uint32_t c = histogram[i];
+                histogram[i] = offset;
+                offset += c;
+            }
+
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                uint64_t key = src_keys[i];
+                uint32_t dst = histogram[(key >> shift) & 0xff]++;
+                dst_keys[dst] = key;
+                dst_indices[dst] = src_indices[i];
+            }
+
+            uint64_t* tmp_keys = src_keys;
+            src_keys = dst_keys;
+            dst_keys = tmp_keys;
+            uint32_t* tmp_indices = src_indices;
+            src_indices = dst_indices;
+            dst_indices = tmp_indices;
+        }
+
+        if (src_indices != indices)
+        {
+            memcpy(indices, src_indices, count * sizeof(uint32_t));
+        }
+    }
+
+    void SortRenderListSegments(uint32_t* indices, RenderListSegment* segments, uint32_t num_segments, RenderListEntry* entries)
+    {
+        RenderListEntrySorter sort;
+        sort.m_Base = entries;
+
+        bool any_sorted = false;
+        for (uint32_t i = 0; i < num_segments; ++i)
+            any_sorted |= segments[i].m_Sorted != 0;
+
+        if (!any_sorted)
+        {
+            if (num_segments > 0)
+            {
+                const RenderListSegment& last = segments[num_segments - 1];
+                std::stable_sort(indices, indices + last.m_Start + last.m_Count, sort);
+            }
+            return;
+        }
+
+        for (uint32_t i = 0; i < num_segments; ++i)
+        {
+            RenderListSegment& segment = segments[i];
+            if (!segment.m_Sorted)
+            {
+                std::stable_sort(indices + segment.m_Start, indices + segment.m_Start + segment.m_Count, sort);
+                segment.m_Sorted = 1;
+            }
+        }
+
+        // Merge adjacent segments pairwise, which keeps the submit order for equal keys
+        while (num_segments > 1)
+        {
+            uint32_t num_merged = 0;
+            for (uint32_t i = 0; i < num_segments; i += 2)
+            {
+                RenderListSegment segment = segments[i];
+                if (i + 1 < num_segments)
+                {
+                    const RenderListSegment& next = segments[i + 1];
+                    uint32_t* first = indices + segment.m_Start;
+                    std::inplace_merge(first, first + segment.m_Count, first + segment.m_Count + next.m_Count, sort);
+                    segment.m_Count += next.m_Count;
+                }
+                segments[num_merged++] = segment;
+            }
+            num_segments = num_merged;
+        }
+    }
+
     static void SortRenderList(HRenderContext context)
     {
         DM_PROFILE(Render, "SortRenderList");
@@ -528,10 +922,16 @@ namespace dmRender
             return;
 
         // First sort on the tag masks
+        SortRenderListSegments(context->m_RenderListSortIndices.Begin(), context->m_RenderListSegments.Begin(), context->m_RenderListSegments.Size(), context->m_RenderList.Begin());
+
+        // Everything is now one sorted segment, in case more entries are submitted this frame (e.g. debug rendering)
         {
-            RenderListEntrySorter sort;
-            sort.m_Base = context->m_RenderList.Begin();
-            std::stable_sort(context->m_RenderListSortIndices.Begin(), context->m_RenderListSortIndices.End(), sort);
+            RenderListSegment segment;
+            segment.m_Start = 0;
+            segment.m_Count = context->m_RenderListSortIndices.Size();
+            segment.m_Sorted = 1;
+            context->m_RenderListSegments.SetSize(1);
+            context->m_RenderListSegments[0] = segment;
         }
         // Now find the ranges of tag masks
         {
@@ -564,9 +964,16 @@ namespace dmRender
 
         {
             DM_PROFILE(Render, "DrawRenderList_SORT");
-            RenderListSorter sort;
-            sort.values = context->m_RenderListSortValues.Begin();
-            std::stable_sort(context->m_RenderListSortBuffer.Begin(), context->m_RenderListSortBuffer.End(), sort);
+            const uint32_t sort_count = context->m_RenderListSortBuffer.Size();
+            if (context->m_RenderListSortKeys.Capacity() < sort_count)
+            {
+                const uint32_t capacity = context->m_RenderListSortBuffer.Capacity();
+                context->m_RenderListSortKeys.SetCapacity(capacity);
+                context->m_RenderListSortKeysTmp.SetCapacity(capacity);
+                context->m_RenderListSortBufferTmp.SetCapacity(capacity);
+            }
+            RadixSortRenderList(context->m_RenderListSortBuffer.Begin(), sort_count, context->m_RenderListSortValues.Begin(),
+                                context->m_RenderListSortKeys.Begin(), context->m_RenderListSortKeysTmp.Begin(), context->m_RenderListSortBufferTmp.Begin());
         }
 
         // Construct render objects
@@ -641,11 +1048,14 @@ namespace dmRender
 
         dmGraphics::HContext context = dmRender::GetGraphicsContext(render_context);
 
+        // Consecutive render objects often share most of their state
+        StateCacheBegin(render_context);
+
         HMaterial material = render_context->m_Material;
         HMaterial context_material = render_context->m_Material;
         if(context_material)
         {
-            dmGraphics::EnableProgram(context, GetMaterialProgram(context_material));
+            StateCacheEnableProgram(render_context, GetMaterialProgram(context_material));
         }
 
         for (uint32_t i = 0; i < render_context->m_RenderObjects.Size(); ++i)
@@ -668,7 +1078,7 @@ namespace dmRender
                 if(material != ro->m_Material)
                 {
                     material = ro->m_Material;
-                    dmGraphics::EnableProgram(context, GetMaterialProgram(material));
+                    StateCacheEnableProgram(render_context, GetMaterialProgram(material));
                 }
             }
 
@@ -679,45 +1089,43 @@ namespace dmRender
                 ApplyNamedConstantBuffer(render_context, material, constant_buffer);
 
             if (ro->m_SetBlendFactors)
-                dmGraphics::SetBlendFunc(context, ro->m_SourceBlendFactor, ro->m_DestinationBlendFactor);
+                StateCacheSetBlendFunc(render_context, ro->m_SourceBlendFactor, ro->m_DestinationBlendFactor);
 
-            if (ro->m_SetStencilTest)
+            if (ro->m_SetStencilTest && StateCacheSetStencilTest(render_context, ro->m_StencilTestParams))
                 ApplyStencilTest(render_context, ro);
 
             if (ro->m_SetFaceWinding)
-                dmGraphics::SetFaceWinding(context, ro->m_FaceWinding);
+                StateCacheSetFaceWinding(render_context, ro->m_FaceWinding);
 
+            // Textures (and the vertex declaration) stay bound until they're replaced, or until StateCacheEnd()
             for (uint32_t i = 0; i < RenderObject::MAX_TEXTURE_COUNT; ++i)
             {
                 dmGraphics::HTexture texture = ro->m_Textures[i];
                 if (render_context->m_Textures[i])
                     texture = render_context->m_Textures[i];
-                if (texture)
+                if (StateCacheEnableTexture(render_context, i, texture, material))
                 {
-                    dmGraphics::EnableTexture(context, i, texture);
                     ApplyMaterialSampler(render_context, material, i, texture);
                 }
-
             }
 
-            dmGraphics::EnableVertexDeclaration(context, ro->m_VertexDeclaration, ro->m_VertexBuffer, GetMaterialProgram(material));
+            StateCacheEnableVertexDeclaration(render_context, ro->m_VertexDeclaration, ro->m_VertexBuffer, GetMaterialProgram(material));
 
-            if (ro->m_IndexBuffer)
+            if (ro->m_InstanceCount > 0)
+            {
+                // The per instance streams are not cached, since they're rarely shared between render objects
+                assert(ro->m_IndexBuffer);
+                dmGraphics::EnableVertexDeclaration(context, ro->m_InstanceVertexDeclaration, ro->m_InstanceVertexBuffer, GetMaterialProgram(material));
+                dmGraphics::DrawElementsInstanced(context, ro->m_PrimitiveType, ro->m_VertexStart, ro->m_VertexCount, ro->m_IndexType, ro->m_IndexBuffer, ro->m_InstanceCount);
+                dmGraphics::DisableVertexDeclaration(context, ro->m_InstanceVertexDeclaration);
+            }
+            else if (ro->m_IndexBuffer)
                 dmGraphics::DrawElements(context, ro->m_PrimitiveType, ro->m_VertexStart, ro->m_VertexCount, ro->m_IndexType, ro->m_IndexBuffer);
             else
                 dmGraphics::Draw(context, ro->m_PrimitiveType, ro->m_VertexStart, ro->m_VertexCount);
-
-            dmGraphics::DisableVertexDeclaration(context, ro->m_VertexDeclaration);
-
-            for (uint32_t i = 0; i < RenderObject::MAX_TEXTURE_COUNT; ++i)
-            {
-                dmGraphics::HTexture texture = ro->m_Textures[i];
-                if (render_context->m_Textures[i])
-                    texture = render_context->m_Textures[i];
-                if (texture)
-                    dmGraphics::DisableTexture(context, i, texture);
-            }
         }
+
+        StateCacheEnd(render_context);
         return RESULT_OK;
     }
 
@@ -849,11 +1257,11 @@ namespace dmRender
 
     struct ApplyContext
     {
-        dmGraphics::HContext m_GraphicsContext;
+        HRenderContext       m_RenderContext;
         HMaterial            m_Material;
-        ApplyContext(dmGraphics::HContext graphics_context, HMaterial material)
+        ApplyContext(HRenderContext render_context, HMaterial material)
         {
-            m_GraphicsContext = graphics_context;
+            m_RenderContext = render_context;
             m_Material = material;
         }
     };
@@ -863,15 +1271,14 @@ namespace dmRender
         int32_t* location = context->m_Material->m_NameHashToLocation.Get(*name_hash);
         if (location)
         {
-            dmGraphics::SetConstantV4(context->m_GraphicsContext, value, *location);
+            StateCacheSetConstantV4(context->m_RenderContext, value, *location);
         }
     }
 
     void ApplyNamedConstantBuffer(dmRender::HRenderContext render_context, HMaterial material, HNamedConstantBuffer buffer)
     {
         dmHashTable64<Vectormath::Aos::Vector4>& constants = buffer->m_Constants;
-        dmGraphics::HContext graphics_context = dmRender::GetGraphicsContext(render_context);
-        ApplyContext context(graphics_context, material);
+        ApplyContext context(render_context, material);
         constants.Iterate(ApplyConstant, &context);
     }
 
@@ -38,6 +38,8 @@ namespace dmRender
     typedef struct RenderScript*            HRenderScript;
     typedef struct RenderScriptInstance*    HRenderScriptInstance;
     typedef struct Predicate*               HPredicate;
+    typedef struct PersistentRenderList*    HPersistentRenderList;
+    typedef uint32_t                        HPersistentRenderListEntry;
 
     /**
      * Display profiles handle
@@ -102,6 +104,8 @@ namespace dmRender
 
     static const HRenderType INVALID_RENDER_TYPE_HANDLE = ~0ULL;
 
+    static const HPersistentRenderListEntry INVALID_PERSISTENT_RENDER_LIST_ENTRY = 0xffffffff;
+
     HRenderContext NewRenderContext(dmGraphics::HContext graphics_context, const RenderContextParams& params);
     Result DeleteRenderContext(HRenderContext render_context, dmScript::HContext script_context);
 
@@ -110,6 +114,28 @@ namespace dmRender
     void RenderListBegin(HRenderContext render_context);
     void RenderListEnd(HRenderContext render_context);
 
+    /**
+     * Persistent render lists are an opt-in alternative to RenderListAlloc/RenderListSubmit,
+     * for component worlds where most entries are unchanged between frames.
+     * The entries are retained (with stable handles) and kept sorted on their material tag list key.
+     * Only entries that are added or marked dirty since the last submit are re-sorted, and then
+     * merged into the previous order.
+     */
+    HPersistentRenderList       NewPersistentRenderList(uint32_t capacity);
+    void                        DeletePersistentRenderList(HPersistentRenderList list);
+    HPersistentRenderListEntry  PersistentRenderListAdd(HPersistentRenderList list, const RenderListEntry& entry);
+    void                        PersistentRenderListRemove(HPersistentRenderList list, HPersistentRenderListEntry handle);
+    // Overwrites the entry, and marks it dirty
+    void                        PersistentRenderListUpdate(HPersistentRenderList list, HPersistentRenderListEntry handle, const RenderListEntry& entry);
+    // Returns the entry. If any of the sort related fields are changed, the entry must be marked dirty
+    RenderListEntry*            PersistentRenderListGet(HPersistentRenderList list, HPersistentRenderListEntry handle);
+    void                        PersistentRenderListSetDirty(HPersistentRenderList list, HPersistentRenderListEntry handle);
+    // Sets the bounding box of the entry, and enables culling for it (see RenderListSetBounds)
+    void                        PersistentRenderListSetBounds(HPersistentRenderList list, HPersistentRenderListEntry handle, const Vector3& half_extents);
+    uint32_t                    PersistentRenderListSize(HPersistentRenderList list);
+    // Adds all entries to the current render frame, using the given dispatch
+    void                        PersistentRenderListSubmit(HRenderContext render_context, HPersistentRenderList list, HRenderListDispatch dispatch);
+
     void SetSystemFontMap(HRenderContext render_context, HFontMap font_map);
 
     dmGraphics::HContext GetGraphicsContext(HRenderContext render_context);
@@ -18,6 +18,7 @@
 #include <dlib/array.h>
 #include <dlib/message.h>
 #include <dlib/hashtable.h>
+#include <dlib/index_pool.h>
 
 #include "render.h"
 
@@ -202,12 +203,89 @@ namespace dmRender
         uint32_t m_Skip:1;      // During the current draw call
     };
 
+    // A range of submitted entries in RenderContext::m_RenderListSortIndices
+    struct RenderListSegment
+    {
+        uint32_t m_Start;
+        uint32_t m_Count:31;
+        uint32_t m_Sorted:1;    // If the range is already sorted on tag list key
+    };
+
+    // The bounding box of a cullable render list entry (see RenderListSetBounds)
+    struct RenderListBounds
+    {
+        float m_HalfExtents[3];
+    };
+
+    enum PersistentRenderListEntryFlag
+    {
+        PERSISTENT_ENTRY_FLAG_ALLOCATED = 1,
+        PERSISTENT_ENTRY_FLAG_DIRTY     = 2,
+    };
+
+    struct PersistentRenderList
+    {
+        dmArray<RenderListEntry>    m_Entries;      // Indexed by handle
+        dmArray<uint8_t>            m_Flags;        // Indexed by handle (PersistentRenderListEntryFlag)
+        dmArray<RenderListBounds>   m_Bounds;       // Indexed by handle, only allocated once an entry has bounds
+        dmIndexPool32               m_Handles;
+        dmArray<uint32_t>           m_Order;        // Handles sorted on tag list key
+        dmArray<uint32_t>           m_Dirty;        // Handles added or changed since the last submit
+        dmArray<uint32_t>           m_Scratch;
+        uint32_t                    m_NumRemoved;   // Removed since the last submit
+    };
+
     struct MaterialTagList
     {
         uint32_t m_Count;
         dmhash_t m_Tags[MAX_MATERIAL_TAG_COUNT];
     };
 
+    // Number of redundant graphics calls skipped by the state cache
+    struct StateCacheStats
+    {
+        uint32_t m_Programs;
+        uint32_t m_Textures;
+        uint32_t m_VertexDeclarations;
+        uint32_t m_Constants;
+        uint32_t m_BlendFuncs;
+        uint32_t m_StencilTests;
+        uint32_t m_FaceWindings;
+    };
+
+    static const uint32_t MAX_STATE_CACHE_CONSTANT_COUNT = 32;
+
+    struct StateCacheConstant
+    {
+        Vector4 m_Values[4];
+        int32_t m_Location;
+        uint32_t m_Count;       // Number of Vector4 (1 or 4)
+    };
+
+    // Tracks the graphics state set by Draw(), in order to skip redundant calls to dmGraphics.
+    // Anything may change the state between two Draw() calls, so it's only active during one.
+    struct StateCache
+    {
+        StateCacheConstant              m_Constants[MAX_STATE_CACHE_CONSTANT_COUNT];
+        dmGraphics::HTexture            m_Textures[RenderObject::MAX_TEXTURE_COUNT];
+        HMaterial                       m_TextureMaterials[RenderObject::MAX_TEXTURE_COUNT]; // The material used for the sampler setup
+        StencilTestParams               m_StencilTestParams;
+        dmGraphics::HProgram            m_Program;
+        dmGraphics::HVertexDeclaration  m_VertexDeclaration;
+        dmGraphics::HVertexBuffer       m_VertexBuffer;
+        dmGraphics::HProgram            m_VertexDeclarationProgram;
+        dmGraphics::BlendFactor         m_SourceBlendFactor;
+        dmGraphics::BlendFactor         m_DestinationBlendFactor;
+        dmGraphics::FaceWinding         m_FaceWinding;
+        StateCacheStats                 m_Stats;            // Reset once per frame, in ClearRenderObjects()
+        uint32_t                        m_ConstantCount;
+        uint32_t                        m_Active : 1;
+        uint32_t                        m_ProgramSet : 1;
+        uint32_t                        m_BlendFuncSet : 1;
+        uint32_t                        m_StencilTestSet : 1;
+        uint32_t                        m_FaceWindingSet : 1;
+    };
+
     struct RenderContext
     {
         dmGraphics::HTexture        m_Textures[RenderObject::MAX_TEXTURE_COUNT];
@@ -216,6 +294,7 @@ namespace dmRender
         dmScript::HContext          m_ScriptContext;
         RenderScriptContext         m_RenderScriptContext;
         dmArray<RenderObject*>      m_RenderObjects;
+        StateCache                  m_StateCache;
         dmScript::ScriptWorld*      m_ScriptWorld;
 
         dmArray<RenderListEntry>    m_RenderList;
@@ -223,7 +302,12 @@ namespace dmRender
         dmArray<RenderListSortValue>m_RenderListSortValues;
         dmArray<uint32_t>           m_RenderListSortBuffer;
         dmArray<uint32_t>           m_RenderListSortIndices;
+        dmArray<uint64_t>           m_RenderListSortKeys;       // Scratch buffers for the radix sort, reused between frames
+        dmArray<uint64_t>           m_RenderListSortKeysTmp;
+        dmArray<uint32_t>           m_RenderListSortBufferTmp;
         dmArray<RenderListRange>    m_RenderListRanges;         // Maps tagmask to a range in the (sorted) render list
+        dmArray<RenderListSegment>  m_RenderListSegments;       // The submitted ranges of m_RenderListSortIndices
+        dmArray<RenderListBounds>   m_RenderListBounds;         // Indexed by RenderListEntry::m_BoundsIndex
 
         dmHashTable32<MaterialTagList>  m_MaterialTagLists;
 
@@ -253,6 +337,22 @@ namespace dmRender
 
     void ApplyRenderObjectConstants(HRenderContext render_context, HMaterial material, const struct RenderObject* ro);
 
+    // State cache. Outside of StateCacheBegin/StateCacheEnd, all calls are passed on to dmGraphics.
+    void StateCacheBegin(HRenderContext render_context);
+    // Unbinds the textures and vertex declaration that are still bound
+    void StateCacheEnd(HRenderContext render_context);
+    void StateCacheResetStats(HRenderContext render_context);
+    void StateCacheEnableProgram(HRenderContext render_context, dmGraphics::HProgram program);
+    void StateCacheSetConstantV4(HRenderContext render_context, const Vector4* data, int32_t location);
+    void StateCacheSetConstantM4(HRenderContext render_context, const Vector4* data, int32_t location);
+    void StateCacheSetBlendFunc(HRenderContext render_context, dmGraphics::BlendFactor source_factor, dmGraphics::BlendFactor destination_factor);
+    void StateCacheSetFaceWinding(HRenderContext render_context, dmGraphics::FaceWinding face_winding);
+    // Returns true if the stencil test state needs to be applied
+    bool StateCacheSetStencilTest(HRenderContext render_context, const StencilTestParams& params);
+    // Returns true if the texture was bound, and the material sampler needs to be applied. A null texture unbinds the unit.
+    bool StateCacheEnableTexture(HRenderContext render_context, uint32_t unit, dmGraphics::HTexture texture, HMaterial material);
+    void StateCacheEnableVertexDeclaration(HRenderContext render_context, dmGraphics::HVertexDeclaration vertex_declaration, dmGraphics::HVertexBuffer vertex_buffer, dmGraphics::HProgram program);
+
     // Return true if the predicate tags all exist in the material tag list
     bool                            MatchMaterialTags(uint32_t material_tag_count, const dmhash_t* material_tags, uint32_t tag_count, const dmhash_t* tags);
     // Returns a hashkey that the material can use to get the list
@@ -281,12 +381,19 @@ namespace dmRender
         }
     };
 
+    // Sorts the indices on tag list key. Presorted segments are merged rather than sorted.
+    void SortRenderListSegments(uint32_t* indices, RenderListSegment* segments, uint32_t num_segments, RenderListEntry* entries);
+
     typedef void (*RangeCallback)(void* ctx, uint32_t val, size_t start, size_t count);
 
     // Invokes the callback for each range. Two ranges are not guaranteed to preceed/succeed one another.
     void FindRenderListRanges(uint32_t* first, size_t offset, size_t size, RenderListEntry* entries, FindRangeComparator& comp, void* ctx, RangeCallback callback );
 
     bool FindTagListRange(RenderListRange* ranges, uint32_t num_ranges, uint32_t tag_list_key, RenderListRange& range);
+
+    // Stable sort of the indices, on the 64 bit sort key of each value (values[indices[i]].m_SortKey)
+    // The scratch buffers must each hold at least 'count' elements
+    void RadixSortRenderList(uint32_t* indices, uint32_t count, const RenderListSortValue* values, uint64_t* keys, uint64_t* keys_tmp, uint32_t* indices_tmp);
 }
 
 #endif
@@ -0,0 +1,259 @@
+// Copyright 2020 The Defold Foundation
+// Licensed under the Defold License version 1.0 (the "License"); you may not use
+// this file except in compliance with the License.
+//
+// You may obtain a copy of the License, together with FAQs at
+// https://www.defold.com/license
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include <string.h>
+
+#include <dlib/profile.h>
+
+#include "render_private.h"
+
+namespace dmRender
+{
+    using namespace Vectormath::Aos;
+
+    void StateCacheBegin(HRenderContext render_context)
+    {
+        StateCache& cache = render_context->m_StateCache;
+        for (uint32_t i = 0; i < RenderObject::MAX_TEXTURE_COUNT; ++i)
+        {
+            cache.m_Textures[i] = 0;
+            cache.m_TextureMaterials[i] = 0;
+        }
+        cache.m_Program = 0;
+        cache.m_VertexDeclaration = 0;
+        cache.m_VertexBuffer = 0;
+        cache.m_VertexDeclarationProgram = 0;
+        cache.m_ConstantCount = 0;
+        cache.m_ProgramSet = 0;
+        cache.m_BlendFuncSet = 0;
+        cache.m_StencilTestSet = 0;
+        cache.m_FaceWindingSet = 0;
+        cache.m_Active = 1;
+    }
+
+    void StateCacheEnd(HRenderContext render_context)
+    {
+        StateCache& cache = render_context->m_StateCache;
+        dmGraphics::HContext graphics_context = render_context->m_GraphicsContext;
+
+        if (cache.m_VertexDeclaration)
+        {
+            dmGraphics::DisableVertexDeclaration(graphics_context, cache.m_VertexDeclaration);
+            cache.m_VertexDeclaration = 0;
+        }
+
+        for (uint32_t i = 0; i < RenderObject::MAX_TEXTURE_COUNT; ++i)
+        {
+            if (cache.m_Textures[i])
+            {
+                dmGraphics::DisableTexture(graphics_context, i, cache.m_Textures[i]);
+                cache.m_Textures[i] = 0;
+            }
+        }
+
+        cache.m_Active = 0;
+    }
+
+    void StateCacheResetStats(HRenderContext render_context)
+    {
+        StateCacheStats& stats = render_context->m_StateCache.m_Stats;
+        DM_COUNTER("RenderStateSkipped", stats.m_Programs + stats.m_Textures + stats.m_VertexDeclarations + stats.m_Constants +
+                                         stats.m_BlendFuncs + stats.m_StencilTests + stats.m_FaceWindings);
+        memset(&stats, 0, sizeof(stats));
+    }
+
+    void StateCacheEnableProgram(HRenderContext render_context, dmGraphics::HProgram program)
+    {
+        StateCache& cache = render_context->m_StateCache;
+        if (cache.m_Active)
+        {
+            if (cache.m_ProgramSet && cache.m_Program == program)
+            {
+                cache.m_Stats.m_Programs++;
+                return;
+            }
+            // The constant values are stored per program
+            cache.m_ConstantCount = 0;
+            cache.m_Program = program;
+            cache.m_ProgramSet = 1;
+        }
+        dmGraphics::EnableProgram(render_context->m_GraphicsContext, program);
+    }
+
+    // Returns true if the value is already set
+    static bool CacheConstant(StateCache& cache, const Vector4* data, int32_t location, uint32_t count)
+    {
+        const uint32_t size = sizeof(Vector4) * count;
+        for (uint32_t i = 0; i < cache.m_ConstantCount; ++i)
+        {
+            StateCacheConstant& c = cache.m_Constants[i];
+            if (c.m_Location == location)
+            {
+                if (c.m_Count == count && memcmp(c.m_Values, data, size) == 0)
+                    return true;
+                c.m_Count = count;
+                memcpy(c.m_Values, data, size);
+                return false;
+            }
+        }
+
+        // If the cache is full, the value is just passed on
+        if (cache.m_ConstantCount < MAX_STATE_CACHE_CONSTANT_COUNT)
+        {
+            StateCacheConstant& c = cache.m_Constants[cache.m_ConstantCount++];
+            c.m_Location = location;
+            c.m_Count = count;
+            memcpy(c.m_Values, data, size);
+        }
+        return false;
+    }
+
+    void StateCacheSetConstantV4(HRenderContext render_context, const Vector4* data, int32_t location)
+    {
+        StateCache& cache = render_context->m_StateCache;
+        if (cache.m_Active && CacheConstant(cache, data, location, 1))
+        {
+            cache.m_Stats.m_Constants++;
+            return;
+        }
+        dmGraphics::SetConstantV4(render_context->m_GraphicsContext, data, location);
+    }
+
+    void StateCacheSetConstantM4(HRenderContext render_context, const Vector4* data, int32_t location)
+    {
+        StateCache& cache = render_context->m_StateCache;
+        if (cache.m_Active && CacheConstant(cache, data, location, 4))
+        {
+            cache.m_Stats.m_Constants++;
+            return;
+        }
+        dmGraphics::SetConstantM4(render_context->m_GraphicsContext, data, location);
+    }
+
+    void StateCacheSetBlendFunc(HRenderContext render_context, dmGraphics::BlendFactor source_factor, dmGraphics::BlendFactor destination_factor)
+    {
+        StateCache& cache = render_context->m_StateCache;
+        if (cache.m_Active)
+        {
+            if (cache.m_BlendFuncSet && cache.m_SourceBlendFactor == source_factor && cache.m_DestinationBlendFactor == destination_factor)
+            {
+                cache.m_Stats.m_BlendFuncs++;
+                return;
+            }
+            cache.m_SourceBlendFactor = source_factor;
+            cache.m_DestinationBlendFactor = destination_factor;
+            cache.m_BlendFuncSet = 1;
+        }
+        dmGraphics::SetBlendFunc(render_context->m_GraphicsContext, source_factor, destination_factor);
+    }
+
+    void StateCacheSetFaceWinding(HRenderContext render_context, dmGraphics::FaceWinding face_winding)
+    {
+        StateCache& cache = render_context->m_StateCache;
+        if (cache.m_Active)
+        {
+            if (cache.m_FaceWindingSet && cache.m_FaceWinding == face_winding)
+            {
+                cache.m_Stats.m_FaceWindings++;
+                return;
+            }
+            cache.m_FaceWinding = face_winding;
+            cache.m_FaceWindingSet = 1;
+        }
+        dmGraphics::SetFaceWinding(render_context->m_GraphicsContext, face_winding);
+    }
+
+    static bool StencilTestParamsEqual(const StencilTestParams& a, const StencilTestParams& b)
+    {
+        return a.m_Front.m_Func == b.m_Front.m_Func &&
+               a.m_Front.m_OpSFail == b.m_Front.m_OpSFail &&
+               a.m_Front.m_OpDPFail == b.m_Front.m_OpDPFail &&
+               a.m_Front.m_OpDPPass == b.m_Front.m_OpDPPass &&
+               a.m_Back.m_Func == b.m_Back.m_Func &&
+               a.m_Back.m_OpSFail == b.m_Back.m_OpSFail &&
+               a.m_Back.m_OpDPFail == b.m_Back.m_OpDPFail &&
+               a.m_Back.m_OpDPPass == b.m_Back.m_OpDPPass &&
+               a.m_Ref == b.m_Ref &&
+               a.m_RefMask == b.m_RefMask &&
+               a.m_BufferMask == b.m_BufferMask &&
+               a.m_ColorBufferMask == b.m_ColorBufferMask &&
+               a.m_SeparateFaceStates == b.m_SeparateFaceStates;
+    }
+
+    bool StateCacheSetStencilTest(HRenderContext render_context, const StencilTestParams& params)
+    {
+        StateCache& cache = render_context->m_StateCache;
+        if (!cache.m_Active)
+            return true;
+
+        // Clearing the stencil buffer is an action, not a state
+        if (!params.m_ClearBuffer && cache.m_StencilTestSet && StencilTestParamsEqual(cache.m_StencilTestParams, params))
+        {
+            cache.m_Stats.m_StencilTests++;
+            return false;
+        }
+        cache.m_StencilTestParams = params;
+        cache.m_StencilTestSet = 1;
+        return true;
+    }
+
+    bool StateCacheEnableTexture(HRenderContext render_context, uint32_t unit, dmGraphics::HTexture texture, HMaterial material)
+    {
+        StateCache& cache = render_context->m_StateCache;
+        dmGraphics::HContext graphics_context = render_context->m_GraphicsContext;
+        if (!cache.m_Active)
+        {
+            if (texture)
+                dmGraphics::EnableTexture(graphics_context, unit, texture);
+            return texture != 0;
+        }
+
+        // The sampler setup depends on the material, and is applied to the active texture unit
+        if (cache.m_Textures[unit] == texture && (!texture || cache.m_TextureMaterials[unit] == material))
+        {
+            if (texture)
+                cache.m_Stats.m_Textures++;
+            return false;
+        }
+
+        if (cache.m_Textures[unit])
+            dmGraphics::DisableTexture(graphics_context, unit, cache.m_Textures[unit]);
+        if (texture)
+            dmGraphics::EnableTexture(graphics_context, unit, texture);
+
+        cache.m_Textures[unit] = texture;
+        cache.m_TextureMaterials[unit] = material;
+        return texture != 0;
+    }
+
+    void StateCacheEnableVertexDeclaration(HRenderContext render_context, dmGraphics::HVertexDeclaration vertex_declaration, dmGraphics::HVertexBuffer vertex_buffer, dmGraphics::HProgram program)
+    {
+        StateCache& cache = render_context->m_StateCache;
+        dmGraphics::HContext graphics_context = render_context->m_GraphicsContext;
+        if (cache.m_Active)
+        {
+            if (cache.m_VertexDeclaration == vertex_declaration && cache.m_VertexBuffer == vertex_buffer && cache.m_VertexDeclarationProgram == program)
+            {
+                cache.m_Stats.m_VertexDeclarations++;
+                return;
+            }
+            // The previous declaration may have enabled more streams
+            if (cache.m_VertexDeclaration)
+                dmGraphics::DisableVertexDeclaration(graphics_context, cache.m_VertexDeclaration);
+
+            cache.m_VertexDeclaration = vertex_declaration;
+            cache.m_VertexBuffer = vertex_buffer;
+            cache.m_VertexDeclarationProgram = program;
+        }
+        dmGraphics::EnableVertexDeclaration(graphics_context, vertex_declaration, vertex_buffer, program);
+    }
+}
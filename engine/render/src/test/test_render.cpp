@@ -15,6 +15,7 @@
 #include <jc_test/jc_test.h>
 #include <dmsdk/vectormath/cpp/vectormath_aos.h>
 
+#include <dlib/dstrings.h>
 #include <dlib/hash.h>
 #include <dlib/math.h>
 
@@ -438,6 +439,71 @@ TEST_F(dmRenderTest, TestRenderListOrder)
     ASSERT_EQ(ctx.m_Z, orders[2]);
 }
 
+static void TestRenderListCullingDispatch(dmRender::RenderListDispatchParams const & params)
+{
+    uint64_t* visible = (uint64_t*) params.m_UserData;
+    if (params.m_Operation == dmRender::RENDER_LIST_OPERATION_BATCH)
+    {
+        for (uint32_t* i = params.m_Begin; i != params.m_End; ++i)
+        {
+            *visible |= params.m_Buf[*i].m_UserData;
+        }
+    }
+}
+
+TEST_F(dmRenderTest, TestRenderListCulling)
+{
+    Vectormath::Aos::Matrix4 view = Vectormath::Aos::Matrix4::identity();
+    Vectormath::Aos::Matrix4 proj = Vectormath::Aos::Matrix4::orthographic(0.0f, WIDTH, 0.0f, HEIGHT, 0.1f, 1.0f);
+    dmRender::SetViewMatrix(m_Context, view);
+    dmRender::SetProjectionMatrix(m_Context, proj);
+
+    uint64_t visible = 0;
+    dmRender::RenderListBegin(m_Context);
+    uint8_t dispatch = dmRender::RenderListMakeDispatch(m_Context, TestRenderListCullingDispatch, &visible);
+
+    struct Bounds { float x, y, z, ex, ey; bool cull; };
+    const Bounds bounds[] = {
+        { WIDTH * 0.5f, HEIGHT * 0.5f, -0.5f, 10.0f, 10.0f, true },    // inside
+        { -20.0f, HEIGHT * 0.5f, -0.5f, 10.0f, 10.0f, true },          // left of the view
+        { -5.0f, HEIGHT * 0.5f, -0.5f, 10.0f, 10.0f, true },           // overlapping the left edge
+        { WIDTH * 0.5f, HEIGHT + 20.0f, -0.5f, 10.0f, 10.0f, true },   // above the view
+        { WIDTH * 0.5f, HEIGHT * 0.5f, -5.0f, 10.0f, 10.0f, true },    // beyond the far plane
+        { -20.0f, HEIGHT * 0.5f, -0.5f, 10.0f, 10.0f, false },         // outside, but not culled
+    };
+    const uint32_t n = DM_ARRAY_SIZE(bounds);
+
+    dmRender::RenderListEntry* out = dmRender::RenderListAlloc(m_Context, n);
+    for (uint32_t i = 0; i < n; ++i)
+    {
+        dmRender::RenderListEntry& entry = out[i];
+        ASSERT_EQ(0u, entry.m_Cull);
+        entry.m_WorldPosition = Point3(bounds[i].x, bounds[i].y, bounds[i].z);
+        entry.m_MajorOrder = dmRender::RENDER_ORDER_WORLD;
+        entry.m_Dispatch = dispatch;
+        entry.m_UserData = 1 << i;
+        if (bounds[i].cull)
+        {
+            dmRender::RenderListSetBounds(m_Context, &entry, Vector3(bounds[i].ex, bounds[i].ey, 0.0f));
+        }
+    }
+    // Only the cullable entries store bounds
+    ASSERT_EQ(n - 1, m_Context->m_RenderListBounds.Size());
+    dmRender::RenderListSubmit(m_Context, out, out + n);
+    dmRender::RenderListEnd(m_Context);
+    dmRender::DrawRenderList(m_Context, 0, 0);
+
+    ASSERT_EQ((1 << 0) | (1 << 2) | (1 << 5), visible);
+
+    // The same list drawn with a camera moved to the left
+    visible = 0;
+    view = Vectormath::Aos::Matrix4::translation(Vectormath::Aos::Vector3(WIDTH * 0.5f + 30.0f, 0.0f, 0.0f));
+    dmRender::SetViewMatrix(m_Context, view);
+    dmRender::DrawRenderList(m_Context, 0, 0);
+
+    ASSERT_EQ((1 << 1) | (1 << 2) | (1 << 5), visible);
+}
+
 TEST_F(dmRenderTest, TestRenderListDebug)
 {
     // Test submitting debug drawing when there is no other drawing going on
@@ -640,6 +706,62 @@ TEST_F(dmRenderTest, GetTextMetricsMeasureTrailingSpace)
     ASSERT_GT(metricsSingleLineSpace.m_Width, 0);
 }
 
+TEST_F(dmRenderTest, TextLayoutCache)
+{
+    const int charwidth = 2;
+
+    uint32_t resource_size = dmRender::GetFontMapResourceSize(m_SystemFontMap);
+
+    dmRender::TextMetrics first;
+    dmRender::GetTextMetrics(m_SystemFontMap, "Hello World Bonanza", 8*charwidth, true, 1.0f, 0.0f, &first);
+
+    // Lay out more texts than the cache holds, so the first one gets replaced
+    dmRender::TextMetrics metrics;
+    char text[32];
+    for (uint32_t i = 0; i < 1000; ++i)
+    {
+        dmSnPrintf(text, sizeof(text), "Text %u", i);
+        dmRender::GetTextMetrics(m_SystemFontMap, text, 0, false, 1.0f, 0.0f, &metrics);
+        ASSERT_EQ(charwidth*strlen(text), metrics.m_Width);
+
+        // Same text with other parameters
+        dmRender::GetTextMetrics(m_SystemFontMap, text, 0, true, 1.0f, 0.0f, &metrics);
+        ASSERT_EQ(charwidth*4, metrics.m_Width);
+    }
+
+    dmRender::GetTextMetrics(m_SystemFontMap, "Hello World Bonanza", 8*charwidth, true, 1.0f, 0.0f, &metrics);
+    ASSERT_EQ(first.m_Width, metrics.m_Width);
+    ASSERT_EQ(first.m_Height, metrics.m_Height);
+
+    // The memory of the laid out texts is part of the font map
+    ASSERT_LT(resource_size, dmRender::GetFontMapResourceSize(m_SystemFontMap));
+
+    // Changing the glyphs invalidates the cached layouts
+    dmRender::FontMapParams font_map_params;
+    font_map_params.m_CacheWidth = 128;
+    font_map_params.m_CacheHeight = 128;
+    font_map_params.m_CacheCellWidth = 8;
+    font_map_params.m_CacheCellHeight = 8;
+    font_map_params.m_MaxAscent = 2;
+    font_map_params.m_MaxDescent = 1;
+    font_map_params.m_Glyphs.SetCapacity(128);
+    font_map_params.m_Glyphs.SetSize(128);
+    memset((void*)&font_map_params.m_Glyphs[0], 0, sizeof(dmRender::Glyph)*128);
+    for (uint32_t i = 0; i < 128; ++i)
+    {
+        font_map_params.m_Glyphs[i].m_Character = i;
+        font_map_params.m_Glyphs[i].m_Width = 2;
+        font_map_params.m_Glyphs[i].m_LeftBearing = 1;
+        font_map_params.m_Glyphs[i].m_Advance = 3;
+        font_map_params.m_Glyphs[i].m_Ascent = 2;
+        font_map_params.m_Glyphs[i].m_Descent = 1;
+    }
+    dmRender::SetFontMap(m_SystemFontMap, font_map_params);
+
+    dmRender::GetTextMetrics(m_SystemFontMap, "Hello World", 0, false, 1.0f, 0.0f, &metrics);
+    ASSERT_EQ(3*11, metrics.m_Width);
+}
+
 TEST_F(dmRenderTest, TextAlignment)
 {
     dmRender::TextMetrics metrics;
@@ -781,6 +903,318 @@ TEST_F(dmRenderTest, FindRanges)
     ASSERT_EQ(6, range.m_Count);
 }
 
+TEST_F(dmRenderTest, StateCache)
+{
+    dmGraphics::ShaderDesc::Shader vp_shader;
+    memset(&vp_shader, 0, sizeof(vp_shader));
+    vp_shader.m_Source.m_Data = (uint8_t*)"uniform vec4 offset;\nuniform vec4 tint;\n";
+    vp_shader.m_Source.m_Count = strlen((const char*)vp_shader.m_Source.m_Data);
+    dmGraphics::ShaderDesc::Shader fp_shader;
+    memset(&fp_shader, 0, sizeof(fp_shader));
+    fp_shader.m_Source.m_Data = (uint8_t*)"foo";
+    fp_shader.m_Source.m_Count = 3;
+    dmGraphics::HVertexProgram vp = dmGraphics::NewVertexProgram(m_GraphicsContext, &vp_shader);
+    dmGraphics::HFragmentProgram fp = dmGraphics::NewFragmentProgram(m_GraphicsContext, &fp_shader);
+    dmRender::HMaterial material = dmRender::NewMaterial(m_Context, vp, fp);
+
+    dmGraphics::VertexElement ve[] = { {"position", 0, 3, dmGraphics::TYPE_FLOAT, false} };
+    dmGraphics::HVertexDeclaration vertex_declaration = dmGraphics::NewVertexDeclaration(m_GraphicsContext, ve, DM_ARRAY_SIZE(ve));
+    float vertices[3 * 3 * 4];
+    memset(vertices, 0, sizeof(vertices));
+    dmGraphics::HVertexBuffer vertex_buffer = dmGraphics::NewVertexBuffer(m_GraphicsContext, sizeof(vertices), vertices, dmGraphics::BUFFER_USAGE_STATIC_DRAW);
+
+    dmGraphics::TextureCreationParams creation_params;
+    creation_params.m_Width = 1;
+    creation_params.m_Height = 1;
+    creation_params.m_OriginalWidth = 1;
+    creation_params.m_OriginalHeight = 1;
+    uint8_t pixel[4] = {0};
+    dmGraphics::TextureParams texture_params;
+    texture_params.m_DataSize = sizeof(pixel);
+    texture_params.m_Data = pixel;
+    texture_params.m_Width = 1;
+    texture_params.m_Height = 1;
+    texture_params.m_Format = dmGraphics::TEXTURE_FORMAT_RGBA;
+    dmGraphics::HTexture textures[2];
+    for (uint32_t i = 0; i < DM_ARRAY_SIZE(textures); ++i)
+    {
+        textures[i] = dmGraphics::NewTexture(m_GraphicsContext, creation_params);
+        dmGraphics::SetTexture(textures[i], texture_params);
+    }
+
+    // Three objects sharing all state, then one with a different texture and tint
+    const uint32_t count = 4;
+    dmRender::RenderObject ros[count];
+    m_Context->m_RenderObjects.SetCapacity(count);
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        dmRender::RenderObject& ro = ros[i];
+        ro.m_Material = material;
+        ro.m_VertexDeclaration = vertex_declaration;
+        ro.m_VertexBuffer = vertex_buffer;
+        ro.m_PrimitiveType = dmGraphics::PRIMITIVE_TRIANGLES;
+        ro.m_VertexStart = i * 3;
+        ro.m_VertexCount = 3;
+        ro.m_Textures[0] = textures[i / 3];
+        ro.m_SetBlendFactors = 1;
+        ro.m_SourceBlendFactor = dmGraphics::BLEND_FACTOR_ONE;
+        ro.m_DestinationBlendFactor = dmGraphics::BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+        dmRender::EnableRenderObjectConstant(&ro, dmHashString64("tint"), Vector4((float)(i / 3), 0.0f, 0.0f, 1.0f));
+        ASSERT_EQ(dmRender::RESULT_OK, dmRender::AddToRender(m_Context, &ro));
+    }
+
+    dmRender::StateCacheResetStats(m_Context);
+    dmRender::Draw(m_Context, 0, 0);
+
+    const dmRender::StateCacheStats& stats = m_Context->m_StateCache.m_Stats;
+    ASSERT_EQ(2u, stats.m_Textures);
+    ASSERT_EQ(3u, stats.m_VertexDeclarations);
+    ASSERT_EQ(3u, stats.m_BlendFuncs);
+    // Only "offset" is unchanged, since both the material and the render objects set "tint"
+    ASSERT_EQ(3u, stats.m_Constants);
+    ASSERT_EQ(0u, stats.m_StencilTests);
+
+    // Everything is unbound after the draw
+    ASSERT_EQ(0u, m_Context->m_StateCache.m_Active);
+    ASSERT_EQ((dmGraphics::HTexture)0, m_Context->m_StateCache.m_Textures[0]);
+
+    dmRender::ClearRenderObjects(m_Context);
+    ASSERT_EQ(0u, m_Context->m_StateCache.m_Stats.m_Textures);
+
+    for (uint32_t i = 0; i < DM_ARRAY_SIZE(textures); ++i)
+    {
+        dmGraphics::DeleteTexture(textures[i]);
+    }
+    dmGraphics::DeleteVertexBuffer(vertex_buffer);
+    dmGraphics::DeleteVertexDeclaration(vertex_declaration);
+    dmRender::DeleteMaterial(m_Context, material);
+    dmGraphics::DeleteVertexProgram(vp);
+    dmGraphics::DeleteFragmentProgram(fp);
+}
+
+TEST(dmRenderSort, SortSegments)
+{
+    const uint32_t count = 64;
+    dmRender::RenderListEntry entries[count];
+    uint32_t indices[count];
+    uint32_t expected[count];
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        entries[i].m_TagListKey = rand() % 5;
+        indices[i] = i;
+        expected[i] = i;
+    }
+
+    dmRender::RenderListEntrySorter sort;
+    sort.m_Base = entries;
+    std::stable_sort(expected, expected + count, sort);
+
+    dmRender::RenderListSegment segments[4];
+    segments[0].m_Start = 0;  segments[0].m_Count = 10; segments[0].m_Sorted = 0;
+    segments[1].m_Start = 10; segments[1].m_Count = 30; segments[1].m_Sorted = 1;
+    segments[2].m_Start = 40; segments[2].m_Count = 4;  segments[2].m_Sorted = 0;
+    segments[3].m_Start = 44; segments[3].m_Count = 20; segments[3].m_Sorted = 1;
+    std::stable_sort(indices + 10, indices + 40, sort);
+    std::stable_sort(indices + 44, indices + 64, sort);
+
+    dmRender::SortRenderListSegments(indices, segments, DM_ARRAY_SIZE(segments), entries);
+
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        ASSERT_EQ(expected[i], indices[i]);
+    }
+}
+
+struct TestPersistentDispatchCtx
+{
+    uint32_t m_EntriesRendered;
+};
+
+static void TestPersistentDispatch(dmRender::RenderListDispatchParams const & params)
+{
+    TestPersistentDispatchCtx* ctx = (TestPersistentDispatchCtx*) params.m_UserData;
+    if (params.m_Operation == dmRender::RENDER_LIST_OPERATION_BATCH)
+    {
+        ctx->m_EntriesRendered += params.m_End - params.m_Begin;
+    }
+}
+
+static void CheckRenderListTagOrder(dmRender::HRenderContext context, uint32_t expected_count)
+{
+    ASSERT_EQ(expected_count, context->m_RenderList.Size());
+    for (uint32_t i = 1; i < context->m_RenderList.Size(); ++i)
+    {
+        ASSERT_LE(context->m_RenderList[i-1].m_TagListKey, context->m_RenderList[i].m_TagListKey);
+    }
+}
+
+TEST_F(dmRenderTest, PersistentRenderList)
+{
+    TestPersistentDispatchCtx ctx;
+    memset(&ctx, 0x00, sizeof(TestPersistentDispatchCtx));
+
+    dmRender::HPersistentRenderList list = dmRender::NewPersistentRenderList(4);
+
+    const uint32_t n = 40; // Larger than the initial capacity
+    dmRender::HPersistentRenderListEntry handles[n];
+    for (uint32_t i = 0; i < n; ++i)
+    {
+        dmRender::RenderListEntry entry;
+        memset(&entry, 0, sizeof(entry));
+        entry.m_WorldPosition = Point3(0, 0, i);
+        entry.m_MajorOrder = dmRender::RENDER_ORDER_WORLD;
+        entry.m_TagListKey = (n - i) % 7;
+        entry.m_BatchKey = i & 3;
+        handles[i] = dmRender::PersistentRenderListAdd(list, entry);
+    }
+    ASSERT_EQ(n, dmRender::PersistentRenderListSize(list));
+
+    dmRender::RenderListBegin(m_Context);
+    dmRender::HRenderListDispatch dispatch = dmRender::RenderListMakeDispatch(m_Context, TestPersistentDispatch, &ctx);
+    dmRender::PersistentRenderListSubmit(m_Context, list, dispatch);
+    CheckRenderListTagOrder(m_Context, n);
+    dmRender::RenderListEnd(m_Context);
+    dmRender::DrawRenderList(m_Context, 0, 0);
+    ASSERT_EQ(n, ctx.m_EntriesRendered);
+
+    // Change some entries, and remove others
+    dmRender::PersistentRenderListRemove(list, handles[3]);
+    dmRender::PersistentRenderListRemove(list, handles[17]);
+    dmRender::PersistentRenderListGet(list, handles[5])->m_TagListKey = 100;
+    dmRender::PersistentRenderListSetDirty(list, handles[5]);
+    dmRender::RenderListEntry entry = *dmRender::PersistentRenderListGet(list, handles[6]);
+    entry.m_TagListKey = 0;
+    dmRender::PersistentRenderListUpdate(list, handles[6], entry);
+    ASSERT_EQ(n - 2, dmRender::PersistentRenderListSize(list));
+
+    // Reusing a removed handle before the next submit
+    handles[3] = dmRender::PersistentRenderListAdd(list, entry);
+    ASSERT_EQ(n - 1, dmRender::PersistentRenderListSize(list));
+
+    ctx.m_EntriesRendered = 0;
+    dmRender::RenderListBegin(m_Context);
+    dispatch = dmRender::RenderListMakeDispatch(m_Context, TestPersistentDispatch, &ctx);
+    dmRender::PersistentRenderListSubmit(m_Context, list, dispatch);
+    CheckRenderListTagOrder(m_Context, n - 1);
+    ASSERT_EQ(100u, m_Context->m_RenderList.Back().m_TagListKey);
+    dmRender::RenderListEnd(m_Context);
+    dmRender::DrawRenderList(m_Context, 0, 0);
+    ASSERT_EQ(n - 1, ctx.m_EntriesRendered);
+
+    dmRender::DeletePersistentRenderList(list);
+}
+
+TEST_F(dmRenderTest, PersistentRenderListCulling)
+{
+    Vectormath::Aos::Matrix4 view = Vectormath::Aos::Matrix4::identity();
+    Vectormath::Aos::Matrix4 proj = Vectormath::Aos::Matrix4::orthographic(0.0f, WIDTH, 0.0f, HEIGHT, 0.1f, 1.0f);
+    dmRender::SetViewMatrix(m_Context, view);
+    dmRender::SetProjectionMatrix(m_Context, proj);
+
+    dmRender::HPersistentRenderList list = dmRender::NewPersistentRenderList(4);
+
+    const uint32_t n = 20; // Larger than the initial capacity
+    dmRender::HPersistentRenderListEntry handles[n];
+    for (uint32_t i = 0; i < n; ++i)
+    {
+        dmRender::RenderListEntry entry;
+        memset(&entry, 0, sizeof(entry));
+        // Every other entry is left of the view
+        entry.m_WorldPosition = Point3((i & 1) ? -20.0f : WIDTH * 0.5f, HEIGHT * 0.5f, -0.5f);
+        entry.m_MajorOrder = dmRender::RENDER_ORDER_WORLD;
+        entry.m_UserData = 1 << i;
+        handles[i] = dmRender::PersistentRenderListAdd(list, entry);
+        // The first ones get their bounds before the list grows
+        if (i < 8)
+        {
+            dmRender::PersistentRenderListSetBounds(list, handles[i], Vector3(10.0f, 10.0f, 0.0f));
+        }
+    }
+
+    // Updating an entry keeps its bounds
+    dmRender::RenderListEntry entry = *dmRender::PersistentRenderListGet(list, handles[1]);
+    entry.m_BatchKey = 1;
+    dmRender::PersistentRenderListUpdate(list, handles[1], entry);
+
+    uint64_t visible = 0;
+    dmRender::RenderListBegin(m_Context);
+    dmRender::HRenderListDispatch dispatch = dmRender::RenderListMakeDispatch(m_Context, TestRenderListCullingDispatch, &visible);
+    dmRender::PersistentRenderListSubmit(m_Context, list, dispatch);
+    ASSERT_EQ(8u, m_Context->m_RenderListBounds.Size());
+    dmRender::RenderListEnd(m_Context);
+    dmRender::DrawRenderList(m_Context, 0, 0);
+
+    uint64_t expected = 0;
+    for (uint32_t i = 0; i < n; ++i)
+    {
+        if (i >= 8 || !(i & 1))
+            expected |= 1 << i;
+    }
+    ASSERT_EQ(expected, visible);
+
+    dmRender::DeletePersistentRenderList(list);
+}
+
+struct RenderListSortValueSorter
+{
+    bool operator()(uint32_t a, uint32_t b) const
+    {
+        return m_Values[a].m_SortKey < m_Values[b].m_SortKey;
+    }
+    dmRender::RenderListSortValue* m_Values;
+};
+
+static void FillSortValues(dmRender::RenderListSortValue* values, uint32_t* indices, uint32_t count)
+{
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        dmRender::RenderListSortValue& v = values[i];
+        v.m_SortKey = 0;
+        v.m_MajorOrder = dmRender::RENDER_ORDER_WORLD;
+        v.m_MinorOrder = rand() % 2;
+        v.m_Order = rand() & 0xffffff;
+        v.m_Dispatch = rand() % 4;
+        v.m_BatchKey = rand() % 16; // Lots of duplicate keys, to test the stability
+        indices[i] = i;
+    }
+}
+
+TEST(dmRenderSort, RadixSort)
+{
+    const uint32_t count = 4096;
+    dmRender::RenderListSortValue* values = new dmRender::RenderListSortValue[count];
+    uint32_t* indices = new uint32_t[count];
+    uint32_t* expected = new uint32_t[count];
+    uint32_t* indices_tmp = new uint32_t[count];
+    uint64_t* keys = new uint64_t[count];
+    uint64_t* keys_tmp = new uint64_t[count];
+
+    FillSortValues(values, indices, count);
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        values[i].m_Order = rand() % 32;
+        expected[i] = i;
+    }
+
+    RenderListSortValueSorter sort;
+    sort.m_Values = values;
+    std::stable_sort(expected, expected + count, sort);
+
+    dmRender::RadixSortRenderList(indices, count, values, keys, keys_tmp, indices_tmp);
+
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        ASSERT_EQ(expected[i], indices[i]);
+    }
+
+    delete[] keys_tmp;
+    delete[] keys;
+    delete[] indices_tmp;
+    delete[] expected;
+    delete[] indices;
+    delete[] values;
+}
+
 int main(int argc, char **argv)
 {
     jc_test_init(&argc, argv);
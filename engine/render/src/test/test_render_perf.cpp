@@ -0,0 +1,98 @@
+// Copyright 2020 The Defold Foundation
+// Licensed under the Defold License version 1.0 (the "License"); you may not use
+// this file except in compliance with the License.
+//
+// You may obtain a copy of the License, together with FAQs at
+// https://www.defold.com/license
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#define JC_TEST_IMPLEMENTATION
+#include <jc_test/jc_test.h>
+
+#include <dlib/array.h>
+#include <dlib/time.h>
+
+#include <algorithm> // std::stable_sort
+
+#include "render/render.h"
+#include "render/render_private.h"
+
+struct RenderListSortValueSorter
+{
+    bool operator()(uint32_t a, uint32_t b) const
+    {
+        return m_Values[a].m_SortKey < m_Values[b].m_SortKey;
+    }
+    dmRender::RenderListSortValue* m_Values;
+};
+
+static void FillSortValues(dmRender::RenderListSortValue* values, uint32_t* indices, uint32_t count)
+{
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        dmRender::RenderListSortValue& v = values[i];
+        v.m_SortKey = 0;
+        v.m_MajorOrder = dmRender::RENDER_ORDER_WORLD;
+        v.m_MinorOrder = rand() % 2;
+        v.m_Order = rand() & 0xffffff;
+        v.m_Dispatch = rand() % 4;
+        v.m_BatchKey = rand() % 16;
+        indices[i] = i;
+    }
+}
+
+TEST(dmRenderSort, Bench)
+{
+    const uint32_t counts[] = {1000, 10000, 100000};
+    const uint32_t iter_count = 10;
+
+    for (uint32_t c = 0; c < DM_ARRAY_SIZE(counts); ++c)
+    {
+        const uint32_t count = counts[c];
+        dmRender::RenderListSortValue* values = new dmRender::RenderListSortValue[count];
+        uint32_t* indices = new uint32_t[count];
+        uint32_t* indices_tmp = new uint32_t[count];
+        uint64_t* keys = new uint64_t[count];
+        uint64_t* keys_tmp = new uint64_t[count];
+
+        RenderListSortValueSorter sort;
+        sort.m_Values = values;
+
+        uint64_t time_stable_sort = 0;
+        uint64_t time_radix_sort = 0;
+        for (uint32_t iter = 0; iter < iter_count; ++iter)
+        {
+            FillSortValues(values, indices, count);
+            uint64_t start = dmTime::GetTime();
+            std::stable_sort(indices, indices + count, sort);
+            time_stable_sort += dmTime::GetTime() - start;
+
+            FillSortValues(values, indices, count);
+            start = dmTime::GetTime();
+            dmRender::RadixSortRenderList(indices, count, values, keys, keys_tmp, indices_tmp);
+            time_radix_sort += dmTime::GetTime() - start;
+        }
+
+        printf("Sort %6u entries: std::stable_sort %.3f ms, radix sort %.3f ms\n", count,
+                time_stable_sort / (1000.0f * iter_count), time_radix_sort / (1000.0f * iter_count));
+
+        delete[] keys_tmp;
+        delete[] keys;
+        delete[] indices_tmp;
+        delete[] indices;
+        delete[] values;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    jc_test_init(&argc, argv);
+    return jc_test_run_all();
+}
@@ -35,6 +35,10 @@ namespace dmLoadQueue
         dmResource::FResourcePreload m_Function;
         dmResource::PreloadHintInfo m_HintInfo;
         void* m_Context;
+        // Set if the resource may be created by the queue, i.e. the type has a thread safe create function.
+        // It is only created if the preload function didn't hint any other resources.
+        dmResource::SResourceType* m_CreateType;
+        dmhash_t m_CanonicalPathHash;
     };
 
     struct LoadResult
@@ -42,6 +46,9 @@ namespace dmLoadQueue
         dmResource::Result m_LoadResult;
         dmResource::Result m_PreloadResult;
         void* m_PreloadData;
+        // RESULT_PENDING unless the resource was created by the queue
+        dmResource::Result m_CreateResult;
+        dmResource::SResourceDescriptor m_Resource;
     };
 
     HQueue CreateQueue(dmResource::HFactory factory);
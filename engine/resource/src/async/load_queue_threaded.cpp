@@ -10,6 +10,8 @@
 // CONDITIONS OF ANY KIND, either express or implied. See the License for the
 // specific language governing permissions and limitations under the License.
 
+#include <string.h>
+
 #include "resource.h"
 #include "resource_private.h"
 #include "load_queue.h"
@@ -17,14 +19,18 @@
 #include <dlib/dstrings.h>
 #include <dlib/log.h>
 #include <dlib/array.h>
+#include <dlib/math.h>
 #include <dlib/thread.h>
 #include <dlib/mutex.h>
 #include <dlib/time.h>
 #include <dlib/condition_variable.h>
+#include <dlib/profile.h>
 
 namespace dmLoadQueue
 {
-    // Implementation of dmLoadQueue with a thread that loads items in the order they are supplied,
+    // Implementation of dmLoadQueue with a pool of threads that load items in the order they are supplied.
+    // Several items can be loading at once, but an item is not handed out by EndLoad until all items
+    // supplied before it have been loaded, so the results are always picked up in the same order.
 
     // Default to small buffers since a lot of what is loaded are just small objects anyway.
     // That way we can have more in flight, but throttle when max pending data grows too large anyway
@@ -35,6 +41,10 @@ namespace dmLoadQueue
     const uint64_t MAX_PENDING_DATA = 4 * 1024 * 1024;
     const uint32_t QUEUE_SLOTS      = 16;
 
+    // Leave some slots for loaded requests waiting to be picked up
+    const uint32_t MAX_THREADS      = QUEUE_SLOTS / 2;
+    const uint32_t MAX_THREAD_NAME  = 16;
+
     struct Request
     {
         const char* m_Name;
@@ -42,6 +52,10 @@ namespace dmLoadQueue
         dmResource::LoadBufferType m_Buffer;
         PreloadInfo m_PreloadInfo;
         LoadResult m_Result;
+        // Position in the queue
+        uint32_t m_Index;
+        // Set when the loading thread is done with the request
+        bool m_Done;
     };
 
     struct Queue
@@ -49,20 +63,23 @@ namespace dmLoadQueue
         dmResource::HFactory m_Factory;
         dmMutex::HMutex m_Mutex;
         dmConditionVariable::HConditionVariable m_WakeupCond;
-        dmThread::Thread m_Thread;
+        dmArray<dmThread::Thread> m_Threads;
+        // The thread names must outlive the start of the threads
+        char m_ThreadNames[MAX_THREADS][MAX_THREAD_NAME];
         Request m_Request[QUEUE_SLOTS];
-        uint32_t m_Front, m_Back, m_Loaded;
+        uint32_t m_Front, m_Back, m_Loaded, m_Loading;
         uint64_t m_BytesWaiting;
         bool m_Shutdown;
 
         // Circular queue with indexing as follow (exclusive end)
         //
-        //          m_Back           m_Loaded   m_Front
-        // [N/A]   [loaded] [loaded] [to-load]  [N/A]
+        //          m_Back           m_Loaded                  m_Loading  m_Front
+        // [N/A]   [loaded] [loaded] [loading/done] [loading]  [to-load]  [N/A]
         //
+        // m_Loaded is only advanced past requests that are done, in order.
     };
 
-    static Request* GetNextRequest(Queue* queue)
+    static Request* ClaimNextRequest(Queue* queue)
     {
         // Since we can be loading many things at once, track the total Capacity() for buffers
         // that are waiting to be picked up by the preloader. In the case of the queue being filled
@@ -73,12 +90,33 @@ namespace dmLoadQueue
             return 0x0;
         }
 
-        if (queue->m_Loaded == queue->m_Front)
+        if (queue->m_Loading == queue->m_Front)
         {
             return 0x0;
         }
 
-        return &queue->m_Request[queue->m_Loaded % QUEUE_SLOTS];
+        return &queue->m_Request[(queue->m_Loading++) % QUEUE_SLOTS];
+    }
+
+    static void CreateResource(Queue* queue, Request* request, dmResource::SResourceType* resource_type, LoadResult& result)
+    {
+        DM_PROFILE(Resource, "CreateResource");
+        dmResource::SResourceDescriptor& resource = result.m_Resource;
+        memset(&resource, 0, sizeof(resource));
+        resource.m_NameHash           = request->m_PreloadInfo.m_CanonicalPathHash;
+        resource.m_ReferenceCount     = 1;
+        resource.m_ResourceType       = (void*)resource_type;
+        resource.m_ResourceSizeOnDisc = request->m_Buffer.Size();
+
+        dmResource::ResourceCreateParams params;
+        params.m_Factory     = queue->m_Factory;
+        params.m_Context     = resource_type->m_Context;
+        params.m_PreloadData = result.m_PreloadData;
+        params.m_Resource    = &resource;
+        params.m_Filename    = request->m_Name;
+        params.m_Buffer      = request->m_Buffer.Begin();
+        params.m_BufferSize  = request->m_Buffer.Size();
+        result.m_CreateResult = resource_type->m_CreateFunction(params);
     }
 
     static void LoadThread(void* arg)
@@ -86,31 +124,40 @@ namespace dmLoadQueue
         Queue* queue     = (Queue*)arg;
         Request* current = 0;
         LoadResult result;
+        // Scratch buffer for data that is decompressed outside of the factory load lock
+        dmResource::LoadBufferType raw_buffer;
         while (true)
         {
             {
                 dmMutex::ScopedLock lk(queue->m_Mutex);
                 if (current != 0)
                 {
-                    // Just finished one (from previous iteratino)
+                    // Just finished one (from previous iteration)
                     queue->m_BytesWaiting += current->m_Buffer.Capacity();
-                    queue->m_Loaded++;
                     current->m_Result = result;
+                    current->m_Done   = true;
                     current           = 0;
+
+                    // Other threads may have finished later requests before this one
+                    while (queue->m_Loaded != queue->m_Loading && queue->m_Request[queue->m_Loaded % QUEUE_SLOTS].m_Done)
+                    {
+                        queue->m_Loaded++;
+                    }
                 }
                 if (queue->m_Shutdown)
                 {
                     return;
                 }
 
-                current = GetNextRequest(queue);
+                current = ClaimNextRequest(queue);
                 if (current == 0x0)
                 {
                     // Nothing to do, reset any buffers of inactive requests that are not at default capacity
                     for (uint32_t i = 0; i < QUEUE_SLOTS; ++i)
                     {
                         Request* r = &queue->m_Request[i];
-                        if (r->m_Buffer.Size() == 0)
+                        bool pending = r->m_Name != 0x0 && !r->m_Done;
+                        if (!pending && r->m_Buffer.Size() == 0)
                         {
                             if (r->m_Buffer.Capacity() > DEFAULT_CAPACITY)
                             {
@@ -119,8 +166,12 @@ namespace dmLoadQueue
                             }
                         }
                     }
+                    if (raw_buffer.Capacity() > DEFAULT_CAPACITY)
+                    {
+                        raw_buffer.SetCapacity(0);
+                    }
                     dmConditionVariable::Wait(queue->m_WakeupCond, queue->m_Mutex);
-                    current = GetNextRequest(queue);
+                    current = ClaimNextRequest(queue);
                 }
             }
 
@@ -134,9 +185,10 @@ namespace dmLoadQueue
                 {
                     current->m_Buffer.SetCapacity(DEFAULT_CAPACITY);
                 }
-                result.m_LoadResult    = DoLoadResource(queue->m_Factory, current->m_CanonicalPath, current->m_Name, &size, &current->m_Buffer);
+                result.m_LoadResult    = DoLoadResource(queue->m_Factory, current->m_CanonicalPath, current->m_Name, &size, &current->m_Buffer, &raw_buffer);
                 result.m_PreloadResult = dmResource::RESULT_PENDING;
                 result.m_PreloadData   = 0;
+                result.m_CreateResult  = dmResource::RESULT_PENDING;
 
                 if (result.m_LoadResult == dmResource::RESULT_OK)
                 {
@@ -156,6 +208,13 @@ namespace dmLoadQueue
                     {
                         result.m_PreloadResult = dmResource::RESULT_OK;
                     }
+
+                    // Resources without dependencies can be created here, if the create function is thread safe
+                    dmResource::SResourceType* create_type = current->m_PreloadInfo.m_CreateType;
+                    if (create_type && result.m_PreloadResult == dmResource::RESULT_OK && current->m_PreloadInfo.m_HintInfo.m_HintCount == 0)
+                    {
+                        CreateResource(queue, current, create_type, result);
+                    }
                 }
             }
         }
@@ -168,11 +227,19 @@ namespace dmLoadQueue
         q->m_Front        = 0;
         q->m_Back         = 0;
         q->m_Loaded       = 0;
+        q->m_Loading      = 0;
         q->m_Shutdown     = false;
         q->m_BytesWaiting = 0;
         q->m_Mutex        = dmMutex::New();
         q->m_WakeupCond   = dmConditionVariable::New();
-        q->m_Thread       = dmThread::New(&LoadThread, 65536, q, "AsyncLoad");
+
+        uint32_t thread_count = dmMath::Min(dmResource::GetLoaderThreadCount(factory), MAX_THREADS);
+        q->m_Threads.SetCapacity(thread_count);
+        for (uint32_t i = 0; i < thread_count; ++i)
+        {
+            dmSnPrintf(q->m_ThreadNames[i], MAX_THREAD_NAME, "AsyncLoad%u", i);
+            q->m_Threads.Push(dmThread::New(&LoadThread, 65536, q, q->m_ThreadNames[i]));
+        }
 
         return q;
     }
@@ -182,10 +249,13 @@ namespace dmLoadQueue
         {
             dmMutex::ScopedLock lk(queue->m_Mutex);
             queue->m_Shutdown = true;
-            // Wake up the worker so it can exit and allow us to join
-            dmConditionVariable::Signal(queue->m_WakeupCond);
+            // Wake up the workers so they can exit and allow us to join
+            dmConditionVariable::Broadcast(queue->m_WakeupCond);
+        }
+        for (uint32_t i = 0; i < queue->m_Threads.Size(); ++i)
+        {
+            dmThread::Join(queue->m_Threads[i]);
         }
-        dmThread::Join(queue->m_Thread);
         dmConditionVariable::Delete(queue->m_WakeupCond);
         dmMutex::Delete(queue->m_Mutex);
         delete queue;
@@ -204,13 +274,12 @@ namespace dmLoadQueue
         if ((queue->m_Front - queue->m_Back) == QUEUE_SLOTS)
             return 0;
 
-        if (queue->m_Loaded == queue->m_Front)
-        {
-            // The worker is sleeping waiting for request, wake it up
-            dmConditionVariable::Signal(queue->m_WakeupCond);
-        }
+        // Wake up a worker, in case they are all sleeping waiting for requests
+        dmConditionVariable::Signal(queue->m_WakeupCond);
 
-        Request* req         = &queue->m_Request[(queue->m_Front++) % QUEUE_SLOTS];
+        Request* req         = &queue->m_Request[queue->m_Front % QUEUE_SLOTS];
+        req->m_Index         = queue->m_Front++;
+        req->m_Done          = false;
         req->m_Name          = name;
         req->m_CanonicalPath = canonical_path;
 
@@ -223,7 +292,8 @@ namespace dmLoadQueue
     Result EndLoad(HQueue queue, HRequest request, void** buf, uint32_t* size, LoadResult* load_result)
     {
         dmMutex::ScopedLock lk(queue->m_Mutex);
-        if (request->m_Result.m_LoadResult == dmResource::RESULT_PENDING)
+        // Not handed out until all earlier requests are done
+        if ((request->m_Index - queue->m_Back) >= (queue->m_Loaded - queue->m_Back))
             return RESULT_PENDING;
 
         *buf         = request->m_Buffer.Begin();
@@ -245,10 +315,14 @@ namespace dmLoadQueue
         uint32_t buffer_capacity = request->m_Buffer.Capacity();
         queue->m_BytesWaiting -= buffer_capacity;
         // If we either have blocked further processing by exceeding MAX_PENDING_DATA or
-        // the buffer has a non-default capacity, we want to wake up the worker
-        if (buffer_capacity != DEFAULT_CAPACITY || (old_bytes_waiting >= MAX_PENDING_DATA && queue->m_BytesWaiting < MAX_PENDING_DATA))
+        // the buffer has a non-default capacity, we want to wake up the workers
+        if (old_bytes_waiting >= MAX_PENDING_DATA && queue->m_BytesWaiting < MAX_PENDING_DATA)
+        {
+            // Wake up threads, we can now fit new requests
+            dmConditionVariable::Broadcast(queue->m_WakeupCond);
+        }
+        else if (buffer_capacity != DEFAULT_CAPACITY)
         {
-            // Wake up thread, we can now fit a new request
             dmConditionVariable::Signal(queue->m_WakeupCond);
         }
 
@@ -143,7 +143,8 @@ namespace dmResource
 
     /**
      * Resource preloading function. This may be called from a separate loading thread
-     * but will not keep any mutexes held while executing the call. During this call
+     * but will not keep any mutexes held while executing the call. Several loading threads
+     * may call preload functions at the same time, for different resources. During this call
      * PreloadHint can be called with the supplied hint_info handle.
      * If RESULT_OK is returned, the resource Create function is guaranteed to be called
      * with the preload_data value supplied.
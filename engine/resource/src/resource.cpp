@@ -131,6 +131,10 @@ struct SResourceFactory
     Manifest*                                    m_Manifest;
     void*                                        m_ArchiveMountInfo;
 
+    uint32_t                                     m_LoaderThreadCount;
+    uint32_t                                     m_MaxPreloaderRequests;
+    uint32_t                                     m_MaxPreloaderPaths;
+
     uint8_t                                      m_UseLiveUpdate : 1;
 };
 
@@ -192,6 +196,9 @@ void SetDefaultNewFactoryParams(struct NewFactoryParams* params)
 {
     params->m_MaxResources = 1024;
     params->m_Flags = RESOURCE_FACTORY_FLAGS_EMPTY;
+    params->m_LoaderThreadCount = 1;
+    params->m_MaxPreloaderRequests = 8192;
+    params->m_MaxPreloaderPaths = 16384;
 
     params->m_ArchiveManifest.m_Data = 0;
     params->m_ArchiveManifest.m_Size = 0;
@@ -456,6 +463,10 @@ HFactory NewFactory(NewFactoryParams* params, const char* uri)
     memset(factory, 0, sizeof(*factory));
     factory->m_Socket = socket;
     factory->m_UseLiveUpdate = params->m_Flags & RESOURCE_FACTORY_FLAGS_LIVE_UPDATE ? 1 : 0;
+    factory->m_LoaderThreadCount = dmMath::Max(params->m_LoaderThreadCount, 1U);
+    // The root request and its path are always needed
+    factory->m_MaxPreloaderRequests = dmMath::Max(params->m_MaxPreloaderRequests, 1U);
+    factory->m_MaxPreloaderPaths = dmMath::Max(params->m_MaxPreloaderPaths, 2U);
 
     dmURI::Result uri_result = dmURI::Parse(uri, &factory->m_UriParts);
     if (uri_result != dmURI::RESULT_OK)
@@ -777,6 +788,7 @@ Result RegisterType(HFactory factory,
     resource_type.m_PostCreateFunction = post_create_function;
     resource_type.m_DestroyFunction = destroy_function;
     resource_type.m_RecreateFunction = recreate_function;
+    resource_type.m_ThreadSafeCreate = false;
 
     factory->m_ResourceTypes[factory->m_ResourceTypesCount++] = resource_type;
 
@@ -847,7 +859,20 @@ Result VerifyResourcesBundled(dmResourceArchive::HArchiveIndexContainer base_arc
     return VerifyResourcesBundled(entries, entry_count, hash_len, base_archive);
 }
 
-static Result LoadFromManifest(const Manifest* manifest, const char* path, uint32_t* resource_size, LoadBufferType* buffer)
+// Used by the async loader to do the expensive parts of a load after the m_LoadMutex has been released
+struct DeferredLoad
+{
+    // Scratch buffer for the raw archive entry data
+    LoadBufferType*              m_RawBuffer;
+    dmResourceArchive::EntryData m_Entry;
+    char                         m_Path[RESOURCE_PATH_MAX];
+    // The raw entry data needs decrypting/decompressing into the buffer
+    uint8_t                      m_Decode : 1;
+    // The resource should be read from the local file system at m_Path
+    uint8_t                      m_ReadFile : 1;
+};
+
+static Result LoadFromManifest(const Manifest* manifest, const char* path, uint32_t* resource_size, LoadBufferType* buffer, DeferredLoad* deferred)
 {
     dmhash_t path_hash = dmHashString64(path);
 
@@ -872,6 +897,27 @@ static Result LoadFromManifest(const Manifest* manifest, const char* path, uint3
         }
 
         buffer->SetSize(0);
+
+        if (deferred && dmResourceArchive::CanReadRawEntry(archive, &ed))
+        {
+            uint32_t raw_size = dmResourceArchive::GetRawEntrySize(&ed);
+            LoadBufferType* raw_buffer = deferred->m_RawBuffer;
+            if (raw_buffer->Capacity() < raw_size)
+            {
+                raw_buffer->SetCapacity(raw_size);
+            }
+            raw_buffer->SetSize(0);
+            if (dmResourceArchive::ReadRawEntry(archive, &ed, raw_buffer->Begin()) != dmResourceArchive::RESULT_OK)
+            {
+                return RESULT_IO_ERROR;
+            }
+            raw_buffer->SetSize(raw_size);
+            deferred->m_Entry = ed;
+            deferred->m_Decode = 1;
+            *resource_size = file_size;
+            return RESULT_OK;
+        }
+
         dmResourceArchive::Result read_result = dmResourceArchive::Read(archive, hash, hash_len, &ed, buffer->Begin());
         if (read_result != dmResourceArchive::RESULT_OK)
         {
@@ -892,13 +938,44 @@ static Result LoadFromManifest(const Manifest* manifest, const char* path, uint3
     return RESULT_IO_ERROR;
 }
 
+static Result LoadFromFileSystem(const char* fs_path, uint32_t* resource_size, LoadBufferType* buffer)
+{
+    // Load over local file system
+    uint32_t file_size;
+    dmSys::Result r = dmSys::ResourceSize(fs_path, &file_size);
+    if (r != dmSys::RESULT_OK) {
+        if (r == dmSys::RESULT_NOENT)
+            return RESULT_RESOURCE_NOT_FOUND;
+        else
+            return RESULT_IO_ERROR;
+    }
+
+    if (buffer->Capacity() < file_size) {
+        buffer->SetCapacity(file_size);
+    }
+    buffer->SetSize(0);
+
+    r = dmSys::LoadResource(fs_path, buffer->Begin(), file_size, &file_size);
+    if (r == dmSys::RESULT_OK) {
+        buffer->SetSize(file_size);
+        *resource_size = file_size;
+        return RESULT_OK;
+    } else {
+        if (r == dmSys::RESULT_NOENT)
+            return RESULT_RESOURCE_NOT_FOUND;
+        else
+            return RESULT_IO_ERROR;
+    }
+}
+
 // Assumes m_LoadMutex is already held
-static Result DoLoadResourceLocked(HFactory factory, const char* path, const char* original_name, uint32_t* resource_size, LoadBufferType* buffer)
+// If 'deferred' is set, the decoding of archive entries and reading from the local file system is left to the caller
+static Result DoLoadResourceLocked(HFactory factory, const char* path, const char* original_name, uint32_t* resource_size, LoadBufferType* buffer, DeferredLoad* deferred)
 {
     DM_PROFILE(Resource, "LoadResource");
     if (factory->m_BuiltinsManifest)
     {
-        if (LoadFromManifest(factory->m_BuiltinsManifest, original_name, resource_size, buffer) == RESULT_OK)
+        if (LoadFromManifest(factory->m_BuiltinsManifest, original_name, resource_size, buffer, deferred) == RESULT_OK)
         {
             return RESULT_OK;
         }
@@ -952,7 +1029,7 @@ static Result DoLoadResourceLocked(HFactory factory, const char* path, const cha
     }
     else if (factory->m_Manifest)
     {
-        Result r = LoadFromManifest(factory->m_Manifest, original_name, resource_size, buffer);
+        Result r = LoadFromManifest(factory->m_Manifest, original_name, resource_size, buffer, deferred);
         return r;
     }
     else
@@ -967,41 +1044,54 @@ static Result DoLoadResourceLocked(HFactory factory, const char* path, const cha
         }
         fs_path = fs_mount_path;
 
-        // Load over local file system
-        uint32_t file_size;
-        dmSys::Result r = dmSys::ResourceSize(fs_path, &file_size);
-        if (r != dmSys::RESULT_OK) {
-            if (r == dmSys::RESULT_NOENT)
-                return RESULT_RESOURCE_NOT_FOUND;
-            else
-                return RESULT_IO_ERROR;
-        }
-
-        if (buffer->Capacity() < file_size) {
-            buffer->SetCapacity(file_size);
-        }
-        buffer->SetSize(0);
-
-        r = dmSys::LoadResource(fs_path, buffer->Begin(), file_size, &file_size);
-        if (r == dmSys::RESULT_OK) {
-            buffer->SetSize(file_size);
-            *resource_size = file_size;
+        if (deferred)
+        {
+            dmStrlCpy(deferred->m_Path, fs_path, sizeof(deferred->m_Path));
+            deferred->m_ReadFile = 1;
             return RESULT_OK;
-        } else {
-            if (r == dmSys::RESULT_NOENT)
-                return RESULT_RESOURCE_NOT_FOUND;
-            else
-                return RESULT_IO_ERROR;
         }
+        return LoadFromFileSystem(fs_path, resource_size, buffer);
     }
 }
 
 // Takes the lock.
-Result DoLoadResource(HFactory factory, const char* path, const char* original_name, uint32_t* resource_size, LoadBufferType* buffer)
+// Only the lookup and the reading of shared resources (archives, http) is done while holding the lock,
+// so that several async loader threads can read files and decompress resources in parallel.
+Result DoLoadResource(HFactory factory, const char* path, const char* original_name, uint32_t* resource_size, LoadBufferType* buffer, LoadBufferType* raw_buffer)
 {
-    // Called from async queue so we wrap around a lock
-    dmMutex::ScopedLock lk(factory->m_LoadMutex);
-    return DoLoadResourceLocked(factory, path, original_name, resource_size, buffer);
+    DeferredLoad deferred;
+    deferred.m_RawBuffer = raw_buffer;
+    deferred.m_Decode = 0;
+    deferred.m_ReadFile = 0;
+
+    Result r;
+    {
+        // Called from async queue so we wrap around a lock
+        dmMutex::ScopedLock lk(factory->m_LoadMutex);
+        r = DoLoadResourceLocked(factory, path, original_name, resource_size, buffer, &deferred);
+    }
+    if (r != RESULT_OK)
+    {
+        return r;
+    }
+
+    if (deferred.m_ReadFile)
+    {
+        DM_PROFILE(Resource, "LoadResourceFile");
+        return LoadFromFileSystem(deferred.m_Path, resource_size, buffer);
+    }
+
+    if (deferred.m_Decode)
+    {
+        DM_PROFILE(Resource, "DecodeResource");
+        if (dmResourceArchive::DecodeRawEntry(&deferred.m_Entry, raw_buffer->Begin(), buffer->Begin()) != dmResourceArchive::RESULT_OK)
+        {
+            return RESULT_IO_ERROR;
+        }
+        buffer->SetSize(deferred.m_Entry.m_ResourceSize);
+        *resource_size = deferred.m_Entry.m_ResourceSize;
+    }
+    return RESULT_OK;
 }
 
 // Assumes m_LoadMutex is already held
@@ -1011,7 +1101,7 @@ Result LoadResource(HFactory factory, const char* path, const char* original_nam
         factory->m_Buffer.SetCapacity(DEFAULT_BUFFER_SIZE);
     }
     factory->m_Buffer.SetSize(0);
-    Result r = DoLoadResourceLocked(factory, path, original_name, resource_size, &factory->m_Buffer);
+    Result r = DoLoadResourceLocked(factory, path, original_name, resource_size, &factory->m_Buffer, 0);
     if (r == RESULT_OK)
         *buffer = factory->m_Buffer.Begin();
     else
@@ -1541,6 +1631,17 @@ Result GetTypeFromExtension(HFactory factory, const char* extension, ResourceTyp
     }
 }
 
+Result SetThreadSafeCreate(HFactory factory, const char* extension, bool thread_safe)
+{
+    SResourceType* resource_type = FindResourceType(factory, extension);
+    if (!resource_type)
+    {
+        return RESULT_UNKNOWN_RESOURCE_TYPE;
+    }
+    resource_type->m_ThreadSafeCreate = thread_safe;
+    return RESULT_OK;
+}
+
 Result GetExtensionFromType(HFactory factory, ResourceType type, const char** extension)
 {
     for (uint32_t i = 0; i < factory->m_ResourceTypesCount; ++i)
@@ -1716,6 +1817,21 @@ Result GetPath(HFactory factory, const void* resource, uint64_t* hash)
     return RESULT_RESOURCE_NOT_FOUND;
 }
 
+uint32_t GetLoaderThreadCount(HFactory factory)
+{
+    return factory->m_LoaderThreadCount;
+}
+
+uint32_t GetMaxPreloaderRequests(HFactory factory)
+{
+    return factory->m_MaxPreloaderRequests;
+}
+
+uint32_t GetMaxPreloaderPaths(HFactory factory)
+{
+    return factory->m_MaxPreloaderPaths;
+}
+
 dmMutex::HMutex GetLoadMutex(const dmResource::HFactory factory)
 {
     return factory->m_LoadMutex;
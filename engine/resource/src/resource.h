@@ -127,11 +127,20 @@ namespace dmResource
         /// Factory flags. Default is RESOURCE_FACTORY_FLAGS_EMPTY
         uint32_t m_Flags;
 
+        /// Number of threads used for async loading. Default is 1
+        uint32_t m_LoaderThreadCount;
+
+        /// Maximum number of pending requests in a preloader. Default is 8192
+        uint32_t m_MaxPreloaderRequests;
+
+        /// Maximum number of unique paths in a preloader. Default is 16384
+        uint32_t m_MaxPreloaderPaths;
+
         EmbeddedResource m_ArchiveIndex;
         EmbeddedResource m_ArchiveData;
         EmbeddedResource m_ArchiveManifest;
 
-        uint32_t m_Reserved[5];
+        uint32_t m_Reserved[2];
 
         NewFactoryParams()
         {
@@ -224,6 +233,19 @@ namespace dmResource
      */
     Result GetTypeFromExtension(HFactory factory, const char* extension, ResourceType* type);
 
+    /**
+     * Allow the create function of a resource type to be called on a loading thread.
+     * Only for types where the create function doesn't get any other resources, and
+     * doesn't touch state that isn't thread safe, such as the graphics context.
+     * The resources are only created on the loading thread if their preload
+     * function didn't hint any other resources.
+     * @param factory Factory handle
+     * @param extension File extension
+     * @param thread_safe If the create function is thread safe
+     * @return RESULT_OK on success
+     */
+    Result SetThreadSafeCreate(HFactory factory, const char* extension, bool thread_safe);
+
     /**
      * Get extension from type
      * @param factory Factory handle
@@ -528,6 +528,62 @@ namespace dmResourceArchive
         return RESULT_OK;
     }
 
+    bool CanReadRawEntry(HArchiveIndexContainer archive, const EntryData* entry)
+    {
+        bool encrypted = (entry->m_Flags & ENTRY_FLAG_ENCRYPTED);
+        bool compressed = entry->m_ResourceCompressedSize != 0xFFFFFFFF;
+        return (encrypted || compressed) && archive->m_Loader.m_Read == ReadEntryFromArchive && archive->m_ArchiveFileIndex != 0;
+    }
+
+    uint32_t GetRawEntrySize(const EntryData* entry)
+    {
+        bool compressed = entry->m_ResourceCompressedSize != 0xFFFFFFFF;
+        return compressed ? entry->m_ResourceCompressedSize : entry->m_ResourceSize;
+    }
+
+    Result ReadRawEntry(HArchiveIndexContainer archive, const EntryData* entry, void* buffer)
+    {
+        const ArchiveFileIndex* afi = archive->m_ArchiveFileIndex;
+        uint32_t size = GetRawEntrySize(entry);
+        if (!afi->m_IsMemMapped)
+        {
+            FILE* resource_file = afi->m_FileResourceData;
+            fseek(resource_file, entry->m_ResourceDataOffset, SEEK_SET);
+            if (fread(buffer, 1, size, resource_file) != size)
+            {
+                return RESULT_IO_ERROR;
+            }
+        } else {
+            // We copy the data, since the archive may be unloaded (e.g. by liveupdate) once the lock is released
+            memcpy(buffer, (void*) (((uintptr_t)afi->m_ResourceData + entry->m_ResourceDataOffset)), size);
+        }
+        return RESULT_OK;
+    }
+
+    Result DecodeRawEntry(const EntryData* entry, void* raw_buffer, void* buffer)
+    {
+        bool encrypted = (entry->m_Flags & ENTRY_FLAG_ENCRYPTED);
+        bool compressed = entry->m_ResourceCompressedSize != 0xFFFFFFFF;
+        uint32_t raw_size = GetRawEntrySize(entry);
+
+        if (encrypted)
+        {
+            Result r = DecryptBuffer(raw_buffer, raw_size);
+            if (r != RESULT_OK)
+            {
+                return r;
+            }
+        }
+
+        if (compressed)
+        {
+            return DecompressBuffer(raw_buffer, raw_size, buffer, entry->m_ResourceSize);
+        }
+
+        memcpy(buffer, raw_buffer, raw_size);
+        return RESULT_OK;
+    }
+
     void RegisterDefaultArchiveLoader()
     {
         dmResourceArchive::ArchiveLoader loader;
@@ -213,6 +213,19 @@ namespace dmResourceArchive
     // Reads an entry from a single archive
     Result ReadEntryFromArchive(HArchiveIndexContainer archive, const uint8_t* hash, uint32_t hash_len, const EntryData* entry, void* buffer);
 
+    // Returns true if the entry needs to be decrypted and/or decompressed, and the archive supports reading the raw entry data.
+    // Used to decode the resources outside of the resource factory load lock
+    bool CanReadRawEntry(HArchiveIndexContainer archive, const EntryData* entry);
+
+    // Size of the entry data as stored in the archive
+    uint32_t GetRawEntrySize(const EntryData* entry);
+
+    // Reads the entry data as stored in the archive (i.e. encrypted and/or compressed) into 'buffer' of size GetRawEntrySize()
+    Result ReadRawEntry(HArchiveIndexContainer archive, const EntryData* entry, void* buffer);
+
+    // Decrypts and decompresses the raw entry data into 'buffer' of size m_ResourceSize. The raw buffer is decrypted in place
+    Result DecodeRawEntry(const EntryData* entry, void* raw_buffer, void* buffer);
+
     // Calls each loader in sequence
 
     /*# Loads the archives, calling each registered loader in sequence
@@ -23,6 +23,7 @@
 #include <dlib/hash.h>
 #include <dlib/hashtable.h>
 #include <dlib/log.h>
+#include <dlib/math.h>
 #include <dlib/uri.h>
 #include <dlib/time.h>
 #include <dlib/spinlock.h>
@@ -71,8 +72,12 @@ namespace dmResource
     // to each request item. The path cache is also syncronized with the same spinlock as the new preloader hints array.
     // The path cache is not touched by the UpdatePreloader code, we keep the internalized pointers in the item.
 
-    // If max number of preload items is reached or the path cache is full new items added to the preloader will
+    // The requests and the path cache are stored in fixed size pages that are allocated on demand, so the
+    // pointers to requests and internalized paths stay valid while the preloader grows.
+    //
+    // If the request budget is reached or the path cache budget is reached new items added to the preloader will
     // be thrown away and can potentially cause synced loading of those resources.
+    // The budgets are set with NewFactoryParams::m_MaxPreloaderRequests and m_MaxPreloaderPaths.
 
     struct PathDescriptor
     {
@@ -83,7 +88,7 @@ namespace dmResource
         dmhash_t m_CanonicalPathHash;
     };
 
-    typedef int16_t TRequestIndex;
+    typedef int32_t TRequestIndex;
 
     struct PreloadRequest
     {
@@ -92,7 +97,7 @@ namespace dmResource
         TRequestIndex m_Parent;
         TRequestIndex m_FirstChild;
         TRequestIndex m_NextSibling;
-        uint16_t m_PendingChildCount;
+        uint32_t m_PendingChildCount;
 
         // Set once resources have started loading, they have a load request
         dmLoadQueue::HRequest m_LoadRequest;
@@ -118,24 +123,21 @@ namespace dmResource
     };
 
 
-    // The preloader will function even down to a value of 1 here (the root object)
-    // and sets the limit of how large a dependencies tree can be stored. Since nodes
+    // The request budget sets the limit of how large a dependencies tree can be stored.
+    // The preloader will function even down to a value of 1 (the root object). Since nodes
     // are always present with all their children inserted (unless there was not room)
     // the required size is something the sum of all children on each level down along
     // the largest branch.
 
-    typedef dmHashTable<dmhash_t, uint32_t> TPathHashTable;
+    typedef dmHashTable<dmhash_t, const char*> TPathHashTable;
     typedef dmHashTable<dmhash_t, bool> TPathInProgressTable;
 
-    static const uint32_t MAX_PRELOADER_REQUESTS         = 1024;
-    static const uint32_t PATH_IN_PROGRESS_TABLE_SIZE    = MAX_PRELOADER_REQUESTS / 3;
-    static const uint32_t PATH_IN_PROGRESS_CAPACITY      = MAX_PRELOADER_REQUESTS;
-    static const uint32_t PATH_IN_PROGRESS_HASHDATA_SIZE = (PATH_IN_PROGRESS_TABLE_SIZE * sizeof(uint32_t)) + (PATH_IN_PROGRESS_CAPACITY * sizeof(TPathInProgressTable::Entry));
-    static const uint32_t PATH_AVERAGE_LENGTH            = 40;
-    static const uint32_t MAX_PRELOADER_PATHS            = 1536;
-    static const uint32_t PATH_BUFFER_TABLE_SIZE         = 509;
-    static const uint32_t PATH_BUFFER_TABLE_CAPACITY     = MAX_PRELOADER_PATHS;
-    static const uint32_t PATH_BUFFER_HASHDATA_SIZE      = (PATH_BUFFER_TABLE_SIZE * sizeof(uint32_t)) + (PATH_BUFFER_TABLE_CAPACITY * sizeof(TPathHashTable::Entry));
+    static const uint32_t REQUEST_PAGE_SHIFT             = 8;
+    static const uint32_t REQUEST_PAGE_SIZE              = 1 << REQUEST_PAGE_SHIFT;
+    static const uint32_t REQUEST_PAGE_MASK              = REQUEST_PAGE_SIZE - 1;
+    static const uint32_t PATH_PAGE_SIZE                 = 16 * 1024;
+    static const uint32_t TABLE_MIN_CAPACITY             = 256;
+    static const uint32_t POST_CREATE_CALLBACKS_GROW     = 128;
 
     struct PendingHint
     {
@@ -145,35 +147,34 @@ namespace dmResource
 
     struct ResourcePreloader
     {
-        ResourcePreloader()
-            : m_InProgress(&m_PathInProgressData, PATH_IN_PROGRESS_TABLE_SIZE, PATH_IN_PROGRESS_CAPACITY)
-        {
-        }
         struct SyncedData
         {
             SyncedData()
-                : m_PathLookup(m_LookupData, PATH_BUFFER_TABLE_SIZE, PATH_BUFFER_TABLE_CAPACITY)
-                , m_PathDataUsed(0)
+                : m_PathPageUsed(PATH_PAGE_SIZE)
+                , m_PathBudgetError(false)
             {
             }
             dmArray<PendingHint> m_NewHints;
             TPathHashTable m_PathLookup;
-            uint8_t m_LookupData[PATH_BUFFER_HASHDATA_SIZE];
-            char m_PathData[MAX_PRELOADER_PATHS * PATH_AVERAGE_LENGTH];
-            uint32_t m_PathDataUsed;
+            // Internalized paths, never moved once written
+            dmArray<char*> m_PathPages;
+            uint32_t m_PathPageUsed;
+            uint32_t m_MaxPaths;
+            // Set once the path cache budget has been exceeded, to only log once
+            bool m_PathBudgetError;
         } m_SyncedData;
 
         dmSpinlock::lock_t m_SyncedDataSpinlock;
 
-        PreloadRequest m_Request[MAX_PRELOADER_REQUESTS];
+        // The request tree, allocated in pages of REQUEST_PAGE_SIZE requests
+        dmArray<PreloadRequest*> m_RequestPages;
+        uint32_t m_MaxRequests;
 
         // list of free nodes
-        TRequestIndex m_Freelist[MAX_PRELOADER_REQUESTS];
-        uint32_t m_FreelistSize;
+        dmArray<TRequestIndex> m_Freelist;
         dmLoadQueue::HQueue m_LoadQueue;
         HFactory m_Factory;
         TPathInProgressTable m_InProgress;
-        uint8_t m_PathInProgressData[PATH_IN_PROGRESS_HASHDATA_SIZE];
 
         // used instead of dynamic allocs as far as it lasts.
         dmBlockAllocator::HContext m_BlockAllocator;
@@ -188,27 +189,88 @@ namespace dmResource
         TRequestIndex m_PersistResourceCount;
 
         dmArray<void*> m_PersistedResources;
+
+        // Set once a budget has been exceeded, to only warn once
+        bool m_BudgetWarning;
     };
 
+    static inline PreloadRequest* GetRequest(ResourcePreloader* preloader, TRequestIndex index)
+    {
+        return &preloader->m_RequestPages[index >> REQUEST_PAGE_SHIFT][index & REQUEST_PAGE_MASK];
+    }
+
+    // Number of requests in the tree, including the root
+    static inline uint32_t GetRequestCount(ResourcePreloader* preloader)
+    {
+        uint32_t allocated = dmMath::Min(preloader->m_RequestPages.Size() * REQUEST_PAGE_SIZE, preloader->m_MaxRequests);
+        return allocated - preloader->m_Freelist.Size();
+    }
+
+    static inline uint32_t GetPathCount(ResourcePreloader* preloader)
+    {
+        DM_SPINLOCK_SCOPED_LOCK(preloader->m_SyncedDataSpinlock)
+        return preloader->m_SyncedData.m_PathLookup.Size();
+    }
+
+    // Adds a new page of requests to the free list, if the budget allows it
+    static bool GrowRequests(ResourcePreloader* preloader)
+    {
+        uint32_t first = preloader->m_RequestPages.Size() * REQUEST_PAGE_SIZE;
+        if (first >= preloader->m_MaxRequests)
+        {
+            return false;
+        }
+        if (preloader->m_RequestPages.Full())
+        {
+            preloader->m_RequestPages.OffsetCapacity(16);
+        }
+        preloader->m_RequestPages.Push(new PreloadRequest[REQUEST_PAGE_SIZE]);
+
+        uint32_t count = dmMath::Min(REQUEST_PAGE_SIZE, preloader->m_MaxRequests - first);
+        preloader->m_Freelist.OffsetCapacity(count);
+        // Lower indices are popped first
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            preloader->m_Freelist.Push((TRequestIndex) (first + count - i - 1));
+        }
+        return true;
+    }
+
     const char* InternalizePath(ResourcePreloader::SyncedData* preloader_synced_data, dmhash_t path_hash, const char* path, uint32_t path_len)
     {
-        uint32_t* path_lookup = preloader_synced_data->m_PathLookup.Get(path_hash);
+        const char** path_lookup = preloader_synced_data->m_PathLookup.Get(path_hash);
         if (path_lookup != 0x0)
         {
-            return &preloader_synced_data->m_PathData[*path_lookup];
+            return *path_lookup;
         }
-        if (preloader_synced_data->m_PathLookup.Full())
+        if (preloader_synced_data->m_PathLookup.Size() >= preloader_synced_data->m_MaxPaths)
         {
+            if (!preloader_synced_data->m_PathBudgetError)
+            {
+                dmLogError("Preloader path budget of %u exceeded, '%s' and later resources will be loaded synchronously", preloader_synced_data->m_MaxPaths, path);
+                preloader_synced_data->m_PathBudgetError = true;
+            }
             return 0x0;
         }
-        if (preloader_synced_data->m_PathDataUsed + path_len + 1 > sizeof(preloader_synced_data->m_PathData))
+        if (preloader_synced_data->m_PathLookup.Full())
         {
-            return 0x0;
+            uint32_t capacity = dmMath::Max(TABLE_MIN_CAPACITY, preloader_synced_data->m_PathLookup.Capacity() * 2);
+            preloader_synced_data->m_PathLookup.SetCapacity(dmMath::Max(1U, capacity / 3), capacity);
         }
-        char* result = &preloader_synced_data->m_PathData[preloader_synced_data->m_PathDataUsed];
+        // Paths never span pages, RESOURCE_PATH_MAX is less than the page size
+        if (preloader_synced_data->m_PathPageUsed + path_len + 1 > PATH_PAGE_SIZE)
+        {
+            if (preloader_synced_data->m_PathPages.Full())
+            {
+                preloader_synced_data->m_PathPages.OffsetCapacity(16);
+            }
+            preloader_synced_data->m_PathPages.Push(new char[PATH_PAGE_SIZE]);
+            preloader_synced_data->m_PathPageUsed = 0;
+        }
+        char* result = preloader_synced_data->m_PathPages.Back() + preloader_synced_data->m_PathPageUsed;
         dmStrlCpy(result, path, path_len + 1);
-        preloader_synced_data->m_PathLookup.Put(path_hash, preloader_synced_data->m_PathDataUsed);
-        preloader_synced_data->m_PathDataUsed += path_len + 1;
+        preloader_synced_data->m_PathLookup.Put(path_hash, result);
+        preloader_synced_data->m_PathPageUsed += path_len + 1;
         return result;
     }
 
@@ -290,6 +352,11 @@ namespace dmResource
     {
         dmhash_t path_hash = path_descriptor->m_CanonicalPathHash;
         assert(preloader->m_InProgress.Get(path_hash) == 0x0);
+        if (preloader->m_InProgress.Full())
+        {
+            uint32_t capacity = dmMath::Max(TABLE_MIN_CAPACITY, preloader->m_InProgress.Capacity() * 2);
+            preloader->m_InProgress.SetCapacity(dmMath::Max(1U, capacity / 3), capacity);
+        }
         preloader->m_InProgress.Put(path_hash, true);
     }
 
@@ -302,44 +369,51 @@ namespace dmResource
 
     static void PreloaderTreeInsert(ResourcePreloader* preloader, TRequestIndex index, TRequestIndex parent)
     {
-        PreloadRequest* reqs      = &preloader->m_Request[0];
-        reqs[index].m_NextSibling = reqs[parent].m_FirstChild;
-        reqs[index].m_Parent      = parent;
-        reqs[parent].m_FirstChild = index;
-        reqs[parent].m_PendingChildCount += 1;
+        PreloadRequest* req        = GetRequest(preloader, index);
+        PreloadRequest* parent_req = GetRequest(preloader, parent);
+        req->m_NextSibling         = parent_req->m_FirstChild;
+        req->m_Parent              = parent;
+        parent_req->m_FirstChild   = index;
+        parent_req->m_PendingChildCount += 1;
     }
 
     static void RemoveFromParentPendingCount(ResourcePreloader* preloader, PreloadRequest* req)
     {
         if (req->m_Parent != -1)
         {
-            assert(preloader->m_Request[req->m_Parent].m_PendingChildCount > 0);
-            preloader->m_Request[req->m_Parent].m_PendingChildCount -= 1;
+            assert(GetRequest(preloader, req->m_Parent)->m_PendingChildCount > 0);
+            GetRequest(preloader, req->m_Parent)->m_PendingChildCount -= 1;
         }
     }
 
     static Result PreloadPathDescriptor(HPreloader preloader, TRequestIndex parent, const PathDescriptor& path_descriptor)
     {
         // Quick deduplication, check if the child is already listed under the current parent
-        TRequestIndex child = preloader->m_Request[parent].m_FirstChild;
+        TRequestIndex child = GetRequest(preloader, parent)->m_FirstChild;
         while (child != -1)
         {
-            if (preloader->m_Request[child].m_PathDescriptor.m_NameHash == path_descriptor.m_NameHash)
+            if (GetRequest(preloader, child)->m_PathDescriptor.m_NameHash == path_descriptor.m_NameHash)
             {
                 return RESULT_ALREADY_REGISTERED;
             }
-            child = preloader->m_Request[child].m_NextSibling;
+            child = GetRequest(preloader, child)->m_NextSibling;
         }
 
-        if (!preloader->m_FreelistSize)
+        if (preloader->m_Freelist.Empty() && !GrowRequests(preloader))
         {
-            // Preload queue is exhausted; this is not fatal, it just means the resource will be loaded
+            // Preload budget is exhausted; this is not fatal, it just means the resource will be loaded
             // inside the main thread which may cause stuttering
+            if (!preloader->m_BudgetWarning)
+            {
+                dmLogWarning("Preloader request budget of %u exceeded, resources will be loaded synchronously", preloader->m_MaxRequests);
+                preloader->m_BudgetWarning = true;
+            }
             return RESULT_OUT_OF_MEMORY;
         }
 
-        TRequestIndex new_req = preloader->m_Freelist[--preloader->m_FreelistSize];
-        PreloadRequest* req   = &preloader->m_Request[new_req];
+        TRequestIndex new_req = preloader->m_Freelist.Back();
+        preloader->m_Freelist.Pop();
+        PreloadRequest* req   = GetRequest(preloader, new_req);
         memset(req, 0, sizeof(PreloadRequest));
         req->m_PathDescriptor    = path_descriptor;
         req->m_FirstChild        = -1;
@@ -353,15 +427,15 @@ namespace dmResource
         TRequestIndex go_up = parent;
         while (go_up != -1)
         {
-            if (preloader->m_Request[go_up].m_PathDescriptor.m_CanonicalPathHash == path_descriptor.m_CanonicalPathHash)
+            if (GetRequest(preloader, go_up)->m_PathDescriptor.m_CanonicalPathHash == path_descriptor.m_CanonicalPathHash)
             {
                 req->m_LoadResult = RESULT_RESOURCE_LOOP_ERROR;
                 assert(parent != -1);
-                assert(preloader->m_Request[parent].m_PendingChildCount > 0);
-                preloader->m_Request[parent].m_PendingChildCount -= 1;
+                assert(GetRequest(preloader, parent)->m_PendingChildCount > 0);
+                GetRequest(preloader, parent)->m_PendingChildCount -= 1;
                 break;
             }
-            go_up = preloader->m_Request[go_up].m_Parent;
+            go_up = GetRequest(preloader, go_up)->m_Parent;
         }
         return RESULT_OK;
     }
@@ -404,12 +478,10 @@ namespace dmResource
     // Only supports removing the first child, which is all the preloader uses anyway.
     static void PreloaderRemoveLeaf(ResourcePreloader* preloader, TRequestIndex index)
     {
-        assert(preloader->m_FreelistSize < MAX_PRELOADER_REQUESTS);
-
-        PreloadRequest* me = &preloader->m_Request[index];
+        PreloadRequest* me = GetRequest(preloader, index);
         assert(me->m_FirstChild == -1);
         assert(me->m_PendingChildCount == 0);
-        PreloadRequest* parent = &preloader->m_Request[me->m_Parent];
+        PreloadRequest* parent = GetRequest(preloader, me->m_Parent);
         assert(parent->m_FirstChild == index);
 
         if (me->m_Resource)
@@ -431,7 +503,8 @@ namespace dmResource
             RemoveFromParentPendingCount(preloader, me);
         }
 
-        preloader->m_Freelist[preloader->m_FreelistSize++] = index;
+        // Capacity is reserved when the requests are allocated
+        preloader->m_Freelist.Push(index);
     }
 
     static void RemoveChildren(ResourcePreloader* preloader, PreloadRequest* req)
@@ -446,13 +519,16 @@ namespace dmResource
     HPreloader NewPreloader(HFactory factory, const dmArray<const char*>& names)
     {
         ResourcePreloader* preloader = new ResourcePreloader();
-        // root is always allocated so we don't add index zero in the free list
-        for (uint32_t i = 0; i < MAX_PRELOADER_REQUESTS - 1; i++)
-        {
-            preloader->m_Freelist[i] = MAX_PRELOADER_REQUESTS - i - 1;
-        }
+        preloader->m_MaxRequests            = GetMaxPreloaderRequests(factory);
+        preloader->m_SyncedData.m_MaxPaths  = GetMaxPreloaderPaths(factory);
+        preloader->m_BudgetWarning          = false;
 
-        preloader->m_FreelistSize = MAX_PRELOADER_REQUESTS - 1;
+        // root is always allocated so we take index zero from the free list
+        GrowRequests(preloader);
+        TRequestIndex root_index = preloader->m_Freelist.Back();
+        preloader->m_Freelist.Pop();
+        assert(root_index == 0);
+        (void) root_index;
 
         preloader->m_Factory         = factory;
         preloader->m_LoadQueue       = dmLoadQueue::CreateQueue(factory);
@@ -462,7 +538,7 @@ namespace dmResource
         preloader->m_PersistedResources.SetCapacity(names.Size());
 
         // Insert root.
-        PreloadRequest* root = &preloader->m_Request[0];
+        PreloadRequest* root = GetRequest(preloader, 0);
         memset(root, 0x00, sizeof(PreloadRequest));
 
         root->m_LoadResult        = MakePathDescriptor(preloader, names[0], root->m_PathDescriptor);
@@ -472,7 +548,7 @@ namespace dmResource
         preloader->m_PersistResourceCount++;
 
         // Post create setup
-        preloader->m_PostCreateCallbacks.SetCapacity(MAX_PRELOADER_REQUESTS / 8);
+        preloader->m_PostCreateCallbacks.SetCapacity(POST_CREATE_CALLBACKS_GROW);
         preloader->m_LoadQueueFull           = false;
         preloader->m_CreateComplete          = false;
         preloader->m_PostCreateCallbackIndex = 0;
@@ -506,6 +582,8 @@ namespace dmResource
         return NewPreloader(factory, names);
     }
 
+    static void FinishCreateResource(HPreloader preloader, PreloadRequest* req, SResourceDescriptor& tmp_resource);
+
     // CreateResource operation ends either with
     //   1) Having created the resource and free:d all buffers => RESULT_OK + m_Resource
     //   2) Having failed, (or created and destroyed), leaving => RESULT_SOME_ERROR + everything free:d
@@ -555,13 +633,23 @@ namespace dmResource
             req->m_LoadResult                 = resource_type->m_CreateFunction(params);
         }
 
+        FinishCreateResource(preloader, req, tmp_resource);
+    }
+
+    // Registers the post create function and inserts the created resource into the factory,
+    // or destroys it if the resource was already loaded. The create function may have been
+    // called by the preloader or on a loading thread.
+    static void FinishCreateResource(HPreloader preloader, PreloadRequest* req, SResourceDescriptor& tmp_resource)
+    {
+        SResourceType* resource_type = req->m_PathDescriptor.m_ResourceType;
+
         if (req->m_LoadResult == RESULT_OK)
         {
             if (resource_type->m_PostCreateFunction)
             {
                 if (preloader->m_PostCreateCallbacks.Full())
                 {
-                    preloader->m_PostCreateCallbacks.OffsetCapacity(MAX_PRELOADER_REQUESTS / 8);
+                    preloader->m_PostCreateCallbacks.OffsetCapacity(POST_CREATE_CALLBACKS_GROW);
                 }
                 preloader->m_PostCreateCallbacks.SetSize(preloader->m_PostCreateCallbacks.Size() + 1);
                 ResourcePostCreateParamsInternal& ip = preloader->m_PostCreateCallbacks.Back();
@@ -675,7 +763,7 @@ namespace dmResource
         {
             return false;
         }
-        PreloadRequest* parent_req = &preloader->m_Request[parent];
+        PreloadRequest* parent_req = GetRequest(preloader, parent);
         if (parent_req->m_PendingChildCount > 0)
         {
             return false;
@@ -722,8 +810,18 @@ namespace dmResource
         {
             if (req->m_LoadResult == RESULT_PENDING)
             {
-                // Create the resource using the loading buffer directly.
-                CreateResource(preloader, req, buffer, buffer_size);
+                if (load_result.m_CreateResult != RESULT_PENDING)
+                {
+                    // Already created on the loading thread
+                    assert(req->m_PendingChildCount == 0);
+                    req->m_LoadResult = load_result.m_CreateResult;
+                    FinishCreateResource(preloader, req, load_result.m_Resource);
+                }
+                else
+                {
+                    // Create the resource using the loading buffer directly.
+                    CreateResource(preloader, req, buffer, buffer_size);
+                }
                 created_resource = true;
             }
             UnmarkPathInProgress(preloader, &req->m_PathDescriptor);
@@ -753,7 +851,7 @@ namespace dmResource
         DM_PROFILE(Resource, "PreloaderUpdateOneItem");
         while (index >= 0)
         {
-            PreloadRequest* req = &preloader->m_Request[index];
+            PreloadRequest* req = GetRequest(preloader, index);
             switch (req->m_LoadResult)
             {
                 case RESULT_PENDING:
@@ -857,8 +955,11 @@ namespace dmResource
         dmLoadQueue::PreloadInfo info;
         info.m_HintInfo.m_Preloader = preloader;
         info.m_HintInfo.m_Parent    = index;
+        info.m_HintInfo.m_HintCount = 0;
         info.m_Function             = req->m_PathDescriptor.m_ResourceType->m_PreloadFunction;
         info.m_Context              = req->m_PathDescriptor.m_ResourceType->m_Context;
+        info.m_CreateType           = req->m_PathDescriptor.m_ResourceType->m_ThreadSafeCreate ? req->m_PathDescriptor.m_ResourceType : 0;
+        info.m_CanonicalPathHash    = req->m_PathDescriptor.m_CanonicalPathHash;
 
         // If we can't add the request to the load queue it is because the queue is full
         // We will try again once we completed loading of an item via dmLoadQueue::EndLoad
@@ -920,6 +1021,8 @@ namespace dmResource
     Result UpdatePreloader(HPreloader preloader, FPreloaderCompleteCallback complete_callback, PreloaderCompleteCallbackParams* complete_callback_params, uint32_t soft_time_limit)
     {
         DM_PROFILE(Resource, "UpdatePreloader");
+        DM_COUNTER("Preloader.Requests", GetRequestCount(preloader));
+        DM_COUNTER("Preloader.Paths", GetPathCount(preloader));
 
         uint64_t start           = dmTime::GetTime();
         uint32_t empty_runs      = 0;
@@ -927,7 +1030,7 @@ namespace dmResource
 
         do
         {
-            Result root_result        = preloader->m_Request[0].m_LoadResult;
+            Result root_result        = GetRequest(preloader, 0)->m_LoadResult;
             Result post_create_result = RESULT_OK;
             if (preloader->m_PostCreateCallbackIndex < preloader->m_PostCreateCallbacks.Size())
             {
@@ -940,7 +1043,7 @@ namespace dmResource
                         // Just waiting for the post-create functions to complete
                         // If main result is RESULT_OK pick up any errors from
                         // post create function
-                        preloader->m_Request[0].m_LoadResult = post_create_result;
+                        GetRequest(preloader, 0)->m_LoadResult = post_create_result;
                     }
                     continue;
                 }
@@ -966,7 +1069,7 @@ namespace dmResource
                     {
                         if (!complete_callback(complete_callback_params))
                         {
-                            preloader->m_Request[0].m_LoadResult = RESULT_NOT_LOADED;
+                            GetRequest(preloader, 0)->m_LoadResult = RESULT_NOT_LOADED;
                         }
                         empty_runs = 0;
                         // We need to continue to do all post create functions
@@ -1030,7 +1133,7 @@ namespace dmResource
         }
 
         // Release root and persisted resources
-        preloader->m_PersistedResources.Push(preloader->m_Request[0].m_Resource);
+        preloader->m_PersistedResources.Push(GetRequest(preloader, 0)->m_Resource);
         for (uint32_t i = 0; i < preloader->m_PersistedResources.Size(); ++i)
         {
             void* resource = preloader->m_PersistedResources[i];
@@ -1039,11 +1142,20 @@ namespace dmResource
             Release(preloader->m_Factory, resource);
         }
 
-        assert(preloader->m_FreelistSize == (MAX_PRELOADER_REQUESTS - 1));
+        assert(GetRequestCount(preloader) == 1);
         dmLoadQueue::DeleteQueue(preloader->m_LoadQueue);
 
         dmBlockAllocator::DeleteContext(preloader->m_BlockAllocator);
 
+        for (uint32_t i = 0; i < preloader->m_RequestPages.Size(); ++i)
+        {
+            delete [] preloader->m_RequestPages[i];
+        }
+        for (uint32_t i = 0; i < preloader->m_SyncedData.m_PathPages.Size(); ++i)
+        {
+            delete [] preloader->m_SyncedData.m_PathPages[i];
+        }
+
         delete preloader;
     }
 
@@ -1071,6 +1183,7 @@ namespace dmResource
         PendingHint& hint     = preloader->m_SyncedData.m_NewHints.Back();
         hint.m_PathDescriptor = path_descriptor;
         hint.m_Parent         = info->m_Parent;
+        info->m_HintCount++;
 
         return true;
     }
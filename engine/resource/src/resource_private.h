@@ -40,6 +40,8 @@ namespace dmResource
         FResourcePostCreate m_PostCreateFunction;
         FResourceDestroy    m_DestroyFunction;
         FResourceRecreate   m_RecreateFunction;
+        // The create function may be called on a loading thread
+        bool                m_ThreadSafeCreate;
     };
 
     typedef dmArray<char> LoadBufferType;
@@ -50,8 +52,15 @@ namespace dmResource
 
     // load with default internal buffer and its management, returns buffer ptr in 'buffer'
     Result LoadResource(HFactory factory, const char* path, const char* original_name, void** buffer, uint32_t* resource_size);
-    // load with own buffer
-    Result DoLoadResource(HFactory factory, const char* path, const char* original_name, uint32_t* resource_size, LoadBufferType* buffer);
+    // load with own buffer, and a scratch buffer for compressed data. Thread safe.
+    Result DoLoadResource(HFactory factory, const char* path, const char* original_name, uint32_t* resource_size, LoadBufferType* buffer, LoadBufferType* raw_buffer);
+
+    // Number of threads used for async loading
+    uint32_t GetLoaderThreadCount(HFactory factory);
+
+    // Budgets for the preloader request tree and path cache
+    uint32_t GetMaxPreloaderRequests(HFactory factory);
+    uint32_t GetMaxPreloaderPaths(HFactory factory);
 
     Result InsertResource(HFactory factory, const char* path, uint64_t canonical_path_hash, SResourceDescriptor* descriptor);
     uint32_t GetCanonicalPath(const char* relative_dir, char* buf);
@@ -89,6 +98,8 @@ namespace dmResource
     {
         HPreloader m_Preloader;
         int32_t m_Parent;
+        // Number of hints made by the preload function
+        uint32_t m_HintCount;
     };
 
     struct TypeCreatorDesc
@@ -223,9 +223,21 @@ protected:
         m_FooResourceCreateCallCount = 0;
         m_FooResourcePostCreateCallCount = 0;
         m_FooResourceDestroyCallCount = 0;
+        m_FooResourceLoaderThreadCreateCount = 0;
 
+        // Only set on the main thread, see FooResourceCreate
+        m_MainThreadKey = dmThread::AllocTls();
+        dmThread::SetTlsValue(m_MainThreadKey, this);
+
+        CreateFactory(1);
+    }
+
+    void CreateFactory(uint32_t loader_thread_count, uint32_t max_preloader_requests = 8192)
+    {
         dmResource::NewFactoryParams params;
         params.m_MaxResources = 16;
+        params.m_LoaderThreadCount = loader_thread_count;
+        params.m_MaxPreloaderRequests = max_preloader_requests;
 
         dmResourceArchive::ClearArchiveLoaders();
         dmResourceArchive::RegisterDefaultArchiveLoader();
@@ -247,6 +259,7 @@ protected:
         {
             dmResource::DeleteFactory(m_Factory);
         }
+        dmThread::FreeTls(m_MainThreadKey);
     }
 
     // dmResource::Get API but with preloader instead
@@ -282,6 +295,8 @@ public:
     uint32_t           m_FooResourceCreateCallCount;
     uint32_t           m_FooResourcePostCreateCallCount;
     uint32_t           m_FooResourceDestroyCallCount;
+    uint32_t           m_FooResourceLoaderThreadCreateCount;
+    dmThread::TlsKey   m_MainThreadKey;
 
     dmResource::HFactory m_Factory;
     const char*        m_ResourceName;
@@ -367,6 +382,10 @@ dmResource::Result FooResourceCreate(const dmResource::ResourceCreateParams& par
 {
     GetResourceTest* self = (GetResourceTest*) params.m_Context;
     self->m_FooResourceCreateCallCount++;
+    if (dmThread::GetTlsValue(self->m_MainThreadKey) == 0)
+    {
+        self->m_FooResourceLoaderThreadCreateCount++;
+    }
 
     TestResource::ResourceFoo* resource_foo;
 
@@ -822,9 +841,114 @@ TEST_P(GetResourceTest, PreloadGetParallell)
     }
 }
 
+TEST_P(GetResourceTest, PreloadGetLoaderThreads)
+{
+    dmResource::DeleteFactory(m_Factory);
+    CreateFactory(4);
+
+    // Several preloaders, to have more requests than loader threads in flight
+    for (uint32_t i=0;i<5;i++)
+    {
+        const uint32_t n = 8;
+        dmResource::HPreloader pr[n];
+        for (uint32_t j=0;j<n;j++)
+        {
+            pr[j] = dmResource::NewPreloader(m_Factory, m_ResourceName);
+        }
+
+        bool done;
+        for (uint32_t j=0;j<30;j++)
+        {
+            done = true;
+            for (uint32_t k=0;k<n;k++)
+            {
+                dmResource::Result r = dmResource::UpdatePreloader(pr[k], 0, 0, 2000);
+                if (r == dmResource::RESULT_PENDING)
+                {
+                    done = false;
+                    continue;
+                }
+                ASSERT_EQ(dmResource::RESULT_OK, r);
+            }
+            if (done)
+            {
+                break;
+            }
+        }
+        ASSERT_TRUE(done);
+
+        TestResourceContainer* resource = 0;
+        dmResource::Result e = dmResource::Get(m_Factory, m_ResourceName, (void**) &resource);
+        ASSERT_EQ(dmResource::RESULT_OK, e);
+        ASSERT_EQ((uint32_t) 2, resource->m_Resources.size()); //NOTE: Hard coded for two resources in test.cont
+
+        for (uint32_t j=0;j<n;j++)
+        {
+            dmResource::DeletePreloader(pr[j]);
+        }
+        dmResource::Release(m_Factory, resource);
+    }
+
+    ASSERT_EQ(m_ResourceContainerCreateCallCount, m_ResourceContainerDestroyCallCount);
+    ASSERT_EQ(m_FooResourceCreateCallCount, m_FooResourceDestroyCallCount);
+}
+
+TEST_P(GetResourceTest, PreloadGetThreadSafeCreate)
+{
+    // The foo resources don't hint anything, and may be created on the loading thread
+    dmResource::Result e = dmResource::SetThreadSafeCreate(m_Factory, "foo", true);
+    ASSERT_EQ(dmResource::RESULT_OK, e);
+    ASSERT_EQ(dmResource::RESULT_UNKNOWN_RESOURCE_TYPE, dmResource::SetThreadSafeCreate(m_Factory, "unknown", true));
+
+    TestResourceContainer* resource = 0;
+    e = PreloaderGet(m_Factory, m_ResourceName, (void**) &resource);
+    ASSERT_EQ(dmResource::RESULT_OK, e);
+    ASSERT_NE((void*) 0, resource);
+
+    const uint32_t sub_resource_count = resource->m_Resources.size();
+    ASSERT_EQ((uint32_t) 2, sub_resource_count); //NOTE: Hard coded for two resources in test.cont
+    ASSERT_EQ((uint32_t) 1, m_ResourceContainerCreateCallCount);
+    ASSERT_EQ(sub_resource_count, m_FooResourceCreateCallCount);
+    ASSERT_EQ(sub_resource_count, m_FooResourcePostCreateCallCount);
+    ASSERT_EQ((uint32_t) 0, m_FooResourceDestroyCallCount);
+#if !defined(__EMSCRIPTEN__)
+    // Created on the loader thread, not here. Web builds load on the main thread
+    ASSERT_EQ(sub_resource_count, m_FooResourceLoaderThreadCreateCount);
+#endif
+
+    dmResource::SResourceDescriptor descriptor;
+    e = dmResource::GetDescriptor(m_Factory, "/test01.foo", &descriptor);
+    ASSERT_EQ(dmResource::RESULT_OK, e);
+    ASSERT_EQ((uint32_t) 1, descriptor.m_ReferenceCount);
+
+    dmResource::Release(m_Factory, resource);
+    ASSERT_EQ((uint32_t) 1, m_ResourceContainerDestroyCallCount);
+    ASSERT_EQ(sub_resource_count, m_FooResourceDestroyCallCount);
+}
+
+TEST_P(GetResourceTest, PreloadGetBudget)
+{
+    // Only room for the root and one of the two foo resources in the preloader,
+    // the other one is loaded when the container is created
+    dmResource::DeleteFactory(m_Factory);
+    CreateFactory(1, 2);
+
+    TestResourceContainer* resource = 0;
+    dmResource::Result e = PreloaderGet(m_Factory, m_ResourceName, (void**) &resource);
+    ASSERT_EQ(dmResource::RESULT_OK, e);
+    ASSERT_NE((void*) 0, resource);
+    ASSERT_EQ((uint32_t) 2, resource->m_Resources.size());
+    ASSERT_EQ((uint32_t) 2, m_FooResourceCreateCallCount);
+    ASSERT_EQ((uint32_t) 2, m_FooResourcePostCreateCallCount);
+
+    dmResource::Release(m_Factory, resource);
+    ASSERT_EQ((uint32_t) 1, m_ResourceContainerDestroyCallCount);
+    ASSERT_EQ((uint32_t) 2, m_FooResourceDestroyCallCount);
+}
+
 TEST_P(GetResourceTest, PreloadGetManyRefs)
 {
-    // this has more references than the preloader can fit into its tree
+    // this has more references than fit in one page of the preloader tree
     dmResource::HPreloader pr = dmResource::NewPreloader(m_Factory, "/many_refs.cont");
 
     dmResource::Result r;
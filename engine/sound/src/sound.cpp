@@ -13,10 +13,12 @@
 #include <stdint.h>
 #include <dlib/hashtable.h>
 #include <dlib/index_pool.h>
+#include <dlib/job_pool.h>
 #include <dlib/log.h>
 #include <dlib/math.h>
 #include <dlib/mutex.h>
 #include <dlib/profile.h>
+#include <dlib/simd.h>
 #include <dlib/thread.h>
 #include <dlib/time.h>
 
@@ -35,6 +37,7 @@
 namespace dmSound
 {
     using namespace Vectormath::Aos;
+    using namespace dmSimd;
 
     #define SOUND_MAX_MIX_CHANNELS (2)
     #define SOUND_OUTBUFFER_COUNT (6)
@@ -184,6 +187,16 @@ namespace dmSound
         int      m_NextMemorySlot;
     };
 
+    /**
+     * Accumulation buffers for the groups, when mixing instances on several threads.
+     * Each slot is only used by one thread at a time, and the buffers are allocated when first used.
+     */
+    struct MixSlot
+    {
+        float*   m_MixBuffers[MAX_GROUPS];
+        bool     m_Used[MAX_GROUPS];
+    };
+
     struct SoundSystem
     {
         dmSoundCodec::HCodecContext   m_CodecContext;
@@ -192,6 +205,13 @@ namespace dmSound
         dmThread::Thread              m_Thread;
         dmMutex::HMutex               m_Mutex;
 
+        // Worker threads for mixing the instances. 0x0 if the instances are mixed on the sound thread
+        dmJobPool::HJobPool     m_MixPool;
+        MixSlot*                m_MixSlots;
+        uint32_t                m_MixSlotCount;
+        // Indices of the instances to mix in the current buffer
+        dmArray<uint16_t>       m_MixIndices;
+
         dmArray<SoundInstance>  m_Instances;
         dmIndexPool16           m_InstancesPool;
 
@@ -246,6 +266,7 @@ namespace dmSound
         params->m_BufferSize = 12 * 4096;
         params->m_FrameCount = 768;
         params->m_MaxInstances = 256;
+        params->m_MixThreadCount = 0;
         params->m_UseThread = true;
     }
 
@@ -336,6 +357,7 @@ namespace dmSound
         uint32_t max_buffers = params->m_MaxBuffers;
         uint32_t max_sources = params->m_MaxSources;
         uint32_t max_instances = params->m_MaxInstances;
+        uint32_t mix_thread_count = params->m_MixThreadCount;
 
         if (config)
         {
@@ -344,6 +366,20 @@ namespace dmSound
             max_buffers = (uint32_t) dmConfigFile::GetInt(config, "sound.max_sound_buffers", (int32_t) max_buffers);
             max_sources = (uint32_t) dmConfigFile::GetInt(config, "sound.max_sound_sources", (int32_t) max_sources);
             max_instances = (uint32_t) dmConfigFile::GetInt(config, "sound.max_sound_instances", (int32_t) max_instances);
+            mix_thread_count = (uint32_t) dmMath::Max(0, dmConfigFile::GetInt(config, "sound.mix_threads", (int32_t) mix_thread_count));
+        }
+
+        sound->m_MixPool = 0;
+        sound->m_MixSlots = 0;
+        sound->m_MixSlotCount = 0;
+        if (mix_thread_count > 0)
+        {
+            sound->m_MixPool = dmJobPool::New("SoundMix", mix_thread_count);
+            // One slot for each worker and one for the sound thread
+            sound->m_MixSlotCount = dmJobPool::GetWorkerCount(sound->m_MixPool) + 1;
+            sound->m_MixSlots = new MixSlot[sound->m_MixSlotCount];
+            memset(sound->m_MixSlots, 0, sizeof(MixSlot) * sound->m_MixSlotCount);
+            sound->m_MixIndices.SetCapacity(max_instances);
         }
 
         sound->m_Instances.SetCapacity(max_instances);
@@ -442,6 +478,17 @@ namespace dmSound
                 }
             }
 
+            if (sound->m_MixPool)
+            {
+                dmJobPool::Delete(sound->m_MixPool);
+                for (uint32_t i = 0; i < sound->m_MixSlotCount; ++i) {
+                    for (uint32_t j = 0; j < MAX_GROUPS; ++j) {
+                        free((void*) sound->m_MixSlots[i].m_MixBuffers[j]);
+                    }
+                }
+                delete [] sound->m_MixSlots;
+            }
+
             if (sound->m_Device)
             {
                 sound->m_DeviceType->m_Close(sound->m_Device);
@@ -843,6 +890,97 @@ namespace dmSound
         *right_scale = sinf(theta);
     }
 
+    // The resamplers convert the frames in chunks on the stack, before they are scaled and added to the mix buffer
+    const uint32_t MIX_CHUNK_FRAMES = 64;
+
+#if defined(DM_SIMD_SSE) || defined(DM_SIMD_NEON)
+
+    // Ramp::GetValue() for the samples i to i+3
+    static inline Float4 GetRampValues4(const Ramp& ramp, uint32_t i)
+    {
+        const float fi = (float) i;
+        Float4 mix = Mul4(Set4(fi, fi + 1.0f, fi + 2.0f, fi + 3.0f), Splat4(ramp.m_TotalSamplesRecip));
+        return Add4(Splat4(ramp.m_From), Mul4(mix, Splat4(ramp.m_To - ramp.m_From)));
+    }
+#endif
+
+    /*
+     * Adds mono frames to the interleaved stereo mix buffer, scaled by the gain and pan ramps.
+     * The ramps are evaluated from sample 'offset' and onwards
+     */
+    static void MixScaledMono(const float* frames, uint32_t count, const Ramp& gain_ramp, const Ramp& pan_ramp, uint32_t offset, float* mix_buffer)
+    {
+        uint32_t i = 0;
+#if defined(DM_SIMD_SSE) || defined(DM_SIMD_NEON)
+        // The pan is constant unless it is being changed, which saves us the sin/cos for each frame
+        if (pan_ramp.m_From == pan_ramp.m_To)
+        {
+            float left_scale, right_scale;
+            GetPanScale(pan_ramp.m_From, &left_scale, &right_scale);
+            Float4 left = Splat4(left_scale);
+            Float4 right = Splat4(right_scale);
+            for (; i + 4 <= count; i += 4)
+            {
+                Float4 s = Mul4(Load4(frames + i), GetRampValues4(gain_ramp, offset + i));
+                Float4 l = Mul4(s, left);
+                Float4 r = Mul4(s, right);
+                float* out = mix_buffer + 2 * i;
+                Store4(out, Add4(Load4(out), ZipLo4(l, r)));
+                Store4(out + 4, Add4(Load4(out + 4), ZipHi4(l, r)));
+            }
+        }
+#endif
+        for (; i < count; i++)
+        {
+            float gain = gain_ramp.GetValue(offset + i);
+            float pan = pan_ramp.GetValue(offset + i);
+            float s = frames[i] * gain;
+
+            float left_scale, right_scale;
+            GetPanScale(pan, &left_scale, &right_scale);
+            mix_buffer[2 * i]       += s * left_scale;
+            mix_buffer[2 * i + 1]   += s * right_scale;
+        }
+    }
+
+    /*
+     * Adds interleaved stereo frames to the interleaved stereo mix buffer, scaled by the gain and pan ramps.
+     * The ramps are evaluated from sample 'offset' and onwards
+     */
+    static void MixScaledStereo(const float* frames, uint32_t count, const Ramp& gain_ramp, const Ramp& pan_ramp, uint32_t offset, float* mix_buffer)
+    {
+        uint32_t i = 0;
+#if defined(DM_SIMD_SSE) || defined(DM_SIMD_NEON)
+        if (pan_ramp.m_From == pan_ramp.m_To)
+        {
+            float left_scale, right_scale;
+            GetPanScale(pan_ramp.m_From, &left_scale, &right_scale);
+            Float4 left_right = Set4(left_scale, right_scale, left_scale, right_scale);
+            for (; i + 4 <= count; i += 4)
+            {
+                Float4 gain = GetRampValues4(gain_ramp, offset + i);
+                Float4 s_lo = Mul4(Mul4(Load4(frames + 2 * i), ZipLo4(gain, gain)), left_right);
+                Float4 s_hi = Mul4(Mul4(Load4(frames + 2 * i + 4), ZipHi4(gain, gain)), left_right);
+                float* out = mix_buffer + 2 * i;
+                Store4(out, Add4(Load4(out), s_lo));
+                Store4(out + 4, Add4(Load4(out + 4), s_hi));
+            }
+        }
+#endif
+        for (; i < count; i++)
+        {
+            float gain = gain_ramp.GetValue(offset + i);
+            float pan = pan_ramp.GetValue(offset + i);
+            float s1 = frames[2 * i] * gain;
+            float s2 = frames[2 * i + 1] * gain;
+
+            float left_scale, right_scale;
+            GetPanScale(pan, &left_scale, &right_scale);
+            mix_buffer[2 * i]       += s1 * left_scale;
+            mix_buffer[2 * i + 1]   += s2 * right_scale;
+        }
+    }
+
     /*
      *
      * Template parameters
@@ -871,29 +1009,27 @@ namespace dmSound
 
         Ramp gain_ramp = GetRamp(mix_context, &instance->m_Gain, mix_buffer_count);
         Ramp pan_ramp = GetRamp(mix_context, &instance->m_Pan, mix_buffer_count);
-        for (uint32_t i = 0; i < mix_buffer_count; i++)
-        {
-            float gain = gain_ramp.GetValue(i);
-            float pan = pan_ramp.GetValue(i);
-            float mix = frac * range_recip; // determines the bias between two consecutive samples in the sound instance. It ranges from 0-1. A mix of 0, makes only the first sample count while a mix of 0.5 will count equally both samples.
-            T s1 = frames[index];
-            T s2 = frames[index + 1];
-            s1 = (s1 - offset) * scale;
-            s2 = (s2 - offset) * scale;
 
-            float left_scale, right_scale;
-            GetPanScale(pan, &left_scale, &right_scale);
+        float resampled[MIX_CHUNK_FRAMES];
+        for (uint32_t chunk = 0; chunk < mix_buffer_count; chunk += MIX_CHUNK_FRAMES)
+        {
+            uint32_t count = dmMath::Min(MIX_CHUNK_FRAMES, mix_buffer_count - chunk);
+            for (uint32_t i = 0; i < count; i++)
+            {
+                float mix = frac * range_recip; // determines the bias between two consecutive samples in the sound instance. It ranges from 0-1. A mix of 0, makes only the first sample count while a mix of 0.5 will count equally both samples.
+                float s1 = ((float) frames[index] - offset) * scale;
+                float s2 = ((float) frames[index + 1] - offset) * scale;
 
-            float s = (1.0f - mix) * s1 + mix * s2; // resulting destination sample value is a mix of two source samples since a kind of fractional indexing is used
-            mix_buffer[2 * i] += s * gain * left_scale;
-            mix_buffer[2 * i + 1] += s * gain * right_scale;
+                resampled[i] = (1.0f - mix) * s1 + mix * s2; // resulting destination sample value is a mix of two source samples since a kind of fractional indexing is used
 
-            prev_index = index; // keep old index for assertion
-            frac += delta;
+                prev_index = index; // keep old index for assertion
+                frac += delta;
 
-            index += (uint32_t)(frac >> RESAMPLE_FRACTION_BITS);
+                index += (uint32_t)(frac >> RESAMPLE_FRACTION_BITS);
 
-            frac &= ((1U << RESAMPLE_FRACTION_BITS) - 1U); // Keep lower RESAMPLE_FRACTION_BITS bits. Clear higher.
+                frac &= ((1U << RESAMPLE_FRACTION_BITS) - 1U); // Keep lower RESAMPLE_FRACTION_BITS bits. Clear higher.
+            }
+            MixScaledMono(resampled, count, gain_ramp, pan_ramp, chunk, mix_buffer + 2 * chunk);
         }
         instance->m_FrameFraction = frac;
 
@@ -926,34 +1062,30 @@ namespace dmSound
 
         Ramp gain_ramp = GetRamp(mix_context, &instance->m_Gain, mix_buffer_count);
         Ramp pan_ramp = GetRamp(mix_context, &instance->m_Pan, mix_buffer_count);
-        for (uint32_t i = 0; i < mix_buffer_count; i++)
+
+        float resampled[2 * MIX_CHUNK_FRAMES];
+        for (uint32_t chunk = 0; chunk < mix_buffer_count; chunk += MIX_CHUNK_FRAMES)
         {
-            float gain = gain_ramp.GetValue(i);
-            float pan = pan_ramp.GetValue(i);
-            float mix = frac * range_recip;
-            T sl1 = frames[2 * index];
-            T sl2 = frames[2 * index + 2];
-            sl1 = (sl1 - offset) * scale;
-            sl2 = (sl2 - offset) * scale;
-
-            T sr1 = frames[2 * index + 1];
-            T sr2 = frames[2 * index + 3];
-            sr1 = (sr1 - offset) * scale;
-            sr2 = (sr2 - offset) * scale;
+            uint32_t count = dmMath::Min(MIX_CHUNK_FRAMES, mix_buffer_count - chunk);
+            for (uint32_t i = 0; i < count; i++)
+            {
+                float mix = frac * range_recip;
+                float sl1 = ((float) frames[2 * index] - offset) * scale;
+                float sl2 = ((float) frames[2 * index + 2] - offset) * scale;
 
-            float left_scale, right_scale;
-            GetPanScale(pan, &left_scale, &right_scale);
+                float sr1 = ((float) frames[2 * index + 1] - offset) * scale;
+                float sr2 = ((float) frames[2 * index + 3] - offset) * scale;
 
-            float sl = (1.0f - mix) * sl1 + mix * sl2;
-            float sr = (1.0f - mix) * sr1 + mix * sr2;
-            mix_buffer[2 * i]       += sl * gain * left_scale;
-            mix_buffer[2 * i + 1]   += sr * gain * right_scale;
+                resampled[2 * i]     = (1.0f - mix) * sl1 + mix * sl2;
+                resampled[2 * i + 1] = (1.0f - mix) * sr1 + mix * sr2;
 
-            prev_index = index;
-            frac += delta;
-            index += (uint32_t)(frac >> RESAMPLE_FRACTION_BITS);
+                prev_index = index;
+                frac += delta;
+                index += (uint32_t)(frac >> RESAMPLE_FRACTION_BITS);
 
-            frac &= ((1U << RESAMPLE_FRACTION_BITS) - 1U);
+                frac &= ((1U << RESAMPLE_FRACTION_BITS) - 1U);
+            }
+            MixScaledStereo(resampled, count, gain_ramp, pan_ramp, chunk, mix_buffer + 2 * chunk);
         }
         instance->m_FrameFraction = frac;
 
@@ -973,17 +1105,15 @@ namespace dmSound
         Ramp gain_ramp = GetRamp(mix_context, &instance->m_Gain, mix_buffer_count);
         Ramp pan_ramp = GetRamp(mix_context, &instance->m_Pan, mix_buffer_count);
 
-        for (uint32_t i = 0; i < mix_buffer_count; i++)
+        float converted[MIX_CHUNK_FRAMES];
+        for (uint32_t chunk = 0; chunk < mix_buffer_count; chunk += MIX_CHUNK_FRAMES)
         {
-            float gain = gain_ramp.GetValue(i);
-            float pan = pan_ramp.GetValue(i);
-            float s = frames[i];
-            s = (s - offset) * scale * gain;
-
-            float left_scale, right_scale;
-            GetPanScale(pan, &left_scale, &right_scale);
-            mix_buffer[2 * i]       += s * left_scale;
-            mix_buffer[2 * i + 1]   += s * right_scale;
+            uint32_t count = dmMath::Min(MIX_CHUNK_FRAMES, mix_buffer_count - chunk);
+            for (uint32_t i = 0; i < count; i++)
+            {
+                converted[i] = ((float) frames[chunk + i] - offset) * scale;
+            }
+            MixScaledMono(converted, count, gain_ramp, pan_ramp, chunk, mix_buffer + 2 * chunk);
         }
         instance->m_FrameCount -= mix_buffer_count;
     }
@@ -998,19 +1128,15 @@ namespace dmSound
         Ramp gain_ramp = GetRamp(mix_context, &instance->m_Gain, mix_buffer_count);
         Ramp pan_ramp = GetRamp(mix_context, &instance->m_Pan, mix_buffer_count);
 
-        for (uint32_t i = 0; i < mix_buffer_count; i++)
+        float converted[2 * MIX_CHUNK_FRAMES];
+        for (uint32_t chunk = 0; chunk < mix_buffer_count; chunk += MIX_CHUNK_FRAMES)
         {
-            float gain = gain_ramp.GetValue(i);
-            float pan = pan_ramp.GetValue(i);
-            float s1 = frames[2 * i];
-            float s2 = frames[2 * i + 1];
-            s1 = (s1 - offset) * scale * gain;
-            s2 = (s2 - offset) * scale * gain;
-
-            float left_scale, right_scale;
-            GetPanScale(pan, &left_scale, &right_scale);
-            mix_buffer[2 * i]       += s1 * left_scale;
-            mix_buffer[2 * i + 1]   += s2 * right_scale;
+            uint32_t count = dmMath::Min(MIX_CHUNK_FRAMES, mix_buffer_count - chunk);
+            for (uint32_t i = 0; i < 2 * count; i++)
+            {
+                converted[i] = ((float) frames[2 * chunk + i] - offset) * scale;
+            }
+            MixScaledStereo(converted, count, gain_ramp, pan_ramp, chunk, mix_buffer + 2 * chunk);
         }
         instance->m_FrameCount -= mix_buffer_count;
     }
@@ -1077,7 +1203,24 @@ namespace dmSound
         mixer(mix_context, instance, rate, mix_rate, mix_buffer, mix_buffer_count);
     }
 
-    static void Mix(const MixContext* mix_context, SoundInstance* instance, const dmSoundCodec::Info* info)
+    // Returns the cleared accumulation buffer for the group in the slot
+    static float* GetSlotMixBuffer(SoundSystem* sound, MixSlot* slot, int group_index)
+    {
+        size_t mix_buffer_size = sound->m_FrameCount * sizeof(float) * SOUND_MAX_MIX_CHANNELS;
+        if (!slot->m_Used[group_index])
+        {
+            if (!slot->m_MixBuffers[group_index])
+            {
+                slot->m_MixBuffers[group_index] = (float*) malloc(mix_buffer_size);
+            }
+            memset(slot->m_MixBuffers[group_index], 0, mix_buffer_size);
+            slot->m_Used[group_index] = true;
+        }
+        return slot->m_MixBuffers[group_index];
+    }
+
+    // The slot is 0x0 when mixing directly to the group mix buffers
+    static void Mix(const MixContext* mix_context, SoundInstance* instance, const dmSoundCodec::Info* info, MixSlot* slot)
     {
         DM_PROFILE(Sound, "Mix")
 
@@ -1090,7 +1233,8 @@ namespace dmSound
         int* index = sound->m_GroupMap.Get(instance->m_Group);
         if (index) {
             SoundGroup* group = &sound->m_Groups[*index];
-            MixResample(mix_context, instance, info, sound->m_MixRate, group->m_MixBuffer, mix_count);
+            float* mix_buffer = slot ? GetSlotMixBuffer(sound, slot, *index) : group->m_MixBuffer;
+            MixResample(mix_context, instance, info, sound->m_MixRate, mix_buffer, mix_count);
         } else {
             dmLogError("Sound group not found");
         }
@@ -1126,7 +1270,7 @@ namespace dmSound
         return false;
     }
 
-    static void MixInstance(const MixContext* mix_context, SoundInstance* instance) {
+    static void MixInstance(const MixContext* mix_context, SoundInstance* instance, MixSlot* slot) {
         SoundSystem* sound = g_SoundSystem;
         uint32_t decoded = 0;
 
@@ -1218,7 +1362,7 @@ namespace dmSound
         }
 
         if (instance->m_FrameCount > 0)
-            Mix(mix_context, instance, &info);
+            Mix(mix_context, instance, &info, slot);
 
         if (instance->m_FrameCount <= 1 && instance->m_EndOfStream) {
             // NOTE: Due to round-off errors, e.g 32000 -> 44100,
@@ -1228,6 +1372,60 @@ namespace dmSound
         }
     }
 
+    struct MixSlotsContext
+    {
+        const MixContext* m_MixContext;
+        SoundSystem*      m_Sound;
+    };
+
+    // Each slot mixes every n:th instance, to even out the cost of the different decoders
+    static void MixSlots(void* _ctx, uint32_t begin, uint32_t end)
+    {
+        DM_PROFILE(Sound, "MixSlots");
+        MixSlotsContext* ctx = (MixSlotsContext*) _ctx;
+        SoundSystem* sound = ctx->m_Sound;
+        const uint32_t slot_count = sound->m_MixSlotCount;
+        const uint32_t instance_count = sound->m_MixIndices.Size();
+        for (uint32_t slot = begin; slot < end; ++slot)
+        {
+            for (uint32_t i = slot; i < instance_count; i += slot_count)
+            {
+                MixInstance(ctx->m_MixContext, &sound->m_Instances[sound->m_MixIndices[i]], &sound->m_MixSlots[slot]);
+            }
+        }
+    }
+
+    // Decodes and mixes the instances on the mix threads, into the accumulation buffers of the slots.
+    // The slot buffers are then added to the group mix buffers
+    static void MixInstancesParallel(const MixContext* mix_context)
+    {
+        SoundSystem* sound = g_SoundSystem;
+
+        MixSlotsContext ctx;
+        ctx.m_MixContext = mix_context;
+        ctx.m_Sound = sound;
+        dmJobPool::ParallelFor(sound->m_MixPool, sound->m_MixSlotCount, 1, MixSlots, &ctx);
+
+        DM_PROFILE(Sound, "ReduceMixSlots");
+        const uint32_t n = sound->m_FrameCount * SOUND_MAX_MIX_CHANNELS;
+        for (uint32_t i = 0; i < sound->m_MixSlotCount; ++i)
+        {
+            MixSlot* slot = &sound->m_MixSlots[i];
+            for (uint32_t g = 0; g < MAX_GROUPS; ++g)
+            {
+                if (!slot->m_Used[g])
+                    continue;
+                const float* in = slot->m_MixBuffers[g];
+                float* out = sound->m_Groups[g].m_MixBuffer;
+                for (uint32_t j = 0; j < n; ++j)
+                {
+                    out[j] += in[j];
+                }
+                slot->m_Used[g] = false;
+            }
+        }
+    }
+
     static void MixInstances(const MixContext* mix_context) {
         DM_PROFILE(Sound, "MixInstances")
         SoundSystem* sound = g_SoundSystem;
@@ -1265,11 +1463,30 @@ namespace dmSound
         }
 
         uint32_t instances = sound->m_Instances.Size();
+        bool parallel = false;
+        if (sound->m_MixPool)
+        {
+            sound->m_MixIndices.SetSize(0);
+            for (uint32_t i = 0; i < instances; ++i) {
+                SoundInstance* instance = &sound->m_Instances[i];
+                if (instance->m_Playing || instance->m_FrameCount > 0)
+                {
+                    sound->m_MixIndices.Push((uint16_t) i);
+                }
+            }
+            parallel = sound->m_MixIndices.Size() > 1;
+        }
+
+        if (parallel)
+        {
+            MixInstancesParallel(mix_context);
+        }
+
         for (uint32_t i = 0; i < instances; ++i) {
             SoundInstance* instance = &sound->m_Instances[i];
-            if (instance->m_Playing || instance->m_FrameCount > 0)
+            if (!parallel && (instance->m_Playing || instance->m_FrameCount > 0))
             {
-                MixInstance(mix_context, instance);
+                MixInstance(mix_context, instance, 0);
             }
 
             if (instance->m_EndOfStream && instance->m_FrameCount == 0) {
@@ -1278,6 +1495,63 @@ namespace dmSound
         }
     }
 
+    // Adds the group mix buffer to the master mix buffer, scaled by the clamped gain ramp
+    static void MixGroup(const float* group_buffer, uint32_t n, const Ramp& ramp, float* mix_buffer)
+    {
+        uint32_t i = 0;
+#if defined(DM_SIMD_SSE) || defined(DM_SIMD_NEON)
+        Float4 zero = Splat4(0.0f);
+        Float4 one = Splat4(1.0f);
+        for (; i + 4 <= n; i += 4)
+        {
+            Float4 gain = Min4(Max4(GetRampValues4(ramp, i), zero), one);
+            const float* in = group_buffer + 2 * i;
+            float* out = mix_buffer + 2 * i;
+            Store4(out, Add4(Load4(out), Mul4(Load4(in), ZipLo4(gain, gain))));
+            Store4(out + 4, Add4(Load4(out + 4), Mul4(Load4(in + 4), ZipHi4(gain, gain))));
+        }
+#endif
+        for (; i < n; i++) {
+            float gain = ramp.GetValue(i);
+            gain = dmMath::Clamp(gain, 0.0f, 1.0f);
+
+            float s1 = group_buffer[2 * i];
+            float s2 = group_buffer[2 * i + 1];
+            mix_buffer[2 * i] += s1 * gain;
+            mix_buffer[2 * i + 1] += s2 * gain;
+        }
+    }
+
+    // Scales the master mix buffer by the gain ramp, and clamps it to the 16 bit output buffer
+    static void MasterClamp(const float* mix_buffer, uint32_t n, const Ramp& ramp, int16_t* out)
+    {
+        uint32_t i = 0;
+#if defined(DM_SIMD_SSE) || defined(DM_SIMD_NEON)
+        Float4 min = Splat4(-32768.0f);
+        Float4 max = Splat4(32767.0f);
+        for (; i + 4 <= n; i += 4)
+        {
+            Float4 gain = GetRampValues4(ramp, i);
+            Float4 s_lo = Mul4(Load4(mix_buffer + 2 * i), ZipLo4(gain, gain));
+            Float4 s_hi = Mul4(Load4(mix_buffer + 2 * i + 4), ZipHi4(gain, gain));
+            s_lo = Max4(min, Min4(max, s_lo));
+            s_hi = Max4(min, Min4(max, s_hi));
+            StoreInt16x8(out + 2 * i, s_lo, s_hi);
+        }
+#endif
+        for (; i < n; i++) {
+            float gain = ramp.GetValue(i);
+            float s1 = mix_buffer[2 * i] * gain;
+            float s2 = mix_buffer[2 * i + 1] * gain;
+            s1 = dmMath::Min(32767.0f, s1);
+            s1 = dmMath::Max(-32768.0f, s1);
+            s2 = dmMath::Min(32767.0f, s2);
+            s2 = dmMath::Max(-32768.0f, s2);
+            out[2 * i] = (int16_t) s1;
+            out[2 * i + 1] = (int16_t) s2;
+        }
+    }
+
     static void Master(const MixContext* mix_context) {
         DM_PROFILE(Sound, "Master")
 
@@ -1309,29 +1583,11 @@ namespace dmSound
                 continue;
             }
             Ramp ramp = GetRamp(mix_context, &g->m_Gain, n);
-            for (uint32_t i = 0; i < n; i++) {
-                float gain = ramp.GetValue(i);
-                gain = dmMath::Clamp(gain, 0.0f, 1.0f);
-
-                float s1 = g->m_MixBuffer[2 * i];
-                float s2 = g->m_MixBuffer[2 * i + 1];
-                mix_buffer[2 * i] += s1 * gain;
-                mix_buffer[2 * i + 1] += s2 * gain;
-            }
+            MixGroup(g->m_MixBuffer, n, ramp, mix_buffer);
         }
 
         Ramp ramp = GetRamp(mix_context, &master->m_Gain, n);
-        for (uint32_t i = 0; i < n; i++) {
-            float gain = ramp.GetValue(i);
-            float s1 = mix_buffer[2 * i] * gain;
-            float s2 = mix_buffer[2 * i + 1] * gain;
-            s1 = dmMath::Min(32767.0f, s1);
-            s1 = dmMath::Max(-32768.0f, s1);
-            s2 = dmMath::Min(32767.0f, s2);
-            s2 = dmMath::Max(-32768.0f, s2);
-            out[2 * i] = (int16_t) s1;
-            out[2 * i + 1] = (int16_t) s2;
-        }
+        MasterClamp(mix_buffer, n, ramp, out);
     }
 
     static void StepGroupValues()
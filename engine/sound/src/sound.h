@@ -81,6 +81,8 @@ namespace dmSound
         uint32_t m_BufferSize;
         uint32_t m_FrameCount;
         uint32_t m_MaxInstances;
+        // Number of worker threads for decoding and mixing the sound instances. 0 mixes on the sound thread
+        uint32_t m_MixThreadCount;
         bool     m_UseThread;
 
         InitializeParams()
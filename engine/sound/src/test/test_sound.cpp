@@ -1484,6 +1484,68 @@ const TestParams2 params_mixer_test[] = {
 INSTANTIATE_TEST_CASE_P(dmSoundMixerTest, dmSoundMixerTest, jc_test_values_in(params_mixer_test));
 #endif
 
+// Mixes N looping instances into the output buffer.
+// Half of the instances are resampled (mono 22050hz), and half are mixed as is (stereo 44100hz)
+static void MixLoopingInstances(uint32_t instance_count, uint32_t mix_thread_count, uint32_t update_count, dmArray<int16_t>& output)
+{
+    dmSound::InitializeParams params;
+    params.m_MaxInstances = instance_count;
+    params.m_MixThreadCount = mix_thread_count;
+    params.m_OutputDevice = "loopback";
+    params.m_FrameCount = 2048;
+    params.m_UseThread = false;
+    ASSERT_EQ(dmSound::RESULT_OK, dmSound::Initialize(0, &params));
+
+    dmSound::HSoundData sound_data[2] = {0, 0};
+    ASSERT_EQ(dmSound::RESULT_OK, dmSound::NewSoundData(MONO_TONE_440_22050_44100_WAV, MONO_TONE_440_22050_44100_WAV_SIZE, dmSound::SOUND_DATA_TYPE_WAV, &sound_data[0], 1));
+    ASSERT_EQ(dmSound::RESULT_OK, dmSound::NewSoundData(STEREO_TONE_440_44100_88200_WAV, STEREO_TONE_440_44100_88200_WAV_SIZE, dmSound::SOUND_DATA_TYPE_WAV, &sound_data[1], 2));
+
+    dmArray<dmSound::HSoundInstance> instances;
+    instances.SetCapacity(instance_count);
+    for (uint32_t i = 0; i < instance_count; ++i)
+    {
+        dmSound::HSoundInstance instance = 0;
+        ASSERT_EQ(dmSound::RESULT_OK, dmSound::NewSoundInstance(sound_data[i % 2], &instance));
+        ASSERT_EQ(dmSound::RESULT_OK, dmSound::SetLooping(instance, true, -1));
+        ASSERT_EQ(dmSound::RESULT_OK, dmSound::SetParameter(instance, dmSound::PARAMETER_GAIN, Vectormath::Aos::Vector4(1.0f / instance_count, 0, 0, 0)));
+        ASSERT_EQ(dmSound::RESULT_OK, dmSound::Play(instance));
+        instances.Push(instance);
+    }
+
+    for (uint32_t i = 0; i < update_count; ++i)
+    {
+        ASSERT_EQ(dmSound::RESULT_OK, dmSound::Update());
+    }
+
+    output.SetCapacity(g_LoopbackDevice->m_AllOutput.Size());
+    output.SetSize(0);
+    output.PushArray(g_LoopbackDevice->m_AllOutput.Begin(), g_LoopbackDevice->m_AllOutput.Size());
+
+    for (uint32_t i = 0; i < instance_count; ++i)
+    {
+        ASSERT_EQ(dmSound::RESULT_OK, dmSound::DeleteSoundInstance(instances[i]));
+    }
+    ASSERT_EQ(dmSound::RESULT_OK, dmSound::DeleteSoundData(sound_data[0]));
+    ASSERT_EQ(dmSound::RESULT_OK, dmSound::DeleteSoundData(sound_data[1]));
+    ASSERT_EQ(dmSound::RESULT_OK, dmSound::Finalize());
+}
+
+// The mix threads only change the order of the additions
+TEST(dmSoundMixThreads, SameOutput)
+{
+    dmArray<int16_t> expected;
+    dmArray<int16_t> output;
+    MixLoopingInstances(16, 0, 20, expected);
+    MixLoopingInstances(16, 3, 20, output);
+
+    ASSERT_LT(0U, expected.Size());
+    ASSERT_EQ(expected.Size(), output.Size());
+    for (uint32_t i = 0; i < expected.Size(); ++i)
+    {
+        ASSERT_NEAR(expected[i], output[i], 1);
+    }
+}
+
 DM_DECLARE_SOUND_DEVICE(LoopBackDevice, "loopback", DeviceLoopbackOpen, DeviceLoopbackClose, DeviceLoopbackQueue, DeviceLoopbackFreeBufferSlots, DeviceLoopbackDeviceInfo, DeviceLoopbackRestart, DeviceLoopbackStop);
 
 int main(int argc, char **argv)
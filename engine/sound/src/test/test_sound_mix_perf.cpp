@@ -0,0 +1,149 @@
+// Copyright 2020 The Defold Foundation
+// Licensed under the Defold License version 1.0 (the "License"); you may not use
+// this file except in compliance with the License.
+//
+// You may obtain a copy of the License, together with FAQs at
+// https://www.defold.com/license
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include <stdio.h>
+#include <stdlib.h>
+#define JC_TEST_IMPLEMENTATION
+#include <jc_test/jc_test.h>
+#include <dlib/array.h>
+#include <dlib/time.h>
+#include "../sound.h"
+
+#include "test/mono_tone_440_22050_44100.wav.embed.h"
+#include "test/stereo_tone_440_44100_88200.wav.embed.h"
+
+// Discards the mixed buffers, and asks for one buffer each update
+struct BenchSoundDevice
+{
+    uint32_t m_BuffersQueued;
+};
+
+BenchSoundDevice* g_BenchDevice = 0;
+
+dmSound::Result DeviceBenchOpen(const dmSound::OpenDeviceParams* params, dmSound::HDevice* device)
+{
+    BenchSoundDevice* d = new BenchSoundDevice;
+    d->m_BuffersQueued = 0;
+    *device = d;
+    g_BenchDevice = d;
+    return dmSound::RESULT_OK;
+}
+
+void DeviceBenchClose(dmSound::HDevice device)
+{
+    delete (BenchSoundDevice*) device;
+    g_BenchDevice = 0;
+}
+
+dmSound::Result DeviceBenchQueue(dmSound::HDevice device, const int16_t* samples, uint32_t sample_count)
+{
+    ((BenchSoundDevice*) device)->m_BuffersQueued++;
+    return dmSound::RESULT_OK;
+}
+
+uint32_t DeviceBenchFreeBufferSlots(dmSound::HDevice device)
+{
+    return 1;
+}
+
+void DeviceBenchDeviceInfo(dmSound::HDevice device, dmSound::DeviceInfo* info)
+{
+    info->m_MixRate = 44100;
+}
+
+void DeviceBenchRestart(dmSound::HDevice device)
+{
+
+}
+
+void DeviceBenchStop(dmSound::HDevice device)
+{
+
+}
+
+// Mixes N looping instances for a number of updates, and returns the number of mixed buffers.
+// Half of the instances are resampled (mono 22050hz), and half are mixed as is (stereo 44100hz)
+static uint32_t MixLoopingInstances(uint32_t instance_count, uint32_t mix_thread_count, uint32_t update_count, uint64_t* elapsed)
+{
+    dmSound::InitializeParams params;
+    params.m_MaxInstances = instance_count;
+    params.m_MixThreadCount = mix_thread_count;
+    params.m_OutputDevice = "bench";
+    params.m_FrameCount = 2048;
+    params.m_UseThread = false;
+    if (dmSound::Initialize(0, &params) != dmSound::RESULT_OK)
+    {
+        return 0;
+    }
+
+    dmSound::HSoundData sound_data[2] = {0, 0};
+    dmSound::NewSoundData(MONO_TONE_440_22050_44100_WAV, MONO_TONE_440_22050_44100_WAV_SIZE, dmSound::SOUND_DATA_TYPE_WAV, &sound_data[0], 1);
+    dmSound::NewSoundData(STEREO_TONE_440_44100_88200_WAV, STEREO_TONE_440_44100_88200_WAV_SIZE, dmSound::SOUND_DATA_TYPE_WAV, &sound_data[1], 2);
+
+    dmArray<dmSound::HSoundInstance> instances;
+    instances.SetCapacity(instance_count);
+    for (uint32_t i = 0; i < instance_count; ++i)
+    {
+        dmSound::HSoundInstance instance = 0;
+        dmSound::NewSoundInstance(sound_data[i % 2], &instance);
+        dmSound::SetLooping(instance, true, -1);
+        dmSound::SetParameter(instance, dmSound::PARAMETER_GAIN, Vectormath::Aos::Vector4(1.0f / instance_count, 0, 0, 0));
+        dmSound::Play(instance);
+        instances.Push(instance);
+    }
+
+    uint64_t start = dmTime::GetTime();
+    for (uint32_t i = 0; i < update_count; ++i)
+    {
+        dmSound::Update();
+    }
+    *elapsed = dmTime::GetTime() - start;
+
+    uint32_t buffer_count = g_BenchDevice->m_BuffersQueued;
+
+    for (uint32_t i = 0; i < instance_count; ++i)
+    {
+        dmSound::DeleteSoundInstance(instances[i]);
+    }
+    dmSound::DeleteSoundData(sound_data[0]);
+    dmSound::DeleteSoundData(sound_data[1]);
+    dmSound::Finalize();
+    return buffer_count;
+}
+
+// With and without mix threads
+TEST(dmSoundBenchmark, MixInstances)
+{
+    const uint32_t instance_counts[] = {1, 8, 32, 64};
+    const uint32_t mix_thread_counts[] = {0, 3};
+    const uint32_t update_count = 50;
+
+    for (uint32_t c = 0; c < DM_ARRAY_SIZE(instance_counts); ++c)
+    {
+        for (uint32_t t = 0; t < DM_ARRAY_SIZE(mix_thread_counts); ++t)
+        {
+            uint64_t elapsed = 0;
+            uint32_t buffer_count = MixLoopingInstances(instance_counts[c], mix_thread_counts[t], update_count, &elapsed);
+            ASSERT_LT(0U, buffer_count);
+            printf("Mixed %u instances on %u mix threads: %u buffers in %.3f ms, %.3f ms per buffer\n",
+                    instance_counts[c], mix_thread_counts[t], buffer_count, elapsed / 1000.0f, elapsed / (1000.0f * buffer_count));
+        }
+    }
+}
+
+DM_DECLARE_SOUND_DEVICE(BenchDevice, "bench", DeviceBenchOpen, DeviceBenchClose, DeviceBenchQueue, DeviceBenchFreeBufferSlots, DeviceBenchDeviceInfo, DeviceBenchRestart, DeviceBenchStop);
+
+int main(int argc, char **argv)
+{
+    jc_test_init(&argc, argv);
+    return jc_test_run_all();
+}